@@ -9,11 +9,13 @@
 #include "validation.h"
 #include "util.h"
 #include "random.h"
+#include <libdevcore/SHA3.h>
 
 int
 main(int argc, char** argv)
 {
     SHA256AutoDetect();
+    dev::sha3AutoDetect();
     RandomInit();
     ECC_Start();
     SetupEnvironment();
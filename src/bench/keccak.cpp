@@ -0,0 +1,61 @@
+// Copyright (c) 2016 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include <libdevcore/SHA3.h>
+
+/* Number of bytes to hash per iteration */
+static const uint64_t BUFFER_SIZE = 1000*1000;
+
+/* Number of independent inputs hashed per iteration, as the keys and nodes of a trie commit */
+static const size_t INPUT_COUNT = 4096;
+
+static std::vector<dev::bytes> Inputs(size_t size)
+{
+    std::vector<dev::bytes> inputs(INPUT_COUNT, dev::bytes(size));
+    for (size_t i = 0; i < inputs.size(); i++)
+        for (size_t j = 0; j < size; j++)
+            inputs[i][j] = (uint8_t)(i * 31 + j);
+    return inputs;
+}
+
+static void HashOneByOne(benchmark::State& state, size_t size)
+{
+    std::vector<dev::bytes> inputs = Inputs(size);
+    dev::h256 hash;
+    while (state.KeepRunning()) {
+        for (dev::bytes const& in : inputs)
+            dev::sha3(dev::bytesConstRef(&in), hash.ref());
+    }
+}
+
+static void HashBatch(benchmark::State& state, size_t size)
+{
+    std::vector<dev::bytes> inputs = Inputs(size);
+    std::vector<dev::bytesConstRef> refs;
+    for (dev::bytes const& in : inputs)
+        refs.push_back(dev::bytesConstRef(&in));
+    while (state.KeepRunning())
+        dev::sha3Batch(refs);
+}
+
+static void Keccak256(benchmark::State& state)
+{
+    dev::h256 hash;
+    dev::bytes in(BUFFER_SIZE, 0);
+    while (state.KeepRunning())
+        dev::sha3(dev::bytesConstRef(&in), hash.ref());
+}
+
+static void Keccak256_32b(benchmark::State& state) { HashOneByOne(state, 32); }
+static void Keccak256_32b_Batch(benchmark::State& state) { HashBatch(state, 32); }
+static void Keccak256_532b(benchmark::State& state) { HashOneByOne(state, 532); }
+static void Keccak256_532b_Batch(benchmark::State& state) { HashBatch(state, 532); }
+
+BENCHMARK(Keccak256);
+BENCHMARK(Keccak256_32b);
+BENCHMARK(Keccak256_32b_Batch);
+BENCHMARK(Keccak256_532b);
+BENCHMARK(Keccak256_532b_Batch);
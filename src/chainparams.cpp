@@ -12,6 +12,7 @@
 #include "utilstrencodings.h"
 
 #include <assert.h>
+#include <limits>
 
 #include "chainparamsseeds.h"
 
@@ -199,6 +200,7 @@ public:
                 COINBASE_MATURITY;
 
         consensus.nFixUTXOCacheHFHeight=100000;
+        consensus.nPrecompilesHFHeight=std::numeric_limits<int>::max(); // not scheduled yet
     }
 };
 
@@ -314,6 +316,7 @@ public:
                 COINBASE_MATURITY;
 
         consensus.nFixUTXOCacheHFHeight=84500;
+        consensus.nPrecompilesHFHeight=std::numeric_limits<int>::max(); // not scheduled yet
     }
 };
 
@@ -389,6 +392,7 @@ public:
         consensus.nFirstMPoSBlock = 5000;
 
         consensus.nFixUTXOCacheHFHeight=0;
+        consensus.nPrecompilesHFHeight=0;
 
         base58Prefixes[PUBKEY_ADDRESS] = std::vector<unsigned char>(1,120);
         base58Prefixes[SCRIPT_ADDRESS] = std::vector<unsigned char>(1,110);
@@ -69,6 +69,8 @@ struct Params {
     int nFirstMPoSBlock;
     int nMPoSRewardRecipients;
     int nFixUTXOCacheHFHeight;
+    /** Block height from which the precompiled contracts 0x05-0x09 (modexp, bn128 add/mul/pairing, blake2f) run */
+    int nPrecompilesHFHeight;
 };
 } // namespace Consensus
 
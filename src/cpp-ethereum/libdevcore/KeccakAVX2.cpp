@@ -0,0 +1,48 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file KeccakAVX2.cpp
+ *
+ * Keccak-f[1600] on 4 states at once, built with AVX2 and only called once the CPU is known to have it.
+ */
+
+#include <immintrin.h>
+#include "KeccakF1600.h"
+
+namespace
+{
+
+struct AVX2Ops
+{
+	using Lane = __m256i;
+
+	static inline Lane bxor(Lane _a, Lane _b) { return _mm256_xor_si256(_a, _b); }
+	static inline Lane andnot(Lane _a, Lane _b) { return _mm256_andnot_si256(_a, _b); }
+	template <int N> static inline Lane rol(Lane _a) { return _mm256_or_si256(_mm256_slli_epi64(_a, N), _mm256_srli_epi64(_a, 64 - N)); }
+	static inline Lane constant(uint64_t _c) { return _mm256_set1_epi64x(_c); }
+};
+
+}
+
+void dev::keccak::keccakF1600x4AVX2(uint64_t* _lanes)
+{
+	__m256i a[25];
+	for (unsigned i = 0; i < 25; ++i)
+		a[i] = _mm256_loadu_si256((__m256i const*)(_lanes + 4 * i));
+	keccakF1600<AVX2Ops>(a);
+	for (unsigned i = 0; i < 25; ++i)
+		_mm256_storeu_si256((__m256i*)(_lanes + 4 * i), a[i]);
+}
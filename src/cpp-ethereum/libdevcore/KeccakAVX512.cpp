@@ -0,0 +1,48 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file KeccakAVX512.cpp
+ *
+ * Keccak-f[1600] on 8 states at once, built with AVX-512F and only called once the CPU is known to have it.
+ */
+
+#include <immintrin.h>
+#include "KeccakF1600.h"
+
+namespace
+{
+
+struct AVX512Ops
+{
+	using Lane = __m512i;
+
+	static inline Lane bxor(Lane _a, Lane _b) { return _mm512_xor_si512(_a, _b); }
+	static inline Lane andnot(Lane _a, Lane _b) { return _mm512_andnot_si512(_a, _b); }
+	template <int N> static inline Lane rol(Lane _a) { return _mm512_rol_epi64(_a, N); }
+	static inline Lane constant(uint64_t _c) { return _mm512_set1_epi64(_c); }
+};
+
+}
+
+void dev::keccak::keccakF1600x8AVX512(uint64_t* _lanes)
+{
+	__m512i a[25];
+	for (unsigned i = 0; i < 25; ++i)
+		a[i] = _mm512_loadu_si512(_lanes + 8 * i);
+	keccakF1600<AVX512Ops>(a);
+	for (unsigned i = 0; i < 25; ++i)
+		_mm512_storeu_si512(_lanes + 8 * i, a[i]);
+}
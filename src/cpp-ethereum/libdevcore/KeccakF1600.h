@@ -0,0 +1,139 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file KeccakF1600.h
+ *
+ * The Keccak-f[1600] permutation, written once for any lane type so that the scalar
+ * and the vectorized variants share it. Only included by the files implementing them.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace dev
+{
+namespace keccak
+{
+
+static const uint64_t c_roundConstants[24] =
+{
+	0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+	0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+	0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+	0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+	0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+	0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+/// One round of Keccak-f[1600] from the lanes @a a to the lanes @a e, lane x + 5 * y at a[x + 5 * y].
+/// Ops provides the lane type Lane and the operations on it: bxor(), andnot() (~a & b),
+/// rol<N>() and constant(), which makes a lane of a round constant.
+/// The round is unrolled so that every rotation is by a constant.
+template <class Ops>
+inline void keccakRound(typename Ops::Lane const* a, typename Ops::Lane* e, uint64_t _rc)
+{
+	using L = typename Ops::Lane;
+
+	// Theta
+	L c0 = Ops::bxor(Ops::bxor(Ops::bxor(a[0], a[5]), Ops::bxor(a[10], a[15])), a[20]);
+	L c1 = Ops::bxor(Ops::bxor(Ops::bxor(a[1], a[6]), Ops::bxor(a[11], a[16])), a[21]);
+	L c2 = Ops::bxor(Ops::bxor(Ops::bxor(a[2], a[7]), Ops::bxor(a[12], a[17])), a[22]);
+	L c3 = Ops::bxor(Ops::bxor(Ops::bxor(a[3], a[8]), Ops::bxor(a[13], a[18])), a[23]);
+	L c4 = Ops::bxor(Ops::bxor(Ops::bxor(a[4], a[9]), Ops::bxor(a[14], a[19])), a[24]);
+	L d0 = Ops::bxor(c4, Ops::template rol<1>(c1));
+	L d1 = Ops::bxor(c0, Ops::template rol<1>(c2));
+	L d2 = Ops::bxor(c1, Ops::template rol<1>(c3));
+	L d3 = Ops::bxor(c2, Ops::template rol<1>(c4));
+	L d4 = Ops::bxor(c3, Ops::template rol<1>(c0));
+
+	// Rho and pi move lane (x, y) to (y, 2x + 3y), then chi and iota, one row at a time
+	L b0 = Ops::bxor(a[0], d0);
+	L b1 = Ops::template rol<44>(Ops::bxor(a[6], d1));
+	L b2 = Ops::template rol<43>(Ops::bxor(a[12], d2));
+	L b3 = Ops::template rol<21>(Ops::bxor(a[18], d3));
+	L b4 = Ops::template rol<14>(Ops::bxor(a[24], d4));
+	e[0] = Ops::bxor(Ops::bxor(b0, Ops::andnot(b1, b2)), Ops::constant(_rc));
+	e[1] = Ops::bxor(b1, Ops::andnot(b2, b3));
+	e[2] = Ops::bxor(b2, Ops::andnot(b3, b4));
+	e[3] = Ops::bxor(b3, Ops::andnot(b4, b0));
+	e[4] = Ops::bxor(b4, Ops::andnot(b0, b1));
+
+	b0 = Ops::template rol<28>(Ops::bxor(a[3], d3));
+	b1 = Ops::template rol<20>(Ops::bxor(a[9], d4));
+	b2 = Ops::template rol<3>(Ops::bxor(a[10], d0));
+	b3 = Ops::template rol<45>(Ops::bxor(a[16], d1));
+	b4 = Ops::template rol<61>(Ops::bxor(a[22], d2));
+	e[5] = Ops::bxor(b0, Ops::andnot(b1, b2));
+	e[6] = Ops::bxor(b1, Ops::andnot(b2, b3));
+	e[7] = Ops::bxor(b2, Ops::andnot(b3, b4));
+	e[8] = Ops::bxor(b3, Ops::andnot(b4, b0));
+	e[9] = Ops::bxor(b4, Ops::andnot(b0, b1));
+
+	b0 = Ops::template rol<1>(Ops::bxor(a[1], d1));
+	b1 = Ops::template rol<6>(Ops::bxor(a[7], d2));
+	b2 = Ops::template rol<25>(Ops::bxor(a[13], d3));
+	b3 = Ops::template rol<8>(Ops::bxor(a[19], d4));
+	b4 = Ops::template rol<18>(Ops::bxor(a[20], d0));
+	e[10] = Ops::bxor(b0, Ops::andnot(b1, b2));
+	e[11] = Ops::bxor(b1, Ops::andnot(b2, b3));
+	e[12] = Ops::bxor(b2, Ops::andnot(b3, b4));
+	e[13] = Ops::bxor(b3, Ops::andnot(b4, b0));
+	e[14] = Ops::bxor(b4, Ops::andnot(b0, b1));
+
+	b0 = Ops::template rol<27>(Ops::bxor(a[4], d4));
+	b1 = Ops::template rol<36>(Ops::bxor(a[5], d0));
+	b2 = Ops::template rol<10>(Ops::bxor(a[11], d1));
+	b3 = Ops::template rol<15>(Ops::bxor(a[17], d2));
+	b4 = Ops::template rol<56>(Ops::bxor(a[23], d3));
+	e[15] = Ops::bxor(b0, Ops::andnot(b1, b2));
+	e[16] = Ops::bxor(b1, Ops::andnot(b2, b3));
+	e[17] = Ops::bxor(b2, Ops::andnot(b3, b4));
+	e[18] = Ops::bxor(b3, Ops::andnot(b4, b0));
+	e[19] = Ops::bxor(b4, Ops::andnot(b0, b1));
+
+	b0 = Ops::template rol<62>(Ops::bxor(a[2], d2));
+	b1 = Ops::template rol<55>(Ops::bxor(a[8], d3));
+	b2 = Ops::template rol<39>(Ops::bxor(a[14], d4));
+	b3 = Ops::template rol<41>(Ops::bxor(a[15], d0));
+	b4 = Ops::template rol<2>(Ops::bxor(a[21], d1));
+	e[20] = Ops::bxor(b0, Ops::andnot(b1, b2));
+	e[21] = Ops::bxor(b1, Ops::andnot(b2, b3));
+	e[22] = Ops::bxor(b2, Ops::andnot(b3, b4));
+	e[23] = Ops::bxor(b3, Ops::andnot(b4, b0));
+	e[24] = Ops::bxor(b4, Ops::andnot(b0, b1));
+}
+
+/// Keccak-f[1600] on the 25 lanes @a a, two rounds at a time between @a a and a second state.
+template <class Ops>
+inline void keccakF1600(typename Ops::Lane* a)
+{
+	typename Ops::Lane e[25];
+	for (unsigned round = 0; round < 24; round += 2)
+	{
+		keccakRound<Ops>(a, e, c_roundConstants[round]);
+		keccakRound<Ops>(e, a, c_roundConstants[round + 1]);
+	}
+}
+
+/// Keccak-f[1600] on 4 states at once with AVX2, lane i of state j at _lanes[4 * i + j].
+void keccakF1600x4AVX2(uint64_t* _lanes);
+
+/// Keccak-f[1600] on 8 states at once with AVX-512, lane i of state j at _lanes[8 * i + j].
+void keccakF1600x8AVX512(uint64_t* _lanes);
+
+}
+}
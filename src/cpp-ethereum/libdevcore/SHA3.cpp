@@ -19,13 +19,26 @@
  * @date 2014
  */
 
+#if defined(HAVE_CONFIG_H)
+#include "config/bitcoin-config.h"
+#endif
+
 #include "SHA3.h"
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <numeric>
 #include "RLP.h"
+#include "KeccakF1600.h"
 #include "picosha2.h"
+
+#if defined(__x86_64__) || defined(__amd64__)
+#if defined(ENABLE_AVX2) || defined(ENABLE_AVX512F)
+#include <cpuid.h>
+#endif
+#endif
 using namespace std;
 using namespace dev;
 
@@ -62,67 +75,19 @@ decsha3(512)
 
 /******** The Keccak-f[1600] permutation ********/
 
-/*** Constants. ***/
-static const uint8_t rho[24] = \
-  { 1,  3,   6, 10, 15, 21,
-	28, 36, 45, 55,  2, 14,
-	27, 41, 56,  8, 25, 43,
-	62, 18, 39, 61, 20, 44};
-static const uint8_t pi[24] = \
-  {10,  7, 11, 17, 18, 3,
-	5, 16,  8, 21, 24, 4,
-   15, 23, 19, 13, 12, 2,
-   20, 14, 22,  9, 6,  1};
-static const uint64_t RC[24] = \
-  {1ULL, 0x8082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
-   0x808bULL, 0x80000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
-   0x8aULL, 0x88ULL, 0x80008009ULL, 0x8000000aULL,
-   0x8000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
-   0x8000000000008002ULL, 0x8000000000000080ULL, 0x800aULL, 0x800000008000000aULL,
-   0x8000000080008081ULL, 0x8000000000008080ULL, 0x80000001ULL, 0x8000000080008008ULL};
-
-/*** Helper macros to unroll the permutation. ***/
-#define rol(x, s) (((x) << s) | ((x) >> (64 - s)))
-#define REPEAT6(e) e e e e e e
-#define REPEAT24(e) REPEAT6(e e e e)
-#define REPEAT5(e) e e e e e
-#define FOR5(v, s, e) \
-  v = 0;            \
-  REPEAT5(e; v += s;)
-
-/*** Keccak-f[1600] ***/
+/*** 64-bit lanes, the permutation itself is in KeccakF1600.h. ***/
+struct ScalarOps
+{
+	using Lane = uint64_t;
+
+	static inline Lane bxor(Lane _a, Lane _b) { return _a ^ _b; }
+	static inline Lane andnot(Lane _a, Lane _b) { return ~_a & _b; }
+	template <int N> static inline Lane rol(Lane _a) { return (_a << N) | (_a >> (64 - N)); }
+	static inline Lane constant(uint64_t _c) { return _c; }
+};
+
 static inline void keccakf(void* state) {
-  uint64_t* a = (uint64_t*)state;
-  uint64_t b[5] = {0};
-  uint64_t t = 0;
-  uint8_t x, y;
-
-  for (int i = 0; i < 24; i++) {
-	// Theta
-	FOR5(x, 1,
-		 b[x] = 0;
-		 FOR5(y, 5,
-			  b[x] ^= a[x + y]; ))
-	FOR5(x, 1,
-		 FOR5(y, 5,
-			  a[y + x] ^= b[(x + 4) % 5] ^ rol(b[(x + 1) % 5], 1); ))
-	// Rho and pi
-	t = a[1];
-	x = 0;
-	REPEAT24(b[0] = a[pi[x]];
-			 a[pi[x]] = rol(t, rho[x]);
-			 t = b[0];
-			 x++; )
-	// Chi
-	FOR5(y,
-	   5,
-	   FOR5(x, 1,
-			b[x] = a[y + x];)
-	   FOR5(x, 1,
-			a[y + x] = b[x] ^ ((~b[(x + 1) % 5]) & b[(x + 2) % 5]); ))
-	// Iota
-	a[0] ^= RC[i];
-  }
+  keccakF1600<ScalarOps>((uint64_t*)state);
 }
 
 /******** The FIPS202-defined functions. ********/
@@ -167,7 +132,7 @@ static inline int hash(uint8_t* out, size_t outlen,
   if ((out == NULL) || ((in == NULL) && inlen != 0) || (rate >= Plen)) {
 	return -1;
   }
-  uint8_t a[Plen] = {0};
+  alignas(uint64_t) uint8_t a[Plen] = {0};
   // Absorb input.
   foldP(in, inlen, xorin);
   // Xor in the DS and pad frame.
@@ -209,6 +174,148 @@ defsha3(256)
 defsha3(384)
 defsha3(512)
 
+/******** Several inputs at once. ********/
+
+/// Keccak-f[1600] on several states at once, the number of states and the function.
+static unsigned s_width = 1;
+static void (*s_keccakfN)(uint64_t*) = nullptr;
+
+/// Keccak-256 of the @a _count inputs @a _inputs[_order[i]] which all take @a _blocks
+/// full blocks before the last one, at most s_width of them.
+static void hashN(bytesConstRef const* _inputs, size_t const* _order, size_t _count, size_t _blocks, h256* o_outputs)
+{
+	size_t const rate = 200 - 256 / 4;
+	uint64_t lanes[25 * 8] = {0};
+	uint8_t block[200];
+	for (size_t b = 0; b <= _blocks; ++b)
+	{
+		for (size_t j = 0; j < _count; ++j)
+		{
+			bytesConstRef in = _inputs[_order[j]];
+			if (b < _blocks)
+				memcpy(block, in.data() + b * rate, rate);
+			else
+			{
+				// Pad the last block the way hash() does
+				size_t left = in.size() - b * rate;
+				memset(block, 0, rate);
+				if (left)
+					memcpy(block, in.data() + b * rate, left);
+				block[left] ^= 0x01;
+				block[rate - 1] ^= 0x80;
+			}
+			for (size_t i = 0; i < rate / 8; ++i)
+			{
+				uint64_t word;
+				memcpy(&word, block + 8 * i, 8);
+				lanes[s_width * i + j] ^= word;
+			}
+		}
+		s_keccakfN(lanes);
+	}
+	for (size_t j = 0; j < _count; ++j)
+		for (size_t i = 0; i < 4; ++i)
+			memcpy(o_outputs[_order[j]].data() + 8 * i, &lanes[s_width * i + j], 8);
+}
+
+/// Checks the permutations on several states against the scalar one.
+static bool selfTest()
+{
+	if (s_width == 1)
+		return true;
+	uint64_t lanes[25 * 8];
+	uint64_t states[8][25];
+	for (unsigned j = 0; j < s_width; ++j)
+		for (unsigned i = 0; i < 25; ++i)
+			lanes[s_width * i + j] = states[j][i] = (uint64_t)(i + 1) * 0x9e3779b97f4a7c15ULL + j;
+	s_keccakfN(lanes);
+	for (unsigned j = 0; j < s_width; ++j)
+	{
+		keccakf(states[j]);
+		for (unsigned i = 0; i < 25; ++i)
+			if (lanes[s_width * i + j] != states[j][i])
+				return false;
+	}
+	return true;
+}
+
+}
+
+std::string sha3AutoDetect()
+{
+#if defined(__x86_64__) || defined(__amd64__)
+#if defined(ENABLE_AVX2) || defined(ENABLE_AVX512F)
+	uint32_t eax, ebx, ecx, edx;
+	uint64_t xcr0 = 0;
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx >> 27) & 1)
+	{
+		// The OS saves the vector registers, see XGETBV
+		uint32_t lo, hi;
+		__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+		xcr0 = ((uint64_t)hi << 32) | lo;
+	}
+	bool haveLeaf7 = __get_cpuid_max(0, nullptr) >= 7;
+	if (haveLeaf7)
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+#endif
+#if defined(ENABLE_AVX512F)
+	if (haveLeaf7 && (ebx >> 16) & 1 && (xcr0 & 0xe6) == 0xe6)
+	{
+		keccak::s_keccakfN = keccak::keccakF1600x8AVX512;
+		keccak::s_width = 8;
+		if (keccak::selfTest())
+			return "avx512";
+	}
+#endif
+#if defined(ENABLE_AVX2)
+	if (haveLeaf7 && (ebx >> 5) & 1 && (xcr0 & 0x6) == 0x6)
+	{
+		keccak::s_keccakfN = keccak::keccakF1600x4AVX2;
+		keccak::s_width = 4;
+		if (keccak::selfTest())
+			return "avx2";
+	}
+#endif
+#endif
+	// Also reached when the permutations on several states do not match the scalar one
+	keccak::s_keccakfN = nullptr;
+	keccak::s_width = 1;
+	return "standard";
+}
+
+void keccakF1600(uint64_t* io_state)
+{
+	keccak::keccakf(io_state);
+}
+
+h256s sha3Batch(std::vector<bytesConstRef> const& _inputs)
+{
+	h256s ret(_inputs.size());
+	size_t const rate = 200 - 256 / 4;
+	if (keccak::s_width == 1 || _inputs.size() < 2)
+	{
+		for (size_t i = 0; i < _inputs.size(); ++i)
+			sha3(_inputs[i], ret[i].ref());
+		return ret;
+	}
+
+	// Inputs go through the permutations together with the ones that take as many blocks
+	std::vector<size_t> order(_inputs.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t _a, size_t _b) { return _inputs[_a].size() / rate < _inputs[_b].size() / rate; });
+	for (size_t i = 0; i < order.size();)
+	{
+		size_t blocks = _inputs[order[i]].size() / rate;
+		size_t end = i + 1;
+		while (end < order.size() && end - i < keccak::s_width && _inputs[order[end]].size() / rate == blocks)
+			++end;
+		if (end - i == 1)
+			sha3(_inputs[order[i]], ret[order[i]].ref());
+		else
+			keccak::hashN(_inputs.data(), &order[i], end - i, blocks, ret.data());
+		i = end;
+	}
+	return ret;
 }
 
 bool sha3(bytesConstRef _input, bytesRef o_output)
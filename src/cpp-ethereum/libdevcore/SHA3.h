@@ -24,6 +24,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "FixedHash.h"
 #include "vector_ref.h"
 
@@ -36,6 +37,19 @@ namespace dev
 /// @returns false if o_output.size() != 32.
 bool sha3(bytesConstRef _input, bytesRef o_output);
 
+/// Calculate the SHA3-256 hashes of several independent inputs, in the same order. Inputs of about
+/// the same size are hashed together where the CPU can run several Keccak-f[1600] at once.
+h256s sha3Batch(std::vector<bytesConstRef> const& _inputs);
+
+/// Select the Keccak-f[1600] implementation for sha3Batch() the CPU supports best, before any other thread hashes.
+/// An implementation is only used if it passes a self-test against the scalar one, in every build.
+/// @returns its name.
+std::string sha3AutoDetect();
+
+/// Apply the scalar Keccak-f[1600] permutation to the 25 lanes @a io_state, the one sha3() runs
+/// and sha3Batch() falls back to when no other implementation passed the self-test.
+void keccakF1600(uint64_t* io_state);
+
 /// Calculate SHA3-256 hash of the given input, returning as a 256-bit hash.
 inline h256 sha3(bytesConstRef _input) { h256 ret; sha3(_input, ret.ref()); return ret; }
 inline SecureFixedHash<32> sha3Secure(bytesConstRef _input) { SecureFixedHash<32> ret; sha3(_input, ret.writable().ref()); return ret; }
@@ -395,6 +395,10 @@ public:
 	void insert(bytesConstRef _key, bytesConstRef _value) { Super::insert(sha3(_key), _value); }
 	void remove(bytesConstRef _key) { Super::remove(sha3(_key)); }
 
+	/// Insert and remove with the hash of the key already known, as from sha3Batch().
+	void insertHashed(h256 const& _hash, bytesConstRef, bytesConstRef _value) { Super::insert(_hash, _value); }
+	void removeHashed(h256 const& _hash) { Super::remove(_hash); }
+
 	// empty from the PoV of the iterator interface; still need a basic iterator impl though.
 	class iterator
 	{
@@ -452,6 +456,14 @@ public:
 
 	void remove(bytesConstRef _key) { Super::remove(sha3(_key)); }
 
+	/// Insert and remove with the hash of the key already known, as from sha3Batch().
+	void insertHashed(h256 const& _hash, bytesConstRef _key, bytesConstRef _value)
+	{
+		Super::insert(_hash, _value);
+		Super::db()->insertAux(_hash, _key);
+	}
+	void removeHashed(h256 const& _hash) { Super::remove(_hash); }
+
 	// iterates over <key, value> pairs
 	class iterator: public GenericTrieDB<_DB>::iterator
 	{
@@ -0,0 +1,815 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file AltBn128.cpp
+ *
+ * The base field is kept in Montgomery form on four 64-bit limbs. The pairing uses the tower
+ * Fp2 = Fp[u]/(u^2 + 1), Fp6 = Fp2[v]/(v^3 - (9 + u)), Fp12 = Fp6[w]/(w^2 - v), and G2 lives
+ * on the D-type twist y^2 = x^3 + 3 / (9 + u), mapped into E(Fp12) by (x, y) -> (x w^2, y w^3).
+ */
+
+#include "AltBn128.h"
+#include <cstring>
+
+using namespace std;
+using namespace dev;
+
+namespace
+{
+
+#ifdef __SIZEOF_INT128__
+using uint128 = unsigned __int128;
+
+/// @returns the low word of _a + _b * _c + _carry and leaves the high word in _carry.
+inline uint64_t mac(uint64_t _a, uint64_t _b, uint64_t _c, uint64_t& _carry)
+{
+	uint128 t = (uint128)_b * _c + _a + _carry;
+	_carry = (uint64_t)(t >> 64);
+	return (uint64_t)t;
+}
+#else
+inline uint64_t mac(uint64_t _a, uint64_t _b, uint64_t _c, uint64_t& _carry)
+{
+	uint64_t bl = (uint32_t)_b, bh = _b >> 32, cl = (uint32_t)_c, ch = _c >> 32;
+	uint64_t ll = bl * cl, lh = bl * ch, hl = bh * cl, hh = bh * ch;
+	uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+	uint64_t lo = (mid << 32) | (uint32_t)ll;
+	uint64_t hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+	lo += _a;
+	hi += lo < _a;
+	lo += _carry;
+	hi += lo < _carry;
+	_carry = hi;
+	return lo;
+}
+#endif
+
+inline uint64_t addc(uint64_t _a, uint64_t _b, uint64_t& _carry)
+{
+	uint64_t s = _a + _carry;
+	uint64_t c = s < _carry;
+	s += _b;
+	_carry = c + (s < _b);
+	return s;
+}
+
+inline uint64_t subb(uint64_t _a, uint64_t _b, uint64_t& _borrow)
+{
+	uint64_t d = _a - _b;
+	uint64_t b = _a < _b;
+	b += d < _borrow;
+	d -= _borrow;
+	_borrow = b;
+	return d;
+}
+
+using Limbs = uint64_t[4];
+
+/// The field modulus p, the group order r and -p^-1 mod 2^64.
+const Limbs c_p = {0x3c208c16d87cfd47ULL, 0x97816a916871ca8dULL, 0xb85045b68181585dULL, 0x30644e72e131a029ULL};
+const Limbs c_r = {0x43e1f593f0000001ULL, 0x2833e84879b97091ULL, 0xb85045b68181585dULL, 0x30644e72e131a029ULL};
+const uint64_t c_pInv = 0x87d20782e4866389ULL;
+/// R, R^2 and R^3 mod p, with R = 2^256.
+const Limbs c_rModP = {0xd35d438dc58f0d9dULL, 0x0a78eb28f5c70b3dULL, 0x666ea36f7879462cULL, 0x0e0a77c19a07df2fULL};
+const Limbs c_r2ModP = {0xf32cfc5b538afa89ULL, 0xb5e71911d44501fbULL, 0x47ab1eff0a417ff6ULL, 0x06d89f71cab8351fULL};
+const Limbs c_r3ModP = {0xb1cd6dafda1530dfULL, 0x62f210e6a7283db6ULL, 0xef7f0b0c0ada0afbULL, 0x20fd6e902d592544ULL};
+
+/// The ate loop count 6z + 2 without its top bit 64, and the BN parameter z.
+const uint64_t c_ateLoopCount = 0x9d797039be763ba8ULL;
+const uint64_t c_z = 4965661367192848881ULL;
+
+inline bool lessThan(uint64_t const* _a, uint64_t const* _b)
+{
+	for (int i = 3; i >= 0; --i)
+		if (_a[i] != _b[i])
+			return _a[i] < _b[i];
+	return false;
+}
+
+inline bool isOne(uint64_t const* _a)
+{
+	return _a[0] == 1 && !(_a[1] | _a[2] | _a[3]);
+}
+
+inline void shiftRight(uint64_t* _a)
+{
+	_a[0] = (_a[0] >> 1) | (_a[1] << 63);
+	_a[1] = (_a[1] >> 1) | (_a[2] << 63);
+	_a[2] = (_a[2] >> 1) | (_a[3] << 63);
+	_a[3] >>= 1;
+}
+
+inline void subtract(uint64_t* _a, uint64_t const* _b)
+{
+	uint64_t borrow = 0;
+	for (unsigned i = 0; i < 4; ++i)
+		_a[i] = subb(_a[i], _b[i], borrow);
+}
+
+/// Halves _a modulo p, for _a below p.
+inline void halveModP(uint64_t* _a)
+{
+	if (_a[0] & 1)
+	{
+		uint64_t carry = 0;
+		for (unsigned i = 0; i < 4; ++i)
+			_a[i] = addc(_a[i], c_p[i], carry);
+	}
+	shiftRight(_a);
+}
+
+/// Sets _a to _a - _b modulo p, for both below p.
+inline void subtractModP(uint64_t* _a, uint64_t const* _b)
+{
+	uint64_t borrow = 0;
+	for (unsigned i = 0; i < 4; ++i)
+		_a[i] = subb(_a[i], _b[i], borrow);
+	if (borrow)
+	{
+		uint64_t carry = 0;
+		for (unsigned i = 0; i < 4; ++i)
+			_a[i] = addc(_a[i], c_p[i], carry);
+	}
+}
+
+class Fp
+{
+public:
+	Fp() { memset(m_v, 0, sizeof(m_v)); }
+
+	/// From the plain value _v, which must be below p.
+	static Fp fromLimbs(uint64_t const* _v) { Fp a; memcpy(a.m_v, _v, sizeof(a.m_v)); return a * r2(); }
+	static Fp fromUint(uint64_t _v) { Limbs v = {_v, 0, 0, 0}; return fromLimbs(v); }
+	static Fp one() { Fp a; memcpy(a.m_v, c_rModP, sizeof(a.m_v)); return a; }
+
+	/// Reads 32 big-endian bytes. @returns false if the value is not below p.
+	bool read(byte const* _in)
+	{
+		Limbs v;
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			v[3 - i] = 0;
+			for (unsigned j = 0; j < 8; ++j)
+				v[3 - i] = (v[3 - i] << 8) | _in[8 * i + j];
+		}
+		if (!lessThan(v, c_p))
+			return false;
+		*this = fromLimbs(v);
+		return true;
+	}
+
+	void write(byte* _out) const
+	{
+		Fp a;
+		Limbs one = {1, 0, 0, 0};
+		montMul(a.m_v, m_v, one);
+		for (unsigned i = 0; i < 4; ++i)
+			for (unsigned j = 0; j < 8; ++j)
+				_out[8 * i + j] = (byte)(a.m_v[3 - i] >> (56 - 8 * j));
+	}
+
+	bool isZero() const { return !(m_v[0] | m_v[1] | m_v[2] | m_v[3]); }
+	bool operator==(Fp const& _b) const { return !memcmp(m_v, _b.m_v, sizeof(m_v)); }
+	bool operator!=(Fp const& _b) const { return !operator==(_b); }
+
+	Fp operator+(Fp const& _b) const
+	{
+		Fp ret;
+		uint64_t carry = 0;
+		ret.m_v[0] = addc(m_v[0], _b.m_v[0], carry);
+		ret.m_v[1] = addc(m_v[1], _b.m_v[1], carry);
+		ret.m_v[2] = addc(m_v[2], _b.m_v[2], carry);
+		ret.m_v[3] = addc(m_v[3], _b.m_v[3], carry);
+		ret.reduce(carry);
+		return ret;
+	}
+
+	Fp operator-(Fp const& _b) const
+	{
+		Fp ret;
+		uint64_t borrow = 0;
+		ret.m_v[0] = subb(m_v[0], _b.m_v[0], borrow);
+		ret.m_v[1] = subb(m_v[1], _b.m_v[1], borrow);
+		ret.m_v[2] = subb(m_v[2], _b.m_v[2], borrow);
+		ret.m_v[3] = subb(m_v[3], _b.m_v[3], borrow);
+		if (borrow)
+		{
+			uint64_t carry = 0;
+			ret.m_v[0] = addc(ret.m_v[0], c_p[0], carry);
+			ret.m_v[1] = addc(ret.m_v[1], c_p[1], carry);
+			ret.m_v[2] = addc(ret.m_v[2], c_p[2], carry);
+			ret.m_v[3] = addc(ret.m_v[3], c_p[3], carry);
+		}
+		return ret;
+	}
+
+	Fp operator-() const { return Fp() - *this; }
+	Fp operator*(Fp const& _b) const { Fp ret; montMul(ret.m_v, m_v, _b.m_v); return ret; }
+	Fp square() const { return *this * *this; }
+
+	/// The binary extended Euclidean algorithm, which need not run in constant time on public inputs.
+	Fp inverse() const
+	{
+		if (isZero())
+			return Fp();
+		Limbs u;
+		Limbs v;
+		Limbs x1 = {1, 0, 0, 0};
+		Limbs x2 = {0, 0, 0, 0};
+		memcpy(u, m_v, sizeof(u));
+		memcpy(v, c_p, sizeof(v));
+		while (!isOne(u) && !isOne(v))
+		{
+			while (!(u[0] & 1))
+			{
+				shiftRight(u);
+				halveModP(x1);
+			}
+			while (!(v[0] & 1))
+			{
+				shiftRight(v);
+				halveModP(x2);
+			}
+			if (lessThan(u, v))
+			{
+				subtract(v, u);
+				subtractModP(x2, x1);
+			}
+			else
+			{
+				subtract(u, v);
+				subtractModP(x1, x2);
+			}
+		}
+		// That is the inverse of aR, which R^3 / R takes back to a^-1 R
+		Fp ret;
+		montMul(ret.m_v, isOne(u) ? x1 : x2, c_r3ModP);
+		return ret;
+	}
+
+private:
+	static Fp const& r2() { static const Fp s_r2 = [](){ Fp a; memcpy(a.m_v, c_r2ModP, sizeof(a.m_v)); return a; }(); return s_r2; }
+
+	/// Subtracts p if the value, with _carry as its bit 256, is not below p.
+	void reduce(uint64_t _carry)
+	{
+		uint64_t borrow = 0;
+		uint64_t r0 = subb(m_v[0], c_p[0], borrow);
+		uint64_t r1 = subb(m_v[1], c_p[1], borrow);
+		uint64_t r2 = subb(m_v[2], c_p[2], borrow);
+		uint64_t r3 = subb(m_v[3], c_p[3], borrow);
+		if (_carry || !borrow)
+		{
+			m_v[0] = r0;
+			m_v[1] = r1;
+			m_v[2] = r2;
+			m_v[3] = r3;
+		}
+	}
+
+	/// Montgomery multiplication _a * _b / R mod p, operand scanning with interleaved reduction.
+	static void montMul(uint64_t* _r, uint64_t const* _a, uint64_t const* _b)
+	{
+		uint64_t t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0;
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			uint64_t carry = 0;
+			t0 = mac(t0, _a[0], _b[i], carry);
+			t1 = mac(t1, _a[1], _b[i], carry);
+			t2 = mac(t2, _a[2], _b[i], carry);
+			t3 = mac(t3, _a[3], _b[i], carry);
+			uint64_t c = 0;
+			t4 = addc(t4, carry, c);
+			uint64_t t5 = c;
+
+			uint64_t m = t0 * c_pInv;
+			carry = 0;
+			mac(t0, m, c_p[0], carry);
+			t0 = mac(t1, m, c_p[1], carry);
+			t1 = mac(t2, m, c_p[2], carry);
+			t2 = mac(t3, m, c_p[3], carry);
+			c = 0;
+			t3 = addc(t4, carry, c);
+			t4 = t5 + c;
+		}
+		uint64_t borrow = 0;
+		uint64_t r0 = subb(t0, c_p[0], borrow);
+		uint64_t r1 = subb(t1, c_p[1], borrow);
+		uint64_t r2 = subb(t2, c_p[2], borrow);
+		uint64_t r3 = subb(t3, c_p[3], borrow);
+		bool keep = !t4 && borrow;
+		_r[0] = keep ? t0 : r0;
+		_r[1] = keep ? t1 : r1;
+		_r[2] = keep ? t2 : r2;
+		_r[3] = keep ? t3 : r3;
+	}
+
+	Limbs m_v;
+};
+
+/// a + b u with u^2 = -1.
+struct Fp2
+{
+	Fp a;
+	Fp b;
+
+	Fp2() = default;
+	Fp2(Fp const& _a, Fp const& _b): a(_a), b(_b) {}
+	static Fp2 one() { return Fp2(Fp::one(), Fp()); }
+	static Fp2 fromLimbs(uint64_t const* _a, uint64_t const* _b) { return Fp2(Fp::fromLimbs(_a), Fp::fromLimbs(_b)); }
+
+	bool isZero() const { return a.isZero() && b.isZero(); }
+	bool operator==(Fp2 const& _o) const { return a == _o.a && b == _o.b; }
+	Fp2 operator+(Fp2 const& _o) const { return Fp2(a + _o.a, b + _o.b); }
+	Fp2 operator-(Fp2 const& _o) const { return Fp2(a - _o.a, b - _o.b); }
+	Fp2 operator-() const { return Fp2(-a, -b); }
+	Fp2 operator*(Fp const& _o) const { return Fp2(a * _o, b * _o); }
+
+	Fp2 operator*(Fp2 const& _o) const
+	{
+		Fp aa = a * _o.a;
+		Fp bb = b * _o.b;
+		return Fp2(aa - bb, (a + b) * (_o.a + _o.b) - aa - bb);
+	}
+
+	Fp2 square() const
+	{
+		Fp ab = a * b;
+		return Fp2((a + b) * (a - b), ab + ab);
+	}
+
+	Fp2 conjugate() const { return Fp2(a, -b); }
+
+	/// Multiplies by the non-residue xi = 9 + u that defines Fp6.
+	Fp2 mulByXi() const
+	{
+		Fp a8 = a + a;
+		a8 = a8 + a8;
+		a8 = a8 + a8;
+		Fp b8 = b + b;
+		b8 = b8 + b8;
+		b8 = b8 + b8;
+		return Fp2(a8 + a - b, b8 + b + a);
+	}
+
+	Fp2 inverse() const
+	{
+		Fp t = (a.square() + b.square()).inverse();
+		return Fp2(a * t, -(b * t));
+	}
+};
+
+/// c0 + c1 v + c2 v^2 with v^3 = xi.
+struct Fp6
+{
+	Fp2 c0;
+	Fp2 c1;
+	Fp2 c2;
+
+	Fp6() = default;
+	Fp6(Fp2 const& _c0, Fp2 const& _c1, Fp2 const& _c2): c0(_c0), c1(_c1), c2(_c2) {}
+	static Fp6 one() { return Fp6(Fp2::one(), Fp2(), Fp2()); }
+
+	bool operator==(Fp6 const& _o) const { return c0 == _o.c0 && c1 == _o.c1 && c2 == _o.c2; }
+	Fp6 operator+(Fp6 const& _o) const { return Fp6(c0 + _o.c0, c1 + _o.c1, c2 + _o.c2); }
+	Fp6 operator-(Fp6 const& _o) const { return Fp6(c0 - _o.c0, c1 - _o.c1, c2 - _o.c2); }
+	Fp6 operator-() const { return Fp6(-c0, -c1, -c2); }
+
+	Fp6 operator*(Fp6 const& _o) const
+	{
+		Fp2 t0 = c0 * _o.c0;
+		Fp2 t1 = c1 * _o.c1;
+		Fp2 t2 = c2 * _o.c2;
+		return Fp6(
+			t0 + ((c1 + c2) * (_o.c1 + _o.c2) - t1 - t2).mulByXi(),
+			(c0 + c1) * (_o.c0 + _o.c1) - t0 - t1 + t2.mulByXi(),
+			(c0 + c2) * (_o.c0 + _o.c2) - t0 - t2 + t1
+		);
+	}
+
+	Fp6 square() const { return *this * *this; }
+
+	/// Multiplies by _a + _b v.
+	Fp6 mulBy01(Fp2 const& _a, Fp2 const& _b) const
+	{
+		Fp2 t0 = c0 * _a;
+		Fp2 t1 = c1 * _b;
+		return Fp6(
+			t0 + (c2 * _b).mulByXi(),
+			(c0 + c1) * (_a + _b) - t0 - t1,
+			c2 * _a + t1
+		);
+	}
+
+	/// Multiplies by v, the non-residue that defines Fp12.
+	Fp6 mulByV() const { return Fp6(c2.mulByXi(), c0, c1); }
+
+	Fp6 inverse() const
+	{
+		Fp2 a = c0.square() - (c1 * c2).mulByXi();
+		Fp2 b = c2.square().mulByXi() - c0 * c1;
+		Fp2 c = c1.square() - c0 * c2;
+		Fp2 t = (c0 * a + (c2 * b + c1 * c).mulByXi()).inverse();
+		return Fp6(a * t, b * t, c * t);
+	}
+};
+
+/// The Frobenius coefficients xi^(i (p - 1) / 6) of w^i, and xi^(i (p^2 - 1) / 6) for i = 2 and 3.
+struct FrobeniusCoefficients
+{
+	Fp2 g1[6];
+	Fp2 g2x;
+	Fp2 g2y;
+
+	FrobeniusCoefficients()
+	{
+		static const Limbs c[5][2] = {
+			{{0xd60b35dadcc9e470ULL, 0x5c521e08292f2176ULL, 0xe8b99fdd76e68b60ULL, 0x1284b71c2865a7dfULL}, {0xca5cf05f80f362acULL, 0x747992778eeec7e5ULL, 0xa6327cfe12150b8eULL, 0x246996f3b4fae7e6ULL}},
+			{{0x99e39557176f553dULL, 0xb78cc310c2c3330cULL, 0x4c0bec3cf559b143ULL, 0x2fb347984f7911f7ULL}, {0x1665d51c640fcba2ULL, 0x32ae2a1d0b7c9dceULL, 0x4ba4cc8bd75a0794ULL, 0x16c9e55061ebae20ULL}},
+			{{0xdc54014671a0135aULL, 0xdbaae0eda9c95998ULL, 0xdc5ec698b6e2f9b9ULL, 0x063cf305489af5dcULL}, {0x82d37f632623b0e3ULL, 0x21807dc98fa25bd2ULL, 0x0704b5a7ec796f2bULL, 0x07c03cbcac41049aULL}},
+			{{0x848a1f55921ea762ULL, 0xd33365f7be94ec72ULL, 0x80f3c0b75a181e84ULL, 0x05b54f5e64eea801ULL}, {0xc13b4711cd2b8126ULL, 0x3685d2ea1bdec763ULL, 0x9f3a80b03b0b1c92ULL, 0x2c145edbe7fd8aeeULL}},
+			{{0x2ea2c810eab7692fULL, 0x425c459b55aa1bd3ULL, 0xe93a3661a4353ff4ULL, 0x0183c1e74f798649ULL}, {0x24c6b8ee6e0c2c4bULL, 0xb080cb99678e2ac0ULL, 0xa27fb246c7729f7dULL, 0x12acf2ca76fd0675ULL}}
+		};
+		static const Limbs c2 = {0xe4bd44e5607cfd48ULL, 0xc28f069fbb966e3dULL, 0x5e6dd9e7e0acccb0ULL, 0x30644e72e131a029ULL};
+		g1[0] = Fp2::one();
+		for (unsigned i = 0; i < 5; ++i)
+			g1[i + 1] = Fp2::fromLimbs(c[i][0], c[i][1]);
+		g2x = Fp2(Fp::fromLimbs(c2), Fp());
+		g2y = -Fp2::one();
+	}
+};
+
+FrobeniusCoefficients const& frobenius()
+{
+	static const FrobeniusCoefficients s_coefficients;
+	return s_coefficients;
+}
+
+/// c0 + c1 w with w^2 = v, so that the coefficient of w^i is c(i % 2).c(i / 2).
+struct Fp12
+{
+	Fp6 c0;
+	Fp6 c1;
+
+	Fp12() = default;
+	Fp12(Fp6 const& _c0, Fp6 const& _c1): c0(_c0), c1(_c1) {}
+	static Fp12 one() { return Fp12(Fp6::one(), Fp6()); }
+
+	bool operator==(Fp12 const& _o) const { return c0 == _o.c0 && c1 == _o.c1; }
+
+	Fp12 operator*(Fp12 const& _o) const
+	{
+		Fp6 t0 = c0 * _o.c0;
+		Fp6 t1 = c1 * _o.c1;
+		return Fp12(t0 + t1.mulByV(), (c0 + c1) * (_o.c0 + _o.c1) - t0 - t1);
+	}
+
+	/// Multiplies by the line _a + _b w + _c w^3, which has only three of the twelve coefficients.
+	Fp12 mulByLine(Fp2 const& _a, Fp2 const& _b, Fp2 const& _c) const
+	{
+		Fp6 t0(c0.c0 * _a, c0.c1 * _a, c0.c2 * _a);
+		Fp6 t1 = c1.mulBy01(_b, _c);
+		return Fp12(t0 + t1.mulByV(), (c0 + c1).mulBy01(_a + _b, _c) - t0 - t1);
+	}
+
+	Fp12 square() const
+	{
+		Fp6 t = c0 * c1;
+		return Fp12((c0 + c1) * (c0 + c1.mulByV()) - t - t.mulByV(), t + t);
+	}
+
+	/// The p^6-th power, which is the inverse on the cyclotomic subgroup.
+	Fp12 conjugate() const { return Fp12(c0, -c1); }
+
+	Fp12 inverse() const
+	{
+		Fp6 t = (c0.square() - c1.square().mulByV()).inverse();
+		return Fp12(c0 * t, -(c1 * t));
+	}
+
+	/// The p-th power.
+	Fp12 frobenius() const
+	{
+		FrobeniusCoefficients const& g = ::frobenius();
+		return Fp12(
+			Fp6(c0.c0.conjugate(), c0.c1.conjugate() * g.g1[2], c0.c2.conjugate() * g.g1[4]),
+			Fp6(c1.c0.conjugate() * g.g1[1], c1.c1.conjugate() * g.g1[3], c1.c2.conjugate() * g.g1[5])
+		);
+	}
+
+	Fp12 pow(uint64_t _e) const
+	{
+		Fp12 ret = one();
+		for (int i = 63; i >= 0; --i)
+		{
+			ret = ret.square();
+			if ((_e >> i) & 1)
+				ret = ret * *this;
+		}
+		return ret;
+	}
+};
+
+/// A point in Jacobian coordinates (x / z^2, y / z^3) on y^2 = x^3 + b over F, the point at infinity has z = 0.
+template <class F>
+struct Point
+{
+	F x;
+	F y;
+	F z;
+
+	bool isInfinity() const { return z.isZero(); }
+
+	Point dbl() const
+	{
+		if (isInfinity() || y.isZero())
+			return Point();
+		F a = x.square();
+		F b = y.square();
+		F c = b.square();
+		F d = (x + b).square() - a - c;
+		d = d + d;
+		F e = a + a + a;
+		F x3 = e.square() - d - d;
+		F c8 = c + c;
+		c8 = c8 + c8;
+		c8 = c8 + c8;
+		F yz = y * z;
+		return Point{x3, e * (d - x3) - c8, yz + yz};
+	}
+
+	Point operator+(Point const& _o) const
+	{
+		if (isInfinity())
+			return _o;
+		if (_o.isInfinity())
+			return *this;
+		F z1z1 = z.square();
+		F z2z2 = _o.z.square();
+		F u1 = x * z2z2;
+		F u2 = _o.x * z1z1;
+		F s1 = y * _o.z * z2z2;
+		F s2 = _o.y * z * z1z1;
+		F h = u2 - u1;
+		F r = s2 - s1;
+		if (h.isZero())
+			return r.isZero() ? dbl() : Point();
+		F hh = h.square();
+		F hhh = h * hh;
+		F v = u1 * hh;
+		F x3 = r.square() - hhh - v - v;
+		return Point{x3, r * (v - x3) - s1 * hhh, z * _o.z * h};
+	}
+
+	/// Multiplies by the 256-bit scalar _s, given as little-endian limbs, four bits at a time.
+	Point mul(uint64_t const* _s) const
+	{
+		Point table[16];
+		table[1] = *this;
+		for (unsigned i = 2; i < 16; ++i)
+			table[i] = table[i - 1] + *this;
+		Point ret;
+		for (int i = 63; i >= 0; --i)
+		{
+			ret = ret.dbl().dbl().dbl().dbl();
+			unsigned nibble = (_s[i / 16] >> (4 * (i % 16))) & 15;
+			if (nibble)
+				ret = ret + table[nibble];
+		}
+		return ret;
+	}
+
+	/// @returns the affine coordinates, or (0, 0) for the point at infinity.
+	void affine(F& o_x, F& o_y) const
+	{
+		if (isInfinity())
+		{
+			o_x = F();
+			o_y = F();
+			return;
+		}
+		F zi = z.inverse();
+		F zi2 = zi.square();
+		o_x = x * zi2;
+		o_y = y * zi2 * zi;
+	}
+};
+
+using G1 = Point<Fp>;
+using G2 = Point<Fp2>;
+
+Fp const& curveB() { static const Fp s_b = Fp::fromUint(3); return s_b; }
+
+Fp2 const& twistB()
+{
+	static const Limbs a = {0x3267e6dc24a138e5ULL, 0xb5b4c5e559dbefa3ULL, 0x81be18991be06ac3ULL, 0x2b149d40ceb8aaaeULL};
+	static const Limbs b = {0xe4a2bd0685c315d2ULL, 0xa74fa084e52d1852ULL, 0xcd2cafadeed8fdf4ULL, 0x009713b03af0fed4ULL};
+	static const Fp2 s_b = Fp2::fromLimbs(a, b);
+	return s_b;
+}
+
+/// Reads the affine point at _in, (0, 0) being the point at infinity. @returns false if it is not on the curve.
+bool readG1(byte const* _in, G1& o_p)
+{
+	Fp x;
+	Fp y;
+	if (!x.read(_in) || !y.read(_in + 32))
+		return false;
+	if (x.isZero() && y.isZero())
+	{
+		o_p = G1();
+		return true;
+	}
+	if (y.square() != x.square() * x + curveB())
+		return false;
+	o_p = G1{x, y, Fp::one()};
+	return true;
+}
+
+/// Reads the affine point at _in, imaginary parts first. @returns false if it is not on the twist or not of order r.
+bool readG2(byte const* _in, G2& o_p)
+{
+	Fp xb;
+	Fp xa;
+	Fp yb;
+	Fp ya;
+	if (!xb.read(_in) || !xa.read(_in + 32) || !yb.read(_in + 64) || !ya.read(_in + 96))
+		return false;
+	Fp2 x(xa, xb);
+	Fp2 y(ya, yb);
+	if (x.isZero() && y.isZero())
+	{
+		o_p = G2();
+		return true;
+	}
+	if (!(y.square() == x.square() * x + twistB()))
+		return false;
+	o_p = G2{x, y, Fp2::one()};
+	return o_p.mul(c_r).isInfinity();
+}
+
+bytes writeG1(G1 const& _p)
+{
+	Fp x;
+	Fp y;
+	_p.affine(x, y);
+	bytes ret(64);
+	x.write(ret.data());
+	y.write(ret.data() + 32);
+	return ret;
+}
+
+/// The line a + b w + c w^3 evaluated at a point of G1, scaled by an element of Fp2 which the
+/// final exponentiation removes.
+struct Line
+{
+	Fp2 a;
+	Fp2 b;
+	Fp2 c;
+};
+
+/// Doubles _t and returns the tangent at _t evaluated at (_px, _py).
+Line doublingStep(G2& _t, Fp const& _px, Fp const& _py)
+{
+	Fp2 zz = _t.z.square();
+	Fp2 e = _t.x.square();
+	e = e + e + e;
+	Fp2 yz = _t.y * _t.z;
+	Fp2 yy = _t.y.square();
+	Line l{(yz + yz) * zz * _py, -(e * zz * _px), e * _t.x - yy - yy};
+	_t = _t.dbl();
+	return l;
+}
+
+/// Adds the affine point (_qx, _qy) to _t and returns the line through both evaluated at (_px, _py).
+Line additionStep(G2& _t, Fp2 const& _qx, Fp2 const& _qy, Fp const& _px, Fp const& _py)
+{
+	Fp2 zz = _t.z.square();
+	Fp2 h = _qx * zz - _t.x;
+	Fp2 r = _qy * _t.z * zz - _t.y;
+	Fp2 z3 = _t.z * h;
+	Line l{z3 * _py, -(r * _px), r * _qx - _qy * z3};
+	Fp2 hh = h.square();
+	Fp2 hhh = h * hh;
+	Fp2 v = _t.x * hh;
+	Fp2 x3 = r.square() - hhh - v - v;
+	_t = G2{x3, r * (v - x3) - _t.y * hhh, z3};
+	return l;
+}
+
+inline Fp12 operator*(Fp12 const& _f, Line const& _l)
+{
+	return _f.mulByLine(_l.a, _l.b, _l.c);
+}
+
+/// The Miller loop of the optimal ate pairing for the affine points _p and _q.
+Fp12 millerLoop(G1 const& _p, G2 const& _q)
+{
+	Fp px = _p.x;
+	Fp py = _p.y;
+	Fp2 qx = _q.x;
+	Fp2 qy = _q.y;
+	G2 t = _q;
+	Fp12 f = Fp12::one();
+	for (int i = 63; i >= 0; --i)
+	{
+		f = f.square() * doublingStep(t, px, py);
+		if ((c_ateLoopCount >> i) & 1)
+			f = f * additionStep(t, qx, qy, px, py);
+	}
+
+	// Add pi(q) and -pi^2(q), the images of q under the Frobenius of the twist
+	FrobeniusCoefficients const& g = frobenius();
+	f = f * additionStep(t, qx.conjugate() * g.g1[2], qy.conjugate() * g.g1[3], px, py);
+	f = f * additionStep(t, qx * g.g2x, -(qy * g.g2y), px, py);
+	return f;
+}
+
+/// Raises _f to (p^12 - 1) / r times 2z (6z^2 + 3z + 1), which is prime to r. The hard part
+/// (p^4 - p^2 + 1) / r is written in base p with coefficients that are polynomials in z, after
+/// Fuentes-Castaneda et al., "Faster hashing to G2".
+Fp12 finalExponentiation(Fp12 const& _f)
+{
+	Fp12 f = _f.conjugate() * _f.inverse();
+	f = f.frobenius().frobenius() * f;
+
+	Fp12 fz = f.pow(c_z);
+	Fp12 fz2 = fz.pow(c_z);
+	Fp12 fz3 = fz2.pow(c_z);
+	Fp12 fz_2 = fz.square();
+	Fp12 fz_4 = fz_2.square();
+	Fp12 fz_6 = fz_4 * fz_2;
+	Fp12 fz2_2 = fz2.square();
+	Fp12 fz2_6 = fz2_2.square() * fz2_2;
+	Fp12 fz3_4 = fz3.square().square();
+	Fp12 t = fz3_4.square() * fz3_4 * fz2_6;
+
+	// f^(12z^3 + 12z^2 + 6z + 1), f^(12z^3 + 6z^2 + 4z), f^(12z^3 + 6z^2 + 6z) and f^(12z^3 + 6z^2 + 4z - 1)
+	Fp12 l0 = t * fz2_6 * fz_6 * f;
+	Fp12 l1 = t * fz_4;
+	Fp12 l2 = t * fz_6;
+	Fp12 l3 = l1 * f.conjugate();
+	return l0 * l1.frobenius() * l2.frobenius().frobenius() * l3.frobenius().frobenius().frobenius();
+}
+
+}
+
+pair<bool, bytes> dev::crypto::alt_bn128_G1_add(bytesConstRef _in)
+{
+	byte in[128] = {};
+	memcpy(in, _in.data(), min<size_t>(_in.size(), sizeof(in)));
+	G1 p1;
+	G1 p2;
+	if (!readG1(in, p1) || !readG1(in + 64, p2))
+		return {false, bytes()};
+	return {true, writeG1(p1 + p2)};
+}
+
+pair<bool, bytes> dev::crypto::alt_bn128_G1_mul(bytesConstRef _in)
+{
+	byte in[96] = {};
+	memcpy(in, _in.data(), min<size_t>(_in.size(), sizeof(in)));
+	G1 p;
+	if (!readG1(in, p))
+		return {false, bytes()};
+	Limbs s;
+	for (unsigned i = 0; i < 4; ++i)
+	{
+		s[3 - i] = 0;
+		for (unsigned j = 0; j < 8; ++j)
+			s[3 - i] = (s[3 - i] << 8) | in[64 + 8 * i + j];
+	}
+	return {true, writeG1(p.mul(s))};
+}
+
+pair<bool, bytes> dev::crypto::alt_bn128_pairing_product(bytesConstRef _in)
+{
+	if (_in.size() % 192)
+		return {false, bytes()};
+	Fp12 f = Fp12::one();
+	for (size_t i = 0; i < _in.size(); i += 192)
+	{
+		G1 p;
+		G2 q;
+		if (!readG1(_in.data() + i, p) || !readG2(_in.data() + i + 64, q))
+			return {false, bytes()};
+		if (!p.isInfinity() && !q.isInfinity())
+			f = f * millerLoop(p, q);
+	}
+	bytes ret(32, 0);
+	ret[31] = finalExponentiation(f) == Fp12::one();
+	return {true, ret};
+}
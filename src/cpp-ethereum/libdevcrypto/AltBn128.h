@@ -0,0 +1,46 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file AltBn128.h
+ *
+ * Arithmetic on the alt_bn128 (BN254) curve and its optimal ate pairing, as used by the
+ * elliptic curve precompiled contracts of EIP-196 and EIP-197.
+ */
+
+#pragma once
+
+#include <libdevcore/Common.h>
+
+namespace dev
+{
+namespace crypto
+{
+
+/// Adds the two G1 points (x1, y1, x2, y2, 32 bytes each, right-padded with zeros).
+/// @returns false and no output if a coordinate is not below the field modulus or a point is not on the curve.
+std::pair<bool, bytes> alt_bn128_G1_add(bytesConstRef _in);
+
+/// Multiplies the G1 point (x, y) by the 256-bit scalar s (32 bytes each, right-padded with zeros).
+std::pair<bool, bytes> alt_bn128_G1_mul(bytesConstRef _in);
+
+/// Checks whether the product of the pairings of the (G1, G2) pairs in @a _in is one.
+/// Each pair takes 192 bytes: x, y of the G1 point, then x, y of the G2 point with the imaginary
+/// part of each coordinate first. @returns 32 bytes holding 1 or 0, or false if the input length is
+/// not a multiple of 192, or a point is not on its curve or a G2 point not in the subgroup of order r.
+std::pair<bool, bytes> alt_bn128_pairing_product(bytesConstRef _in);
+
+}
+}
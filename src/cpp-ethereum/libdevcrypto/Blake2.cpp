@@ -0,0 +1,115 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file Blake2.cpp
+ */
+
+#include "Blake2.h"
+
+using namespace std;
+using namespace dev;
+
+namespace
+{
+
+const uint64_t c_iv[8] =
+{
+	0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+	0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+const uint8_t c_sigma[10][16] =
+{
+	{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+	{14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+	{11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+	{7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+	{9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+	{2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+	{12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+	{13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+	{6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+	{10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0}
+};
+
+inline uint64_t rotr(uint64_t _x, unsigned _n)
+{
+	return (_x >> _n) | (_x << (64 - _n));
+}
+
+inline uint64_t readLE(byte const* _p)
+{
+	uint64_t ret = 0;
+	for (int i = 7; i >= 0; --i)
+		ret = (ret << 8) | _p[i];
+	return ret;
+}
+
+inline void mix(uint64_t* _v, unsigned _a, unsigned _b, unsigned _c, unsigned _d, uint64_t _x, uint64_t _y)
+{
+	_v[_a] = _v[_a] + _v[_b] + _x;
+	_v[_d] = rotr(_v[_d] ^ _v[_a], 32);
+	_v[_c] = _v[_c] + _v[_d];
+	_v[_b] = rotr(_v[_b] ^ _v[_c], 24);
+	_v[_a] = _v[_a] + _v[_b] + _y;
+	_v[_d] = rotr(_v[_d] ^ _v[_a], 16);
+	_v[_c] = _v[_c] + _v[_d];
+	_v[_b] = rotr(_v[_b] ^ _v[_c], 63);
+}
+
+}
+
+bytes dev::crypto::blake2FCompression(uint32_t _rounds, bytesConstRef _h, bytesConstRef _m, uint64_t _t0, uint64_t _t1, bool _lastBlock)
+{
+	uint64_t h[8];
+	uint64_t m[16];
+	uint64_t v[16];
+	for (unsigned i = 0; i < 8; ++i)
+		h[i] = readLE(_h.data() + 8 * i);
+	for (unsigned i = 0; i < 16; ++i)
+		m[i] = readLE(_m.data() + 8 * i);
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		v[i] = h[i];
+		v[i + 8] = c_iv[i];
+	}
+	v[12] ^= _t0;
+	v[13] ^= _t1;
+	if (_lastBlock)
+		v[14] = ~v[14];
+
+	for (uint32_t r = 0; r < _rounds; ++r)
+	{
+		uint8_t const* s = c_sigma[r % 10];
+		mix(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+		mix(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+		mix(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+		mix(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+		mix(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+		mix(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+		mix(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+		mix(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+	}
+
+	bytes ret(64);
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		uint64_t w = h[i] ^ v[i] ^ v[i + 8];
+		for (unsigned j = 0; j < 8; ++j)
+			ret[8 * i + j] = (byte)(w >> (8 * j));
+	}
+	return ret;
+}
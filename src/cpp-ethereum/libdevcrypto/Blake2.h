@@ -0,0 +1,37 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file Blake2.h
+ *
+ * The BLAKE2b compression function F with a variable number of rounds, as specified by EIP-152.
+ */
+
+#pragma once
+
+#include <libdevcore/Common.h>
+
+namespace dev
+{
+namespace crypto
+{
+
+/// Runs _rounds rounds of F on the state _h (64 bytes) with the message block _m (128 bytes),
+/// the offset counters _t0 and _t1 and the final block flag. All words are little-endian.
+/// @returns the new state, 64 bytes.
+bytes blake2FCompression(uint32_t _rounds, bytesConstRef _h, bytesConstRef _m, uint64_t _t0, uint64_t _t1, bool _lastBlock);
+
+}
+}
@@ -56,6 +56,11 @@ R"E(
 		"0000000000000000000000000000000000000002": { "precompiled": { "name": "sha256", "linear": { "base": 60, "word": 12 } } },
 		"0000000000000000000000000000000000000003": { "precompiled": { "name": "ripemd160", "linear": { "base": 600, "word": 120 } } },
 		"0000000000000000000000000000000000000004": { "precompiled": { "name": "identity", "linear": { "base": 15, "word": 3 } } },
+		"0000000000000000000000000000000000000005": { "precompiled": { "name": "modexp", "startingBlock": "0x7fffffff" } },
+		"0000000000000000000000000000000000000006": { "precompiled": { "name": "alt_bn128_G1_add", "startingBlock": "0x7fffffff" } },
+		"0000000000000000000000000000000000000007": { "precompiled": { "name": "alt_bn128_G1_mul", "startingBlock": "0x7fffffff" } },
+		"0000000000000000000000000000000000000008": { "precompiled": { "name": "alt_bn128_pairing_product", "startingBlock": "0x7fffffff" } },
+		"0000000000000000000000000000000000000009": { "precompiled": { "name": "blake2_compression", "startingBlock": "0x7fffffff" } },
         "0000000000000000000000000000000000000080": { "code": 
         "0x60606040523615610110576000357c0100000000000000000000000000000000000000000000000000000000900463ffffffff1680630c83ebac14610115578063153417471461017b57806319971cbd146101d85780631ec28e0f146101fe57806327e357461461022f5780633a32306c146102525780634364725c146102ba5780634afb4f11146102eb5780634cc0e2bc146103535780635f302e8b1461038f5780636b102c49146103cd5780636fb81cbb146104185780637b993bf314610427578063850d9758146104725780638a5a9d07146104f2578063bec171e514610523578063bf5f1e831461058b578063e9944a81146105c7578063f769ac4814610652578063f9f51401146106af575b610000565b34610000576101396004808035906020019091908035906020019091905050610738565b604051808273ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16815260200191505060405180910390f35b346100005761019660048080359060200190919050506107ee565b604051808273ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16815260200191505060405180910390f35b34610000576101fc600480803590602001909190803590602001909190505061083a565b005b34610000576102196004808035906020019091905050610f01565b6040518082815260200191505060405180910390f35b346100005761023c610f59565b6040518082815260200191505060405180910390f35b34610000576102a4600480803590602001908201803590602001908080602002602001604051908101604052809392919081815260200183836020028082843782019150505050505091905050610f67565b6040518082815260200191505060405180910390f35b34610000576102d56004808035906020019091905050610fd5565b6040518082815260200191505060405180910390f35b346100005761033d600480803590602001908201803590602001908080602002602001604051908101604052809392919081815260200183836020028082843782019150505050505091905050611007565b6040518082815260200191505060405180910390f35b346100005761038d600480803573ffffffffffffffffffffffffffffffffffffffff1690602001909190803590602001909190505061109a565b005b34610000576103b36004808035906020019091908035906020019091905050611881565b604051808215151515815260200191505060405180910390f35b34610000576103fe600480803573ffffffffffffffffffffffffffffffffffffffff16906020019091905050611948565b604051808215151515815260200191505060405180910390f35b34610000576104256119ec565b005b3461000057610458600480803573ffffffffffffffffffffffffffffffffffffffff16906020019091905050611ac0565b604051808215151515815260200191505060405180910390f35b346100005761048d6004808035906020019091905050611b64565b60405180806020018281038252838181518152602001915080519060200190602002808383600083146104df575b8051825260208311156104df576020820191506020810190506020830392506104bb565b5050509050019250505060405180910390f35b346100005761050d6004808035906020019091905050611cb7565b6040518082815260200191505060405180910390f35b3461000057610575600480803590602001908201803590602001908080602002602001604051908101604052809392919081815260200183836020028082843782019150505050505091905050611ce3565b6040518082815260200191505060405180910390f35b34610000576105c5600480803573ffffffffffffffffffffffffffffffffffffffff16906020019091908035906020019091905050611d76565b005b3461000057610638600480803573ffffffffffffffffffffffffffffffffffffffff16906020019091908035906020019082018035906020019080806020026020016040519081016040528093929190818152602001838360200280828437820191505050505050919050506129a6565b604051808215151515815260200191505060405180910390f35b346100005761066d6004808035906020019091905050612a23565b604051808273ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16815260200191505060405180910390f35b34610000576106d36004808035906020019091908035906020019091905050612b55565b6040518080602001828103825283818151815260200191508051906020019060200280838360008314610725575b80518252602083111561072557602082019150602081019050602083039250610701565b5050509050019250505060405180910390f35b600060018311806107495750600282115b1561075357610000565b600083141561079d576006600001600083815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1690506107e8565b60018314156107e7576006600201600083815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1690506107e8565b5b92915050565b6000600082815481101561000057906000526020600020906002020160005b5060010160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1690505b919050565b61084333611948565b151561084e57610000565b600281111561085c57610000565b600081148061086b5750600281145b8015610904575061090160018054806020026020016040519081016040528092919081815260200182805480156108f757602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16815260200190600101908083116108ad575b5050505050610f67565b82115b1561090e57610000565b6001811480156109ab57506109a8600280548060200260200160405190810160405280929190818152602001828054801561099e57602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311610954575b5050505050610f67565b82115b156109b557610000565b60008114156109d1578160096000015414156109d057610000565b5b60018114156109ed578160096001015414156109ec57610000565b5b6002811415610a0957816009600201541415610a0857610000565b5b6006600101600082815260200190815260200160002060000160009054906101000a900460ff161515610bbb5760016006600101600083815260200190815260200160002060000160006101000a81548160ff02191690831515021790555081600660010160008381526020019081526020016000206002018190555043600660010160008381526020019081526020016000206003018190555060006006600101600083815260200190815260200160002060010181815481835581811511610aff57818360005260206000209182019101610afe91905b80821115610afa576000816000905550600101610ae2565b5090565b5b50505050600660010160008281526020019081526020016000206001018054806001018281815481835581811511610b6357818360005260206000209182019101610b6291905b80821115610b5e576000816000905550600101610b46565b5090565b5b505050916000526020600020900160005b33909190916101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff16021790555050610d7a565b600554600660010160008381526020019081526020016000206003015443031115610bee57610be981612d90565b610efc565b816006600101600083815260200190815260200160002060020154141515610c1557610000565b610cbc3360066001016000848152602001908152602001600020600101805480602002602001604051908101604052809291908181526020018280548015610cb257602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311610c68575b50505050506129a6565b15610cc657610000565b600660010160008281526020019081526020016000206001018054806001018281815481835581811511610d2657818360005260206000209182019101610d2591905b80821115610d21576000816000905550600101610d09565b5090565b5b505050916000526020600020900160005b33909190916101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff160217905550505b600960020154610e2660066001016000848152602001908152602001600020600101805480602002602001604051908101604052809291908181526020018280548015610e1c57602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311610dd2575b5050505050611ce3565b101515610efb576000811480610e3c5750600181145b15610e4c57610e4b6002612e63565b5b6000811415610e795760066001016000828152602001908152602001600020600201546009600001819055505b6002811415610e9757610e8c6000612e63565b610e966001612e63565b5b6001811415610ec45760066001016000828152602001908152602001600020600201546009600101819055505b6002811415610ef15760066001016000828152602001908152602001600020600201546009600201819055505b610efa81612d90565b5b5b5b5050565b60006002821115610f1157610000565b6000821415610f27576009600001549050610f54565b6001821415610f3d576009600101549050610f54565b6002821415610f53576009600201549050610f54565b5b919050565b600060008054905090505b90565b60006000600060009050600091505b8351821015610fca57600084838151811015610000579060200190602002015173ffffffffffffffffffffffffffffffffffffffff16141515610fbc5780806001019150505b5b8180600101925050610f76565b8092505b5050919050565b60006002821115610fe557610000565b600660010160008381526020019081526020016000206002015490505b919050565b60006000600060009050600091505b835182101561108f57600084838151811015610000579060200190602002015173ffffffffffffffffffffffffffffffffffffffff16141580156110735750611072848381518110156100005790602001906020020151611ac0565b5b156110815780806001019150505b5b8180600101925050611016565b8092505b5050919050565b600060006110a733611948565b15156110b257610000565b60008473ffffffffffffffffffffffffffffffffffffffff1614156110d657610000565b60018311156110e457610000565b60008314156111b45761117c600180548060200260200160405190810160405280929190818152602001828054801561117257602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311611128575b5050505050610f67565b9150600960000154821480611195575060096002015482145b1561119f57610000565b6111a884611948565b15156111b357610000565b5b600183141561127257600960010154611252600280548060200260200160405190810160405280929190818152602001828054801561124857602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16815260200190600101908083116111fe575b5050505050610f67565b141561125d57610000565b61126684611ac0565b151561127157610000565b5b6006600201600084815260200190815260200160002060000160009054906101000a900460ff16151561145e5760016006600201600085815260200190815260200160002060000160006101000a81548160ff021916908315150217905550836006600201600085815260200190815260200160002060020160006101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff160217905550436006600201600085815260200190815260200160002060030181905550600060066002016000858152602001908152602001600020600101818154818355818115116113a2578183600052602060002091820191016113a191905b8082111561139d576000816000905550600101611385565b5090565b5b505050506006600201600084815260200190815260200160002060010180548060010182818154818355818115116114065781836000526020600020918201910161140591905b808211156114015760008160009055506001016113e9565b5090565b5b505050916000526020600020900160005b33909190916101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff16021790555050611669565b6005546006600201600085815260200190815260200160002060030154430311156114915761148c83612f70565b61187a565b8373ffffffffffffffffffffffffffffffffffffffff166006600201600085815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1614151561150457610000565b6115ab33600660020160008681526020019081526020016000206001018054806020026020016040519081016040528092919081815260200182805480156115a157602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311611557575b50505050506129a6565b156115b557610000565b6006600201600084815260200190815260200160002060010180548060010182818154818355818115116116155781836000526020600020918201910161161491905b808211156116105760008160009055506001016115f8565b5090565b5b505050916000526020600020900160005b33909190916101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff160217905550505b6009600201546117156006600201600086815260200190815260200160002060010180548060200260200160405190810160405280929190818152602001828054801561170b57602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16815260200190600101908083116116c1575b5050505050611ce3565b1015156118795760008314801561176a57506117696006600201600085815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff16611948565b5b156117b3576117b2836006600201600086815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1661307d565b5b60018314801561180157506118006006600201600085815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff16611ac0565b5b1561184a57611849836006600201600086815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1661307d565b5b600090505b600381101561186f5761186181612e63565b5b808060010191505061184f565b61187883612f70565b5b5b5b50505050565b600060028311806118925750600282115b1561189c57610000565b60008314156118d3576006600001600083815260200190815260200160002060000160009054906101000a900460ff169050611942565b600183141561190a576006600101600083815260200190815260200160002060000160009054906101000a900460ff169050611942565b6002831415611941576006600201600083815260200190815260200160002060000160009054906101000a900460ff169050611942565b5b92915050565b60006000600090505b6001805490508110156119e1578273ffffffffffffffffffffffffffffffffffffffff16600182815481101561000057906000526020600020900160005b9054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1614156119d357600191506119e6565b5b8080600101915050611951565b600091505b50919050565b600460009054906101000a900460ff1615611a0657610000565b60018054806001018281815481835581811511611a4f57818360005260206000209182019101611a4e91905b80821115611a4a576000816000905550600101611a32565b5090565b5b505050916000526020600020900160005b33909190916101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff160217905550506001600460006101000a81548160ff0219169083151502179055505b565b60006000600090505b600280549050811015611b59578273ffffffffffffffffffffffffffffffffffffffff16600282815481101561000057906000526020600020900160005b9054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff161415611b4b5760019150611b5e565b5b8080600101915050611ac9565b600091505b50919050565b60206040519081016040528060008152506001821115611b8357610000565b6000821415611c1a576001805480602002602001604051908101604052809291908181526020018280548015611c0e57602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311611bc4575b50505050509050611cb2565b6001821415611cb1576002805480602002602001604051908101604052809291908181526020018280548015611ca557602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311611c5b575b50505050509050611cb2565b5b919050565b6000600082815481101561000057906000526020600020906002020160005b506000015490505b919050565b60006000600060009050600091505b8351821015611d6b57600084838151811015610000579060200190602002015173ffffffffffffffffffffffffffffffffffffffff1614158015611d4f5750611d4e848381518110156100005790602001906020020151611948565b5b15611d5d5780806001019150505b5b8180600101925050611cf2565b8092505b5050919050565b611d7f33611948565b158015611d925750611d9033611ac0565b155b15611d9c57610000565b600081148015611e3c5750600354611e396001805480602002602001604051908101604052809291908181526020018280548015611e2f57602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311611de5575b5050505050610f67565b10155b15611e4657610000565b600181148015611ee65750600354611ee36002805480602002602001604051908101604052809291908181526020018280548015611ed957602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311611e8f575b5050505050610f67565b10155b15611ef057610000565b60008273ffffffffffffffffffffffffffffffffffffffff161415611f1457610000565b6002811115611f2257610000565b6000811480611f315750600181145b8015611f525750611f4182611948565b80611f515750611f5082611ac0565b5b5b15611f5c57610000565b6006600001600082815260200190815260200160002060000160009054906101000a900460ff16151561215b57611f9233611ac0565b15611f9c57610000565b60016006600001600083815260200190815260200160002060000160006101000a81548160ff021916908315150217905550816006600001600083815260200190815260200160002060020160006101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff1602179055504360066000016000838152602001908152602001600020600301819055506000600660000160008381526020019081526020016000206001018181548183558181151161209f5781836000526020600020918201910161209e91905b8082111561209a576000816000905550600101612082565b5090565b5b505050506006600001600082815260200190815260200160002060010180548060010182818154818355818115116121035781836000526020600020918201910161210291905b808211156120fe5760008160009055506001016120e6565b5090565b5b505050916000526020600020900160005b33909190916101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff16021790555050612366565b60055460066000016000838152602001908152602001600020600301544303111561218e5761218981612e63565b6129a1565b8173ffffffffffffffffffffffffffffffffffffffff166006600001600083815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1614151561220157610000565b6122a8336006600001600084815260200190815260200160002060010180548060200260200160405190810160405280929190818152602001828054801561229e57602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311612254575b50505050506129a6565b156122b257610000565b6006600001600082815260200190815260200160002060010180548060010182818154818355818115116123125781836000526020600020918201910161231191905b8082111561230d5760008160009055506001016122f5565b5090565b5b505050916000526020600020900160005b33909190916101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff160217905550505b60008114806123755750600181145b1561268b576009600201546124266006600001600084815260200190815260200160002060010180548060200260200160405190810160405280929190818152602001828054801561241c57602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16815260200190600101908083116123d2575b5050505050611ce3565b10151561268a5761246f6006600001600083815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff16611948565b806124b857506124b76006600001600083815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff16611ac0565b5b156124c257610000565b60008114156125a157600180548060010182818154818355818115116125145781836000526020600020918201910161251391905b8082111561250f5760008160009055506001016124f7565b5090565b5b505050916000526020600020900160005b6006600001600085815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff16909190916101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff160217905550505b600181141561268057600280548060010182818154818355818115116125f3578183600052602060002091820191016125f291905b808211156125ee5760008160009055506001016125d6565b5090565b5b505050916000526020600020900160005b6006600001600085815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff16909190916101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff160217905550505b61268981612e63565b5b5b60028114156129a0576009600001546127406006600001600084815260200190815260200160002060010180548060200260200160405190810160405280929190818152602001828054801561273657602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16815260200190600101908083116126ec575b5050505050611ce3565b101580156127f857506009600101546127f5600660000160008481526020019081526020016000206001018054806020026020016040519081016040528092919081815260200182805480156127eb57602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16815260200190600101908083116127a1575b5050505050611007565b10155b1561299f57600060008054905011801561283d5750600143016000600160008054905003815481101561000057906000526020600020906002020160005b5060000154145b1561284757610000565b600080548060010182818154818355818115116128c0576002028160020283600052602060002091820191016128bf91905b808211156128bb57600060008201600090556001820160006101000a81549073ffffffffffffffffffffffffffffffffffffffff021916905550600201612879565b5090565b5b505050916000526020600020906002020160005b6040604051908101604052806001430181526020016006600001600087815260200190815260200160002060020160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681525090919091506000820151816000015560208201518160010160006101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff16021790555050505061299e81612e63565b5b5b5b5b5050565b60006000600090505b8251811015612a17578373ffffffffffffffffffffffffffffffffffffffff1683828151811015610000579060200190602002015173ffffffffffffffffffffffffffffffffffffffff161415612a095760019150612a1c565b5b80806001019150506129af565b600091505b5092915050565b6000600060006000805490501415612a3e5760009150612b4f565b60016000805490500390505b6000811115612ad55782600082815481101561000057906000526020600020906002020160005b5060000154111515612ac657600081815481101561000057906000526020600020906002020160005b5060010160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff169150612b4f565b5b808060019003915050612a4a565b8260006000815481101561000057906000526020600020906002020160005b5060000154111515612b4a5760006000815481101561000057906000526020600020906002020160005b5060010160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff169150612b4f565b600091505b50919050565b60206040519081016040528060008152506002831180612b755750600282115b15612b7f57610000565b6000831415612c2d5760066000016000838152602001908152602001600020600101805480602002602001604051908101604052809291908181526020018280548015612c2157602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311612bd7575b50505050509050612d8a565b6001831415612cdb5760066001016000838152602001908152602001600020600101805480602002602001604051908101604052809291908181526020018280548015612ccf57602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311612c85575b50505050509050612d8a565b6002831415612d895760066002016000838152602001908152602001600020600101805480602002602001604051908101604052809291908181526020018280548015612d7d57602002820191906000526020600020905b8160009054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff1681526020019060010190808311612d33575b50505050509050612d8a565b5b92915050565b6000600660010160008381526020019081526020016000206002018190555060006006600101600083815260200190815260200160002060010181815481835581811511612e0a57818360005260206000209182019101612e0991905b80821115612e05576000816000905550600101612ded565b5090565b5b505050506000600660010160008381526020019081526020016000206003018190555060006006600101600083815260200190815260200160002060000160006101000a81548160ff0219169083151502179055505b50565b60006006600001600083815260200190815260200160002060020160006101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff16021790555060006006600001600083815260200190815260200160002060010181815481835581811511612f1757818360005260206000209182019101612f1691905b80821115612f12576000816000905550600101612efa565b5090565b5b505050506000600660000160008381526020019081526020016000206003018190555060006006600001600083815260200190815260200160002060000160006101000a81548160ff0219169083151502179055505b50565b60006006600201600083815260200190815260200160002060020160006101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff160217905550600060066002016000838152602001908152602001600020600101818154818355818115116130245781836000526020600020918201910161302391905b8082111561301f576000816000905550600101613007565b5090565b5b505050506000600660020160008381526020019081526020016000206003018190555060006006600201600083815260200190815260200160002060000160006101000a81548160ff0219169083151502179055505b50565b6000600083141561315157600090505b600180549050811015613150578173ffffffffffffffffffffffffffffffffffffffff16600182815481101561000057906000526020600020900160005b9054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16141561314257600181815481101561000057906000526020600020900160005b6101000a81549073ffffffffffffffffffffffffffffffffffffffff02191690555b5b808060010191505061308d565b5b600183141561322357600090505b600280549050811015613222578173ffffffffffffffffffffffffffffffffffffffff16600282815481101561000057906000526020600020900160005b9054906101000a900473ffffffffffffffffffffffffffffffffffffffff1673ffffffffffffffffffffffffffffffffffffffff16141561321457600281815481101561000057906000526020600020900160005b6101000a81549073ffffffffffffffffffffffffffffffffffffffff02191690555b5b808060010191505061315f565b5b5b5050505600a165627a7a7230582036e4abcf6c2808d63bc7a088f625291c4621d5f8e2812de8b45d7456f787eac00029",
         "storage": {"3": "30","5": "21600"} },
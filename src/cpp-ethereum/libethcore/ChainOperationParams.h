@@ -37,7 +37,7 @@ class PrecompiledContract
 public:
 	PrecompiledContract() = default;
 	PrecompiledContract(
-		std::function<bigint(size_t)> const& _cost,
+		PrecompiledPricer const& _cost,
 		PrecompiledExecutor const& _exec,
 		u256 const& _startingBlock = 0
 	):
@@ -52,13 +52,14 @@ public:
 		u256 const& _startingBlock = 0
 	);
 
-	bigint cost(bytesConstRef _in) const { return m_cost(_in.size()); }
+	bigint cost(bytesConstRef _in, EVMSchedule const& _schedule) const { return m_cost(_in, _schedule); }
 	std::pair<bool, bytes> execute(bytesConstRef _in) const { return m_execute(_in); }
 
 	u256 const& startingBlock() const { return m_startingBlock; }
+	void setStartingBlock(u256 const& _startingBlock) { m_startingBlock = _startingBlock; } // silubium
 
 private:
-	std::function<bigint(size_t)> m_cost;
+	PrecompiledPricer m_cost;
 	PrecompiledExecutor m_execute;
 	u256 m_startingBlock = 0;
 };
@@ -24,7 +24,10 @@
 #include <libdevcore/SHA3.h>
 #include <libdevcore/Hash.h>
 #include <libdevcrypto/Common.h>
+#include <libdevcrypto/AltBn128.h>
+#include <libdevcrypto/Blake2.h>
 #include <libethcore/Common.h>
+#include <limits>
 using namespace std;
 using namespace dev;
 using namespace dev::eth;
@@ -38,6 +41,13 @@ PrecompiledExecutor const& PrecompiledRegistrar::executor(std::string const& _na
 	return get()->m_execs[_name];
 }
 
+PrecompiledPricer const& PrecompiledRegistrar::pricer(std::string const& _name)
+{
+	if (!get()->m_pricers.count(_name))
+		BOOST_THROW_EXCEPTION(PricerNotFound());
+	return get()->m_pricers[_name];
+}
+
 namespace
 {
 
@@ -90,4 +100,146 @@ ETH_REGISTER_PRECOMPILED(identity)(bytesConstRef _in)
 	return {true, _in.toBytes()};
 }
 
+// Reads _count bytes from _begin as a big-endian number, as if _in were followed by zeros.
+bigint parseBigEndianRightPadded(bytesConstRef _in, bigint const& _begin, bigint const& _count)
+{
+	if (_begin > _in.count())
+		return 0;
+	assert(_count <= numeric_limits<size_t>::max() / 8); // Otherwise, the return value would not fit in the memory.
+
+	size_t const begin{_begin};
+	size_t const count{_count};
+
+	// crop _in, not going beyond its size
+	bytesConstRef cropped = _in.cropped(begin, min(count, _in.count() - begin));
+
+	bigint ret = fromBigEndian<bigint>(cropped);
+	// shift as if we had right-padding zeroes
+	ret <<= 8 * (count - cropped.count());
+
+	return ret;
+}
+
+ETH_REGISTER_PRECOMPILED(modexp)(bytesConstRef _in)
+{
+	// This is only called once the gas of the lengths has been paid, so they fit in memory
+	size_t const baseLength(parseBigEndianRightPadded(_in, 0, 32));
+	size_t const expLength(parseBigEndianRightPadded(_in, 32, 32));
+	size_t const modLength(parseBigEndianRightPadded(_in, 64, 32));
+	if (modLength == 0 && baseLength == 0)
+		return {true, bytes{}}; // This is a special case where expLength can be very big.
+
+	bigint const base(parseBigEndianRightPadded(_in, 96, baseLength));
+	bigint const exp(parseBigEndianRightPadded(_in, 96 + baseLength, expLength));
+	bigint const mod(parseBigEndianRightPadded(_in, 96 + baseLength + expLength, modLength));
+
+	bigint const result = mod != 0 ? boost::multiprecision::powm(base, exp, mod) : bigint{0};
+
+	bytes ret(modLength);
+	toBigEndian(result, ret);
+	return {true, ret};
+}
+
+bigint expLengthAdjust(bigint const& _expOffset, bigint const& _expLength, bytesConstRef _in)
+{
+	if (_expLength <= 32)
+	{
+		bigint const exp(parseBigEndianRightPadded(_in, _expOffset, _expLength));
+		return exp ? msb(exp) : 0;
+	}
+	else
+	{
+		bigint const expFirstWord(parseBigEndianRightPadded(_in, _expOffset, 32));
+		size_t const highestBit(expFirstWord ? msb(expFirstWord) : 0);
+		return 8 * (_expLength - 32) + highestBit;
+	}
+}
+
+bigint multComplexity(bigint const& _x)
+{
+	if (_x <= 64)
+		return _x * _x;
+	if (_x <= 1024)
+		return (_x * _x) / 4 + 96 * _x - 3072;
+	else
+		return (_x * _x) / 16 + 480 * _x - 199680;
+}
+
+ETH_REGISTER_PRECOMPILED_PRICER(modexp)(bytesConstRef _in, EVMSchedule const& _schedule)
+{
+	bigint const baseLength(parseBigEndianRightPadded(_in, 0, 32));
+	bigint const expLength(parseBigEndianRightPadded(_in, 32, 32));
+	bigint const modLength(parseBigEndianRightPadded(_in, 64, 32));
+
+	bigint const maxLength(max(modLength, baseLength));
+	bigint const adjustedExpLength(expLengthAdjust(baseLength + 96, expLength, _in));
+
+	return multComplexity(maxLength) * max<bigint>(adjustedExpLength, 1) / _schedule.modexpQuadDivisor;
+}
+
+ETH_REGISTER_PRECOMPILED(alt_bn128_G1_add)(bytesConstRef _in)
+{
+	return dev::crypto::alt_bn128_G1_add(_in);
+}
+
+ETH_REGISTER_PRECOMPILED_PRICER(alt_bn128_G1_add)(bytesConstRef, EVMSchedule const& _schedule)
+{
+	return _schedule.bn128AddGas;
+}
+
+ETH_REGISTER_PRECOMPILED(alt_bn128_G1_mul)(bytesConstRef _in)
+{
+	return dev::crypto::alt_bn128_G1_mul(_in);
+}
+
+ETH_REGISTER_PRECOMPILED_PRICER(alt_bn128_G1_mul)(bytesConstRef, EVMSchedule const& _schedule)
+{
+	return _schedule.bn128MulGas;
+}
+
+ETH_REGISTER_PRECOMPILED(alt_bn128_pairing_product)(bytesConstRef _in)
+{
+	return dev::crypto::alt_bn128_pairing_product(_in);
+}
+
+ETH_REGISTER_PRECOMPILED_PRICER(alt_bn128_pairing_product)(bytesConstRef _in, EVMSchedule const& _schedule)
+{
+	return _schedule.bn128PairingBaseGas + bigint(_in.size() / 192) * _schedule.bn128PairingPairGas;
+}
+
+ETH_REGISTER_PRECOMPILED(blake2_compression)(bytesConstRef _in)
+{
+	static constexpr size_t roundsSize = 4;
+	static constexpr size_t stateVectorSize = 8 * 8;
+	static constexpr size_t messageBlockSize = 16 * 8;
+	static constexpr size_t offsetCounterSize = 8;
+	static constexpr size_t finalBlockIndicatorSize = 1;
+	static constexpr size_t totalInputSize = roundsSize + stateVectorSize + messageBlockSize + 2 * offsetCounterSize + finalBlockIndicatorSize;
+
+	if (_in.size() != totalInputSize)
+		return {false, {}};
+
+	auto const rounds = fromBigEndian<uint32_t>(_in.cropped(0, roundsSize));
+	auto const stateVector = _in.cropped(roundsSize, stateVectorSize);
+	auto const messageBlock = _in.cropped(roundsSize + stateVectorSize, messageBlockSize);
+	bytes const offsetCounters = _in.cropped(roundsSize + stateVectorSize + messageBlockSize, 2 * offsetCounterSize).toBytes();
+	auto const finalBlockIndicator = _in[totalInputSize - 1];
+
+	if (finalBlockIndicator != 0 && finalBlockIndicator != 1)
+		return {false, {}};
+
+	uint64_t t[2] = {0, 0};
+	for (unsigned i = 0; i < 2; ++i)
+		for (int j = 7; j >= 0; --j)
+			t[i] = (t[i] << 8) | offsetCounters[8 * i + j];
+
+	return {true, dev::crypto::blake2FCompression(rounds, stateVector, messageBlock, t[0], t[1], finalBlockIndicator)};
+}
+
+ETH_REGISTER_PRECOMPILED_PRICER(blake2_compression)(bytesConstRef _in, EVMSchedule const& _schedule)
+{
+	auto const rounds = fromBigEndian<uint32_t>(_in.cropped(0, 4));
+	return bigint(rounds) * _schedule.blake2RoundGas;
+}
+
 }
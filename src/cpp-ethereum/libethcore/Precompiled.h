@@ -25,6 +25,7 @@
 #include <functional>
 #include <libdevcore/CommonData.h>
 #include <libdevcore/Exceptions.h>
+#include <libevmcore/EVMSchedule.h>
 
 namespace dev
 {
@@ -32,8 +33,10 @@ namespace eth
 {
 
 using PrecompiledExecutor = std::function<std::pair<bool, bytes>(bytesConstRef _in)>;
+using PrecompiledPricer = std::function<bigint(bytesConstRef _in, EVMSchedule const& _schedule)>;
 
 DEV_SIMPLE_EXCEPTION(ExecutorNotFound);
+DEV_SIMPLE_EXCEPTION(PricerNotFound);
 
 class PrecompiledRegistrar
 {
@@ -46,15 +49,23 @@ public:
 	/// Unregister an executor. Shouldn't generally be necessary.
 	static void unregisterPrecompiled(std::string const& _name) { get()->m_execs.erase(_name); }
 
+	/// Get the pricer of @a _name function, for the contracts whose cost is not linear in the input size, or @throw PricerNotFound if not found.
+	static PrecompiledPricer const& pricer(std::string const& _name);
+
+	/// Register a pricer. In general just use ETH_REGISTER_PRECOMPILED_PRICER.
+	static PrecompiledPricer registerPricer(std::string const& _name, PrecompiledPricer const& _pricer) { return (get()->m_pricers[_name] = _pricer); }
+
 private:
 	static PrecompiledRegistrar* get() { if (!s_this) s_this = new PrecompiledRegistrar; return s_this; }
 
 	std::unordered_map<std::string, PrecompiledExecutor> m_execs;
+	std::unordered_map<std::string, PrecompiledPricer> m_pricers;
 	static PrecompiledRegistrar* s_this;
 };
 
 // TODO: unregister on unload with a static object.
 #define ETH_REGISTER_PRECOMPILED(Name) static std::pair<bool, bytes> __eth_registerPrecompiledFunction ## Name(bytesConstRef _in); static PrecompiledExecutor __eth_registerPrecompiledFactory ## Name = ::dev::eth::PrecompiledRegistrar::registerPrecompiled(#Name, &__eth_registerPrecompiledFunction ## Name); static std::pair<bool, bytes> __eth_registerPrecompiledFunction ## Name
+#define ETH_REGISTER_PRECOMPILED_PRICER(Name) static bigint __eth_registerPricerFunction ## Name(bytesConstRef _in, EVMSchedule const& _schedule); static PrecompiledPricer __eth_registerPricerFactory ## Name = ::dev::eth::PrecompiledRegistrar::registerPricer(#Name, &__eth_registerPricerFunction ## Name); static bigint __eth_registerPricerFunction ## Name
 
 }
 }
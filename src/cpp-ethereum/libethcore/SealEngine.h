@@ -81,7 +81,7 @@ public:
 	{
 		return m_params.precompiled.count(_a) != 0 && _blockNumber >= m_params.precompiled.at(_a).startingBlock();
 	}
-	virtual bigint costOfPrecompiled(Address const& _a, bytesConstRef _in, u256 const&) const { return m_params.precompiled.at(_a).cost(_in); }
+	virtual bigint costOfPrecompiled(Address const& _a, bytesConstRef _in, EnvInfo const& _envInfo) const { return m_params.precompiled.at(_a).cost(_in, evmSchedule(_envInfo)); }
 	virtual std::pair<bool, bytes> executePrecompiled(Address const& _a, bytesConstRef _in, u256 const&) const { return m_params.precompiled.at(_a).execute(_in); }
 
 ////////////////////////////////////////////////////////////// // silubium
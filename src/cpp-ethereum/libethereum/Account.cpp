@@ -116,20 +116,20 @@ AccountMap dev::eth::jsonToAccountMap(std::string const& _json, u256 const& _def
 		{
 			js::mObject p = o["precompiled"].get_obj();
 			auto n = p["name"].get_str();
-			if (!p.count("linear"))
-			{
-				cwarn << "No gas cost given for precompiled contract " << n;
-				throw;
-			}
 			try
 			{
-				auto l = p["linear"].get_obj();
 				u256 startingBlock = 0;
 				if (p.count("startingBlock"))
 					startingBlock = u256(p["startingBlock"].get_str());
-				unsigned base = toUnsigned(l["base"]);
-				unsigned word = toUnsigned(l["word"]);
-				o_precompiled->insert(make_pair(a, PrecompiledContract(base, word, PrecompiledRegistrar::executor(n), startingBlock)));
+				if (p.count("linear"))
+				{
+					auto l = p["linear"].get_obj();
+					unsigned base = toUnsigned(l["base"]);
+					unsigned word = toUnsigned(l["word"]);
+					o_precompiled->insert(make_pair(a, PrecompiledContract(base, word, PrecompiledRegistrar::executor(n), startingBlock)));
+				}
+				else
+					o_precompiled->insert(make_pair(a, PrecompiledContract(PrecompiledRegistrar::pricer(n), PrecompiledRegistrar::executor(n), startingBlock)));
 			}
 			catch (ExecutorNotFound)
 			{
@@ -137,6 +137,11 @@ AccountMap dev::eth::jsonToAccountMap(std::string const& _json, u256 const& _def
 				cwarn << "Couldn't create a precompiled contract account. Missing an executor called:" << n;
 				throw;
 			}
+			catch (PricerNotFound)
+			{
+				cwarn << "No gas cost given for precompiled contract " << n;
+				throw;
+			}
 		}
 	}
 
@@ -279,7 +279,7 @@ bool Executive::call(CallParameters const& _p, u256 const& _gasPrice, Address co
 
 	if (m_sealEngine.isPrecompiled(_p.codeAddress, m_envInfo.number()))
 	{
-		bigint g = m_sealEngine.costOfPrecompiled(_p.codeAddress, _p.data, m_envInfo.number());
+		bigint g = m_sealEngine.costOfPrecompiled(_p.codeAddress, _p.data, m_envInfo);
 		if (_p.gas < g)
 		{
 			m_excepted = TransactionException::OutOfGasBase;
@@ -21,7 +21,10 @@
 
 #include "State.h"
 
+#include <atomic>
 #include <ctime>
+#include <mutex>
+#include <thread>
 #include <boost/filesystem.hpp>
 #include <boost/timer.hpp>
 #include <libdevcore/CommonIO.h>
@@ -68,6 +71,8 @@ State::State(State const& _s):
 	m_unchangedCacheEntries(_s.m_unchangedCacheEntries),
 	m_nonExistingAccountsCache(_s.m_nonExistingAccountsCache),
 	m_touched(_s.m_touched),
+	m_deferredCache(_s.m_deferredCache),
+	m_deferCommits(_s.m_deferCommits),
 	m_accountStartNonce(_s.m_accountStartNonce)
 {}
 
@@ -150,7 +155,10 @@ State& State::operator=(State const& _s)
 	m_cache = _s.m_cache;
 	m_unchangedCacheEntries = _s.m_unchangedCacheEntries;
 	m_nonExistingAccountsCache = _s.m_nonExistingAccountsCache;
+	m_cleanCache.clear();
 	m_touched = _s.m_touched;
+	m_deferredCache = _s.m_deferredCache;
+	m_deferCommits = _s.m_deferCommits;
 	m_accountStartNonce = _s.m_accountStartNonce;
 	return *this;
 }
@@ -166,14 +174,46 @@ Account* State::account(Address const& _addr)
 	if (it != m_cache.end())
 		return &it->second;
 
+	// Accounts committed while the commits are deferred, changed on a copy until the next commit // silubium
+	auto deferred = m_deferredCache.find(_addr);
+	if (deferred != m_deferredCache.end())
+	{
+		if (!deferred->second.isAlive())
+			return nullptr;
+
+		clearCacheIfTooLarge();
+
+		auto i = m_cache.emplace(_addr, deferred->second);
+		i.first->second.untouch();
+		m_unchangedCacheEntries.push_back(_addr);
+		onAccountLoaded(_addr, &i.first->second); // silubium
+		return &i.first->second;
+	}
+
 	if (m_nonExistingAccountsCache.count(_addr))
 		return nullptr;
 
+	// Accounts loaded or committed since the state was at another root
+	if (StateCache::Entry const* clean = m_cleanCache.account(_addr))
+	{
+		clearCacheIfTooLarge();
+
+		auto i = m_cache.emplace(
+			std::piecewise_construct,
+			std::forward_as_tuple(_addr),
+			std::forward_as_tuple(clean->nonce, clean->balance, clean->storageRoot, clean->codeHash, Account::Unchanged)
+		);
+		m_unchangedCacheEntries.push_back(_addr);
+		onAccountLoaded(_addr, &i.first->second); // silubium
+		return &i.first->second;
+	}
+
 	// Populate basic info.
 	string stateBack = m_state.at(_addr);
 	if (stateBack.empty())
 	{
 		m_nonExistingAccountsCache.insert(_addr);
+		onAccountLoaded(_addr, nullptr); // silubium
 		return nullptr;
 	}
 
@@ -186,6 +226,8 @@ Account* State::account(Address const& _addr)
 		std::forward_as_tuple(state[0].toInt<u256>(), state[1].toInt<u256>(), state[2].toHash<h256>(), state[3].toHash<h256>(), Account::Unchanged)
 	);
 	m_unchangedCacheEntries.push_back(_addr);
+	m_cleanCache.noteAccount(_addr, i.first->second);
+	onAccountLoaded(_addr, &i.first->second); // silubium
 	return &i.first->second;
 }
 
@@ -211,12 +253,143 @@ void State::commit(CommitBehaviour _commitBehaviour)
 {
 	if (_commitBehaviour == CommitBehaviour::RemoveEmptyAccounts)
 		removeEmptyAccounts();
-	m_touched += dev::eth::commit(m_cache, m_state);
+	if (m_deferCommits)
+	{
+		// silubium
+		for (auto& i: m_cache)
+			if (i.second.isDirty())
+			{
+				m_deferredCache[i.first] = std::move(i.second);
+				m_touched.insert(i.first);
+			}
+	}
+	else
+	{
+		m_touched += dev::eth::commit(m_cache, m_state, [this](Address const& _addr, Account const* _account, h256 const& _storageRoot)
+		{
+			noteCommitted(_addr, _account, _storageRoot);
+		});
+		m_cleanCache.committed(m_state.root());
+	}
 	m_changeLog.clear();
 	m_cache.clear();
 	m_unchangedCacheEntries.clear();
 }
 
+void State::noteCommitted(Address const& _addr, Account const* _account, h256 const& _storageRoot)
+{
+	if (_account)
+		m_cleanCache.noteCommitted(_addr, *_account, _storageRoot);
+	else
+		m_cleanCache.noteRemoved(_addr);
+	onAccountCommitted(_addr, _account, _storageRoot); // silubium
+}
+
+namespace
+{
+
+/// Nodes of storage tries hashed on top of the state overlay, which is only read meanwhile, so that
+/// the storage tries of several accounts can be hashed at once. // silubium
+class StorageHashDB
+{
+public:
+	explicit StorageHashDB(OverlayDB const& _base): m_base(_base) {}
+
+	std::string lookup(h256 const& _h) const
+	{
+		std::string ret = m_nodes.lookup(_h);
+		return ret.empty() ? m_base.lookup(_h) : ret;
+	}
+	bool exists(h256 const& _h) const { return m_nodes.exists(_h) || m_base.exists(_h); }
+	void insert(h256 const& _h, bytesConstRef _v) { m_nodes.insert(_h, _v); }
+	bool kill(h256 const& _h) { return m_nodes.kill(_h); }
+	void insertAux(h256 const& _h, bytesConstRef _v) { m_aux.emplace_back(_h, _v.toBytes()); }
+
+	/// Moves the nodes still referenced and the preimages into @a _db.
+	void writeTo(OverlayDB& _db)
+	{
+		EnforceRefs enforce(m_nodes, true);
+		for (auto const& i: m_nodes.get())
+			_db.insert(i.first, &i.second);
+		for (auto const& i: m_aux)
+			_db.insertAux(i.first, &i.second);
+		m_nodes.clear();
+		m_aux.clear();
+	}
+
+private:
+	OverlayDB const& m_base;
+	MemoryDB m_nodes;
+	std::vector<std::pair<h256, bytes>> m_aux;
+};
+
+}
+
+void State::deferCommits()
+{
+	m_deferredCache.clear();
+	m_deferCommits = true;
+}
+
+void State::commitDeferred(unsigned _threads)
+{
+	commit(CommitBehaviour::KeepEmptyAccounts);
+	m_deferCommits = false;
+
+	std::vector<AccountMap::value_type const*> storages;
+	for (auto const& i: m_deferredCache)
+		if (i.second.isDirty() && i.second.isAlive() && !i.second.storageOverlay().empty())
+			storages.push_back(&i);
+
+	// The storage tries of different accounts share no state, so they are hashed apart and written to the overlay afterwards
+	std::vector<h256> roots(storages.size());
+	std::vector<StorageHashDB> dbs(max<size_t>(1, min<size_t>(_threads, storages.size())), StorageHashDB(m_db));
+	std::atomic<size_t> next(0);
+	std::exception_ptr error;
+	std::mutex errorMutex;
+	auto hashStorages = [&](StorageHashDB& _db)
+	{
+		try
+		{
+			for (size_t n = next++; n < storages.size(); n = next++)
+			{
+				Account const& a = storages[n]->second;
+				SecureTrieDB<h256, StorageHashDB> storageDB(&_db, a.baseRoot());
+				commitStorage(a.storageOverlay(), storageDB);
+				assert(storageDB.root());
+				roots[n] = storageDB.root();
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(errorMutex);
+			if (!error)
+				error = std::current_exception();
+		}
+	};
+	std::vector<std::thread> workers;
+	for (size_t t = 1; t < dbs.size(); ++t)
+		workers.emplace_back(hashStorages, std::ref(dbs[t]));
+	hashStorages(dbs[0]);
+	for (auto& w: workers)
+		w.join();
+	if (error)
+		std::rethrow_exception(error);
+
+	StorageRoots storageRoots;
+	for (size_t n = 0; n < storages.size(); ++n)
+		storageRoots[storages[n]->first] = roots[n];
+	for (auto& db: dbs)
+		db.writeTo(m_db);
+
+	m_touched += dev::eth::commit(m_deferredCache, m_state, [this](Address const& _addr, Account const* _account, h256 const& _storageRoot)
+	{
+		noteCommitted(_addr, _account, _storageRoot);
+	}, storageRoots);
+	m_cleanCache.committed(m_state.root());
+	m_deferredCache.clear();
+}
+
 unordered_map<Address, u256> State::addresses() const
 {
 #if ETH_FATDB
@@ -238,6 +411,9 @@ void State::setRoot(h256 const& _r)
 	m_cache.clear();
 	m_unchangedCacheEntries.clear();
 	m_nonExistingAccountsCache.clear();
+	m_deferredCache.clear();
+	m_deferCommits = false;
+	m_cleanCache.setRoot(_r);
 //	m_touched.clear();
 	m_state.setRoot(_r);
 }
@@ -358,11 +534,20 @@ u256 State::storage(Address const& _id, u256 const& _key) const
 		if (mit != a->storageOverlay().end())
 			return mit->second;
 
-		// Not in the storage cache - go to the DB.
-		SecureTrieDB<h256, OverlayDB> memdb(const_cast<OverlayDB*>(&m_db), a->baseRoot());			// promise we won't change the overlay! :)
-		string payload = memdb.at(_key);
-		u256 ret = payload.size() ? RLP(payload).toInt<u256>() : 0;
+		// Not in the storage cache - go to the slots kept across commits, then to the flat storage and the DB.
+		u256 ret;
+		if (!m_cleanCache.storage(_id, a->baseRoot(), _key, ret))
+		{
+			if (!lookupStorage(_id, a->baseRoot(), _key, ret)) // silubium
+			{
+				SecureTrieDB<h256, OverlayDB> memdb(const_cast<OverlayDB*>(&m_db), a->baseRoot());			// promise we won't change the overlay! :)
+				string payload = memdb.at(_key);
+				ret = payload.size() ? RLP(payload).toInt<u256>() : 0;
+			}
+			m_cleanCache.noteStorage(_id, a->baseRoot(), _key, ret);
+		}
 		a->setStorageCache(_key, ret);
+		onStorageLoaded(_id, _key); // silubium
 		return ret;
 	}
 	else
@@ -373,6 +558,7 @@ void State::setStorage(Address const& _contract, u256 const& _key, u256 const& _
 {
 	m_changeLog.emplace_back(_contract, _key, storage(_contract, _key));
 	m_cache[_contract].setStorage(_key, _value);
+	onStorageWritten(_contract, _key); // silubium
 }
 
 map<h256, pair<u256, u256>> State::storage(Address const& _id) const
@@ -430,7 +616,13 @@ bytes const& State::code(Address const& _addr) const
 	{
 		// Load the code from the backend.
 		Account* mutableAccount = const_cast<Account*>(a);
-		mutableAccount->noteCode(m_db.lookup(a->codeHash()));
+		if (bytes const* clean = m_cleanCache.code(_addr, a->codeHash()))
+			mutableAccount->noteCode(bytesConstRef(clean));
+		else
+		{
+			mutableAccount->noteCode(m_db.lookup(a->codeHash()));
+			m_cleanCache.noteCode(_addr, a->codeHash(), a->code());
+		}
 		CodeSizeCache::instance().store(a->codeHash(), a->code().size());
 	}
 
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <array>
+#include <functional>
 #include <unordered_map>
 #include <libdevcore/Common.h>
 #include <libdevcore/RLP.h>
@@ -30,6 +31,7 @@
 #include <libethcore/Exceptions.h>
 #include <libethcore/BlockHeader.h>
 #include <libethereum/CodeSizeCache.h>
+#include <libethereum/StateCache.h>
 #include <libethereum/GenericMiner.h>
 #include <libevm/ExtVMFace.h>
 #include "Account.h"
@@ -294,6 +296,19 @@ public:
 	/// Resets any uncommitted changes to the cache.
 	void setRoot(h256 const& _root);
 
+	/// Keep what commit() writes in memory from now on, until commitDeferred() or setRoot(). // silubium
+	/// rootHash() and storageRoot() stay at the root the state was at until then.
+	void deferCommits();
+
+	/// @returns true if commit() keeps the accounts in memory. // silubium
+	bool deferringCommits() const { return m_deferCommits; }
+
+	/// Write the accounts kept since deferCommits() to the trie, hashing their storage tries on up to @a _threads threads. // silubium
+	void commitDeferred(unsigned _threads = 1);
+
+	/// @returns the cache of the clean accounts and storage of the state, which is kept across commits.
+	StateCache const& cleanCache() const { return m_cleanCache; }
+
 	/// Get the account start nonce. May be required.
 	u256 const& accountStartNonce() const { return m_accountStartNonce; }
 	u256 const& requireAccountStartNonce() const;
@@ -326,12 +341,33 @@ protected: // silubium
 
 	void createAccount(Address const& _address, Account const&& _account);
 
+	/// Called when an account is read from the trie, with a null pointer if it does not exist. // silubium
+	virtual void onAccountLoaded(Address const&, Account const*) {}
+
+	/// Called when a storage slot is read from the trie. // silubium
+	virtual void onStorageLoaded(Address const&, u256 const&) const {}
+
+	/// Called when a storage slot is written. // silubium
+	virtual void onStorageWritten(Address const&, u256 const&) {}
+
+	/// Called before a storage slot is read from the storage trie with the given root, @returns true if the value was found elsewhere. // silubium
+	virtual bool lookupStorage(Address const&, h256 const&, u256 const&, u256&) const { return false; }
+
+	/// Called when commit() writes an account with the given storage root, with a null pointer if it was removed. // silubium
+	virtual void onAccountCommitted(Address const&, Account const*, h256 const&) {}
+
+	/// Notes an account written to the trie in the caches and the hooks. // silubium
+	void noteCommitted(Address const& _addr, Account const* _account, h256 const& _storageRoot);
+
 	OverlayDB m_db;								///< Our overlay for the state tree.
 	SecureTrieDB<Address, OverlayDB> m_state;	///< Our state tree, as an OverlayDB DB.
 	mutable std::unordered_map<Address, Account> m_cache;	///< Our address cache. This stores the states of each address that has (or at least might have) been changed.
 	mutable std::vector<Address> m_unchangedCacheEntries;	///< Tracks entries in m_cache that can potentially be purged if it grows too large.
 	mutable std::set<Address> m_nonExistingAccountsCache;	///< Tracks addresses that are known to not exist.
+	mutable StateCache m_cleanCache;			///< Accounts and storage as they are at the root, kept across commits. Copies start without it.
 	AddressHash m_touched;						///< Tracks all addresses touched so far.
+	AccountMap m_deferredCache;					///< Accounts committed since deferCommits(), written to the trie by commitDeferred(). // silubium
+	bool m_deferCommits = false;				///< Whether commit() keeps the accounts in m_deferredCache. // silubium
 
 	u256 m_accountStartNonce;
 
@@ -341,36 +377,87 @@ protected: // silubium
 
 std::ostream& operator<<(std::ostream& _out, State const& _s);
 
+/// Called for every account written by commit(), with a null account if it was removed, and the storage root it was written with.
+using OnCommitFunc = std::function<void(Address const&, Account const*, h256 const&)>;
+
+/// Storage roots of accounts that were already hashed, which commit() uses instead of their storage overlay.
+using StorageRoots = std::unordered_map<Address, h256>;
+
+/// Write the storage overlay @a _overlay to the storage trie @a _storageDB, hashing all the keys at once.
 template <class DB>
-AddressHash commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state)
+void commitStorage(std::unordered_map<u256, u256> const& _overlay, SecureTrieDB<h256, DB>& _storageDB)
 {
+	h256s keys;
+	keys.reserve(_overlay.size());
+	for (auto const& i: _overlay)
+		keys.push_back(h256(i.first));
+	std::vector<bytesConstRef> refs;
+	refs.reserve(keys.size());
+	for (h256 const& k: keys)
+		refs.push_back(k.ref());
+	h256s hashes = sha3Batch(refs);
+
+	size_t n = 0;
+	for (auto const& i: _overlay)
+	{
+		if (i.second)
+		{
+			bytes value = rlp(i.second);
+			_storageDB.insertHashed(hashes[n], refs[n], &value);
+		}
+		else
+			_storageDB.removeHashed(hashes[n]);
+		++n;
+	}
+}
+
+template <class DB>
+AddressHash commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state, OnCommitFunc const& _onCommit = OnCommitFunc(), StorageRoots const& _storageRoots = StorageRoots())
+{
+	// The keys of the accounts are hashed all at once
+	std::vector<bytesConstRef> keys;
+	for (auto const& i: _cache)
+		if (i.second.isDirty())
+			keys.push_back(i.first.ref());
+	h256s hashes = sha3Batch(keys);
+	size_t n = 0;
+
 	AddressHash ret;
 	for (auto const& i: _cache)
 		if (i.second.isDirty())
 		{
+			h256 const& hash = hashes[n];
+			bytesConstRef key = keys[n++];
 			if (!i.second.isAlive())
-				_state.remove(i.first);
+			{
+				_state.removeHashed(hash);
+				if (_onCommit)
+					_onCommit(i.first, nullptr, h256());
+			}
 			else
 			{
 				RLPStream s(4);
 				s << i.second.nonce() << i.second.balance();
 
-				if (i.second.storageOverlay().empty())
+				h256 storageRoot;
+				auto hashed = _storageRoots.find(i.first);
+				if (hashed != _storageRoots.end())
+					storageRoot = hashed->second;
+				else if (i.second.storageOverlay().empty())
 				{
 					assert(i.second.baseRoot());
-					s.append(i.second.baseRoot());
+					storageRoot = i.second.baseRoot();
 				}
 				else
 				{
 					SecureTrieDB<h256, DB> storageDB(_state.db(), i.second.baseRoot());
-					for (auto const& j: i.second.storageOverlay())
-						if (j.second)
-							storageDB.insert(j.first, rlp(j.second));
-						else
-							storageDB.remove(j.first);
+					commitStorage(i.second.storageOverlay(), storageDB);
 					assert(storageDB.root());
-					s.append(storageDB.root());
+					storageRoot = storageDB.root();
 				}
+				s.append(storageRoot);
+				if (_onCommit)
+					_onCommit(i.first, &i.second, storageRoot);
 
 				if (i.second.hasNewCode())
 				{
@@ -383,7 +470,7 @@ AddressHash commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state)
 				else
 					s << i.second.codeHash();
 
-				_state.insert(i.first, &s.out());
+				_state.insertHashed(hash, key, &s.out());
 			}
 			ret.insert(i.first);
 		}
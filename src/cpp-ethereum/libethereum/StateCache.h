@@ -0,0 +1,243 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file StateCache.h
+ * @date 2018
+ */
+
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include "Account.h"
+
+namespace dev
+{
+namespace eth
+{
+
+/**
+ * @brief Clean accounts, code and storage slots of the state trie at one root. Unlike the account
+ * cache of State, it is kept when the changes are committed: the committed accounts and slots are
+ * written through, and the cache then describes the new root. Moving to any other root drops it.
+ * If the cache is full, random accounts are removed with their code and storage.
+ */
+class StateCache
+{
+public:
+	struct Entry
+	{
+		u256 nonce;
+		u256 balance;
+		h256 storageRoot;
+		h256 codeHash;
+		bytes code;
+		std::unordered_map<u256, u256> storage;
+	};
+
+	/// @returns the root the entries are valid for, or a null hash if it is not known.
+	h256 const& root() const { return m_root; }
+
+	/// Moves the cache to @a _root, dropping all the entries if it described another root.
+	void setRoot(h256 const& _root)
+	{
+		if (_root != m_root)
+			clear();
+		m_root = _root;
+	}
+
+	/// Forgets the entries and the root, until the next setRoot.
+	void clear()
+	{
+		m_entries.clear();
+		m_root = h256();
+		m_storageSize = 0;
+		m_codeSize = 0;
+	}
+
+	Entry const* account(Address const& _addr)
+	{
+		auto it = m_entries.find(_addr);
+		if (it == m_entries.end())
+		{
+			++m_misses;
+			return nullptr;
+		}
+		++m_hits;
+		return &it->second;
+	}
+
+	/// Notes an account read from the trie at root().
+	void noteAccount(Address const& _addr, Account const& _account)
+	{
+		if (!m_root || m_entries.count(_addr))
+			return;
+		removeOverLimit(1, 0, 0);
+		Entry& e = m_entries[_addr];
+		e.nonce = _account.nonce();
+		e.balance = _account.balance();
+		e.storageRoot = _account.baseRoot();
+		e.codeHash = _account.codeHash();
+	}
+
+	/// @returns whether the slot @a _key of the storage at @a _storageRoot of the account is known, and its value in @a o_value.
+	bool storage(Address const& _addr, h256 const& _storageRoot, u256 const& _key, u256& o_value) const
+	{
+		auto it = m_entries.find(_addr);
+		if (it == m_entries.end() || it->second.storageRoot != _storageRoot)
+			return false;
+		auto slot = it->second.storage.find(_key);
+		if (slot == it->second.storage.end())
+			return false;
+		o_value = slot->second;
+		return true;
+	}
+
+	void noteStorage(Address const& _addr, h256 const& _storageRoot, u256 const& _key, u256 const& _value)
+	{
+		auto it = m_entries.find(_addr);
+		if (it == m_entries.end() || it->second.storageRoot != _storageRoot)
+			return;
+		if (removeOverLimit(0, 1, 0, _addr) && !m_entries.count(_addr))
+			return;
+		if (it->second.storage.emplace(_key, _value).second)
+			++m_storageSize;
+	}
+
+	bytes const* code(Address const& _addr, h256 const& _codeHash) const
+	{
+		auto it = m_entries.find(_addr);
+		if (it == m_entries.end() || it->second.codeHash != _codeHash || it->second.code.empty())
+			return nullptr;
+		return &it->second.code;
+	}
+
+	void noteCode(Address const& _addr, h256 const& _codeHash, bytes const& _code)
+	{
+		auto it = m_entries.find(_addr);
+		if (it == m_entries.end() || it->second.codeHash != _codeHash || !it->second.code.empty())
+			return;
+		if (removeOverLimit(0, 0, _code.size(), _addr) && !m_entries.count(_addr))
+			return;
+		it->second.code = _code;
+		m_codeSize += _code.size();
+	}
+
+	/// Writes through an account committed with the storage root @a _storageRoot. The storage overlay
+	/// of the account holds the slots read or written since it was loaded, all of them as they are at
+	/// the new storage root.
+	void noteCommitted(Address const& _addr, Account const& _account, h256 const& _storageRoot)
+	{
+		if (!m_root)
+			return;
+		auto it = m_entries.find(_addr);
+		if (it == m_entries.end())
+		{
+			removeOverLimit(1, _account.storageOverlay().size(), 0);
+			it = m_entries.emplace(_addr, Entry()).first;
+			it->second.storageRoot = _account.baseRoot();
+		}
+		Entry& e = it->second;
+		// The slots of another base, as after a suicide and a new creation, are stale
+		if (e.storageRoot != _account.baseRoot())
+		{
+			m_storageSize -= e.storage.size();
+			e.storage.clear();
+		}
+		for (auto const& i: _account.storageOverlay())
+		{
+			auto slot = e.storage.insert(i);
+			if (slot.second)
+				++m_storageSize;
+			else
+				slot.first->second = i.second;
+		}
+		if (e.codeHash != _account.codeHash() || e.code.empty())
+		{
+			m_codeSize -= e.code.size();
+			e.code = _account.code();
+			m_codeSize += e.code.size();
+		}
+		e.nonce = _account.nonce();
+		e.balance = _account.balance();
+		e.storageRoot = _storageRoot;
+		e.codeHash = _account.codeHash();
+		removeOverLimit(0, 0, 0, _addr);
+	}
+
+	/// Drops a committed account which is not in the trie any more.
+	void noteRemoved(Address const& _addr)
+	{
+		auto it = m_entries.find(_addr);
+		if (it != m_entries.end())
+			erase(it);
+	}
+
+	/// Notes that the committed changes took the state to @a _root.
+	void committed(h256 const& _root)
+	{
+		if (m_root)
+			m_root = _root;
+	}
+
+	size_t size() const { return m_entries.size(); }
+	size_t storageSize() const { return m_storageSize; }
+	uint64_t hits() const { return m_hits; }
+	uint64_t misses() const { return m_misses; }
+
+	static const size_t c_maxAccounts = 10000;
+	static const size_t c_maxStorage = 250000;
+	static const size_t c_maxCodeSize = 32 * 1024 * 1024;
+
+private:
+	/// Removes random accounts until @a _accounts accounts, @a _slots slots and @a _code bytes of code fit
+	/// in the limits. @a _keep is only removed if it is the last account.
+	/// @returns whether anything was removed.
+	bool removeOverLimit(size_t _accounts, size_t _slots, size_t _code, Address const& _keep = Address())
+	{
+		bool removed = false;
+		while (!m_entries.empty() && (m_entries.size() + _accounts > c_maxAccounts || m_storageSize + _slots > c_maxStorage || m_codeSize + _code > c_maxCodeSize))
+		{
+			auto it = m_entries.lower_bound(Address::random());
+			if (it == m_entries.end())
+				it = m_entries.begin();
+			if (it->first == _keep && m_entries.size() > 1)
+				continue;
+			erase(it);
+			removed = true;
+		}
+		return removed;
+	}
+
+	void erase(std::map<Address, Entry>::iterator _it)
+	{
+		m_storageSize -= _it->second.storage.size();
+		m_codeSize -= _it->second.code.size();
+		m_entries.erase(_it);
+	}
+
+	h256 m_root;
+	std::map<Address, Entry> m_entries;
+	size_t m_storageSize = 0;
+	size_t m_codeSize = 0;
+	uint64_t m_hits = 0;
+	uint64_t m_misses = 0;
+};
+
+}
+}
@@ -0,0 +1,135 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file CodeAnalysisCache.h
+ * @date 2018
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+#include "Word256.h"
+
+namespace dev
+{
+namespace eth
+{
+
+/**
+ * @brief Code of a contract as prepared by VM::optimize: padded with zero bytes, with synthetic
+ * instructions made invalid and constant pushes and jumps rewritten, together with its jump
+ * destinations and constant pool. It only depends on the code, so it is built once and shared by
+ * all the frames running the same code.
+ */
+struct CodeAnalysis
+{
+	bytes code;
+	std::vector<uint64_t> jumpDests;
+	std::vector<uint64_t> beginSubs;
+	Word256 pool[256] = {};
+
+	size_t memoryUsage() const
+	{
+		return sizeof(CodeAnalysis) + code.capacity() + (jumpDests.capacity() + beginSubs.capacity()) * sizeof(uint64_t);
+	}
+};
+
+/**
+ * @brief Thread-safe cache from code hash to analyzed code, shared by the VMs of the process.
+ * If the cache is over its size limit, the least recently used entries are removed.
+ */
+class CodeAnalysisCache
+{
+public:
+	static const size_t c_defaultMaxSize = 64 * 1024 * 1024;
+
+	std::shared_ptr<CodeAnalysis const> find(h256 const& _hash)
+	{
+		UniqueGuard g(x_cache);
+		auto it = m_cache.find(_hash);
+		if (it == m_cache.end())
+		{
+			++m_misses;
+			return nullptr;
+		}
+		++m_hits;
+		m_lru.splice(m_lru.begin(), m_lru, it->second.second);
+		return it->second.first;
+	}
+
+	void store(h256 const& _hash, std::shared_ptr<CodeAnalysis const> const& _analysis)
+	{
+		UniqueGuard g(x_cache);
+		// Frames on other threads may have analyzed the same code meanwhile
+		if (m_cache.count(_hash))
+			return;
+		m_lru.push_front(_hash);
+		m_cache.emplace(_hash, std::make_pair(_analysis, m_lru.begin()));
+		m_size += _analysis->memoryUsage();
+		removeOverLimit();
+	}
+
+	void setMaxSize(size_t _maxSize)
+	{
+		UniqueGuard g(x_cache);
+		m_maxSize = _maxSize;
+		removeOverLimit();
+	}
+
+	void clear()
+	{
+		UniqueGuard g(x_cache);
+		m_cache.clear();
+		m_lru.clear();
+		m_size = 0;
+	}
+
+	size_t size() const { UniqueGuard g(x_cache); return m_size; }
+	uint64_t hits() const { UniqueGuard g(x_cache); return m_hits; }
+	uint64_t misses() const { UniqueGuard g(x_cache); return m_misses; }
+
+	static CodeAnalysisCache& instance() { static CodeAnalysisCache cache; return cache; }
+
+private:
+	/// Removes the least recently used entries until the cache fits in its limit.
+	/// The frames still running their code keep them alive.
+	void removeOverLimit()
+	{
+		while (m_size > m_maxSize && !m_lru.empty())
+		{
+			auto it = m_cache.find(m_lru.back());
+			m_size -= it->second.first->memoryUsage();
+			m_cache.erase(it);
+			m_lru.pop_back();
+		}
+	}
+
+	mutable Mutex x_cache;
+	std::unordered_map<h256, std::pair<std::shared_ptr<CodeAnalysis const>, std::list<h256>::iterator>> m_cache;
+	std::list<h256> m_lru;
+	size_t m_size = 0;
+	size_t m_maxSize = c_defaultMaxSize;
+	uint64_t m_hits = 0;
+	uint64_t m_misses = 0;
+};
+
+}
+}
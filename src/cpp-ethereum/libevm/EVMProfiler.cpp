@@ -0,0 +1,155 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file EVMProfiler.cpp
+ * @date 2018
+ */
+
+#include "EVMProfiler.h"
+#include <chrono>
+#include <libdevcore/Guards.h>
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+std::atomic<bool> EVMProfiler::s_enabled{false};
+std::atomic<unsigned> EVMProfiler::s_samplePeriod{EVMProfiler::c_defaultSamplePeriod};
+
+namespace
+{
+
+int64_t nowNanos()
+{
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Mutex x_profile;
+EVMProfile s_profile;
+
+}
+
+struct EVMProfiler::ThreadProfile
+{
+	std::array<OpcodeProfile, 256> opcodes;
+	std::unordered_map<Address, ContractProfile> contracts;
+	uint64_t frames = 0;
+	Frame* current = nullptr;
+	unsigned countdown = 1;
+
+	/// Adds the counters of the thread to the process profile and clears them.
+	void merge()
+	{
+		Guard l(x_profile);
+		for (size_t i = 0; i < opcodes.size(); ++i)
+		{
+			OpcodeProfile& from = opcodes[i];
+			if (!from.count)
+				continue;
+			OpcodeProfile& to = s_profile.opcodes[i];
+			to.count += from.count;
+			to.gas += from.gas;
+			to.samples += from.samples;
+			to.sampledNanos += from.sampledNanos;
+			from = OpcodeProfile();
+		}
+		for (auto const& i: contracts)
+		{
+			ContractProfile& to = s_profile.contracts[i.first];
+			to.frames += i.second.frames;
+			to.steps += i.second.steps;
+			to.gas += i.second.gas;
+			to.nanos += i.second.nanos;
+			to.sloads += i.second.sloads;
+			to.sstores += i.second.sstores;
+		}
+		contracts.clear();
+		s_profile.frames += frames;
+		frames = 0;
+	}
+};
+
+namespace
+{
+
+thread_local EVMProfiler::ThreadProfile t_profile;
+
+}
+
+void EVMProfiler::setEnabled(bool _enabled, unsigned _samplePeriod)
+{
+	s_samplePeriod = max(_samplePeriod, 1u);
+	s_enabled = _enabled;
+}
+
+void EVMProfiler::reset()
+{
+	Guard l(x_profile);
+	s_profile = EVMProfile();
+}
+
+EVMProfile EVMProfiler::snapshot()
+{
+	Guard l(x_profile);
+	return s_profile;
+}
+
+EVMProfiler::Frame::Frame(Address const& _address):
+	m_thread(t_profile),
+	m_parent(m_thread.current),
+	m_opcodes(m_thread.opcodes.data()),
+	m_countdown(&m_thread.countdown),
+	m_address(_address),
+	m_begin(nowNanos())
+{
+	// A sample running over the call would measure the callee
+	if (m_parent)
+		m_parent->m_sampled = nullptr;
+	m_thread.current = this;
+}
+
+EVMProfiler::Frame::~Frame()
+{
+	int64_t elapsed = nowNanos() - m_begin;
+	ContractProfile& contract = m_thread.contracts[m_address];
+	++contract.frames;
+	contract.steps += m_steps;
+	contract.gas += m_gas;
+	contract.nanos += max<int64_t>(elapsed - m_childNanos, 0);
+	contract.sloads += m_sloads;
+	contract.sstores += m_sstores;
+	++m_thread.frames;
+
+	m_thread.current = m_parent;
+	if (m_parent)
+		m_parent->m_childNanos += elapsed;
+	else
+		m_thread.merge();
+}
+
+void EVMProfiler::Frame::beginSample(OpcodeProfile& _op)
+{
+	*m_countdown = samplePeriod();
+	m_sampled = &_op;
+	m_sampleBegin = nowNanos();
+}
+
+void EVMProfiler::Frame::endSample()
+{
+	// The instruction ran from its metering up to the metering of the next one
+	m_sampled->sampledNanos += nowNanos() - m_sampleBegin;
+	++m_sampled->samples;
+	m_sampled = nullptr;
+}
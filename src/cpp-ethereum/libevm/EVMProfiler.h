@@ -0,0 +1,136 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file EVMProfiler.h
+ * @date 2018
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <unordered_map>
+#include <libdevcore/Common.h>
+#include <libdevcrypto/Common.h>
+#include <libevmcore/Instruction.h>
+
+namespace dev
+{
+namespace eth
+{
+
+struct OpcodeProfile
+{
+	uint64_t count = 0;
+	uint64_t gas = 0;               ///< gas charged by the instruction itself, for calls the gas given to the callee
+	uint64_t samples = 0;           ///< number of executions whose wall time was measured
+	uint64_t sampledNanos = 0;      ///< wall time of those executions
+
+	/// Wall time of all the executions, extrapolated from the samples.
+	uint64_t estimatedNanos() const { return samples ? uint64_t((long double)sampledNanos * count / samples) : 0; }
+};
+
+struct ContractProfile
+{
+	uint64_t frames = 0;
+	uint64_t steps = 0;
+	uint64_t gas = 0;
+	uint64_t nanos = 0;             ///< wall time of its frames, without the frames they called
+	uint64_t sloads = 0;
+	uint64_t sstores = 0;
+};
+
+struct EVMProfile
+{
+	std::array<OpcodeProfile, 256> opcodes;
+	std::unordered_map<Address, ContractProfile> contracts;
+	uint64_t frames = 0;
+};
+
+/**
+ * @brief Counting and sampling profiler of the interpreter, switched on and off at runtime.
+ * Instruction counts and gas are exact, the wall time of an instruction is measured once every
+ * sample period instructions. The counters accumulate per thread and are merged into the process
+ * profile when the outermost frame of the thread returns, so an enabled profiler takes one lock
+ * per transaction and an idle one costs a test per frame.
+ */
+class EVMProfiler
+{
+public:
+	static const unsigned c_defaultSamplePeriod = 64;
+
+	static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+	static unsigned samplePeriod() { return s_samplePeriod.load(std::memory_order_relaxed); }
+	static void setEnabled(bool _enabled, unsigned _samplePeriod = c_defaultSamplePeriod);
+
+	/// Clears the process profile. Frames running meanwhile are still merged when they return.
+	static void reset();
+	static EVMProfile snapshot();
+
+	struct ThreadProfile;
+
+	/// Profile of one frame, alive for the duration of VM::exec.
+	class Frame
+	{
+	public:
+		explicit Frame(Address const& _address);
+		~Frame();
+		Frame(Frame const&) = delete;
+		Frame& operator=(Frame const&) = delete;
+
+		void onOperation(Instruction _op, uint64_t _gas)
+		{
+			OpcodeProfile& op = m_opcodes[(byte)_op];
+			++op.count;
+			op.gas += _gas;
+			++m_steps;
+			m_gas += _gas;
+			if (_op == Instruction::SLOAD)
+				++m_sloads;
+			else if (_op == Instruction::SSTORE)
+				++m_sstores;
+			if (m_sampled)
+				endSample();
+			if (--*m_countdown == 0)
+				beginSample(op);
+		}
+
+	private:
+		void beginSample(OpcodeProfile& _op);
+		void endSample();
+
+		ThreadProfile& m_thread;
+		Frame* m_parent;
+		OpcodeProfile* m_opcodes;
+		unsigned* m_countdown;
+		Address m_address;
+		int64_t m_begin;
+		int64_t m_childNanos = 0;
+		OpcodeProfile* m_sampled = nullptr;
+		int64_t m_sampleBegin = 0;
+		uint64_t m_steps = 0;
+		uint64_t m_gas = 0;
+		uint64_t m_sloads = 0;
+		uint64_t m_sstores = 0;
+	};
+
+private:
+	static std::atomic<bool> s_enabled;
+	static std::atomic<unsigned> s_samplePeriod;
+};
+
+}
+}
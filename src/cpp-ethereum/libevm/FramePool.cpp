@@ -0,0 +1,99 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file FramePool.cpp
+ * @date 2018
+ */
+
+#include "FramePool.h"
+#include <new>
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+namespace
+{
+
+struct ThreadPool
+{
+	// all the frames are VMs, so the pooled blocks have a single size
+	size_t frameSize = 0;
+	vector<void*> frames;
+	vector<bytes> buffers;
+
+	~ThreadPool()
+	{
+		for (void* frame: frames)
+			::operator delete(frame);
+	}
+};
+
+thread_local ThreadPool t_pool;
+
+}
+
+void* FramePool::allocateFrame(size_t _size)
+{
+	ThreadPool& pool = t_pool;
+	if (_size == pool.frameSize && !pool.frames.empty())
+	{
+		void* frame = pool.frames.back();
+		pool.frames.pop_back();
+		return frame;
+	}
+	return ::operator new(_size);
+}
+
+void FramePool::releaseFrame(void* _frame, size_t _size)
+{
+	ThreadPool& pool = t_pool;
+	if (pool.frames.empty())
+		pool.frameSize = _size;
+	if (_size == pool.frameSize && pool.frames.size() < c_maxFrames)
+		pool.frames.push_back(_frame);
+	else
+		::operator delete(_frame);
+}
+
+void FramePool::acquireBuffer(bytes& o_buffer)
+{
+	ThreadPool& pool = t_pool;
+	if (pool.buffers.empty())
+		return;
+	o_buffer.swap(pool.buffers.back());
+	pool.buffers.pop_back();
+}
+
+void FramePool::releaseBuffer(bytes& io_buffer)
+{
+	ThreadPool& pool = t_pool;
+	if (io_buffer.capacity() && io_buffer.capacity() <= c_maxBufferCapacity && pool.buffers.size() < c_maxFrames)
+	{
+		io_buffer.clear();
+		pool.buffers.push_back(std::move(io_buffer));
+	}
+	io_buffer = bytes();
+}
+
+size_t FramePool::pooledFrames()
+{
+	return t_pool.frames.size();
+}
+
+size_t FramePool::pooledBuffers()
+{
+	return t_pool.buffers.size();
+}
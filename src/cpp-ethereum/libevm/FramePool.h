@@ -0,0 +1,60 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file FramePool.h
+ * @date 2018
+ */
+
+#pragma once
+
+#include <libdevcore/Common.h>
+
+namespace dev
+{
+namespace eth
+{
+
+/**
+ * @brief Per-thread pools of the interpreter frames and of their memory buffers.
+ * A call chain takes its frames from the pool of the thread running the transaction and gives
+ * them back when they return, so nested calls and the next transactions of the block reuse the
+ * blocks and the buffer capacity of the previous ones instead of allocating them again. Buffers
+ * come back empty: the memory of a frame is zeroed as it grows, never up front.
+ */
+class FramePool
+{
+public:
+	/// Frames and buffers kept per thread, deeper call chains allocate the frames beyond.
+	static const size_t c_maxFrames = 64;
+	/// Buffers above this capacity are freed rather than kept.
+	static const size_t c_maxBufferCapacity = 1024 * 1024;
+
+	/// Block of @a _size bytes for a frame, from the pool if it has one of that size.
+	static void* allocateFrame(size_t _size);
+	static void releaseFrame(void* _frame, size_t _size);
+
+	/// Moves a pooled buffer, cleared but with its capacity, into the empty @a o_buffer.
+	static void acquireBuffer(bytes& o_buffer);
+	/// Gives back the capacity of @a io_buffer, which is left empty.
+	static void releaseBuffer(bytes& io_buffer);
+
+	/// Number of frames and buffers pooled by the calling thread.
+	static size_t pooledFrames();
+	static size_t pooledBuffers();
+};
+
+}
+}
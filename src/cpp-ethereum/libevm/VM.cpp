@@ -27,9 +27,14 @@ using namespace dev;
 using namespace dev::eth;
 
 
-uint64_t VM::memNeed(u256 _offset, u256 _size)
+uint64_t VM::memNeed(Word256 const& _offset, Word256 const& _size)
 {
-	return toInt63(_size ? u512(_offset) + _size : u512(0));
+	if (!_size)
+		return 0;
+	// both below 2^64, so that their sum does not overflow the 63 bits checked by toInt63
+	if (!_offset.fitsUint64() || !_size.fitsUint64() || (_offset.limb(0) | _size.limb(0)) >> 63)
+		throwOutOfGas();
+	return toInt63(_offset.limb(0) + _size.limb(0));
 }
 
 template <class S> S divWorkaround(S const& _a, S const& _b)
@@ -57,7 +62,7 @@ uint64_t VM::decodeJumpDest(const byte* const _code, uint64_t& _pc)
 	return dest;
 }
 
-uint64_t VM::decodeJumpvDest(const byte* const _code, uint64_t& _pc, u256*& _sp)
+uint64_t VM::decodeJumpvDest(const byte* const _code, uint64_t& _pc, Word256*& _sp)
 {
 	// Layout of jump table in bytecode...
 	//     byte opcode
@@ -82,10 +87,23 @@ uint64_t VM::decodeJumpvDest(const byte* const _code, uint64_t& _pc, u256*& _sp)
 //
 void VM::onOperation()
 {
-	if (m_onOp)
-		(m_onOp)(++m_nSteps, m_PC, m_OP,
-			m_newMemSize > m_mem.size() ? (m_newMemSize - m_mem.size()) / 32 : uint64_t(0),
-			m_runGas, m_io_gas, this, m_ext);
+	if (m_profile)
+		m_profile->onOperation(m_OP, m_runGas);
+	if (!m_onOp)
+		return;
+#if EVM_FUSE_INSTRUCTIONS
+	// superinstructions are traced as the instruction they replace
+	static Instruction const c_replaced[] = {
+		Instruction::SWAP1, Instruction::PUSH1, Instruction::PUSH1, Instruction::PUSHC, Instruction::PUSHC
+	};
+	Instruction op = Instruction::SWAP1POP <= m_OP && m_OP <= Instruction::PUSHCJUMPCI ?
+		c_replaced[(byte)m_OP - (byte)Instruction::SWAP1POP] : m_OP;
+#else
+	Instruction op = m_OP;
+#endif
+	(m_onOp)(++m_nSteps, m_PC, op,
+		m_newMemSize > m_mem.size() ? (m_newMemSize - m_mem.size()) / 32 : uint64_t(0),
+		m_runGas, m_io_gas, this, m_ext);
 }
 
 void VM::checkStack(unsigned _removed, unsigned _added)
@@ -129,7 +147,7 @@ void VM::updateMem()
 void VM::logGasMem()
 {
 	unsigned n = (unsigned)m_OP - (unsigned)Instruction::LOG0;
-	m_runGas = toInt63(m_schedule->logGas + m_schedule->logTopicGas * n + u512(m_schedule->logDataGas) * *(m_SP - 1));
+	m_runGas = toInt63(m_schedule->logGas + m_schedule->logTopicGas * n + u512(m_schedule->logDataGas) * u256(*(m_SP - 1)));
 	m_newMemSize = memNeed(*m_SP, *(m_SP - 1));
 	updateMem();
 }
@@ -156,6 +174,11 @@ void VM::fetchInstruction()
 	#define checkStack(r,a)
 #endif
 
+VM::~VM()
+{
+	FramePool::releaseBuffer(m_mem);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // interpreter entry point
@@ -168,6 +191,12 @@ owning_bytes_ref VM::exec(u256& _io_gas, ExtVMFace& _ext, OnOpFunc const& _onOp)
 	m_schedule = &m_ext->evmSchedule();
 	m_onOp = _onOp;
 	m_onFail = &VM::onOperation;
+	FramePool::acquireBuffer(m_mem);
+
+	std::unique_ptr<EVMProfiler::Frame> profile;
+	if (EVMProfiler::enabled())
+		profile.reset(new EVMProfiler::Frame(_ext.myAddress));
+	m_profile = profile.get();
 	
 	try
 	{
@@ -228,7 +257,9 @@ void VM::interpretCases()
 
 			size_t b = (size_t)*m_SP--;
 			size_t s = (size_t)*m_SP--;
-			m_output = owning_bytes_ref{std::move(m_mem), b, s};
+			// copy the output, so that the memory buffer goes back to the pool with the frame
+			if (s)
+				m_output = owning_bytes_ref{bytes(m_mem.begin() + b, m_mem.begin() + b + s), 0, s};
 			m_bounce = 0;
 		}
 		BREAK
@@ -272,7 +303,7 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			*m_SP = (u256)*(h256 const*)(m_mem.data() + (unsigned)*m_SP);
+			*m_SP = Word256::fromBigEndian(m_mem.data() + (unsigned)*m_SP);
 		}
 		NEXT
 
@@ -283,7 +314,7 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			*(h256*)&m_mem[(unsigned)*m_SP] = (h256)*(m_SP - 1);
+			(m_SP - 1)->toBigEndian(&m_mem[(unsigned)*m_SP]);
 			m_SP -= 2;
 		}
 		NEXT
@@ -295,14 +326,17 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_mem[(unsigned)*m_SP] = (byte)(*(m_SP - 1) & 0xff);
+			m_mem[(unsigned)*m_SP] = (byte)(m_SP - 1)->limb(0);
 			m_SP -= 2;
 		}
 		NEXT
 
 		CASE(SHA3)
 		{
-			m_runGas = toInt63(m_schedule->sha3Gas + (u512(*(m_SP - 1)) + 31) / 32 * m_schedule->sha3WordGas);
+			if ((m_SP - 1)->fitsUint64() && (m_SP - 1)->limb(0) <= 0x7FFFFFFFFFFFFFFF)
+				m_runGas = toInt63(m_schedule->sha3Gas + u256(((m_SP - 1)->limb(0) + 31) / 32) * m_schedule->sha3WordGas);
+			else
+				m_runGas = toInt63(m_schedule->sha3Gas + (u512(u256(*(m_SP - 1))) + 31) / 32 * m_schedule->sha3WordGas);
 			m_newMemSize = memNeed(*m_SP, *(m_SP - 1));
 			updateMem();
 			ON_OP();
@@ -310,7 +344,7 @@ void VM::interpretCases()
 
 			uint64_t inOff = (uint64_t)*m_SP--;
 			uint64_t inSize = (uint64_t)*m_SP--;
-			*++m_SP = (u256)sha3(bytesConstRef(m_mem.data() + inOff, inSize));
+			*++m_SP = Word256::fromBigEndian(sha3(bytesConstRef(m_mem.data() + inOff, inSize)).data());
 		}
 		NEXT
 
@@ -331,7 +365,7 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_ext->log({*(m_SP - 2)}, bytesConstRef(m_mem.data() + (uint64_t)*m_SP, (uint64_t)*(m_SP - 1)));
+			m_ext->log({(m_SP - 2)->hash()}, bytesConstRef(m_mem.data() + (uint64_t)*m_SP, (uint64_t)*(m_SP - 1)));
 			m_SP -= 3;
 		}
 		NEXT
@@ -342,7 +376,7 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_ext->log({*(m_SP - 2), *(m_SP-3)}, bytesConstRef(m_mem.data() + (uint64_t)*m_SP, (uint64_t)*(m_SP - 1)));
+			m_ext->log({(m_SP - 2)->hash(), (m_SP - 3)->hash()}, bytesConstRef(m_mem.data() + (uint64_t)*m_SP, (uint64_t)*(m_SP - 1)));
 			m_SP -= 4;
 		}
 		NEXT
@@ -353,7 +387,7 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_ext->log({*(m_SP - 2), *(m_SP-3), *(m_SP-4)}, bytesConstRef(m_mem.data() + (uint64_t)*m_SP, (uint64_t)*(m_SP - 1)));
+			m_ext->log({(m_SP - 2)->hash(), (m_SP - 3)->hash(), (m_SP - 4)->hash()}, bytesConstRef(m_mem.data() + (uint64_t)*m_SP, (uint64_t)*(m_SP - 1)));
 			m_SP -= 5;
 		}
 		NEXT
@@ -364,19 +398,20 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			m_ext->log({*(m_SP - 2), *(m_SP-3), *(m_SP-4), *(m_SP-5)}, bytesConstRef(m_mem.data() + (uint64_t)*m_SP, (uint64_t)*(m_SP - 1)));
+			m_ext->log({(m_SP - 2)->hash(), (m_SP - 3)->hash(), (m_SP - 4)->hash(), (m_SP - 5)->hash()}, bytesConstRef(m_mem.data() + (uint64_t)*m_SP, (uint64_t)*(m_SP - 1)));
 			m_SP -= 6;
 		}
 		NEXT	
 
 		CASE(EXP)
 		{
-			u256 expon = *(m_SP - 1);
-			m_runGas = toInt63(m_schedule->expGas + m_schedule->expByteGas * (32 - (h256(expon).firstBitSet() / 8)));
+			Word256 const expon = *(m_SP - 1);
+			// bytes of the exponent, as 32 - h256(expon).firstBitSet() / 8
+			m_runGas = toInt63(m_schedule->expGas + m_schedule->expByteGas * ((expon.bitLength() + 7) / 8));
 			ON_OP();
 			updateIOGas();
 
-			u256 base = *m_SP--;
+			Word256 const base = *m_SP--;
 			*m_SP = exp256(base, expon);
 		}
 		NEXT
@@ -426,7 +461,7 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			*(m_SP - 1) = *(m_SP - 1) ? divWorkaround(*m_SP, *(m_SP - 1)) : 0;
+			*(m_SP - 1) = *m_SP / *(m_SP - 1);
 			--m_SP;
 		}
 		NEXT
@@ -446,7 +481,7 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			*(m_SP - 1) = *(m_SP - 1) ? modWorkaround(*m_SP, *(m_SP - 1)) : 0;
+			*(m_SP - 1) = *m_SP % *(m_SP - 1);
 			--m_SP;
 		}
 		NEXT
@@ -564,7 +599,7 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			*(m_SP - 1) = *m_SP < 32 ? (*(m_SP - 1) >> (unsigned)(8 * (31 - *m_SP))) & 0xff : 0;
+			*(m_SP - 1) = *m_SP < 32 ? ((*(m_SP - 1) >> unsigned(8 * (31 - m_SP->limb(0)))).limb(0) & 0xff) : 0;
 			--m_SP;
 		}
 		NEXT
@@ -574,7 +609,7 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			*(m_SP - 2) = *(m_SP - 2) ? u256((u512(*m_SP) + u512(*(m_SP - 1))) % *(m_SP - 2)) : 0;
+			*(m_SP - 2) = *(m_SP - 2) ? u256((u512(u256(*m_SP)) + u512(u256(*(m_SP - 1)))) % u256(*(m_SP - 2))) : 0;
 			m_SP -= 2;
 		}
 		NEXT
@@ -584,7 +619,7 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			*(m_SP - 2) = *(m_SP - 2) ? u256((u512(*m_SP) * u512(*(m_SP - 1))) % *(m_SP - 2)) : 0;
+			*(m_SP - 2) = *(m_SP - 2) ? u256((u512(u256(*m_SP)) * u512(u256(*(m_SP - 1)))) % u256(*(m_SP - 2))) : 0;
 			m_SP -= 2;
 		}
 		NEXT
@@ -597,9 +632,9 @@ void VM::interpretCases()
 			if (*m_SP < 31)
 			{
 				unsigned testBit = static_cast<unsigned>(*m_SP) * 8 + 7;
-				u256& number = *(m_SP - 1);
-				u256 mask = ((u256(1) << testBit) - 1);
-				if (boost::multiprecision::bit_test(number, testBit))
+				Word256& number = *(m_SP - 1);
+				Word256 mask = ((Word256(1) << testBit) - 1);
+				if (number.bit(testBit))
 					number |= ~mask;
 				else
 					number &= mask;
@@ -661,16 +696,16 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			if (u512(*m_SP) + 31 < m_ext->data.size())
-				*m_SP = (u256)*(h256 const*)(m_ext->data.data() + (size_t)*m_SP);
+			if (m_SP->fitsUint64() && m_SP->limb(0) < m_ext->data.size() && m_ext->data.size() - m_SP->limb(0) >= 32)
+				*m_SP = Word256::fromBigEndian(m_ext->data.data() + (size_t)*m_SP);
 			else if (*m_SP >= m_ext->data.size())
-				*m_SP = u256(0);
+				*m_SP = 0;
 			else
 			{
 				h256 r;
 				for (uint64_t i = (uint64_t)*m_SP, e = (uint64_t)*m_SP + (uint64_t)32, j = 0; i < e; ++i, ++j)
 					r[j] = i < m_ext->data.size() ? m_ext->data[i] : 0;
-				*m_SP = (u256)r;
+				*m_SP = r;
 			}
 		}
 		NEXT
@@ -767,7 +802,7 @@ void VM::interpretCases()
 			ON_OP();
 			updateIOGas();
 
-			*++m_SP = (u160)m_ext->envInfo().author();
+			*++m_SP = fromAddress(m_ext->envInfo().author());
 		}
 		NEXT
 
@@ -1011,6 +1046,107 @@ void VM::interpretCases()
 		}
 		CONTINUE
 
+#if EVM_FUSE_INSTRUCTIONS
+		//
+		// Superinstructions replace the first instruction of a sequence, and the
+		// instructions are fetched, metered and traced one by one as if dispatched
+		//
+
+		CASE(SWAP1POP)
+		{
+			ON_OP();
+			updateIOGas();
+
+			std::swap(*m_SP, *(m_SP - 1));
+			++m_PC;
+
+			fetchInstruction();
+			ON_OP();
+			updateIOGas();
+
+			--m_SP;
+		}
+		NEXT
+
+		CASE(PUSH1JUMPC)
+		{
+			ON_OP();
+			updateIOGas();
+
+			*++m_SP = m_code[++m_PC];
+			++m_PC;
+
+			fetchInstruction();
+			ON_OP();
+			updateIOGas();
+
+			m_PC = uint64_t(*m_SP);
+			--m_SP;
+		}
+		CONTINUE
+
+		CASE(PUSH1JUMPCI)
+		{
+			ON_OP();
+			updateIOGas();
+
+			*++m_SP = m_code[++m_PC];
+			++m_PC;
+
+			fetchInstruction();
+			ON_OP();
+			updateIOGas();
+
+			if (*(m_SP - 1))
+				m_PC = uint64_t(*m_SP);
+			else
+				++m_PC;
+			m_SP -= 2;
+		}
+		CONTINUE
+
+		CASE(PUSHCJUMPC)
+		{
+			ON_OP();
+			updateIOGas();
+
+			++m_PC;
+			*++m_SP = m_pool[m_code[m_PC]];
+			++m_PC;
+			m_PC += m_code[m_PC];
+
+			fetchInstruction();
+			ON_OP();
+			updateIOGas();
+
+			m_PC = uint64_t(*m_SP);
+			--m_SP;
+		}
+		CONTINUE
+
+		CASE(PUSHCJUMPCI)
+		{
+			ON_OP();
+			updateIOGas();
+
+			++m_PC;
+			*++m_SP = m_pool[m_code[m_PC]];
+			++m_PC;
+			m_PC += m_code[m_PC];
+
+			fetchInstruction();
+			ON_OP();
+			updateIOGas();
+
+			if (*(m_SP - 1))
+				m_PC = uint64_t(*m_SP);
+			else
+				++m_PC;
+			m_SP -= 2;
+		}
+		CONTINUE
+#endif
+
 		CASE(DUP1)
 		CASE(DUP2)
 		CASE(DUP3)
@@ -1063,7 +1199,7 @@ void VM::interpretCases()
 			updateIOGas();
 
 			unsigned n = (unsigned)m_OP - (unsigned)Instruction::SWAP1 + 2;
-			u256 d = *m_SP;
+			Word256 d = *m_SP;
 			*m_SP = m_stack[(1 + m_SP - m_stack) - n];
 			m_stack[(1 + m_SP - m_stack) - n] = d;
 		}
@@ -28,6 +28,10 @@
 #include <libdevcore/SHA3.h>
 #include <libethcore/BlockHeader.h>
 #include "VMFace.h"
+#include "CodeAnalysisCache.h"
+#include "EVMProfiler.h"
+#include "FramePool.h"
+#include "Word256.h"
 
 namespace dev
 {
@@ -41,6 +45,11 @@ inline Address asAddress(u256 _item)
 	return right160(h256(_item));
 }
 
+inline Address asAddress(Word256 const& _item)
+{
+	return right160(_item.hash());
+}
+
 inline u256 fromAddress(Address _a)
 {
 	return (u160)_a;
@@ -60,16 +69,33 @@ struct InstructionMetric
 class VM: public VMFace
 {
 public:
+	~VM();
+
 	virtual owning_bytes_ref exec(u256& io_gas, ExtVMFace& _ext, OnOpFunc const& _onOp) override final;
 
+	// frames of nested calls and of the next transactions reuse the blocks of the returned ones
+	static void* operator new(size_t _size) { return FramePool::allocateFrame(_size); }
+	static void operator delete(void* _frame, size_t _size) { FramePool::releaseFrame(_frame, _size); }
+
 #if EVM_JUMPS_AND_SUBS
 	// invalid code will throw an exeption
 	void validate(ExtVMFace& _ext);
-	void validateSubroutine(uint64_t _PC, uint64_t* _RP, u256* _SP);
+	void validateSubroutine(uint64_t _PC, uint64_t* _RP, Word256* _SP);
 #endif
 
 	bytes const& memory() const { return m_mem; }
-	u256s stack() const { assert(m_stack <= m_SP + 1); return u256s(m_stack, m_SP + 1); };
+	u256s stack() const
+	{
+		assert(m_stack <= m_SP + 1);
+		u256s ret;
+		for (Word256 const* item = m_stack; item <= m_SP; ++item)
+			ret.push_back(*item);
+		return ret;
+	}
+
+	// analyze code for the frames running it, with superinstructions if _fuse is set and
+	// the interpreter is built with them
+	static std::shared_ptr<CodeAnalysis const> analyze(bytes const& _code, bool _fuse = true);
 
 private:
 
@@ -77,11 +103,11 @@ private:
 	uint64_t m_io_gas = 0;
 	ExtVMFace* m_ext = 0;
 	OnOpFunc m_onOp;
+	EVMProfiler::Frame* m_profile = nullptr;
 
 	static std::array<InstructionMetric, 256> c_metrics;
 	static void initMetrics();
-	static u256 exp256(u256 _base, u256 _exponent);
-	void copyCode(int);
+	static Word256 exp256(Word256 const& _base, Word256 const& _exponent);
 	const void* const* c_jumpTable = 0;
 	bool m_caseInit = false;
 	
@@ -97,13 +123,14 @@ private:
 	// space for memory
 	bytes m_mem;
 
-	// space for code and pointer to data
-	bytes m_codeSpace;
-	byte* m_code = nullptr;
+	// analyzed code, shared with the frames running the same code, and pointer to it
+	std::shared_ptr<CodeAnalysis const> m_analysis;
+	byte const* m_code = nullptr;
 
-	// space for stack and pointer to data
-	u256 m_stackSpace[1025];
-	u256* m_stack = m_stackSpace + 1;
+	// space for stack and pointer to data, in fixed-width words that convert to u256 at the
+	// boundaries with ExtVMFace
+	Word256 m_stackSpace[1025];
+	Word256* m_stack = m_stackSpace + 1;
 	ptrdiff_t stackSize() { return m_SP - m_stack; }
 	
 #if EVM_JUMPS_AND_SUBS
@@ -116,12 +143,12 @@ private:
 #endif
 
 	// constant pool
-	u256 m_pool[256];
+	Word256 const* m_pool = nullptr;
 
 	// interpreter state
 	Instruction m_OP;                   // current operator
 	uint64_t    m_PC = 0;               // program counter
-	u256*       m_SP = m_stack - 1;     // stack pointer
+	Word256*    m_SP = m_stack - 1;     // stack pointer
 #if EVM_JUMPS_AND_SUBS
 	uint64_t*   m_RP = m_return - 1;    // return pointer
 #endif
@@ -143,8 +170,8 @@ private:
 	bool caseCallSetup(CallParameters*, bytesRef& o_output);
 	void caseCall();
 
-	void copyDataToMemory(bytesConstRef _data, u256*& m_SP);
-	uint64_t memNeed(u256 _offset, u256 _size);
+	void copyDataToMemory(bytesConstRef _data, Word256*& m_SP);
+	uint64_t memNeed(Word256 const& _offset, Word256 const& _size);
 
 	void throwOutOfGas();
 	void throwBadInstruction();
@@ -153,9 +180,7 @@ private:
 
 	void reportStackUse();
 
-	std::vector<uint64_t> m_beginSubs;
-	std::vector<uint64_t> m_jumpDests;
-	int64_t verifyJumpDest(u256 const& _dest, bool _throw = true);
+	int64_t verifyJumpDest(Word256 const& _dest, bool _throw = true);
 
 	int poolConstant(const u256&);
 
@@ -169,7 +194,7 @@ private:
 	void fetchInstruction();
 	
 	uint64_t decodeJumpDest(const byte* const _code, uint64_t& _pc);
-	uint64_t decodeJumpvDest(const byte* const _code, uint64_t& _pc, u256*& _sp);
+	uint64_t decodeJumpvDest(const byte* const _code, uint64_t& _pc, Word256*& _sp);
 
 	template<class T> uint64_t toInt63(T v)
 	{
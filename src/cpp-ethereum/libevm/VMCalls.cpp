@@ -25,10 +25,10 @@ using namespace dev::eth;
 
 
 
-void VM::copyDataToMemory(bytesConstRef _data, u256*& _sp)
+void VM::copyDataToMemory(bytesConstRef _data, Word256*& _sp)
 {
 	auto offset = static_cast<size_t>(*_sp--);
-	s512 bigIndex = *_sp--;
+	s512 bigIndex = u256(*_sp--);
 	auto index = static_cast<size_t>(bigIndex);
 	auto size = static_cast<size_t>(*_sp--);
 
@@ -74,16 +74,16 @@ void VM::throwBadStack(unsigned _size, unsigned _removed, unsigned _added)
 	}
 }
 
-int64_t VM::verifyJumpDest(u256 const& _dest, bool _throw)
+int64_t VM::verifyJumpDest(Word256 const& _dest, bool _throw)
 {
 	
 	// check for overflow
-	if (_dest <= 0x7FFFFFFFFFFFFFFF) {
+	if (_dest.fitsUint64() && _dest.limb(0) <= 0x7FFFFFFFFFFFFFFF) {
 
 		// check for within bounds and to a jump destination
 		// use binary search of array because hashtable collisions are exploitable
 		uint64_t pc = uint64_t(_dest);
-		if (std::binary_search(m_jumpDests.begin(), m_jumpDests.end(), pc))
+		if (std::binary_search(m_analysis->jumpDests.begin(), m_analysis->jumpDests.end(), pc))
 			return pc;
 	}
 	if (_throw)
@@ -105,7 +105,7 @@ void VM::caseCreate()
 	ON_OP();
 	updateIOGas();
 
-	auto const& endowment = *m_SP--;
+	u256 const endowment = *m_SP--;
 	uint64_t initOff = (uint64_t)*m_SP--;
 	uint64_t initSize = (uint64_t)*m_SP--;
 
@@ -118,7 +118,7 @@ void VM::caseCreate()
 		if (!m_schedule->staticCallDepthLimit())
 			createGas -= createGas / 64;
 		u256 gas = createGas;
-		*++m_SP = (u160)m_ext->create(endowment, gas, bytesConstRef(m_mem.data() + initOff, initSize), m_onOp);
+		*++m_SP = fromAddress(m_ext->create(endowment, gas, bytesConstRef(m_mem.data() + initOff, initSize), m_onOp));
 		*io_gas -= (createGas - gas);
 		m_io_gas = uint64_t(*io_gas);
 	}
@@ -160,10 +160,10 @@ bool VM::caseCallSetup(CallParameters *callParams, bytesRef& o_output)
 		m_runGas += toInt63(m_schedule->callValueTransferGas);
 
 	size_t sizesOffset = m_OP == Instruction::DELEGATECALL ? 3 : 4;
-	u256 inputOffset = m_stack[(1 + m_SP - m_stack) - sizesOffset];
-	u256 inputSize = m_stack[(1 + m_SP - m_stack) - sizesOffset - 1];
-	u256 outputOffset = m_stack[(1 + m_SP - m_stack) - sizesOffset - 2];
-	u256 outputSize = m_stack[(1 + m_SP - m_stack) - sizesOffset - 3];
+	Word256 const& inputOffset = m_stack[(1 + m_SP - m_stack) - sizesOffset];
+	Word256 const& inputSize = m_stack[(1 + m_SP - m_stack) - sizesOffset - 1];
+	Word256 const& outputOffset = m_stack[(1 + m_SP - m_stack) - sizesOffset - 2];
+	Word256 const& outputSize = m_stack[(1 + m_SP - m_stack) - sizesOffset - 3];
 	uint64_t inputMemNeed = memNeed(inputOffset, inputSize);
 	uint64_t outputMemNeed = memNeed(outputOffset, outputSize);
 
@@ -174,12 +174,12 @@ bool VM::caseCallSetup(CallParameters *callParams, bytesRef& o_output)
 	// "Static" costs already applied. Calculate call gas.
 	if (m_schedule->staticCallDepthLimit())
 		// With static call depth limit we just charge the provided gas amount.
-		callParams->gas = *m_SP;
+		callParams->gas = u256(*m_SP);
 	else
 	{
 		// Apply "all but one 64th" rule.
 		u256 maxAllowedCallGas = m_io_gas - m_io_gas / 64;
-		callParams->gas = std::min(*m_SP, maxAllowedCallGas);
+		callParams->gas = std::min(u256(*m_SP), maxAllowedCallGas);
 	}
 
 	m_runGas = toInt63(callParams->gas);
@@ -200,7 +200,7 @@ bool VM::caseCallSetup(CallParameters *callParams, bytesRef& o_output)
 	}
 	else
 	{
-		callParams->apparentValue = callParams->valueTransfer = *m_SP;
+		callParams->apparentValue = callParams->valueTransfer = u256(*m_SP);
 		--m_SP;
 	}
 
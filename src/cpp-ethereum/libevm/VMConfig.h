@@ -26,6 +26,11 @@ namespace eth
 //
 // EVM_SWITCH_DISPATCH    - dispatch via loop and switch
 // EVM_JUMP_DISPATCH      - dispatch via a jump table - available only on GCC
+//                          and Clang, set by configure --enable-evm-jump-dispatch
+//
+// EVM_FUSE_INSTRUCTIONS  - superinstructions for common sequences of instructions,
+//                          with jump table dispatch only, the default switch
+//                          dispatch runs the instructions as they are
 //
 // EVM_USE_CONSTANT_POOL  - 256 constants unpacked and ready to assign to stack
 //
@@ -44,8 +49,10 @@ namespace eth
 	#ifndef __GNUC__
 		#error "address of label extension avaiable only on Gnu"
 	#endif
+	#define EVM_FUSE_INSTRUCTIONS true
 #else
 	#define EVM_SWITCH_DISPATCH
+	#define EVM_FUSE_INSTRUCTIONS false
 #endif
 
 #ifndef EVM_OPTIMIZE
@@ -316,11 +323,11 @@ namespace eth
 			&&LOG4,  \
 			&&INVALID,  \
 			&&INVALID,  \
-			&&INVALID,  \
-			&&INVALID,  \
-			&&INVALID,  \
-			&&INVALID,  \
-			&&INVALID,  \
+			&&SWAP1POP,  \
+			&&PUSH1JUMPC,  \
+			&&PUSH1JUMPCI,  \
+			&&PUSHCJUMPC,  \
+			&&PUSHCJUMPCI,  \
 			&&PUSHC,  \
 			&&JUMPC,  \
 			&&JUMPCI,  \
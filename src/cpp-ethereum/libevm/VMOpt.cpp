@@ -49,46 +49,60 @@ void VM::initMetrics()
 	done = true;
 }
 
-void VM::copyCode(int _extraBytes)
+void VM::optimize()
 {
-	// Copy code so that it can be safely modified and extend code by
-	// _extraBytes zero bytes to allow reading virtual data at the end
-	// of the code without bounds checks.
-	auto extendedSize = m_ext->code.size() + _extraBytes;
-	m_codeSpace.reserve(extendedSize);
-	m_codeSpace = m_ext->code;
-	m_codeSpace.resize(extendedSize);
-	m_code = m_codeSpace.data();
+	// The analysis only depends on the code, frames entering the same code reuse it
+	h256 const& codeHash = m_ext->codeHash;
+	if (codeHash)
+		m_analysis = CodeAnalysisCache::instance().find(codeHash);
+	if (!m_analysis)
+	{
+		m_analysis = analyze(m_ext->code);
+		if (codeHash)
+			CodeAnalysisCache::instance().store(codeHash, m_analysis);
+	}
+	m_code = m_analysis->code.data();
+	m_pool = m_analysis->pool;
 }
 
-void VM::optimize()
+std::shared_ptr<CodeAnalysis const> VM::analyze(bytes const& _code, bool _fuse)
 {
-	copyCode(33);
+	auto analysis = make_shared<CodeAnalysis>();
 
-	size_t const nBytes = m_ext->code.size();
+	// Copy code so that it can be safely modified and extend code by
+	// 33 zero bytes to allow reading virtual data at the end
+	// of the code without bounds checks.
+	analysis->code.reserve(_code.size() + 33);
+	analysis->code = _code;
+	analysis->code.resize(_code.size() + 33);
+	byte* code = analysis->code.data();
+	std::vector<uint64_t>& jumpDests = analysis->jumpDests;
+
+	size_t const nBytes = _code.size();
 
 	// build a table of jump destinations for use in verifyJumpDest
 	
 	TRACE_STR(1, "Build JUMPDEST table")
 	for (size_t pc = 0; pc < nBytes; ++pc)
 	{
-		Instruction op = Instruction(m_code[pc]);
+		Instruction op = Instruction(code[pc]);
 		TRACE_OP(2, pc, op);
 				
 		// make synthetic ops in user code trigger invalid instruction if run
 		if (
 			op == Instruction::PUSHC ||
 			op == Instruction::JUMPC ||
-			op == Instruction::JUMPCI
+			op == Instruction::JUMPCI ||
+			(op >= Instruction::SWAP1POP && op <= Instruction::PUSHCJUMPCI)
 		)
 		{
 			TRACE_OP(1, pc, op);
-			m_code[pc] = (byte)Instruction::BAD;
+			code[pc] = (byte)Instruction::BAD;
 		}
 
 		if (op == Instruction::JUMPDEST)
 		{
-			m_jumpDests.push_back(pc);
+			jumpDests.push_back(pc);
 		}
 		else if (
 			(byte)Instruction::PUSH1 <= (byte)op &&
@@ -109,11 +123,11 @@ void VM::optimize()
 		else if (op == Instruction::JUMPV || op == Instruction::JUMPSUBV)
 		{
 			++pc;
-			pc += 4 * m_code[pc];  // number of 4-byte dests followed by table
+			pc += 4 * code[pc];  // number of 4-byte dests followed by table
 		}
 		else if (op == Instruction::BEGINSUB)
 		{
-			m_beginSubs.push_back(pc);
+			analysis->beginSubs.push_back(pc);
 		}
 		else if (op == Instruction::BEGINDATA)
 		{
@@ -126,7 +140,7 @@ void VM::optimize()
 	
 	#ifdef EVM_USE_CONSTANT_POOL
 	
-		// maintain constant pool as a hash table of up to 256 u256 constants
+		// maintain constant pool as a hash table of up to 256 256-bit constants
 		struct hash256
 		{
 			// FNV chosen as good, fast, and byte-at-a-time
@@ -134,10 +148,10 @@ void VM::optimize()
 			const uint32_t FNV_PRIME2 = 16777619;
 			uint32_t hash = FNV_PRIME1;
 			
-			u256 (&table)[256];
+			Word256 (&table)[256];
 			bool empty[256];
 			
-			hash256(u256 (&table)[256]) : table(table)
+			hash256(Word256 (&table)[256]) : table(table)
 			{
 				for (int i = 0; i < 256; ++i)
 				{
@@ -155,7 +169,7 @@ void VM::optimize()
 			byte getHash() { return ((hash >> 8) ^ hash) & 0xff; }
 		
 			// insert value at byte index in table, false if collision
-			bool insertVal(byte hash, u256& val)
+			bool insertVal(byte hash, Word256 const& val)
 			{
 				if (empty[hash])
 				{
@@ -165,7 +179,7 @@ void VM::optimize()
 				}
 				return table[hash] == val;
 			}
-		} constantPool(m_pool);
+		} constantPool(analysis->pool);
 		#define CONST_POOL_HASH_INIT() constantPool.hashInit()
 		#define CONST_POOL_HASH_BYTE(b) constantPool.hashByte(b)
 		#define CONST_POOL_GET_HASH() constantPool.getHash()
@@ -177,11 +191,19 @@ void VM::optimize()
 		#define CONST_POOL_INSERT_VAL(hash, val) false
 	#endif
 
+	#ifdef EVM_REPLACE_CONST_JUMP
+		// same as verifyJumpDest, with the table built above
+		auto isJumpDest = [&](Word256 const& _dest)
+		{
+			return _dest <= 0x7FFFFFFFFFFFFFFF && std::binary_search(jumpDests.begin(), jumpDests.end(), uint64_t(_dest));
+		};
+	#endif
+
 	TRACE_STR(1, "Do first pass optimizations")
 	for (size_t pc = 0; pc < nBytes; ++pc)
 	{
-		u256 val = 0;
-		Instruction op = Instruction(m_code[pc]);
+		Word256 val = 0;
+		Instruction op = Instruction(code[pc]);
 
 		if ((byte)Instruction::PUSH1 <= (byte)op && (byte)op <= (byte)Instruction::PUSH32)
 		{
@@ -190,10 +212,10 @@ void VM::optimize()
 
 			// decode pushed bytes to integral value
 			CONST_POOL_HASH_INIT();
-			val = m_code[pc+1];
+			val = code[pc+1];
 			for (uint64_t i = pc+2, n = nPush; --n; ++i) {
-				val = (val << 8) | m_code[i];
-				CONST_POOL_HASH_BYTE(m_code[i]);
+				val = (val << 8) | code[i];
+				CONST_POOL_HASH_BYTE(code[i]);
 			}
 
 		#ifdef EVM_USE_CONSTANT_POOL
@@ -205,9 +227,9 @@ void VM::optimize()
 				byte hash = CONST_POOL_GET_HASH();
 				if (CONST_POOL_INSERT_VAL(hash, val))
 				{
-					m_code[pc] = (byte)Instruction::PUSHC;
-					m_code[pc+1] = hash;
-					m_code[pc+2] = nPush - 1;
+					code[pc] = (byte)Instruction::PUSHC;
+					code[pc+1] = hash;
+					code[pc+2] = nPush - 1;
 					TRACE_VAL(1, "constant pooled", val);
 				}
 				TRACE_POST_OPT(1, pc, op);
@@ -220,14 +242,14 @@ void VM::optimize()
 			// outer loop is N = number of bytes in code array
 			// so complexity is N log M, worst case is N log N
 			size_t i = pc + nPush + 1;
-			op = Instruction(m_code[i]);
+			op = Instruction(code[i]);
 			if (op == Instruction::JUMP)
 			{
 				TRACE_STR(1, "Replace const JUMPC")
 				TRACE_PRE_OPT(1, i, op);
 				
-				if (0 <= verifyJumpDest(val, false))
-					m_code[i] = byte(op = Instruction::JUMPC);
+				if (isJumpDest(val))
+					code[i] = byte(op = Instruction::JUMPC);
 				
 				TRACE_POST_OPT(1, i, op);
 			}
@@ -236,19 +258,42 @@ void VM::optimize()
 				TRACE_STR(1, "Replace const JUMPCI")
 				TRACE_PRE_OPT(1, i, op);
 				
-				if (0 <= verifyJumpDest(val, false))
-					m_code[i] = byte(op = Instruction::JUMPCI);
+				if (isJumpDest(val))
+					code[i] = byte(op = Instruction::JUMPCI);
 				
 				TRACE_POST_OPT(1, ii, op);
 			}
 		#endif
 
+		#if EVM_FUSE_INSTRUCTIONS
+			// run a constant jump with the push before it
+			if (_fuse && (op == Instruction::JUMPC || op == Instruction::JUMPCI))
+			{
+				TRACE_PRE_OPT(1, pc, Instruction(code[pc]));
+				if (code[pc] == (byte)Instruction::PUSH1)
+					code[pc] = byte(op == Instruction::JUMPC ? Instruction::PUSH1JUMPC : Instruction::PUSH1JUMPCI);
+				else if (code[pc] == (byte)Instruction::PUSHC)
+					code[pc] = byte(op == Instruction::JUMPC ? Instruction::PUSHCJUMPC : Instruction::PUSHCJUMPCI);
+				TRACE_POST_OPT(1, pc, Instruction(code[pc]));
+			}
+		#endif
+
 			pc += nPush;
 		}
+	#if EVM_FUSE_INSTRUCTIONS
+		else if (_fuse && op == Instruction::SWAP1 && code[pc + 1] == (byte)Instruction::POP)
+		{
+			TRACE_PRE_OPT(1, pc, op);
+			code[pc] = (byte)Instruction::SWAP1POP;
+			TRACE_POST_OPT(1, pc, Instruction::SWAP1POP);
+		}
+	#endif
 		
 	}
 	TRACE_STR(1, "Finished optimizations")
 #endif	
+
+	return analysis;
 }
 
 
@@ -270,16 +315,7 @@ void VM::initEntry()
 // Is faster than boost::multiprecision::powm() because it avoids explicit
 // mod operation.
 // Do not inline it.
-u256 VM::exp256(u256 _base, u256 _exponent)
+Word256 VM::exp256(Word256 const& _base, Word256 const& _exponent)
 {
-	using boost::multiprecision::limb_type;
-	u256 result = 1;
-	while (_exponent)
-	{
-		if (static_cast<limb_type>(_exponent) & 1)	// If exponent is odd.
-			result *= _base;
-		_base *= _base;
-		_exponent >>= 1;
-	}
-	return result;
+	return Word256::exp(_base, _exponent);
 }
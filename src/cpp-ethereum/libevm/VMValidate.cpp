@@ -60,7 +60,7 @@ void VM::validate(ExtVMFace& _ext)
 // - PC is the offset in the code to start validating at
 // - RP is the top PC on return stack that RETURNSUB returns to
 // - SP = FP at the top level, so the stack size is also the frame size
-void VM::validateSubroutine(uint64_t _PC, uint64_t* _RP, u256* _SP)
+void VM::validateSubroutine(uint64_t _PC, uint64_t* _RP, Word256* _SP)
 {
 	// set current interpreter state
 	m_PC = _PC, m_RP = _RP, m_SP = _SP;
@@ -136,7 +136,7 @@ void VM::validateSubroutine(uint64_t _PC, uint64_t* _RP, u256* _SP)
 			for (size_t sub = 0, nSubs = m_code[m_PC+1]; sub < nSubs; ++sub)
 			{
 				// check for enough arguments on stack
-				u256 slot = sub;
+				Word256 slot = sub;
 				_SP = &slot;
 				size_t destPC = decodeJumpvDest(m_code, _PC, _SP);
 				byte nArgs = m_code[destPC+1];
@@ -0,0 +1,396 @@
+/*
+	This file is part of cpp-ethereum.
+
+	cpp-ethereum is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	cpp-ethereum is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with cpp-ethereum.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file Word256.h
+ * @date 2018
+ */
+
+#pragma once
+
+#include <type_traits>
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+
+namespace dev
+{
+namespace eth
+{
+
+#ifdef __SIZEOF_INT128__
+using uint128 = unsigned __int128;
+#endif
+
+/**
+ * @brief Word of the VM stack: 256 bits in four 64-bit limbs, least significant first.
+ * Arithmetic is modulo 2^256 like u256, without its size field and normalization.
+ * It converts to and from u256 implicitly for the code outside the interpreter.
+ */
+class Word256
+{
+public:
+	/// Leaves the limbs uninitialized so that stack space is not cleared; Word256() and Word256{} are zero.
+	Word256() = default;
+	Word256(uint64_t _v): m_limbs{_v, 0, 0, 0} {}
+	Word256(uint64_t _l0, uint64_t _l1, uint64_t _l2, uint64_t _l3): m_limbs{_l0, _l1, _l2, _l3} {}
+	Word256(u256 const& _v)
+	{
+		using limb_type = boost::multiprecision::limb_type;
+		static_assert(64 % (sizeof(limb_type) * 8) == 0, "limbs of u256 do not divide 64 bits");
+		unsigned const perLimb = 64 / (sizeof(limb_type) * 8);
+		auto const& backend = _v.backend();
+		m_limbs[0] = m_limbs[1] = m_limbs[2] = m_limbs[3] = 0;
+		for (unsigned i = 0; i < backend.size(); ++i)
+			m_limbs[i / perLimb] |= uint64_t(backend.limbs()[i]) << (sizeof(limb_type) * 8 * (i % perLimb));
+	}
+
+	operator u256() const
+	{
+		using limb_type = boost::multiprecision::limb_type;
+		unsigned const perLimb = 64 / (sizeof(limb_type) * 8);
+		u256 ret;
+		auto& backend = ret.backend();
+		backend.resize(4 * perLimb, 4 * perLimb);
+		for (unsigned i = 0; i < 4 * perLimb; ++i)
+			backend.limbs()[i] = limb_type(m_limbs[i / perLimb] >> (sizeof(limb_type) * 8 * (i % perLimb)));
+		backend.normalize();
+		return ret;
+	}
+
+	explicit operator bool() const { return (m_limbs[0] | m_limbs[1] | m_limbs[2] | m_limbs[3]) != 0; }
+
+	/// Truncates to the low bits, as the conversions of u256 do
+	template <class T, class = typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+	explicit operator T() const { return T(m_limbs[0]); }
+
+	uint64_t limb(unsigned _i) const { return m_limbs[_i]; }
+	uint64_t& limb(unsigned _i) { return m_limbs[_i]; }
+
+	/// @returns true if the value fits in 64 bits
+	bool fitsUint64() const { return (m_limbs[1] | m_limbs[2] | m_limbs[3]) == 0; }
+
+	/// @returns the number of bits up to the most significant bit set, 0 for zero
+	unsigned bitLength() const
+	{
+		for (int i = 3; i >= 0; --i)
+			if (m_limbs[i])
+				return i * 64 + 64 - countLeadingZeros(m_limbs[i]);
+		return 0;
+	}
+
+	bool bit(unsigned _i) const { return (m_limbs[_i / 64] >> (_i % 64)) & 1; }
+
+	/// Big-endian encoding, as memory and hashes hold words
+	static Word256 fromBigEndian(byte const* _data)
+	{
+		Word256 ret;
+		for (unsigned i = 0; i < 4; ++i)
+			ret.m_limbs[3 - i] = loadBigEndian(_data + i * 8);
+		return ret;
+	}
+	void toBigEndian(byte* o_data) const
+	{
+		for (unsigned i = 0; i < 4; ++i)
+			storeBigEndian(m_limbs[3 - i], o_data + i * 8);
+	}
+	Word256(h256 const& _h): Word256(fromBigEndian(_h.data())) {}
+	h256 hash() const { h256 ret; toBigEndian(ret.data()); return ret; }
+
+	Word256 operator~() const { return Word256(~m_limbs[0], ~m_limbs[1], ~m_limbs[2], ~m_limbs[3]); }
+	Word256& operator&=(Word256 const& _b) { for (unsigned i = 0; i < 4; ++i) m_limbs[i] &= _b.m_limbs[i]; return *this; }
+	Word256& operator|=(Word256 const& _b) { for (unsigned i = 0; i < 4; ++i) m_limbs[i] |= _b.m_limbs[i]; return *this; }
+	Word256& operator^=(Word256 const& _b) { for (unsigned i = 0; i < 4; ++i) m_limbs[i] ^= _b.m_limbs[i]; return *this; }
+
+	Word256& operator+=(Word256 const& _b)
+	{
+#ifdef __SIZEOF_INT128__
+		uint128 sum = 0;
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			sum = uint128(m_limbs[i]) + _b.m_limbs[i] + uint64_t(sum >> 64);
+			m_limbs[i] = uint64_t(sum);
+		}
+#else
+		uint64_t carry = 0;
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			uint64_t s = m_limbs[i] + carry;
+			carry = s < carry;
+			m_limbs[i] = s + _b.m_limbs[i];
+			carry += m_limbs[i] < s;
+		}
+#endif
+		return *this;
+	}
+
+	Word256& operator-=(Word256 const& _b) { subtract(_b); return *this; }
+
+	Word256& operator*=(Word256 const& _b)
+	{
+		// only the partial products of the low 256 bits
+		uint64_t r[4] = {0, 0, 0, 0};
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			uint64_t carry = 0;
+			for (unsigned j = 0; i + j < 4; ++j)
+			{
+				uint64_t hi;
+				uint64_t lo = mul64(m_limbs[i], _b.m_limbs[j], hi);
+				uint64_t t = r[i + j] + lo;
+				hi += t < lo;
+				r[i + j] = t + carry;
+				hi += r[i + j] < t;
+				carry = hi;
+			}
+		}
+		for (unsigned i = 0; i < 4; ++i)
+			m_limbs[i] = r[i];
+		return *this;
+	}
+
+	Word256 operator<<(unsigned _shift) const
+	{
+		if (_shift >= 256)
+			return Word256();
+		Word256 ret{};
+		unsigned const limbs = _shift / 64;
+		unsigned const bits = _shift % 64;
+		for (unsigned i = limbs; i < 4; ++i)
+		{
+			ret.m_limbs[i] = m_limbs[i - limbs] << bits;
+			if (bits && i > limbs)
+				ret.m_limbs[i] |= m_limbs[i - limbs - 1] >> (64 - bits);
+		}
+		return ret;
+	}
+
+	Word256 operator>>(unsigned _shift) const
+	{
+		if (_shift >= 256)
+			return Word256();
+		Word256 ret{};
+		unsigned const limbs = _shift / 64;
+		unsigned const bits = _shift % 64;
+		for (unsigned i = 0; i + limbs < 4; ++i)
+		{
+			ret.m_limbs[i] = m_limbs[i + limbs] >> bits;
+			if (bits && i + limbs + 1 < 4)
+				ret.m_limbs[i] |= m_limbs[i + limbs + 1] << (64 - bits);
+		}
+		return ret;
+	}
+
+	/// @returns true if the subtraction borrowed, that is if this was lower than _b
+	bool subtract(Word256 const& _b)
+	{
+		uint64_t borrow = 0;
+		for (unsigned i = 0; i < 4; ++i)
+		{
+			uint64_t d = m_limbs[i] - _b.m_limbs[i];
+			uint64_t b = m_limbs[i] < _b.m_limbs[i];
+			m_limbs[i] = d - borrow;
+			borrow = b | (d < borrow);
+		}
+		return borrow;
+	}
+
+	/// Unsigned division with remainder, with quotient and remainder 0 if _v is 0 as in DIV and MOD
+	static void divMod(Word256 const& _u, Word256 const& _v, Word256& o_q, Word256& o_r);
+
+	/// _base to the power of _exponent modulo 2^256
+	static Word256 exp(Word256 _base, Word256 const& _exponent)
+	{
+		Word256 result(1);
+		for (unsigned i = 0, n = _exponent.bitLength(); i < n; ++i)
+		{
+			if (_exponent.bit(i))
+				result *= _base;
+			_base *= _base;
+		}
+		return result;
+	}
+
+	friend bool operator==(Word256 const& _a, Word256 const& _b)
+	{
+		return ((_a.m_limbs[0] ^ _b.m_limbs[0]) | (_a.m_limbs[1] ^ _b.m_limbs[1]) |
+			(_a.m_limbs[2] ^ _b.m_limbs[2]) | (_a.m_limbs[3] ^ _b.m_limbs[3])) == 0;
+	}
+	friend bool operator<(Word256 const& _a, Word256 const& _b) { Word256 d = _a; return d.subtract(_b); }
+
+private:
+	static unsigned countLeadingZeros(uint64_t _v)
+	{
+#ifdef __GNUC__
+		return __builtin_clzll(_v);
+#else
+		unsigned n = 0;
+		for (uint64_t bit = uint64_t(1) << 63; !(_v & bit); bit >>= 1)
+			++n;
+		return n;
+#endif
+	}
+
+	static uint64_t mul64(uint64_t _a, uint64_t _b, uint64_t& o_hi)
+	{
+#ifdef __SIZEOF_INT128__
+		uint128 p = uint128(_a) * _b;
+		o_hi = uint64_t(p >> 64);
+		return uint64_t(p);
+#else
+		uint64_t aLo = uint32_t(_a), aHi = _a >> 32, bLo = uint32_t(_b), bHi = _b >> 32;
+		uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+		uint64_t mid = (ll >> 32) + uint32_t(lh) + uint32_t(hl);
+		o_hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+		return (mid << 32) | uint32_t(ll);
+#endif
+	}
+
+	static uint64_t loadBigEndian(byte const* _p)
+	{
+		uint64_t v = 0;
+		for (unsigned i = 0; i < 8; ++i)
+			v = (v << 8) | _p[i];
+		return v;
+	}
+	static void storeBigEndian(uint64_t _v, byte* _p)
+	{
+		for (int i = 7; i >= 0; --i, _v >>= 8)
+			_p[i] = byte(_v);
+	}
+
+	uint64_t m_limbs[4];
+};
+
+static_assert(std::is_trivially_default_constructible<Word256>::value, "Word256 must not initialize its limbs by default");
+
+inline Word256 operator+(Word256 _a, Word256 const& _b) { return _a += _b; }
+inline Word256 operator-(Word256 _a, Word256 const& _b) { return _a -= _b; }
+inline Word256 operator*(Word256 _a, Word256 const& _b) { return _a *= _b; }
+inline Word256 operator&(Word256 _a, Word256 const& _b) { return _a &= _b; }
+inline Word256 operator|(Word256 _a, Word256 const& _b) { return _a |= _b; }
+inline Word256 operator^(Word256 _a, Word256 const& _b) { return _a ^= _b; }
+inline Word256 operator/(Word256 const& _a, Word256 const& _b) { Word256 q, r; Word256::divMod(_a, _b, q, r); return q; }
+inline Word256 operator%(Word256 const& _a, Word256 const& _b) { Word256 q, r; Word256::divMod(_a, _b, q, r); return r; }
+inline bool operator!=(Word256 const& _a, Word256 const& _b) { return !(_a == _b); }
+inline bool operator>(Word256 const& _a, Word256 const& _b) { return _b < _a; }
+inline bool operator<=(Word256 const& _a, Word256 const& _b) { return !(_b < _a); }
+inline bool operator>=(Word256 const& _a, Word256 const& _b) { return !(_a < _b); }
+
+inline void Word256::divMod(Word256 const& _u, Word256 const& _v, Word256& o_q, Word256& o_r)
+{
+	o_q = Word256();
+	o_r = Word256();
+	if (!_v)
+		return;
+	if (_u < _v)
+	{
+		o_r = _u;
+		return;
+	}
+#ifdef __SIZEOF_INT128__
+	unsigned n = 4;
+	while (!_v.m_limbs[n - 1])
+		--n;
+	unsigned m = 4;
+	while (!_u.m_limbs[m - 1])
+		--m;
+
+	if (n == 1)
+	{
+		// short division by a single limb
+		uint64_t const d = _v.m_limbs[0];
+		uint64_t r = 0;
+		for (int i = m - 1; i >= 0; --i)
+		{
+			uint128 t = (uint128(r) << 64) | _u.m_limbs[i];
+			o_q.m_limbs[i] = uint64_t(t / d);
+			r = uint64_t(t % d);
+		}
+		o_r.m_limbs[0] = r;
+		return;
+	}
+
+	// Knuth's algorithm D, with the divisor normalized so that its top bit is set
+	unsigned const s = countLeadingZeros(_v.m_limbs[n - 1]);
+	uint64_t vn[4];
+	uint64_t un[5];
+	for (unsigned i = n - 1; i > 0; --i)
+		vn[i] = (_v.m_limbs[i] << s) | (s ? _v.m_limbs[i - 1] >> (64 - s) : 0);
+	vn[0] = _v.m_limbs[0] << s;
+	un[m] = s ? _u.m_limbs[m - 1] >> (64 - s) : 0;
+	for (unsigned i = m - 1; i > 0; --i)
+		un[i] = (_u.m_limbs[i] << s) | (s ? _u.m_limbs[i - 1] >> (64 - s) : 0);
+	un[0] = _u.m_limbs[0] << s;
+
+	for (int j = m - n; j >= 0; --j)
+	{
+		uint128 const top = (uint128(un[j + n]) << 64) | un[j + n - 1];
+		uint128 qhat = top / vn[n - 1];
+		uint128 rhat = top % vn[n - 1];
+		while ((qhat >> 64) || qhat * vn[n - 2] > ((rhat << 64) | un[j + n - 2]))
+		{
+			--qhat;
+			rhat += vn[n - 1];
+			if (rhat >> 64)
+				break;
+		}
+
+		// multiply and subtract
+		uint64_t borrow = 0;
+		uint64_t carry = 0;
+		for (unsigned i = 0; i < n; ++i)
+		{
+			uint128 p = qhat * vn[i] + carry;
+			carry = uint64_t(p >> 64);
+			uint64_t sub = uint64_t(p);
+			uint64_t t = un[i + j] - sub;
+			uint64_t b = un[i + j] < sub;
+			un[i + j] = t - borrow;
+			borrow = b | (t < borrow);
+		}
+		uint64_t t = un[j + n] - carry;
+		uint64_t b = un[j + n] < carry;
+		un[j + n] = t - borrow;
+		borrow = b | (t < borrow);
+
+		if (borrow)
+		{
+			// qhat was one too large, add the divisor back
+			--qhat;
+			uint64_t c = 0;
+			for (unsigned i = 0; i < n; ++i)
+			{
+				uint128 sum = uint128(un[i + j]) + vn[i] + c;
+				un[i + j] = uint64_t(sum);
+				c = uint64_t(sum >> 64);
+			}
+			un[j + n] += c;
+		}
+		o_q.m_limbs[j] = uint64_t(qhat);
+	}
+
+	// unnormalize the remainder
+	for (unsigned i = 0; i < n; ++i)
+		o_r.m_limbs[i] = (un[i] >> s) | (s ? un[i + 1] << (64 - s) : 0);
+#else
+	u256 const u = _u;
+	u256 const v = _v;
+	o_q = u / v;
+	o_r = u % v;
+#endif
+}
+
+}
+}
@@ -72,6 +72,16 @@ struct EVMSchedule
 	unsigned suicideGas = 0;
 	unsigned maxCodeSize = unsigned(-1);
 
+////////////////////////////////////////////////////////////// // silubium
+	/// Prices of the precompiled contracts 0x05-0x09, which depend on the input rather than on its size
+	unsigned modexpQuadDivisor = 20;
+	unsigned bn128AddGas = 300;
+	unsigned bn128MulGas = 7000;
+	unsigned bn128PairingBaseGas = 70000;
+	unsigned bn128PairingPairGas = 52000;
+	unsigned blake2RoundGas = 1;
+//////////////////////////////////////////////////////////////
+
 	bool staticCallDepthLimit() const { return !eip150Mode; }
 	bool suicideChargesNewAccountGas() const { return eip150Mode; }
 	bool emptinessIsNonexistence() const { return eip158Mode; }
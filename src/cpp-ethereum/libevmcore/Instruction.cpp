@@ -319,6 +319,12 @@ static const std::map<Instruction,  InstructionInfo> c_instructionInfo =
 	{ Instruction::SUICIDE,      { "SUICIDE",        0,     1,     0,  true,       Tier::Special } },
  
 	// these are generated by the interpreter - should never be in user code
+	// superinstructions are metered as their first instruction, the interpreter meters the others
+	{ Instruction::SWAP1POP,     { "SWAP1POP",       0,     2,     2,   false,     Tier::VeryLow } },
+	{ Instruction::PUSH1JUMPC,   { "PUSH1JUMPC",     1,     0,     1,   false,     Tier::VeryLow } },
+	{ Instruction::PUSH1JUMPCI,  { "PUSH1JUMPCI",    1,     0,     1,   false,     Tier::VeryLow } },
+	{ Instruction::PUSHCJUMPC,   { "PUSHCJUMPC",     2,     0,     1,   false,     Tier::VeryLow } },
+	{ Instruction::PUSHCJUMPCI,  { "PUSHCJUMPCI",    2,     0,     1,   false,     Tier::VeryLow } },
 	{ Instruction::PUSHC,        { "PUSHC",          2,     0 ,    1,   false,     Tier::VeryLow } },
 	{ Instruction::JUMPC,        { "JUMPC",          0,     1,     0,   true,      Tier::Mid } },
 	{ Instruction::JUMPCI,       { "JUMPCI",         0,     1,     0,   true,      Tier::High } },
@@ -182,7 +182,12 @@ enum class Instruction: uint8_t
 	LOG4,               ///< Makes a log entry; 4 topics.
 	
 	// these are generated by the interpreter - should never be in user code
-	PUSHC = 0xac,       ///< push value from constant pool
+	SWAP1POP = 0xa7,    ///< SWAP1 followed by POP
+	PUSH1JUMPC,         ///< PUSH1 followed by JUMPC
+	PUSH1JUMPCI,        ///< PUSH1 followed by JUMPCI
+	PUSHCJUMPC,         ///< PUSHC followed by JUMPC
+	PUSHCJUMPCI,        ///< PUSHC followed by JUMPCI
+	PUSHC,              ///< push value from constant pool
 	JUMPC,              ///< alter the program counter - pre-verified
 	JUMPCI,             ///< conditionally alter the program counter - pre-verified
 	BAD,                ///< placed to force invalid instruction exception
@@ -10,13 +10,32 @@
 #include <atomic>
 
 #if defined(__x86_64__) || defined(__amd64__)
-#if defined(EXPERIMENTAL_ASM)
+// the libbitcoinconsensus build only has the sources of the crypto library, not the AVX2 one
+#if defined(ENABLE_AVX2) && defined(BUILD_BITCOIN_INTERNAL)
+#undef ENABLE_AVX2
+#endif
+#if defined(EXPERIMENTAL_ASM) || defined(ENABLE_AVX2)
 #include <cpuid.h>
+#endif
+#if defined(EXPERIMENTAL_ASM)
 namespace sha256_sse4
 {
 void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 }
 #endif
+#if defined(ENABLE_AVX2)
+namespace sha256_avx2
+{
+void Transform8(uint32_t* states, const unsigned char* blocks);
+}
+#endif
+#endif
+
+#if defined(__SSE2__)
+namespace sha256_sse2
+{
+void Transform4(uint32_t* states, const unsigned char* blocks);
+}
 #endif
 
 // Internal implementation code.
@@ -174,21 +193,90 @@ bool SelfTest(TransformType tr) {
 
 TransformType Transform = sha256::Transform;
 
+typedef void (*TransformLanesType)(uint32_t*, const unsigned char*);
+
+/** Widest multi-lane transform, with its number of lanes. */
+TransformLanesType TransformLanes = nullptr;
+size_t nTransformLanes = 1;
+
+/** Check the multi-lane transform against the single one, on distinct states and blocks. */
+bool SelfTestLanes()
+{
+    uint32_t states[8 * 8], expected[8 * 8];
+    unsigned char blocks[64 * 8];
+    for (size_t i = 0; i < sizeof(states) / sizeof(states[0]); i++)
+        states[i] = expected[i] = 0x9e3779b9ul * (i + 1);
+    for (size_t i = 0; i < sizeof(blocks); i++)
+        blocks[i] = (unsigned char)(i * 7 + 3);
+
+    TransformLanes(states, blocks);
+    for (size_t l = 0; l < nTransformLanes; l++)
+        Transform(expected + 8 * l, blocks + 64 * l, 1);
+    return memcmp(states, expected, 8 * nTransformLanes * sizeof(uint32_t)) == 0;
+}
+
 } // namespace
 
 std::string SHA256AutoDetect()
 {
+    std::string ret = "standard";
 #if defined(EXPERIMENTAL_ASM) && (defined(__x86_64__) || defined(__amd64__))
     uint32_t eax, ebx, ecx, edx;
     if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx >> 19) & 1) {
         Transform = sha256_sse4::Transform;
-        assert(SelfTest(Transform));
-        return "sse4";
+        ret = "sse4";
     }
 #endif
-
     assert(SelfTest(Transform));
-    return "standard";
+
+#if defined(__SSE2__)
+    TransformLanes = sha256_sse2::Transform4;
+    nTransformLanes = 4;
+    assert(SelfTestLanes());
+    ret += ",sse2(4way)";
+#endif
+#if defined(ENABLE_AVX2) && (defined(__x86_64__) || defined(__amd64__))
+    uint32_t a, b, c, d;
+    uint64_t xcr0 = 0;
+    if (__get_cpuid(1, &a, &b, &c, &d) && (c >> 27) & 1) {
+        // The OS saves the vector registers, see XGETBV
+        uint32_t lo, hi;
+        __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        xcr0 = ((uint64_t)hi << 32) | lo;
+    }
+    if (__get_cpuid_max(0, nullptr) >= 7) {
+        __cpuid_count(7, 0, a, b, c, d);
+        if ((b >> 5) & 1 && (xcr0 & 0x6) == 0x6) {
+            TransformLanes = sha256_avx2::Transform8;
+            nTransformLanes = 8;
+            assert(SelfTestLanes());
+            ret += ",avx2(8way)";
+        }
+    }
+#endif
+    return ret;
+}
+
+void SHA256Initialize(uint32_t state[8])
+{
+    sha256::Initialize(state);
+}
+
+void SHA256TransformBatch(uint32_t* states, const unsigned char* blocks, size_t count)
+{
+    if (TransformLanes) {
+        while (count >= nTransformLanes) {
+            TransformLanes(states, blocks);
+            states += 8 * nTransformLanes;
+            blocks += 64 * nTransformLanes;
+            count -= nTransformLanes;
+        }
+    }
+    while (count--) {
+        Transform(states, blocks, 1);
+        states += 8;
+        blocks += 64;
+    }
 }
 
 ////// SHA-256
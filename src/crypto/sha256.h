@@ -31,4 +31,12 @@ public:
  */
 std::string SHA256AutoDetect();
 
+/** Set state to the initial SHA-256 state. */
+void SHA256Initialize(uint32_t state[8]);
+
+/** Compress independent 64-byte blocks, as many at once as the CPU allows.
+ *  For every i < count, the state states[8*i..8*i+8) is updated with blocks[64*i..64*i+64).
+ */
+void SHA256TransformBatch(uint32_t* states, const unsigned char* blocks, size_t count);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
@@ -0,0 +1,37 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+//
+// SHA-256 on 8 blocks at once, built with AVX2 and only called once the CPU is known to have it.
+
+#include "crypto/sha256_lanes.h"
+
+#include <immintrin.h>
+
+namespace
+{
+struct AVX2Ops
+{
+    typedef __m256i Lane;
+    static const size_t LANES = 8;
+
+    static inline Lane Add(Lane a, Lane b) { return _mm256_add_epi32(a, b); }
+    static inline Lane Xor(Lane a, Lane b) { return _mm256_xor_si256(a, b); }
+    static inline Lane And(Lane a, Lane b) { return _mm256_and_si256(a, b); }
+    static inline Lane Or(Lane a, Lane b) { return _mm256_or_si256(a, b); }
+    static inline Lane AndNot(Lane a, Lane b) { return _mm256_andnot_si256(a, b); }
+    template <int N> static inline Lane Shr(Lane a) { return _mm256_srli_epi32(a, N); }
+    template <int N> static inline Lane Shl(Lane a) { return _mm256_slli_epi32(a, N); }
+    static inline Lane Set(uint32_t x) { return _mm256_set1_epi32(x); }
+    static inline Lane Load(const uint32_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static inline void Store(uint32_t* p, Lane a) { _mm256_storeu_si256((__m256i*)p, a); }
+};
+} // namespace
+
+namespace sha256_avx2
+{
+void Transform8(uint32_t* states, const unsigned char* blocks)
+{
+    sha256_lanes::Transform<AVX2Ops>(states, blocks);
+}
+} // namespace sha256_avx2
@@ -0,0 +1,97 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_CRYPTO_SHA256_LANES_H
+#define BITCOIN_CRYPTO_SHA256_LANES_H
+
+#include "crypto/common.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * SHA-256 compression of independent blocks, one per lane of a vector of 32-bit words.
+ * Ops provides the Lane type, its LANES count and the word-wise operations; the block
+ * words and the states are transposed into lanes on the way in and back on the way out.
+ */
+namespace sha256_lanes
+{
+static const uint32_t K[64] = {
+    0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+    0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+    0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul, 0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+    0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+    0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+    0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+    0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+    0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul, 0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul};
+
+template <typename Ops, int N>
+inline typename Ops::Lane Rotr(typename Ops::Lane x) { return Ops::Or(Ops::template Shr<N>(x), Ops::template Shl<32 - N>(x)); }
+
+template <typename Ops>
+void Transform(uint32_t* states, const unsigned char* blocks)
+{
+    typedef typename Ops::Lane Lane;
+    const size_t LANES = Ops::LANES;
+
+    uint32_t words[16][LANES];
+    for (size_t l = 0; l < LANES; l++) {
+        for (size_t j = 0; j < 16; j++)
+            words[j][l] = ReadBE32(blocks + 64 * l + 4 * j);
+    }
+    Lane w[16];
+    for (size_t j = 0; j < 16; j++)
+        w[j] = Ops::Load(words[j]);
+
+    uint32_t init[8][LANES];
+    for (size_t l = 0; l < LANES; l++) {
+        for (size_t j = 0; j < 8; j++)
+            init[j][l] = states[8 * l + j];
+    }
+    Lane s[8];
+    for (size_t j = 0; j < 8; j++)
+        s[j] = Ops::Load(init[j]);
+
+    Lane a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+    for (int i = 0; i < 64; i++) {
+        if (i >= 16) {
+            Lane w15 = w[(i - 15) & 15], w2 = w[(i - 2) & 15];
+            Lane sigma0 = Ops::Xor(Ops::Xor(Rotr<Ops, 7>(w15), Rotr<Ops, 18>(w15)), Ops::template Shr<3>(w15));
+            Lane sigma1 = Ops::Xor(Ops::Xor(Rotr<Ops, 17>(w2), Rotr<Ops, 19>(w2)), Ops::template Shr<10>(w2));
+            w[i & 15] = Ops::Add(Ops::Add(w[i & 15], sigma0), Ops::Add(w[(i - 7) & 15], sigma1));
+        }
+        Lane sum1 = Ops::Xor(Ops::Xor(Rotr<Ops, 6>(e), Rotr<Ops, 11>(e)), Rotr<Ops, 25>(e));
+        Lane ch = Ops::Xor(Ops::And(e, f), Ops::AndNot(e, g));
+        Lane t1 = Ops::Add(Ops::Add(Ops::Add(h, sum1), Ops::Add(ch, Ops::Set(K[i]))), w[i & 15]);
+        Lane sum0 = Ops::Xor(Ops::Xor(Rotr<Ops, 2>(a), Rotr<Ops, 13>(a)), Rotr<Ops, 22>(a));
+        Lane maj = Ops::Or(Ops::And(a, b), Ops::And(c, Ops::Or(a, b)));
+        h = g;
+        g = f;
+        f = e;
+        e = Ops::Add(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = Ops::Add(t1, Ops::Add(sum0, maj));
+    }
+    s[0] = Ops::Add(s[0], a);
+    s[1] = Ops::Add(s[1], b);
+    s[2] = Ops::Add(s[2], c);
+    s[3] = Ops::Add(s[3], d);
+    s[4] = Ops::Add(s[4], e);
+    s[5] = Ops::Add(s[5], f);
+    s[6] = Ops::Add(s[6], g);
+    s[7] = Ops::Add(s[7], h);
+
+    for (size_t j = 0; j < 8; j++)
+        Ops::Store(init[j], s[j]);
+    for (size_t l = 0; l < LANES; l++) {
+        for (size_t j = 0; j < 8; j++)
+            states[8 * l + j] = init[j][l];
+    }
+}
+} // namespace sha256_lanes
+
+#endif // BITCOIN_CRYPTO_SHA256_LANES_H
@@ -0,0 +1,41 @@
+// Copyright (c) 2018 The Bitcoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+//
+// SHA-256 on 4 blocks at once. SSE2 is part of x86-64, so this needs no runtime check.
+
+#if defined(__SSE2__)
+
+#include "crypto/sha256_lanes.h"
+
+#include <emmintrin.h>
+
+namespace
+{
+struct SSE2Ops
+{
+    typedef __m128i Lane;
+    static const size_t LANES = 4;
+
+    static inline Lane Add(Lane a, Lane b) { return _mm_add_epi32(a, b); }
+    static inline Lane Xor(Lane a, Lane b) { return _mm_xor_si128(a, b); }
+    static inline Lane And(Lane a, Lane b) { return _mm_and_si128(a, b); }
+    static inline Lane Or(Lane a, Lane b) { return _mm_or_si128(a, b); }
+    static inline Lane AndNot(Lane a, Lane b) { return _mm_andnot_si128(a, b); }
+    template <int N> static inline Lane Shr(Lane a) { return _mm_srli_epi32(a, N); }
+    template <int N> static inline Lane Shl(Lane a) { return _mm_slli_epi32(a, N); }
+    static inline Lane Set(uint32_t x) { return _mm_set1_epi32(x); }
+    static inline Lane Load(const uint32_t* p) { return _mm_loadu_si128((const __m128i*)p); }
+    static inline void Store(uint32_t* p, Lane a) { _mm_storeu_si128((__m128i*)p, a); }
+};
+} // namespace
+
+namespace sha256_sse2
+{
+void Transform4(uint32_t* states, const unsigned char* blocks)
+{
+    sha256_lanes::Transform<SSE2Ops>(states, blocks);
+}
+} // namespace sha256_sse2
+
+#endif
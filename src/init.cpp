@@ -42,6 +42,11 @@
 #include "util.h"
 #include "utilmoneystr.h"
 #include "validationinterface.h"
+#include "silubium/logsubscriptions.h"
+#include "silubium/statepruner.h"
+#include "silubium/flatstorage.h"
+#include <libdevcore/SHA3.h>
+#include <libevm/EVMProfiler.h>
 #ifdef ENABLE_WALLET
 #include "wallet/wallet.h"
 #endif
@@ -249,6 +254,10 @@ void Shutdown()
         pblocktree = nullptr;
         delete pstorageresult;
         pstorageresult = nullptr;
+        delete peventindex;
+        peventindex = nullptr;
+        delete pflatstorage;
+        pflatstorage = nullptr;
         delete globalState.release();
         globalSealEngine.reset();
     }
@@ -266,6 +275,12 @@ void Shutdown()
     }
 #endif
 
+    if (plogsubscriptions) {
+        UnregisterValidationInterface(plogsubscriptions);
+        delete plogsubscriptions;
+        plogsubscriptions = nullptr;
+    }
+
 #ifndef WIN32
     try {
         fs::remove(GetPidFile());
@@ -392,6 +407,13 @@ std::string HelpMessage(HelpMessageMode mode)
 #endif
     strUsage += HelpMessageOpt("-txindex", strprintf(_("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)"), DEFAULT_TXINDEX));
     strUsage += HelpMessageOpt("-logevents", strprintf(_("Maintain a full EVM log index, used by searchlogs and gettransactionreceipt rpc calls (default: %u)"), DEFAULT_LOGEVENTS));
+    strUsage += HelpMessageOpt("-receiptcache=<n>", strprintf(_("Number of transaction receipts to keep in memory for rpc calls (default: %u)"), DEFAULT_RECEIPT_CACHE_SIZE));
+    strUsage += HelpMessageOpt("-prunestate=<n>", strprintf(_("Delete in the background the contract state trie nodes that only blocks older than the last <n> blocks and the checkpoints use. "
+            "Blocks below them cannot be disconnected, and getstorage cannot go back to them (default: 0 = keep all, >=%u)"), MIN_BLOCKS_TO_KEEP));
+    strUsage += HelpMessageOpt("-flatstorage", strprintf(_("Keep the contract storage of the tip in a flat table, which serves storage reads without walking the state trie (default: %u)"), DEFAULT_FLAT_STORAGE));
+    strUsage += HelpMessageOpt("-evmprofile", strprintf(_("Count the instructions, gas and time spent by the EVM per opcode and per contract, reported by the getevmprofile rpc call (default: %u)"), DEFAULT_EVM_PROFILE));
+    strUsage += HelpMessageOpt("-parallelcontracts", strprintf(_("Execute the contract transactions of a block speculatively on -par threads (default: %u)"), DEFAULT_PARALLEL_CONTRACTS));
+    strUsage += HelpMessageOpt("-parallelblockproofs", strprintf(_("Check the block signatures and stake kernels of the next blocks to connect on -par threads (default: %u)"), DEFAULT_PARALLEL_BLOCK_PROOFS));
 
     strUsage += HelpMessageGroup(_("Connection options:"));
     strUsage += HelpMessageOpt("-addnode=<ip>", _("Add a node to connect to and attempt to keep the connection open"));
@@ -445,6 +467,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-zmqpubhashtx=<address>", _("Enable publish hash transaction in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawblock=<address>", _("Enable publish raw block in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawtx=<address>", _("Enable publish raw transaction in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubcontractlog=<address>", _("Enable publish contract logs of connected and disconnected blocks in <address> (requires -logevents)"));
 #endif
 
     strUsage += HelpMessageGroup(_("Debugging/Testing options:"));
@@ -1047,6 +1070,21 @@ bool AppInitParameterInteraction()
         nScriptCheckThreads = 0;
     else if (nScriptCheckThreads > MAX_SCRIPTCHECK_THREADS)
         nScriptCheckThreads = MAX_SCRIPTCHECK_THREADS;
+    fParallelContracts = gArgs.GetBoolArg("-parallelcontracts", DEFAULT_PARALLEL_CONTRACTS);
+    fParallelBlockProofs = gArgs.GetBoolArg("-parallelblockproofs", DEFAULT_PARALLEL_BLOCK_PROOFS);
+
+    // contract state pruning; the number of recent blocks whose state is kept
+    int64_t nPruneStateArg = gArgs.GetArg("-prunestate", DEFAULT_PRUNE_STATE);
+    if (nPruneStateArg < 0) {
+        return InitError(_("Prunestate cannot be configured with a negative value."));
+    }
+    if (nPruneStateArg > 0 && nPruneStateArg < MIN_BLOCKS_TO_KEEP) {
+        return InitError(strprintf(_("Prunestate configured below the minimum of %d blocks.  Please use a higher number."), MIN_BLOCKS_TO_KEEP));
+    }
+    nPruneStateDepth = (unsigned int)std::min<int64_t>(nPruneStateArg, std::numeric_limits<int>::max());
+    if (nPruneStateDepth) {
+        LogPrintf("Contract state pruning configured to keep the last %u blocks.\n", nPruneStateDepth);
+    }
 
     // block pruning; get the amount of disk space (in MiB) to allot for block & undo files
     int64_t nPruneArg = gArgs.GetArg("-prune", 0);
@@ -1210,6 +1248,8 @@ bool AppInitSanityChecks()
     // Initialize elliptic curve code
     std::string sha256_algo = SHA256AutoDetect();
     LogPrintf("Using the '%s' SHA256 implementation\n", sha256_algo);
+    std::string keccak_algo = dev::sha3AutoDetect(); // silubium
+    LogPrintf("Using the '%s' Keccak implementation\n", keccak_algo);
     RandomInit();
     ECC_Start();
     globalVerifyHandle.reset(new ECCVerifyHandle());
@@ -1271,6 +1311,14 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     if (nScriptCheckThreads) {
         for (int i=0; i<nScriptCheckThreads-1; i++)
             threadGroup.create_thread(&ThreadScriptCheck);
+        if (fParallelContracts) {
+            for (int i=0; i<nScriptCheckThreads-1; i++)
+                threadGroup.create_thread(&ThreadContractCheck);
+        }
+        if (fParallelBlockProofs) {
+            for (int i=0; i<nScriptCheckThreads-1; i++)
+                threadGroup.create_thread(&ThreadBlockProofCheck);
+        }
     }
 
     // Start the lightweight task scheduler thread
@@ -1408,6 +1456,9 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
     }
 #endif
 
+    plogsubscriptions = new LogSubscriptions();
+    RegisterValidationInterface(plogsubscriptions);
+
 #if ENABLE_ZMQ
     pzmqNotificationInterface = CZMQNotificationInterface::Create();
 
@@ -1460,6 +1511,9 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                 delete pcoinscatcher;
                 delete pblocktree;
                 delete pstorageresult;
+                delete peventindex;
+                delete pflatstorage;
+                pflatstorage = nullptr;
                 globalState.reset();
                 globalSealEngine.reset();
 
@@ -1530,6 +1584,21 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                     break;
                 }
 
+                uint256 hashSnapshotLoad = pcoinsdbview->ReadStateSnapshotLoad(); // silubium
+                if (!hashSnapshotLoad.IsNull()) {
+                    // The mark is cleared right after the snapshot block is activated, which may not have happened if the node stopped in between
+                    uint256 hashSnapshotBlock;
+                    uint64_t nSnapshotChainTx;
+                    if (pcoinsdbview->GetBestBlock() != hashSnapshotLoad || !pblocktree->ReadStateSnapshotBlock(hashSnapshotBlock, nSnapshotChainTx) || hashSnapshotBlock != hashSnapshotLoad) {
+                        strLoadError = _("The node stopped while a state snapshot was loaded. You will need to rebuild the database using -reindex-chainstate.");
+                        break;
+                    }
+                    if (!pcoinsdbview->WriteStateSnapshotLoad(uint256())) {
+                        strLoadError = _("Error initializing block database");
+                        break;
+                    }
+                }
+
                 // The on-disk coinsdb is now in a good state, create the cache
                 pcoinsTip = new CCoinsViewCache(pcoinscatcher);
 
@@ -1559,11 +1628,15 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                 dev::eth::BaseState existsSilubiumstate = fStatus ? dev::eth::BaseState::PreExisting : dev::eth::BaseState::Empty;
                 globalState = std::unique_ptr<SilubiumState>(new SilubiumState(dev::u256(0), SilubiumState::openDB(dirSilubium, hashDB, dev::WithExisting::Trust), dirSilubium, existsSilubiumstate));
                 dev::eth::ChainParams cp((dev::eth::genesisInfo(dev::eth::Network::silubiumMainNetwork)));
+                for (unsigned i = 5; i <= 9; i++) // modexp, bn128 add/mul/pairing and blake2f run from the fork height
+                    cp.precompiled.at(dev::Address(i)).setStartingBlock(chainparams.GetConsensus().nPrecompilesHFHeight);
                 globalSealEngine = std::unique_ptr<dev::eth::SealEngineFace>(cp.createSealEngine());
 
-                pstorageresult = new StorageResults(silubiumStateDir.string());
+                pstorageresult = new StorageResults(silubiumStateDir.string(), std::max<int64_t>(0, gArgs.GetArg("-receiptcache", DEFAULT_RECEIPT_CACHE_SIZE)));
+                peventindex = new EventIndex(silubiumStateDir.string());
                 if (fReset) {
                     pstorageresult->wipeResults();
+                    peventindex->wipe();
                 }
 
                 if(chainActive.Tip() != nullptr){
@@ -1577,7 +1650,17 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                 globalState->db().commit();
                 globalState->dbUtxo().commit();
 
+                if (gArgs.GetBoolArg("-flatstorage", DEFAULT_FLAT_STORAGE)) {
+                    pflatstorage = new FlatStorage(silubiumStateDir.string());
+                    // Left behind by a crash, or by running without -flatstorage
+                    uint256 hashTip = chainActive.Tip() ? chainActive.Tip()->GetBlockHash() : uint256();
+                    if (fReset || pflatstorage->tip() != hashTip)
+                        pflatstorage->wipe();
+                    globalState->setFlatStorage(pflatstorage);
+                }
+
                 fRecordLogOpcodes = gArgs.IsArgSet("-record-log-opcodes");
+                dev::eth::EVMProfiler::setEnabled(gArgs.GetBoolArg("-evmprofile", DEFAULT_EVM_PROFILE));
                 fIsVMlogFile = fs::exists(GetDataDir() / "vmExecLogs.json");
                 ///////////////////////////////////////////////////////////
 
@@ -1591,10 +1674,19 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
                 {
                     pstorageresult->wipeResults();
                     pblocktree->WipeHeightIndex();
+                    peventindex->wipe();
                     fLogEvents = true;//false;
                     pblocktree->WriteFlag("logevents", fLogEvents);
                 }
 
+                if (fLogEvents && !peventindex->isBuilt()) {
+                    uiInterface.InitMessage(_("Building event index..."));
+                    if (!BuildEventIndex()) {
+                        strLoadError = _("Error building the event index");
+                        break;
+                    }
+                }
+
                 if (!fReset) {
                     // Note that RewindBlockIndex MUST run even if we're about to -reindex-chainstate.
                     // It both disconnects blocks based on chainActive, and drops block data in
@@ -1735,6 +1827,10 @@ bool AppInitMain(boost::thread_group& threadGroup, CScheduler& scheduler)
 
     threadGroup.create_thread(boost::bind(&ThreadImport, vImportFiles));
 
+    if (nPruneStateDepth) {
+        threadGroup.create_thread(&ThreadPruneState);
+    }
+
     // Wait for genesis block to be processed
     {
         boost::unique_lock<boost::mutex> lock(cs_GenesisWait);
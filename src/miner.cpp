@@ -880,6 +880,239 @@ bool CheckStake(const std::shared_ptr<const CBlock> pblock, CWallet& wallet)
     return true;
 }
 
+CStakeTemplate::CStakeTemplate() : nTotalFees(0), fHasContracts(false), fRebuild(false) {}
+
+bool CStakeTemplate::NeedsUpdate(const uint256& hashPrevBlock, uint32_t nTime, const CScript& scriptPubKeyIn) const
+{
+    LOCK(cs);
+    if (!pblocktemplate || pblocktemplate->block.hashPrevBlock != hashPrevBlock || fRebuild)
+        return true;
+    // without contracts the body does not depend on the slot nor on the staker
+    return fHasContracts && (pblocktemplate->block.nTime != nTime || scriptPubKey != scriptPubKeyIn);
+}
+
+void CStakeTemplate::Set(std::unique_ptr<CBlockTemplate> pblocktemplateIn, int64_t nTotalFeesIn, const CScript& scriptPubKeyIn)
+{
+    bool fContracts = false;
+    for (const CTransactionRef& tx : pblocktemplateIn->block.vtx) {
+        if (tx->HasCreateOrCall()) {
+            fContracts = true;
+            break;
+        }
+    }
+
+    LOCK(cs);
+    pblocktemplate = std::move(pblocktemplateIn);
+    nTotalFees = nTotalFeesIn;
+    scriptPubKey = scriptPubKeyIn;
+    fHasContracts = fContracts;
+    // The changes queued before the build may be in it already, Update skips them
+    fRebuild = false;
+}
+
+void CStakeTemplate::TransactionAddedToMempool(CTransactionRef tx)
+{
+    // Also queued while a template is built, until it is set
+    LOCK(cs);
+    vAdded.push_back(tx);
+}
+
+void CStakeTemplate::TransactionRemovedFromMempool(CTransactionRef tx, MemPoolRemovalReason reason)
+{
+    // The transactions of a new tip are left to the build for that tip
+    if (reason == MemPoolRemovalReason::BLOCK)
+        return;
+    LOCK(cs);
+    vRemoved.push_back(tx->GetHash());
+}
+
+void CStakeTemplate::Update()
+{
+    LOCK2(cs_main, mempool.cs);
+    LOCK(cs);
+    if (!pblocktemplate || pblocktemplate->block.hashPrevBlock != chainActive.Tip()->GetBlockHash() || fRebuild)
+        return;
+    std::vector<CTransactionRef> vAddedNow;
+    std::vector<uint256> vRemovedNow;
+    vAddedNow.swap(vAdded);
+    vRemovedNow.swap(vRemoved);
+    if (vAddedNow.empty() && vRemovedNow.empty())
+        return;
+
+    CBlock& block = pblocktemplate->block;
+    // The fees and sigops of the coinstake are not in the lists, which start with the coinbase
+    const size_t nFirstTx = block.IsProofOfStake() ? 2 : 1;
+    const size_t nOffset = block.vtx.size() - pblocktemplate->vTxFees.size();
+    CAmount nFeesChange = 0;
+
+    // A removed transaction takes the transactions of the template spending it along
+    std::set<uint256> setRemoved(vRemovedNow.begin(), vRemovedNow.end());
+    for (size_t i = nFirstTx; i < block.vtx.size();) {
+        const CTransaction& tx = *block.vtx[i];
+        bool fRemove = setRemoved.count(tx.GetHash()) > 0;
+        for (const CTxIn& txin : tx.vin)
+            fRemove = fRemove || setRemoved.count(txin.prevout.hash) > 0;
+        if (!fRemove) {
+            i++;
+            continue;
+        }
+        if (tx.HasCreateOrCall()) {
+            // The state roots of the block depend on the execution, the staker must not use it until it is built again
+            pblocktemplate.reset();
+            return;
+        }
+        setRemoved.insert(tx.GetHash());
+        nFeesChange -= pblocktemplate->vTxFees[i - nOffset];
+        pblocktemplate->vTxFees.erase(pblocktemplate->vTxFees.begin() + (i - nOffset));
+        pblocktemplate->vTxSigOpsCost.erase(pblocktemplate->vTxSigOpsCost.begin() + (i - nOffset));
+        block.vtx.erase(block.vtx.begin() + i);
+    }
+    bool fChanged = !setRemoved.empty();
+
+    // Added transactions are appended as CreateNewBlock would take them, with their parents already in the block
+    const CChainParams& chainparams = Params();
+    const CBlockIndex* pindexPrev = chainActive.Tip();
+    const int nHeight = pindexPrev->nHeight + 1;
+    const int64_t nLockTimeCutoff = (STANDARD_LOCKTIME_VERIFY_FLAGS & LOCKTIME_MEDIAN_TIME_PAST)
+                                    ? pindexPrev->GetMedianTimePast()
+                                    : block.GetBlockTime();
+    const bool fIncludeWitness = IsWitnessEnabled(pindexPrev, chainparams.GetConsensus());
+    const BlockAssembler::Options options = DefaultOptions(chainparams);
+    const uint64_t nBlockMaxWeight = std::max<size_t>(4000, std::min<size_t>(dgpMaxBlockWeight - 4000, options.nBlockMaxWeight));
+    uint64_t nBlockWeight = GetBlockWeight(block);
+    int64_t nBlockSigOpsCost = 0;
+    for (int64_t nSigOpsCost : pblocktemplate->vTxSigOpsCost)
+        nBlockSigOpsCost += nSigOpsCost;
+    std::set<uint256> setInBlock;
+    for (const CTransactionRef& tx : block.vtx)
+        setInBlock.insert(tx->GetHash());
+
+    for (const CTransactionRef& tx : vAddedNow) {
+        CTxMemPool::txiter it = mempool.mapTx.find(tx->GetHash());
+        if (it == mempool.mapTx.end() || setInBlock.count(tx->GetHash()))
+            continue;
+        if (tx->HasCreateOrCall()) {
+            fRebuild = true;
+            continue;
+        }
+        if (it->GetModifiedFee() < options.blockMinFeeRate.GetFee(it->GetTxSize()))
+            continue;
+        if (!IsFinalTx(*tx, nHeight, nLockTimeCutoff) || (!fIncludeWitness && tx->HasWitness()))
+            continue;
+        bool fParentsInBlock = true;
+        for (const CTxIn& txin : tx->vin)
+            fParentsInBlock = fParentsInBlock && (!mempool.exists(txin.prevout.hash) || setInBlock.count(txin.prevout.hash));
+        if (!fParentsInBlock)
+            continue;
+        if (nBlockWeight + it->GetTxWeight() >= nBlockMaxWeight || nBlockSigOpsCost + it->GetSigOpCost() >= dgpMaxBlockSigOps)
+            continue;
+
+        block.vtx.push_back(tx);
+        pblocktemplate->vTxFees.push_back(it->GetFee());
+        pblocktemplate->vTxSigOpsCost.push_back(it->GetSigOpCost());
+        nBlockWeight += it->GetTxWeight();
+        nBlockSigOpsCost += it->GetSigOpCost();
+        nFeesChange += it->GetFee();
+        setInBlock.insert(tx->GetHash());
+        fChanged = true;
+    }
+    if (!fChanged)
+        return;
+
+    // The reward of a proof of work block is in the coinbase, a coinstake is made from nTotalFees when signing
+    nTotalFees += nFeesChange;
+    pblocktemplate->vTxFees[0] -= nFeesChange;
+    CMutableTransaction coinbaseTx(*block.vtx[0]);
+    if (!block.IsProofOfStake())
+        coinbaseTx.vout[0].nValue += nFeesChange;
+    // The witness commitment covers the transactions, it is made again
+    CScript scriptCommitment(pblocktemplate->vchCoinbaseCommitment.begin(), pblocktemplate->vchCoinbaseCommitment.end());
+    for (size_t i = 0; i < coinbaseTx.vout.size(); i++) {
+        if (!scriptCommitment.empty() && coinbaseTx.vout[i].scriptPubKey == scriptCommitment) {
+            coinbaseTx.vout.erase(coinbaseTx.vout.begin() + i);
+            break;
+        }
+    }
+    coinbaseTx.vin[0].scriptWitness.SetNull();
+    block.vtx[0] = MakeTransactionRef(std::move(coinbaseTx));
+    pblocktemplate->vchCoinbaseCommitment = GenerateCoinbaseCommitment(block, pindexPrev, chainparams.GetConsensus(), block.IsProofOfStake());
+}
+
+std::unique_ptr<CBlockTemplate> CStakeTemplate::Get(const CBlockHeader& header, const CScript& scriptPubKeyIn, int64_t& nTotalFeesOut) const
+{
+    LOCK(cs);
+    if (!pblocktemplate || pblocktemplate->block.hashPrevBlock != header.hashPrevBlock || pblocktemplate->block.nBits != header.nBits)
+        return nullptr;
+    if (fHasContracts && (pblocktemplate->block.nTime != header.nTime || scriptPubKey != scriptPubKeyIn))
+        return nullptr;
+
+    std::unique_ptr<CBlockTemplate> pblocktemplateOut(new CBlockTemplate(*pblocktemplate));
+    pblocktemplateOut->block.nTime = header.nTime;
+    nTotalFeesOut = nTotalFees;
+    return pblocktemplateOut;
+}
+
+void CStakeTemplate::Clear()
+{
+    LOCK(cs);
+    pblocktemplate.reset();
+    vAdded.clear();
+    vRemoved.clear();
+}
+
+CScript CStakeTemplate::GetStakerScript() const
+{
+    LOCK(cs);
+    return scriptStaker;
+}
+
+void CStakeTemplate::SetStakerScript(const CScript& scriptPubKeyIn)
+{
+    LOCK(cs);
+    scriptStaker = scriptPubKeyIn;
+}
+
+static CStakeTemplate stakeTemplate;
+
+void ThreadStakeTemplate(CWallet *pwallet)
+{
+    RenameThread("silubiumcoin-stktmpl");
+
+    // Disconnected when the thread is interrupted
+    boost::signals2::scoped_connection connAdded(mempool.NotifyEntryAdded.connect(boost::bind(&CStakeTemplate::TransactionAddedToMempool, &stakeTemplate, _1)));
+    boost::signals2::scoped_connection connRemoved(mempool.NotifyEntryRemoved.connect(boost::bind(&CStakeTemplate::TransactionRemovedFromMempool, &stakeTemplate, _1, _2)));
+
+    while (true)
+    {
+        MilliSleep(STAKER_TEMPLATE_POLLING_PERIOD);
+
+        if (pwallet->IsLocked() || IsInitialBlockDownload() || !pwallet->HaveAvailableCoinsForStaking()) {
+            stakeTemplate.Clear();
+            continue;
+        }
+
+        // The staker tries the slots up to MAX_STAKE_LOOKAHEAD ahead, a kernel hit is first seen on the last one
+        uint32_t nTime = (GetAdjustedTime() & ~STAKE_TIMESTAMP_MASK) + MAX_STAKE_LOOKAHEAD - (STAKE_TIMESTAMP_MASK + 1);
+        CScript scriptPubKey = stakeTemplate.GetStakerScript();
+        uint256 hashPrevBlock;
+        {
+            LOCK(cs_main);
+            hashPrevBlock = chainActive.Tip()->GetBlockHash();
+        }
+        stakeTemplate.Update();
+        if (!stakeTemplate.NeedsUpdate(hashPrevBlock, nTime, scriptPubKey))
+            continue;
+
+        int64_t nTotalFees = 0;
+        std::unique_ptr<CBlockTemplate> pblocktemplate(
+                BlockAssembler(Params()).CreateNewBlock(scriptPubKey, true, true, &nTotalFees,
+                                                        nTime, FutureDrift(GetAdjustedTime()) - STAKE_TIME_BUFFER));
+        if (!pblocktemplate.get())
+            continue;
+        stakeTemplate.Set(std::move(pblocktemplate), nTotalFees, scriptPubKey);
+    }
+}
+
 void ThreadStakeMiner(CWallet *pwallet)
 {
     SetThreadPriority(THREAD_PRIORITY_LOWEST);
@@ -890,6 +1123,7 @@ void ThreadStakeMiner(CWallet *pwallet)
     CReserveKey reservekey(pwallet);
 
     bool fTryToSync = true;
+    bool fStakerTemplate = gArgs.GetBoolArg("-stakertemplate", DEFAULT_STAKER_TEMPLATE);
     bool regtestMode = Params().GetConsensus().fPoSNoRetargeting;
     if(regtestMode){
         nMinerSleep = 30000; //limit regtest to 30s, otherwise it'll create 2 blocks per second
@@ -932,6 +1166,8 @@ void ThreadStakeMiner(CWallet *pwallet)
 
             uint32_t beginningTime=GetAdjustedTime();
             beginningTime &= ~STAKE_TIMESTAMP_MASK;
+            // Search the kernels of the whole lookahead window at once, then only sign at the times that hit
+            std::vector<uint32_t> vStakeTimes = pwallet->FindStakeTimes(pblocktemplate->block.nBits, beginningTime, beginningTime + MAX_STAKE_LOOKAHEAD);
             for(uint32_t i=beginningTime;i<beginningTime + MAX_STAKE_LOOKAHEAD;i+=STAKE_TIMESTAMP_MASK+1) {
 
                 // The information is needed for status bar to determine if the staker is trying to create block and when it will be created approximately,
@@ -939,6 +1175,9 @@ void ThreadStakeMiner(CWallet *pwallet)
                 // nLastCoinStakeSearchInterval > 0 mean that the staker is running
                 nLastCoinStakeSearchInterval = i - nLastCoinStakeSearchTime;
 
+                if (!std::binary_search(vStakeTimes.begin(), vStakeTimes.end(), i))
+                    continue;
+
                 // Try to sign a block (this also checks for a PoS stake)
                 pblocktemplate->block.nTime = i;
                 std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>(pblocktemplate->block);
@@ -951,10 +1190,18 @@ void ThreadStakeMiner(CWallet *pwallet)
                         LogPrintf("ThreadStakeMiner(): Valid future PoS block was orphaned before becoming valid");
                         break;
                     }
-                    // Create a block that's properly populated with transactions
-                    std::unique_ptr<CBlockTemplate> pblocktemplatefilled(
-                            BlockAssembler(Params()).CreateNewBlock(pblock->vtx[1]->vout[1].scriptPubKey, true, true, &nTotalFees,
-                                                                    i, FutureDrift(GetAdjustedTime()) - STAKE_TIME_BUFFER));
+                    // Create a block that's properly populated with transactions, the speculative template already is
+                    const CScript& scriptStaker = pblock->vtx[1]->vout[1].scriptPubKey;
+                    std::unique_ptr<CBlockTemplate> pblocktemplatefilled;
+                    if (fStakerTemplate) {
+                        stakeTemplate.SetStakerScript(scriptStaker);
+                        pblocktemplatefilled = stakeTemplate.Get(*pblock, scriptStaker, nTotalFees);
+                        if (pblocktemplatefilled.get())
+                            LogPrint(BCLog::COINSTAKE, "ThreadStakeMiner(): using the speculative block template\n");
+                    }
+                    if (!pblocktemplatefilled.get())
+                        pblocktemplatefilled = BlockAssembler(Params()).CreateNewBlock(scriptStaker, true, true, &nTotalFees,
+                                                                    i, FutureDrift(GetAdjustedTime()) - STAKE_TIME_BUFFER);
                     if (!pblocktemplatefilled.get())
                         return;
                     if (chainActive.Tip()->GetBlockHash() != pblock->hashPrevBlock) {
@@ -1025,5 +1272,7 @@ void StakeSilubiums(bool fStake, CWallet *pwallet)
     {
         stakeThread = new boost::thread_group();
         stakeThread->create_thread(boost::bind(&ThreadStakeMiner, pwallet));
+        if (gArgs.GetBoolArg("-stakertemplate", DEFAULT_STAKER_TEMPLATE))
+            stakeThread->create_thread(boost::bind(&ThreadStakeTemplate, pwallet));
     }
 }
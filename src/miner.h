@@ -28,6 +28,8 @@ static const bool DEFAULT_STAKE = true;
 
 static const bool DEFAULT_STAKE_CACHE = true;
 
+static const bool DEFAULT_STAKER_TEMPLATE = true;
+
 //How many seconds to look ahead and prepare a block for staking
 //Look ahead up to 3 "timeslots" in the future, 48 seconds
 //Reduce this to reduce computational waste for stakers, increase this to increase the amount of time available to construct full blocks
@@ -45,6 +47,9 @@ static const int32_t STAKE_TIME_BUFFER = 2;
 //Note this is overridden for regtest mode
 static const int32_t STAKER_POLLING_PERIOD = 5000;
 
+//How often to check the speculative staker template against the tip and the time slot, and apply the mempool changes to it, in milliseconds
+static const int32_t STAKER_TEMPLATE_POLLING_PERIOD = 1000;
+
 //How much time to spend trying to process transactions when using the generate RPC call
 static const int32_t POW_MINER_MAX_TIME = 60;
 
@@ -196,6 +201,52 @@ struct update_for_parent_inclusion
     CTxMemPool::txiter iter;
 };
 
+/**
+ * Filled block kept ready for the staker, built in the background against the tip
+ * and rebuilt when the tip changes. On a kernel hit the staker signs it instead of
+ * assembling and executing the block from scratch. A build holds cs_main and the
+ * mempool lock like CreateNewBlock, so it is only done once per tip: the mempool
+ * changes after it are queued by the mempool signals, and the transactions without
+ * contracts are appended to or removed from the body in place. Contracts have to be
+ * executed, so a contract transaction coming or going rebuilds the template instead.
+ * The contract executions read the block time and the author, the coinstake script,
+ * so a template with contracts only serves the slot and the script it was built for.
+ */
+class CStakeTemplate
+{
+public:
+    CStakeTemplate();
+
+    /** Whether a template for the tip, the slot nTime and the staker script is worth building */
+    bool NeedsUpdate(const uint256& hashPrevBlock, uint32_t nTime, const CScript& scriptPubKey) const;
+    void Set(std::unique_ptr<CBlockTemplate> pblocktemplate, int64_t nTotalFees, const CScript& scriptPubKey);
+
+    /** Queue the mempool changes, connected to the mempool signals */
+    void TransactionAddedToMempool(CTransactionRef tx);
+    void TransactionRemovedFromMempool(CTransactionRef tx, MemPoolRemovalReason reason);
+    /** Apply the queued mempool changes to a template for the tip, a contract transaction among them makes it need an update */
+    void Update();
+
+    /** Copy of the template if it is valid for the header, with the time of the header */
+    std::unique_ptr<CBlockTemplate> Get(const CBlockHeader& header, const CScript& scriptPubKey, int64_t& nTotalFees) const;
+    void Clear();
+
+    /** Script of the last kernel hit, the templates with contracts are built for it */
+    CScript GetStakerScript() const;
+    void SetStakerScript(const CScript& scriptPubKey);
+
+private:
+    mutable CCriticalSection cs;
+    std::unique_ptr<CBlockTemplate> pblocktemplate;
+    int64_t nTotalFees;
+    CScript scriptPubKey;
+    CScript scriptStaker;
+    bool fHasContracts;
+    bool fRebuild;
+    std::vector<CTransactionRef> vAdded;
+    std::vector<uint256> vRemoved;
+};
+
 /** Generate a new block, without valid proof-of-work */
 class BlockAssembler
 {
@@ -14,6 +14,10 @@
 #include "chainparams.h"
 #include "script/sign.h"
 #include "consensus/consensus.h"
+#include "crypto/common.h"
+#include "crypto/sha256.h"
+
+#include <cmath>
 
 using namespace std;
 
@@ -113,6 +117,16 @@ bool CheckProofOfStake(CBlockIndex* pindexPrev, CValidationState& state, const C
         return state.DoS(100, error("CheckProofOfStake() : Stake prevout does not exist %s", txin.prevout.hash.ToString()));
     }
 
+    return CheckProofOfStake(pindexPrev, state, tx, nBits, nTimeBlock, coinPrev, hashProofOfStake, targetProofOfStake);
+}
+
+bool CheckProofOfStake(CBlockIndex* pindexPrev, CValidationState& state, const CTransaction& tx, unsigned int nBits, uint32_t nTimeBlock, const Coin& coinPrev, uint256& hashProofOfStake, uint256& targetProofOfStake)
+{
+    if (!tx.IsCoinStake())
+        return error("CheckProofOfStake() : called on non-coinstake %s", tx.GetHash().ToString());
+
+    const CTxIn& txin = tx.vin[0];
+
     if(pindexPrev->nHeight + 1 - coinPrev.nHeight < COINBASE_MATURITY){
         return state.DoS(100, error("CheckProofOfStake() : Stake prevout is not mature, expecting %i and only matured to %i", COINBASE_MATURITY, pindexPrev->nHeight + 1 - coinPrev.nHeight));
     }
@@ -180,6 +194,88 @@ bool CheckKernel(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t nTimeBloc
     return false;
 }
 
+CStakeKernelBatch::CStakeKernelBatch(const CBlockIndex* pindexPrev, unsigned int nBits, const std::vector<CStakeKernelCoin>& coinsIn) : coins(coinsIn)
+{
+    arith_uint256 bnTarget;
+    bnTarget.SetCompact(nBits);
+
+    // First block: nStakeModifier, blockFrom.nTime and the first 28 bytes of txPrev.vout.hash
+    midstates.resize(8 * coins.size());
+    targets.resize(coins.size());
+    std::vector<unsigned char> blocks(64 * coins.size());
+    for (size_t i = 0; i < coins.size(); i++) {
+        unsigned char* block = &blocks[64 * i];
+        memcpy(block, pindexPrev->nStakeModifier.begin(), 32);
+        WriteLE32(block + 32, coins[i].blockFromTime);
+        memcpy(block + 36, coins[i].prevout.hash.begin(), 28);
+        SHA256Initialize(&midstates[8 * i]);
+
+        targets[i] = bnTarget * arith_uint256(coins[i].amount);
+    }
+    SHA256TransformBatch(midstates.data(), blocks.data(), coins.size());
+}
+
+void CStakeKernelBatch::Search(uint32_t nTimeBegin, uint32_t nTimeEnd, std::vector<std::pair<size_t, uint32_t> >& hits) const
+{
+    // Pairs hashed per batch, bounding the buffers for large wallets
+    static const size_t BATCH_SIZE = 1024;
+
+    const uint32_t nStep = STAKE_TIMESTAMP_MASK + 1;
+    size_t nTimes = nTimeEnd > nTimeBegin ? (nTimeEnd - nTimeBegin + nStep - 1) / nStep : 0;
+    size_t nPairs = nTimes * coins.size();
+
+    std::vector<uint32_t> states(8 * BATCH_SIZE);
+    std::vector<unsigned char> blocks(64 * BATCH_SIZE);
+    for (size_t nFirst = 0; nFirst < nPairs; nFirst += BATCH_SIZE) {
+        size_t nCount = std::min(BATCH_SIZE, nPairs - nFirst);
+
+        // Last block of the kernel: the rest of txPrev.vout.hash, txPrev.vout.n and nTime, padded for 76 bytes
+        memset(blocks.data(), 0, 64 * nCount);
+        for (size_t j = 0; j < nCount; j++) {
+            size_t i = (nFirst + j) % coins.size();
+            uint32_t nTime = nTimeBegin + nStep * ((nFirst + j) / coins.size());
+            unsigned char* block = &blocks[64 * j];
+            memcpy(block, coins[i].prevout.hash.begin() + 28, 4);
+            WriteLE32(block + 4, coins[i].prevout.n);
+            WriteLE32(block + 8, nTime);
+            block[12] = 0x80;
+            WriteBE64(block + 56, 76 * 8);
+            memcpy(&states[8 * j], &midstates[8 * i], 32);
+        }
+        SHA256TransformBatch(states.data(), blocks.data(), nCount);
+
+        // Outer hash of the 32-byte digest
+        memset(blocks.data(), 0, 64 * nCount);
+        for (size_t j = 0; j < nCount; j++) {
+            unsigned char* block = &blocks[64 * j];
+            for (int k = 0; k < 8; k++)
+                WriteBE32(block + 4 * k, states[8 * j + k]);
+            block[32] = 0x80;
+            WriteBE64(block + 56, 32 * 8);
+            SHA256Initialize(&states[8 * j]);
+        }
+        SHA256TransformBatch(states.data(), blocks.data(), nCount);
+
+        for (size_t j = 0; j < nCount; j++) {
+            uint256 hashProofOfStake;
+            for (int k = 0; k < 8; k++)
+                WriteBE32(hashProofOfStake.begin() + 4 * k, states[8 * j + k]);
+            size_t i = (nFirst + j) % coins.size();
+            if (UintToArith256(hashProofOfStake) <= targets[i])
+                hits.push_back(std::make_pair(i, nTimeBegin + nStep * (uint32_t)((nFirst + j) / coins.size())));
+        }
+    }
+}
+
+double CStakeKernelBatch::ExpectedTime(size_t i) const
+{
+    // Each block time the kernel hash is uniform below 2^256
+    double nProbability = std::min(1.0, (targets[i].getdouble() + 1) / std::pow(2.0, 256));
+    if (coins[i].amount <= 0)
+        return 0;
+    return (STAKE_TIMESTAMP_MASK + 1) / nProbability;
+}
+
 void CacheKernel(std::map<COutPoint, CStakeCache>& cache, const COutPoint& prevout, CBlockIndex* pindexPrev, CCoinsViewCache& view){
     if(cache.find(prevout) != cache.end()){
         //already in cache
@@ -29,6 +29,37 @@ struct CStakeCache{
 
 void CacheKernel(std::map<COutPoint, CStakeCache>& cache, const COutPoint& prevout, CBlockIndex* pindexPrev, CCoinsViewCache& view);
 
+// A coin searched for a kernel, with the data of its stake cache entry
+struct CStakeKernelCoin{
+    CStakeKernelCoin(const COutPoint& prevout_, const CStakeCache& stake) : prevout(prevout_), blockFromTime(stake.blockFromTime), amount(stake.amount){
+    }
+    COutPoint prevout;
+    uint32_t blockFromTime;
+    CAmount amount;
+};
+
+// Kernel search of many coins over a window of block times in one pass.
+// The first SHA-256 block of a kernel only depends on the stake modifier and the coin,
+// so its midstate is computed once per coin; the last block and the outer hash of every
+// (coin, time) pair run on the lanes of SHA256TransformBatch. A hit is a candidate to be
+// confirmed by CheckKernel, like a hit on the stake cache.
+class CStakeKernelBatch{
+public:
+    CStakeKernelBatch(const CBlockIndex* pindexPrev, unsigned int nBits, const std::vector<CStakeKernelCoin>& coins);
+
+    // Append the (coin index, block time) pairs meeting the target for the block times
+    // nTimeBegin, nTimeBegin + STAKE_TIMESTAMP_MASK + 1, ... below nTimeEnd, ordered by time
+    void Search(uint32_t nTimeBegin, uint32_t nTimeEnd, std::vector<std::pair<size_t, uint32_t> >& hits) const;
+
+    // Expected seconds before a coin stakes at this difficulty, 0 if it never can
+    double ExpectedTime(size_t i) const;
+
+private:
+    std::vector<CStakeKernelCoin> coins;
+    std::vector<uint32_t> midstates;
+    std::vector<arith_uint256> targets;
+};
+
 // Compute the hash modifier for proof-of-stake
 uint256 ComputeStakeModifier(const CBlockIndex* pindexPrev, const uint256& kernel);
 
@@ -39,6 +70,8 @@ bool CheckStakeKernelHash(CBlockIndex* pindexPrev, unsigned int nBits, uint32_t
 // Check kernel hash target and coinstake signature
 // Sets hashProofOfStake on success return
 bool CheckProofOfStake(CBlockIndex* pindexPrev, CValidationState& state, const CTransaction& tx, unsigned int nBits, uint32_t nTimeBlock, uint256& hashProofOfStake, uint256& targetProofOfStake, CCoinsViewCache& view);
+// Same with the stake coin already looked up, so that the checks can run without the coins view
+bool CheckProofOfStake(CBlockIndex* pindexPrev, CValidationState& state, const CTransaction& tx, unsigned int nBits, uint32_t nTimeBlock, const Coin& coinPrev, uint256& hashProofOfStake, uint256& targetProofOfStake);
 
 // Check whether the coinstake timestamp meets protocol
 bool CheckCoinStakeTimestamp(uint32_t nTimeBlock);
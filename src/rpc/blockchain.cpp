@@ -27,6 +27,9 @@
 #include "hash.h"
 #include "libdevcore/CommonData.h"
 #include "pos.h"
+#include "silubium/logsubscriptions.h"
+#include "silubium/statepruner.h"
+#include "silubium/statesnapshot.h"
 #include "txdb.h"
 
 #include <stdint.h>
@@ -817,6 +820,9 @@ UniValue getstorage(const JSONRPCRequest& request)
             if((blockNum < 0 && blockNum != -1) || blockNum > chainActive.Height())
                 throw JSONRPCError(RPC_INVALID_PARAMS, "Incorrect block number");
 
+            if(blockNum != -1 && IsStatePruned(blockNum))
+                throw JSONRPCError(RPC_MISC_ERROR, "State of the block has been pruned");
+
             if(blockNum != -1)
                 ts.SetRoot(uintToh256(chainActive[blockNum]->hashStateRoot), uintToh256(chainActive[blockNum]->hashUTXORoot));
                 
@@ -1010,6 +1016,33 @@ UniValue getblock(const JSONRPCRequest& request)
 }
 
 ////////////////////////////////////////////////////////////////////// // silubium
+/** Calls accepted by one callcontractbatch request */
+static const size_t MAX_CALLCONTRACT_BATCH = 10000;
+
+static dev::Address parseSenderAddress(const std::string& strSender)
+{
+    CBitcoinAddress silubiumSenderAddress(strSender);
+    if(silubiumSenderAddress.IsValid()){
+        CKeyID keyid;
+        silubiumSenderAddress.GetKeyID(keyid);
+        return dev::Address(HexStr(valtype(keyid.begin(),keyid.end())));
+    }
+    return dev::Address(strSender);
+}
+
+uint64_t parseUInt64(const UniValue& val, uint64_t defaultVal) {
+    if (val.isNull()) {
+        return defaultVal;
+    }
+
+    int64_t n = val.get_int64();
+    if (n < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMS, "Expects unsigned integer");
+    }
+
+    return n;
+}
+
 UniValue callcontract(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() < 2)
@@ -1022,8 +1055,6 @@ UniValue callcontract(const JSONRPCRequest& request)
              "4. gasLimit             (string, optional) The gas limit for executing the contract\n"
          );
  
-    LOCK(cs_main);
-    
     std::string strAddr = request.params[0].get_str();
     std::string data = request.params[1].get_str();
 
@@ -1032,22 +1063,22 @@ UniValue callcontract(const JSONRPCRequest& request)
 
     if(strAddr.size() != 40 || !CheckHex(strAddr))
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Incorrect address");
+
+    // Only the snapshot of the tip is taken under cs_main, the call runs concurrently with other calls and block connection
+    ContractStateSnapshot snapshot;
+    {
+        LOCK(cs_main);
+        if(!GetContractStateSnapshot(snapshot))
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Contract state not available");
+    }
  
     dev::Address addrAccount(strAddr);
-    if(!globalState->addressInUse(addrAccount))
+    if(!snapshot.state->addressInUse(addrAccount))
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Address does not exist");
     
     dev::Address senderAddress;
     if(request.params.size() == 3){
-        CBitcoinAddress silubiumSenderAddress(request.params[2].get_str());
-        if(silubiumSenderAddress.IsValid()){
-            CKeyID keyid;
-            silubiumSenderAddress.GetKeyID(keyid);
-            senderAddress = dev::Address(HexStr(valtype(keyid.begin(),keyid.end())));
-        }else{
-            senderAddress = dev::Address(request.params[2].get_str());
-        }
-
+        senderAddress = parseSenderAddress(request.params[2].get_str());
     }
     uint64_t gasLimit=0;
     if(request.params.size() == 4){
@@ -1055,9 +1086,10 @@ UniValue callcontract(const JSONRPCRequest& request)
     }
 
 
-    std::vector<ResultExecute> execResults = CallContract(addrAccount, ParseHex(data), senderAddress, gasLimit);
+    std::vector<ResultExecute> execResults = CallContract(snapshot, addrAccount, ParseHex(data), senderAddress, gasLimit);
 
     if(fRecordLogOpcodes){
+        LOCK(cs_main);
         writeVMlog(execResults);
     }
 
@@ -1069,6 +1101,103 @@ UniValue callcontract(const JSONRPCRequest& request)
     return result;
 }
 
+UniValue callcontractbatch(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+             "callcontractbatch [{\"address\":\"address\",\"data\":\"data\"},...] ( threads )\n"
+             "\nExecute read-only contract calls against the same state of the tip, with one setup for all of them.\n"
+             "\nArguments:\n"
+             "1. calls                (array, required) The calls to execute, at most " + std::to_string(MAX_CALLCONTRACT_BATCH) + "\n"
+             "    [\n"
+             "      {\n"
+             "        \"address\"      (string, required) The contract address\n"
+             "        \"data\"         (string, required) The data hex string\n"
+             "        \"sender\"       (string, optional) The sender address\n"
+             "        \"gasLimit\"     (numeric, optional) The gas limit for executing the contract\n"
+             "      }\n"
+             "      ,...\n"
+             "    ]\n"
+             "2. threads              (numeric, optional, default=1) Threads to spread the calls over, at most the number of cores\n"
+             "\nResult:\n"
+             "{\n"
+             "  \"blockNumber\": n,       (numeric) Height of the block the calls were executed on top of\n"
+             "  \"results\": [            (array) One result per call, in order, as returned by callcontract,\n"
+             "                             or with an \"error\" field if the address does not exist\n"
+             "  ]\n"
+             "}\n"
+             "\nExamples:\n"
+             + HelpExampleCli("callcontractbatch", "'[{\"address\":\"12ae42729af478ca92c8c66773a3e32115717be4\",\"data\":\"06fdde03\"}]' 4")
+             + HelpExampleRpc("callcontractbatch", "[{\"address\":\"12ae42729af478ca92c8c66773a3e32115717be4\",\"data\":\"06fdde03\"}], 4")
+         );
+
+    const UniValue& params = request.params[0].get_array();
+    if(params.size() > MAX_CALLCONTRACT_BATCH)
+        throw JSONRPCError(RPC_INVALID_PARAMS, strprintf("Too many calls, at most %u", MAX_CALLCONTRACT_BATCH));
+
+    std::vector<ContractCall> calls(params.size());
+    for(size_t i = 0; i < params.size(); i++){
+        const UniValue& param = params[i].get_obj();
+        RPCTypeCheckObj(param,
+            {
+                {"address", UniValueType(UniValue::VSTR)},
+                {"data", UniValueType(UniValue::VSTR)},
+                {"sender", UniValueType(UniValue::VSTR)},
+                {"gasLimit", UniValueType(UniValue::VNUM)},
+            }, true, true);
+
+        std::string strAddr = find_value(param, "address").get_str();
+        std::string data = find_value(param, "data").get_str();
+        if(data.size() % 2 != 0 || !CheckHex(data))
+            throw JSONRPCError(RPC_TYPE_ERROR, strprintf("Invalid data (data not hex) in call %u", i));
+        if(strAddr.size() != 40 || !CheckHex(strAddr))
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("Incorrect address in call %u", i));
+
+        calls[i].address = dev::Address(strAddr);
+        calls[i].data = ParseHex(data);
+        if(!find_value(param, "sender").isNull())
+            calls[i].sender = parseSenderAddress(find_value(param, "sender").get_str());
+        calls[i].gasLimit = parseUInt64(find_value(param, "gasLimit"), 0);
+    }
+
+    int nThreads = request.params.size() > 1 ? request.params[1].get_int() : 1;
+    if(nThreads < 1 || nThreads > GetNumCores())
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid threads, must be between 1 and %d", GetNumCores()));
+
+    ContractStateSnapshot snapshot;
+    {
+        LOCK(cs_main);
+        if(!GetContractStateSnapshot(snapshot))
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Contract state not available");
+    }
+
+    std::vector<ResultExecute> execResults = CallContractBatch(snapshot, calls, nThreads);
+
+    if(fRecordLogOpcodes){
+        LOCK(cs_main);
+        writeVMlog(execResults);
+    }
+
+    UniValue results(UniValue::VARR);
+    for(size_t i = 0; i < execResults.size(); i++){
+        UniValue result(UniValue::VOBJ);
+        result.push_back(Pair("address", calls[i].address.hex()));
+        // Calls to an unused address are not executed and have no receipt
+        if(execResults[i].txRec.stateRoot() == dev::h256()){
+            result.push_back(Pair("error", "Address does not exist"));
+        }else{
+            result.push_back(Pair("executionResult", executionResultToJSON(execResults[i].execRes)));
+            result.push_back(Pair("transactionReceipt", transactionReceiptToJSON(execResults[i].txRec)));
+        }
+        results.push_back(result);
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("blockNumber", (uint64_t)snapshot.env.number() - 1));
+    result.push_back(Pair("results", results));
+    return result;
+}
+
 void assignJSON(UniValue& entry, const TransactionReceiptInfo& resExec) {
     entry.push_back(Pair("blockHash", resExec.blockHash.GetHex()));
     entry.push_back(Pair("blockNumber", uint64_t(resExec.blockNumber)));
@@ -1310,12 +1439,12 @@ UniValue waitforlogs(const JSONRPCRequest& request_) {
     auto& addresses = params.addresses;
     auto& filterTopics = params.topics;
 
+    // Every topic of the filter has to be in a log, so blocks missing any of them are skipped
+    EventFilter filter(addresses, filterTopics, true);
+
     while (curheight == 0) {
-        {
-            LOCK(cs_main);
-            curheight = pblocktree->ReadHeightIndex(params.fromBlock, params.toBlock, params.minconf,
-                    hashesToBlock, addresses);
-        }
+        curheight = peventindex->search(params.fromBlock, params.toBlock, params.minconf,
+                filter, hashesToBlock);
 
         // if curheight >= fromBlock. Blockchain extended with new log entries. Return next block height to client.
         //    nextBlock = curheight + 1
@@ -1355,8 +1484,6 @@ UniValue waitforlogs(const JSONRPCRequest& request_) {
         }
     }
 
-    LOCK(cs_main);
-
     UniValue jsonLogs(UniValue::VARR);
 
     for (const auto& txHashes : hashesToBlock) {
@@ -1411,6 +1538,145 @@ UniValue waitforlogs(const JSONRPCRequest& request_) {
     return result;
 }
 
+UniValue subscribelogs(const JSONRPCRequest& request) {
+    if (request.fHelp || request.params.size() > 1) {
+        throw std::runtime_error(
+                "subscribelogs (filter)\n"
+                "requires -logevents to be enabled\n"
+                "\nRegisters a log subscription. The logs of every connected block are matched once against all subscriptions,\n"
+                "and the matching entries are queued until they are fetched with `polllogs`.\n"
+                "A subscription that is not polled for 10 minutes is removed.\n"
+                "\nArguments:\n"
+                "1. filter    ({ addresses?: Hex160String[], topics?: Hex256String[] }, optional default={}) Filter conditions for logs, same as in `waitforlogs`\n"
+                "\nResult:\n"
+                "{\n"
+                "  \"id\": n,        (numeric) The subscription id to pass to polllogs and unsubscribelogs\n"
+                "  \"cursor\": n     (numeric) The cursor of the first log of the subscription\n"
+                "}\n"
+                "\nExamples:\n"
+                + HelpExampleCli("subscribelogs", "'{\"addresses\": [\"12ae42729af478ca92c8c66773a3e32115717be4\"]}'")
+                + HelpExampleRpc("subscribelogs", "{\"addresses\": [\"12ae42729af478ca92c8c66773a3e32115717be4\"]}")
+                );
+    }
+
+    if (!fLogEvents)
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Events indexing disabled");
+
+    LogFilter filter;
+    if (!request.params[0].isNull()) {
+        parseParam(request.params[0]["addresses"], filter.addresses);
+        parseParam(request.params[0]["topics"], filter.topics);
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("id", plogsubscriptions->subscribe(filter)));
+    result.push_back(Pair("cursor", 0));
+    return result;
+}
+
+UniValue polllogs(const JSONRPCRequest& request_) {
+    // this is a long poll function. force cast to non const pointer
+    JSONRPCRequest& request = (JSONRPCRequest&) request_;
+
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3) {
+        throw std::runtime_error(
+                "polllogs id (cursor) (timeout)\n"
+                "requires -logevents to be enabled\n"
+                "\nReturns the logs of a subscription at or after cursor, waiting for them if there are none yet.\n"
+                "Logs before cursor are released, so polling again with the same cursor returns the same logs.\n"
+                "Logs of disconnected blocks are returned again with \"removed\" set to true.\n"
+                "\nArguments:\n"
+                "1. id        (numeric, required) The subscription id returned by subscribelogs\n"
+                "2. cursor    (numeric, optional, default=0) The cursor returned by the previous call\n"
+                "3. timeout   (numeric, optional, default=60) Seconds to wait for logs, at most 600\n"
+                "\nResult:\n"
+                "{\n"
+                "  \"entries\": [...], (array) The logs, in the format of waitforlogs with an additional \"removed\" field\n"
+                "  \"count\": n,       (numeric) The number of entries\n"
+                "  \"cursor\": n,      (numeric) The cursor to pass to the next call\n"
+                "  \"dropped\": n      (numeric) Logs after cursor that were discarded because the subscription was not polled in time\n"
+                "}\n"
+                "\nExamples:\n"
+                + HelpExampleCli("polllogs", "1 0 60")
+                + HelpExampleRpc("polllogs", "1, 0, 60")
+                );
+    }
+
+    if (!fLogEvents)
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Events indexing disabled");
+
+    uint64_t id = parseUInt64(request.params[0], 0);
+    uint64_t cursor = parseUInt64(request.params[1], 0);
+    int64_t timeout = std::min<uint64_t>(parseUInt64(request.params[2], 60), 600);
+
+    bool fAlive = true;
+    auto alive = [&request, &fAlive]() {
+        request.PollPing();
+        fAlive = request.PollAlive() && IsRPCRunning();
+        return fAlive;
+    };
+
+    std::vector<ContractLog> logs;
+    uint64_t nextCursor = cursor;
+    uint64_t dropped = 0;
+    if (!plogsubscriptions->poll(id, cursor, std::chrono::seconds(0), alive, logs, nextCursor, dropped)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown subscription");
+    }
+
+    // Nothing queued yet, wait for the next blocks without re-reading anything
+    if (logs.empty() && timeout > 0) {
+        request.PollStart();
+
+        uint64_t droppedMeanwhile = 0;
+        if (!plogsubscriptions->poll(id, nextCursor, std::chrono::seconds(timeout), alive, logs, nextCursor, droppedMeanwhile)) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown subscription");
+        }
+        dropped += droppedMeanwhile;
+
+        if (!fAlive) {
+            LogPrintf("polllogs client disconnected\n");
+            return NullUniValue;
+        }
+    }
+
+    UniValue jsonLogs(UniValue::VARR);
+    for (const ContractLog& log : logs) {
+        UniValue jsonLog(UniValue::VOBJ);
+
+        assignJSON(jsonLog, *log.receipt);
+        assignJSON(jsonLog, log.log(), false);
+        jsonLog.push_back(Pair("removed", log.removed));
+
+        jsonLogs.push_back(jsonLog);
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("entries", jsonLogs));
+    result.push_back(Pair("count", (int) jsonLogs.size()));
+    result.push_back(Pair("cursor", nextCursor));
+    result.push_back(Pair("dropped", dropped));
+
+    return result;
+}
+
+UniValue unsubscribelogs(const JSONRPCRequest& request) {
+    if (request.fHelp || request.params.size() != 1) {
+        throw std::runtime_error(
+                "unsubscribelogs id\n"
+                "\nRemoves a log subscription.\n"
+                "\nArguments:\n"
+                "1. id        (numeric, required) The subscription id returned by subscribelogs\n"
+                "\nResult:\n"
+                "true|false   (boolean) If the subscription existed\n"
+                "\nExamples:\n"
+                + HelpExampleCli("unsubscribelogs", "1")
+                + HelpExampleRpc("unsubscribelogs", "1")
+                );
+    }
+
+    return plogsubscriptions->unsubscribe(parseUInt64(request.params[0], 0));
+}
+
 class SearchLogsParams {
 public:
     size_t fromBlock;
@@ -1472,14 +1738,14 @@ UniValue searchlogs(const JSONRPCRequest& request)
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Events indexing disabled");
 
     int curheight = 0;
-    
-    LOCK(cs_main);
 
     SearchLogsParams params(request.params);
     
     std::vector<std::vector<uint256>> hashesToBlock;
 
-    curheight = pblocktree->ReadHeightIndex(params.fromBlock, params.toBlock, params.minconf, hashesToBlock, params.addresses);
+    // The event index is read from a snapshot of its own database, without cs_main
+    curheight = peventindex->search(params.fromBlock, params.toBlock, params.minconf,
+            EventFilter(params.addresses, params.topics, false), hashesToBlock);
 
     if (curheight == -1) {
         throw JSONRPCError(RPC_INVALID_PARAMETER, "Incorrect params");
@@ -1736,6 +2002,108 @@ UniValue pruneblockchain(const JSONRPCRequest& request)
     return uint64_t(height);
 }
 
+UniValue dumpstatesnapshot(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            "dumpstatesnapshot \"path\"\n"
+            "\nWrite the coins, contract accounts with their code and storage, and UTXO trie of the tip to a file,\n"
+            "which a new node can load with loadstatesnapshot instead of syncing the blocks below it.\n"
+            "Note this call may take some time.\n"
+            "\nArguments:\n"
+            "1. \"path\"       (string, required) The file to write, relative to the data directory. It must not exist yet.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"blockhash\": \"hash\",     (string) The block the snapshot was taken at\n"
+            "  \"height\": n,             (numeric) The height of the block\n"
+            "  \"hashStateRoot\": \"hash\", (string) The root of the contract state trie of the block\n"
+            "  \"hashUTXORoot\": \"hash\",  (string) The root of the UTXO trie of the block\n"
+            "  \"accounts\": n,           (numeric) The number of contract accounts\n"
+            "  \"storage\": n,            (numeric) The number of storage slots\n"
+            "  \"vins\": n,               (numeric) The number of UTXO trie entries\n"
+            "  \"coins\": n,              (numeric) The number of unspent transaction outputs\n"
+            "  \"coins_hash\": \"hash\",    (string) The hash of the coins, to pass to loadstatesnapshot\n"
+            "  \"path\": \"path\"           (string) The absolute path of the file\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("dumpstatesnapshot", "\"state.dat\"")
+            + HelpExampleRpc("dumpstatesnapshot", "\"state.dat\""));
+
+    fs::path path = fs::absolute(request.params[0].get_str(), GetDataDir());
+    if (fs::exists(path))
+        throw JSONRPCError(RPC_INVALID_PARAMETER, path.string() + " already exists");
+
+    StateSnapshotHeader header;
+    StateSnapshotStats stats;
+    std::string error;
+    if (!DumpStateSnapshot(path, header, stats, error))
+        throw JSONRPCError(RPC_MISC_ERROR, error);
+
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("blockhash", header.hashBlock.GetHex()));
+    result.push_back(Pair("height", header.nHeight));
+    result.push_back(Pair("hashStateRoot", header.hashStateRoot.GetHex()));
+    result.push_back(Pair("hashUTXORoot", header.hashUTXORoot.GetHex()));
+    result.push_back(Pair("accounts", stats.nAccounts));
+    result.push_back(Pair("storage", stats.nStorage));
+    result.push_back(Pair("vins", stats.nVins));
+    result.push_back(Pair("coins", stats.nCoins));
+    result.push_back(Pair("coins_hash", stats.hashCoins.GetHex()));
+    result.push_back(Pair("path", path.string()));
+    return result;
+}
+
+UniValue loadstatesnapshot(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 2 || request.params.size() > 3)
+        throw std::runtime_error(
+            "loadstatesnapshot \"path\" \"coins_hash\" ( threads )\n"
+            "\nLoad a snapshot written by dumpstatesnapshot and make its block the tip, on a node that has synced the headers\n"
+            "but not connected blocks past genesis. The contract state is checked against the roots of the block header.\n"
+            "The blocks below the snapshot are not downloaded, like on a pruned node.\n"
+            "Note this call may take some time.\n"
+            "\nArguments:\n"
+            "1. \"path\"         (string, required) The snapshot file, relative to the data directory\n"
+            "2. \"coins_hash\"   (string, required) The coins_hash returned by dumpstatesnapshot on a trusted node.\n"
+            "                  The coins can not be checked against the block, so the snapshot is only loaded if they match it.\n"
+            "3. threads        (numeric, optional, default=number of cores) Threads to build the storage tries on\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"blockhash\": \"hash\",     (string) The new tip\n"
+            "  \"height\": n,             (numeric) The height of the new tip\n"
+            "  \"accounts\": n,           (numeric) The number of contract accounts\n"
+            "  \"storage\": n,            (numeric) The number of storage slots\n"
+            "  \"vins\": n,               (numeric) The number of UTXO trie entries\n"
+            "  \"coins\": n,              (numeric) The number of unspent transaction outputs\n"
+            "  \"coins_hash\": \"hash\"     (string) The hash of the loaded coins\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("loadstatesnapshot", "\"state.dat\" \"hash\"")
+            + HelpExampleRpc("loadstatesnapshot", "\"state.dat\", \"hash\", 4"));
+
+    fs::path path = fs::absolute(request.params[0].get_str(), GetDataDir());
+    uint256 hashCoins = ParseHashV(request.params[1], "coins_hash");
+    int nThreads = request.params.size() > 2 ? request.params[2].get_int() : GetNumCores();
+    if (nThreads < 1 || nThreads > GetNumCores())
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid threads, must be between 1 and %d", GetNumCores()));
+
+    StateSnapshotHeader header;
+    StateSnapshotStats stats;
+    std::string error;
+    if (!LoadStateSnapshot(path, hashCoins, nThreads, header, stats, error))
+        throw JSONRPCError(RPC_MISC_ERROR, error);
+
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("blockhash", header.hashBlock.GetHex()));
+    result.push_back(Pair("height", header.nHeight));
+    result.push_back(Pair("accounts", stats.nAccounts));
+    result.push_back(Pair("storage", stats.nStorage));
+    result.push_back(Pair("vins", stats.nVins));
+    result.push_back(Pair("coins", stats.nCoins));
+    result.push_back(Pair("coins_hash", stats.hashCoins.GetHex()));
+    return result;
+}
+
 UniValue gettxoutsetinfo(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 0)
@@ -2394,6 +2762,8 @@ static const CRPCCommand commands[] =
     { "blockchain",         "gettxout",               &gettxout,               true,  {"txid","n","include_mempool"} },
     { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        true,  {} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        true,  {"height"} },
+    { "blockchain",         "dumpstatesnapshot",      &dumpstatesnapshot,      true,  {"path"} },
+    { "blockchain",         "loadstatesnapshot",      &loadstatesnapshot,      true,  {"path","coins_hash","threads"} },
     { "blockchain",         "verifychain",            &verifychain,            true,  {"checklevel","nblocks"} },
     { "blockchain",         "getaccountinfo",         &getaccountinfo,         true,  {"contract_address"} },
     { "blockchain",         "getstorage",             &getstorage,             true,  {"address, index, blockNum"} },
@@ -2401,6 +2771,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "preciousblock",          &preciousblock,          true,  {"blockhash"} },
 
     { "blockchain",         "callcontract",           &callcontract,           true,  {"address","data"} },
+    { "blockchain",         "callcontractbatch",      &callcontractbatch,      true,  {"calls","threads"} },
     /* Not shown in help */
     { "hidden",             "invalidateblock",        &invalidateblock,        true,  {"blockhash"} },
     { "hidden",             "reconsiderblock",        &reconsiderblock,        true,  {"blockhash"} },
@@ -2412,6 +2783,9 @@ static const CRPCCommand commands[] =
     { "blockchain",         "searchlogs",             &searchlogs,             true,  {"fromBlock", "toBlock", "address", "topics"} },
 
     { "blockchain",         "waitforlogs",            &waitforlogs,            true,  {"fromBlock", "nblocks", "address", "topics"} },
+    { "blockchain",         "subscribelogs",          &subscribelogs,          true,  {"filter"} },
+    { "blockchain",         "polllogs",               &polllogs,               true,  {"id", "cursor", "timeout"} },
+    { "blockchain",         "unsubscribelogs",        &unsubscribelogs,        true,  {"id"} },
 };
 
 void RegisterBlockchainRPCCommands(CRPCTable &t)
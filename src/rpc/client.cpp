@@ -92,6 +92,9 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getblockhashes", 1, "low"},
     { "getblockhashes", 2, "options"},
     { "getspentinfo", 0, "argument"},
+    { "callcontractbatch", 0, "calls"},
+    { "callcontractbatch", 1, "threads"},
+    { "loadstatesnapshot", 2, "threads"},
     { "searchlogs", 0, "fromBlock"},
     { "searchlogs", 1, "toBlock"},
     { "searchlogs", 2, "address"},
@@ -100,6 +103,11 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "waitforlogs", 1, "txlimit"},
     { "waitforlogs", 2, "address"},
     { "waitforlogs", 3, "topics"},
+    { "subscribelogs", 0, "filter"},
+    { "polllogs", 0, "id"},
+    { "polllogs", 1, "cursor"},
+    { "polllogs", 2, "timeout"},
+    { "unsubscribelogs", 0, "id"},
     //////////////////////////////////////////////////
     { "createmultisig", 0, "nrequired" },
     { "createmultisig", 1, "keys" },
@@ -152,6 +160,10 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getmempoolancestors", 1, "verbose" },
     { "getmempooldescendants", 1, "verbose" },
     { "bumpfee", 1, "options" },
+    { "getevmprofile", 0, "reset" },
+    { "getevmprofile", 1, "count" },
+    { "setevmprofile", 0, "enabled" },
+    { "setevmprofile", 1, "sampleperiod" },
     { "logging", 0, "include" },
     { "logging", 1, "exclude" },
     { "disconnectnode", 1, "nodeid" },
@@ -164,6 +176,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "sendtocontract", 4, "gasPrice" },
     { "sendtocontract", 6, "broadcast" },
     { "sendtocontract", 7, "changeToSender" },
+    { "liststakingcoins", 0, "count" },
     { "reservebalance", 0, "reserve"},
     { "reservebalance", 1, "amount"},
     { "listcontracts", 0, "start" },
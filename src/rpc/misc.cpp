@@ -31,6 +31,8 @@
 
 #include <univalue.h>
 
+#include <libevm/EVMProfiler.h>
+
 /**
  * @note Do not add or change anything in the information returned by this
  * method. `getinfo` exists for backwards-compatibility only. It combines
@@ -641,6 +643,147 @@ UniValue logging(const JSONRPCRequest& request)
     return result;
 }
 
+UniValue setevmprofile(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+            "setevmprofile enabled ( sampleperiod )\n"
+            "\nSwitches the EVM profiler on or off. The collected profile is kept, getevmprofile reads and resets it.\n"
+            "\nArguments:\n"
+            "1. enabled           (boolean, required) Whether to profile the contracts executed from now on\n"
+            "2. sampleperiod      (numeric, optional, default=" + std::to_string(dev::eth::EVMProfiler::c_defaultSamplePeriod) + ") Measure the wall time of one instruction in sampleperiod\n"
+            "\nExamples:\n"
+            + HelpExampleCli("setevmprofile", "true")
+            + HelpExampleRpc("setevmprofile", "true, 16")
+        );
+
+    unsigned samplePeriod = dev::eth::EVMProfiler::c_defaultSamplePeriod;
+    if (request.params.size() > 1 && !request.params[1].isNull()) {
+        int n = request.params[1].get_int();
+        if (n < 1)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid sampleperiod, must be at least 1");
+        samplePeriod = n;
+    }
+    dev::eth::EVMProfiler::setEnabled(request.params[0].get_bool(), samplePeriod);
+    return NullUniValue;
+}
+
+UniValue getevmprofile(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 2)
+        throw std::runtime_error(
+            "getevmprofile ( reset count )\n"
+            "\nReturns the instructions, gas and wall time spent by the EVM since the profile was last reset, per opcode and per contract.\n"
+            "The profiler is switched on by -evmprofile or setevmprofile. Instruction counts and gas are exact, instruction times are\n"
+            "extrapolated from one sampled instruction in sampleperiod. Times are in nanoseconds.\n"
+            "\nArguments:\n"
+            "1. reset             (boolean, optional, default=false) Clear the profile after reading it\n"
+            "2. count             (numeric, optional, default=20) Number of contracts to return, the ones with the most time first\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"enabled\": true|false,         (boolean) Whether the profiler is running\n"
+            "  \"sampleperiod\": n,             (numeric) Instructions per timed instruction\n"
+            "  \"frames\": n,                   (numeric) Number of contract executions, including calls and creates\n"
+            "  \"steps\": n,                    (numeric) Number of instructions\n"
+            "  \"sload\": n,                    (numeric) Number of SLOAD instructions\n"
+            "  \"sstore\": n,                   (numeric) Number of SSTORE instructions\n"
+            "  \"opcodes\": [                   (array) Opcodes executed, the ones with the most time first\n"
+            "    {\n"
+            "      \"opcode\": \"name\",          (string) Opcode, or superinstruction of the optimized interpreter\n"
+            "      \"count\": n,                (numeric) Number of executions\n"
+            "      \"gas\": n,                  (numeric) Gas charged, for calls and creates the gas given to the callee\n"
+            "      \"samples\": n,              (numeric) Number of timed executions\n"
+            "      \"avgtime\": n,              (numeric) Average time of the timed executions\n"
+            "      \"time\": n                  (numeric) Estimated time of all the executions\n"
+            "    }, ...\n"
+            "  ],\n"
+            "  \"contracts\": [                 (array) Contracts executed, the ones with the most time first\n"
+            "    {\n"
+            "      \"address\": \"hex\",          (string) Contract address\n"
+            "      \"frames\": n,               (numeric) Number of executions\n"
+            "      \"steps\": n,                (numeric) Number of instructions\n"
+            "      \"gas\": n,                  (numeric) Gas charged by the instructions\n"
+            "      \"time\": n,                 (numeric) Time spent in its code, without the contracts it called\n"
+            "      \"sload\": n,                (numeric) Number of SLOAD instructions\n"
+            "      \"sstore\": n                (numeric) Number of SSTORE instructions\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getevmprofile", "")
+            + HelpExampleCli("getevmprofile", "true 5")
+            + HelpExampleRpc("getevmprofile", "false, 10")
+        );
+
+    bool fReset = request.params.size() > 0 && !request.params[0].isNull() && request.params[0].get_bool();
+    int count = 20;
+    if (request.params.size() > 1 && !request.params[1].isNull()) {
+        count = request.params[1].get_int();
+        if (count < 0)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid count, must be non-negative");
+    }
+
+    dev::eth::EVMProfile profile = dev::eth::EVMProfiler::snapshot();
+    if (fReset)
+        dev::eth::EVMProfiler::reset();
+
+    std::vector<std::pair<uint64_t, unsigned>> opcodes;
+    uint64_t steps = 0;
+    for (unsigned op = 0; op < profile.opcodes.size(); op++) {
+        if (profile.opcodes[op].count) {
+            opcodes.push_back(std::make_pair(profile.opcodes[op].estimatedNanos(), op));
+            steps += profile.opcodes[op].count;
+        }
+    }
+    std::sort(opcodes.begin(), opcodes.end(), std::greater<std::pair<uint64_t, unsigned>>());
+
+    UniValue opcodesArr(UniValue::VARR);
+    for (const std::pair<uint64_t, unsigned>& entry : opcodes) {
+        const dev::eth::OpcodeProfile& op = profile.opcodes[entry.second];
+        std::string name = dev::eth::instructionInfo(dev::eth::Instruction(entry.second)).name;
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("opcode", name.empty() ? strprintf("0x%02x", entry.second) : name));
+        obj.push_back(Pair("count", op.count));
+        obj.push_back(Pair("gas", op.gas));
+        obj.push_back(Pair("samples", op.samples));
+        obj.push_back(Pair("avgtime", op.samples ? op.sampledNanos / op.samples : 0));
+        obj.push_back(Pair("time", entry.first));
+        opcodesArr.push_back(obj);
+    }
+
+    std::vector<std::pair<uint64_t, dev::Address>> contracts;
+    for (const auto& contract : profile.contracts)
+        contracts.push_back(std::make_pair(contract.second.nanos, contract.first));
+    std::sort(contracts.begin(), contracts.end(), std::greater<std::pair<uint64_t, dev::Address>>());
+    if (contracts.size() > (size_t)count)
+        contracts.resize(count);
+
+    UniValue contractsArr(UniValue::VARR);
+    for (const std::pair<uint64_t, dev::Address>& entry : contracts) {
+        const dev::eth::ContractProfile& contract = profile.contracts[entry.second];
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("address", entry.second.hex()));
+        obj.push_back(Pair("frames", contract.frames));
+        obj.push_back(Pair("steps", contract.steps));
+        obj.push_back(Pair("gas", contract.gas));
+        obj.push_back(Pair("time", contract.nanos));
+        obj.push_back(Pair("sload", contract.sloads));
+        obj.push_back(Pair("sstore", contract.sstores));
+        contractsArr.push_back(obj);
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("enabled", dev::eth::EVMProfiler::enabled()));
+    result.push_back(Pair("sampleperiod", (uint64_t)dev::eth::EVMProfiler::samplePeriod()));
+    result.push_back(Pair("frames", profile.frames));
+    result.push_back(Pair("steps", steps));
+    result.push_back(Pair("sload", profile.opcodes[(size_t)dev::eth::Instruction::SLOAD].count));
+    result.push_back(Pair("sstore", profile.opcodes[(size_t)dev::eth::Instruction::SSTORE].count));
+    result.push_back(Pair("opcodes", opcodesArr));
+    result.push_back(Pair("contracts", contractsArr));
+    return result;
+}
+
 UniValue echo(const JSONRPCRequest& request)
 {
     if (request.fHelp)
@@ -659,6 +802,8 @@ static const CRPCCommand commands[] =
   //  --------------------- ------------------------  -----------------------  ----------
     { "control",            "getinfo",                &getinfo,                true,  {} }, /* uses wallet if enabled */
     { "control",            "getmemoryinfo",          &getmemoryinfo,          true,  {"mode"} },
+    { "control",            "getevmprofile",          &getevmprofile,          true,  {"reset","count"} },
+    { "control",            "setevmprofile",          &setevmprofile,          true,  {"enabled","sampleperiod"} },
     { "util",               "validateaddress",        &validateaddress,        true,  {"address"} }, /* uses wallet if enabled */
     { "util",               "createmultisig",         &createmultisig,         true,  {"nrequired","keys"} },
     { "util",               "verifymessage",          &verifymessage,          true,  {"address","signature","message"} },
@@ -0,0 +1,235 @@
+#include <silubium/eventindex.h>
+#include <util.h>
+#include <libdevcore/RLP.h>
+#include <leveldb/write_batch.h>
+
+#include <algorithm>
+
+static const char DB_EVENT_BLOCK = 'B';
+static const char DB_EVENT_RANGE = 'R';
+static const std::string DB_EVENT_TIP = "t";
+static const std::string DB_EVENT_BUILT = "v";
+
+EventIndex *peventindex = nullptr;
+
+static std::string heightKey(char prefix, unsigned int height){
+    std::string key(1, prefix);
+    for(int i = 3; i >= 0; i--)
+        key.push_back((char)(height >> (i * 8)));
+    return key;
+}
+
+static bool isHeightKey(char prefix, leveldb::Slice const& key){
+    return key.size() == 5 && key[0] == prefix;
+}
+
+static unsigned int decodeHeight(leveldb::Slice const& key){
+    unsigned int height = 0;
+    for(size_t i = key.size() - 4; i < key.size(); i++)
+        height = (height << 8) | (unsigned char)key[i];
+    return height;
+}
+
+static unsigned int rangeStart(unsigned int height){
+    return height - height % EVENT_INDEX_RANGE;
+}
+
+static std::string encodeRange(dev::eth::LogBloom const& bloom, unsigned int lastHeight){
+    dev::RLPStream stream(2);
+    stream << bloom << lastHeight;
+    return std::string(stream.out().begin(), stream.out().end());
+}
+
+/** Read options pinned to a snapshot for as long as they are in scope */
+struct EventIndexSnapshot{
+    leveldb::DB* db;
+    leveldb::ReadOptions options;
+
+    EventIndexSnapshot(leveldb::DB* _db) : db(_db) { options.snapshot = db->GetSnapshot(); }
+    ~EventIndexSnapshot() { db->ReleaseSnapshot(options.snapshot); }
+};
+
+void EventIndexBlock::add(dev::h160 const& _contract, std::vector<uint256> const& _hashes){
+    bloom.shiftBloom<3>(dev::sha3(_contract.ref()));
+    contracts.push_back(std::make_pair(_contract, _hashes));
+}
+
+EventFilter::EventFilter(std::set<dev::h160> const& _addresses, std::vector<boost::optional<dev::h256>> const& _topics, bool _allTopics) :
+        addresses(_addresses), allTopics(_allTopics){
+    for(dev::h160 const& address : addresses)
+        addressBlooms.push_back(dev::eth::LogBloom().shiftBloom<3>(dev::sha3(address.ref())));
+    for(boost::optional<dev::h256> const& topic : _topics){
+        if(topic)
+            topicBlooms.push_back(dev::eth::LogBloom().shiftBloom<3>(dev::sha3(topic->ref())));
+    }
+}
+
+bool EventFilter::matches(dev::eth::LogBloom const& _bloom) const{
+    auto contained = [&_bloom](dev::eth::LogBloom const& part){ return _bloom.contains(part); };
+    if(!addressBlooms.empty() && std::none_of(addressBlooms.begin(), addressBlooms.end(), contained))
+        return false;
+    if(topicBlooms.empty())
+        return true;
+    if(allTopics)
+        return std::all_of(topicBlooms.begin(), topicBlooms.end(), contained);
+    return std::any_of(topicBlooms.begin(), topicBlooms.end(), contained);
+}
+
+EventIndex::EventIndex(std::string const& _path){
+    path = _path + "/eventsDB";
+    options.create_if_missing = true;
+    leveldb::Status status = leveldb::DB::Open(options, path, &db);
+    assert(status.ok());
+    LogPrintf("Opened event index in %s\n", path);
+}
+
+EventIndex::~EventIndex()
+{
+    delete db;
+    db = NULL;
+}
+
+bool EventIndex::writeBlock(unsigned int height, EventIndexBlock const& block){
+    leveldb::WriteBatch batch;
+    if(!block.contracts.empty()){
+        dev::RLPStream stream(2);
+        stream << block.bloom;
+        stream.appendList(block.contracts.size());
+        for(auto const& contract : block.contracts){
+            stream.appendList(2) << contract.first;
+            stream.appendList(contract.second.size());
+            for(uint256 const& hash : contract.second)
+                stream << uintToh256(hash);
+        }
+        batch.Put(heightKey(DB_EVENT_BLOCK, height), std::string(stream.out().begin(), stream.out().end()));
+
+        dev::eth::LogBloom rangeBloom = block.bloom;
+        unsigned int lastHeight = height;
+        std::string value;
+        if(db->Get(leveldb::ReadOptions(), heightKey(DB_EVENT_RANGE, rangeStart(height)), &value).ok()){
+            dev::RLP range(value);
+            rangeBloom |= range[0].toHash<dev::eth::LogBloom>();
+            lastHeight = std::max(lastHeight, range[1].toInt<unsigned int>());
+        }
+        batch.Put(heightKey(DB_EVENT_RANGE, rangeStart(height)), encodeRange(rangeBloom, lastHeight));
+    }
+    batch.Put(DB_EVENT_TIP, heightKey(DB_EVENT_TIP[0], height));
+    return db->Write(leveldb::WriteOptions(), &batch).ok();
+}
+
+bool EventIndex::eraseBlock(unsigned int height){
+    leveldb::WriteBatch batch;
+    std::string value;
+    if(db->Get(leveldb::ReadOptions(), heightKey(DB_EVENT_BLOCK, height), &value).ok()){
+        batch.Delete(heightKey(DB_EVENT_BLOCK, height));
+
+        // The range bloom keeps the bits of the erased block, which only costs a false positive
+        std::string rangeKey = heightKey(DB_EVENT_RANGE, rangeStart(height));
+        std::string rangeValue;
+        if(db->Get(leveldb::ReadOptions(), rangeKey, &rangeValue).ok() && dev::RLP(rangeValue)[1].toInt<unsigned int>() == height){
+            std::unique_ptr<leveldb::Iterator> it(db->NewIterator(leveldb::ReadOptions()));
+            it->Seek(heightKey(DB_EVENT_BLOCK, height));
+            if(it->Valid())
+                it->Prev();
+            if(it->Valid() && isHeightKey(DB_EVENT_BLOCK, it->key()) && decodeHeight(it->key()) >= rangeStart(height))
+                batch.Put(rangeKey, encodeRange(dev::RLP(rangeValue)[0].toHash<dev::eth::LogBloom>(), decodeHeight(it->key())));
+            else
+                batch.Delete(rangeKey);
+        }
+    }
+    if(height > 0)
+        batch.Put(DB_EVENT_TIP, heightKey(DB_EVENT_TIP[0], height - 1));
+    else
+        batch.Delete(DB_EVENT_TIP);
+    return db->Write(leveldb::WriteOptions(), &batch).ok();
+}
+
+int EventIndex::search(int low, int high, int minconf, EventFilter const& filter, std::vector<std::vector<uint256>>& blocksOfHashes){
+
+    if ((high < low && high > -1) || (high == 0 && low == 0) || (high < -1 || low < 0)) {
+       return -1;
+    }
+
+    EventIndexSnapshot snapshot(db);
+
+    int tip = readHeight(snapshot.options, DB_EVENT_TIP);
+    if(high == -1 || high > tip)
+        high = tip;
+    if(minconf > 0)
+        high = std::min(high, tip - minconf);
+
+    int curheight = 0;
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(snapshot.options));
+    for(int start = rangeStart(low); start <= high; start += EVENT_INDEX_RANGE){
+        int end = start + EVENT_INDEX_RANGE - 1;
+        std::string value;
+        if(!db->Get(snapshot.options, heightKey(DB_EVENT_RANGE, start), &value).ok())
+            continue;
+
+        dev::RLP range(value);
+        if(start >= low && end <= high && !filter.matches(range[0].toHash<dev::eth::LogBloom>())){
+            curheight = range[1].toInt<unsigned int>();
+            continue;
+        }
+
+        for(it->Seek(heightKey(DB_EVENT_BLOCK, std::max(low, start))); it->Valid(); it->Next()){
+            if(!isHeightKey(DB_EVENT_BLOCK, it->key()))
+                break;
+            int height = decodeHeight(it->key());
+            if(height > std::min(high, end))
+                break;
+
+            curheight = height;
+
+            EventIndexBlock block;
+            decodeBlock(it->value().ToString(), block);
+            if(!filter.matches(block.bloom))
+                continue;
+
+            for(auto const& contract : block.contracts){
+                if(filter.getAddresses().empty() || filter.getAddresses().count(contract.first))
+                    blocksOfHashes.push_back(contract.second);
+            }
+        }
+    }
+
+    return curheight;
+}
+
+bool EventIndex::isBuilt(){
+    std::string value;
+    return db->Get(leveldb::ReadOptions(), DB_EVENT_BUILT, &value).ok();
+}
+
+void EventIndex::setBuilt(){
+    leveldb::Status status = db->Put(leveldb::WriteOptions(), DB_EVENT_BUILT, "1");
+    assert(status.ok());
+}
+
+void EventIndex::wipe(){
+    LogPrintf("Wiping event index in %s\n", path);
+    leveldb::WriteBatch batch;
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(leveldb::ReadOptions()));
+    for(it->SeekToFirst(); it->Valid(); it->Next())
+        batch.Delete(it->key());
+    leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+    assert(status.ok());
+}
+
+void EventIndex::decodeBlock(std::string const& _value, EventIndexBlock& _block){
+    dev::RLP state(_value);
+    _block.bloom = state[0].toHash<dev::eth::LogBloom>();
+    for(dev::RLP const& contract : state[1]){
+        std::vector<uint256> hashes;
+        for(dev::h256 const& hash : contract[1].toVector<dev::h256>())
+            hashes.push_back(h256Touint(hash));
+        _block.contracts.push_back(std::make_pair(contract[0].toHash<dev::h160>(), hashes));
+    }
+}
+
+int EventIndex::readHeight(leveldb::ReadOptions const& _options, std::string const& _key){
+    std::string value;
+    if(!db->Get(_options, _key, &value).ok() || value.size() != 5)
+        return -1;
+    return decodeHeight(value);
+}
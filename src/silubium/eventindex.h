@@ -0,0 +1,93 @@
+#pragma once
+
+#include <uint256.h>
+#include <libethcore/Common.h>
+#include <libevm/ExtVMFace.h>
+#include <leveldb/db.h>
+#include <boost/optional.hpp>
+
+#include <set>
+
+/** Number of consecutive blocks summarized by one range bloom of the event index */
+static const unsigned int EVENT_INDEX_RANGE = 1024;
+
+/** Contract transactions of a block, grouped by contract address like the height index */
+struct EventIndexBlock{
+    dev::eth::LogBloom bloom;
+    std::vector<std::pair<dev::h160, std::vector<uint256>>> contracts;
+
+    // Add the transactions of a contract, the blooms of their logs are or'ed into bloom separately
+    void add(dev::h160 const& _contract, std::vector<uint256> const& _hashes);
+};
+
+/** Addresses and topics a log query is restricted to */
+class EventFilter{
+
+public:
+
+    EventFilter(std::set<dev::h160> const& _addresses, std::vector<boost::optional<dev::h256>> const& _topics, bool _allTopics);
+
+    /** False if no block summarized by @a _bloom can have matching logs */
+    bool matches(dev::eth::LogBloom const& _bloom) const;
+
+    std::set<dev::h160> const& getAddresses() const { return addresses; }
+
+private:
+
+    std::set<dev::h160> addresses;
+
+    std::vector<dev::eth::LogBloom> addressBlooms;
+
+    std::vector<dev::eth::LogBloom> topicBlooms;
+
+    // Every topic has to match (waitforlogs) instead of any of them (searchlogs)
+    bool allTopics;
+};
+
+/**
+ * Log blooms of every block and of every EVENT_INDEX_RANGE blocks, next to the contract
+ * transactions of each block. Kept in its own database, so that log queries read a
+ * consistent snapshot without cs_main, and skip blocks without reading their receipts.
+ */
+class EventIndex{
+
+public:
+
+    EventIndex(std::string const& _path);
+
+    ~EventIndex();
+
+    /** Record the contract transactions of a connected block, which becomes the tip */
+    bool writeBlock(unsigned int height, EventIndexBlock const& block);
+
+    /** Remove a disconnected block, its parent becomes the tip */
+    bool eraseBlock(unsigned int height);
+
+    /**
+     * Collect the transactions of the contracts in @a filter from blocks low to high (-1 for the tip),
+     * leaving out the last minconf blocks. Returns the height of the last block with contract
+     * transactions in the range, whether or not they matched, 0 if there is none, and -1 on bad parameters.
+     */
+    int search(int low, int high, int minconf, EventFilter const& filter, std::vector<std::vector<uint256>>& blocksOfHashes);
+
+    /** False until the index has been filled with the blocks connected before it existed */
+    bool isBuilt();
+
+    void setBuilt();
+
+    void wipe();
+
+private:
+
+    static void decodeBlock(std::string const& _value, EventIndexBlock& _block);
+
+    int readHeight(leveldb::ReadOptions const& _options, std::string const& _key);
+
+    std::string path;
+
+    leveldb::DB* db;
+
+    leveldb::Options options;
+};
+
+extern EventIndex *peventindex;
@@ -0,0 +1,300 @@
+#include <silubium/flatstorage.h>
+#include <util.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libdevcore/TrieCommon.h>
+
+#include <set>
+
+static const char DB_FLAT_ACCOUNT = 'a';
+static const char DB_FLAT_SLOT = 's';
+static const char DB_FLAT_UNDO = 'u';
+static const std::string DB_FLAT_INCARNATION = "n";
+static const std::string DB_FLAT_TIP = "t";
+
+FlatStorage *pflatstorage = nullptr;
+
+static std::string accountKey(dev::Address const& address){
+    return std::string(1, DB_FLAT_ACCOUNT) + std::string((char const*)address.data(), address.size);
+}
+
+static std::string slotKey(uint64_t incarnation, dev::u256 const& key){
+    std::string ret(1, DB_FLAT_SLOT);
+    for(int i = 7; i >= 0; i--)
+        ret.push_back((char)(incarnation >> (i * 8)));
+    dev::h256 slot(key);
+    return ret + std::string((char const*)slot.data(), slot.size);
+}
+
+static uint64_t slotIncarnation(std::string const& key){
+    uint64_t incarnation = 0;
+    for(size_t i = 1; i <= 8; i++)
+        incarnation = (incarnation << 8) | (unsigned char)key[i];
+    return incarnation;
+}
+
+static std::string undoKey(unsigned int height){
+    std::string key(1, DB_FLAT_UNDO);
+    for(int i = 3; i >= 0; i--)
+        key.push_back((char)(height >> (i * 8)));
+    return key;
+}
+
+static std::string rlpString(dev::RLPStream const& stream){
+    return std::string(stream.out().begin(), stream.out().end());
+}
+
+FlatStorage::FlatStorage(std::string const& _path) : nHits(0), nMisses(0){
+    path = _path + "/flatDB";
+    options.create_if_missing = true;
+    leveldb::Status status = leveldb::DB::Open(options, path, &db);
+    assert(status.ok());
+
+    std::string value;
+    nextIncarnation = db->Get(leveldb::ReadOptions(), DB_FLAT_INCARNATION, &value).ok() ? dev::RLP(value).toInt<uint64_t>() : 1;
+    firstPendingIncarnation = nextIncarnation;
+    LogPrintf("Opened flat contract storage in %s\n", path);
+}
+
+FlatStorage::~FlatStorage()
+{
+    delete db;
+    db = NULL;
+}
+
+boost::optional<FlatStorage::FlatAccount> const& FlatStorage::account(dev::Address const& _address){
+    AssertLockHeld(cs);
+    auto it = accounts.find(_address);
+    if(it != accounts.end())
+        return it->second;
+
+    if(accounts.size() >= FLAT_STORAGE_MAX_ACCOUNTS)
+        accounts.clear();
+    boost::optional<FlatAccount>& flat = accounts[_address];
+    std::string value;
+    if(db->Get(leveldb::ReadOptions(), accountKey(_address), &value).ok()){
+        dev::RLP rlp(value);
+        flat = FlatAccount{rlp[0].toHash<dev::h256>(), rlp[1].toInt<uint64_t>(), rlp[2].toInt<uint8_t>() != 0};
+    }
+    return flat;
+}
+
+boost::optional<FlatStorage::FlatAccount> FlatStorage::pendingAccount(dev::Address const& _address){
+    AssertLockHeld(cs);
+    auto it = pendingAccounts.find(_address);
+    if(it != pendingAccounts.end())
+        return it->second;
+    return account(_address);
+}
+
+bool FlatStorage::storage(dev::Address const& _address, dev::h256 const& _storageRoot, dev::u256 const& _key, dev::u256& o_value){
+    boost::optional<FlatAccount> flat;
+    {
+        LOCK(cs);
+        flat = account(_address);
+    }
+    if(!flat || flat->storageRoot != _storageRoot){
+        nMisses++;
+        return false;
+    }
+
+    std::string value;
+    if(db->Get(leveldb::ReadOptions(), slotKey(flat->incarnation, _key), &value).ok()){
+        o_value = dev::RLP(value).toInt<dev::u256>();
+    } else if(flat->complete){
+        o_value = 0;
+    } else {
+        nMisses++;
+        return false;
+    }
+    nHits++;
+    return true;
+}
+
+void FlatStorage::noteCommitted(dev::Address const& _address, dev::eth::Account const* _account, dev::h256 const& _storageRoot){
+    LOCK(cs);
+    boost::optional<FlatAccount> flat = pendingAccount(_address);
+    if(!_account){
+        if(flat)
+            pendingAccounts[_address] = boost::none;
+        return;
+    }
+
+    if(!flat || flat->storageRoot != _account->baseRoot()){
+        // Only code reads storage, and nothing is known of a storage that is neither empty nor written
+        bool empty = _account->baseRoot() == dev::EmptyTrie;
+        if(_account->codeHash() == dev::EmptySHA3 || (!empty && _account->storageOverlay().empty())){
+            if(flat)
+                pendingAccounts[_address] = boost::none;
+            return;
+        }
+        flat = FlatAccount{_account->baseRoot(), nextIncarnation++, empty};
+    }
+
+    // The overlay also holds the slots read since the account was loaded, all of them as they are at the new root
+    for(auto const& i : _account->storageOverlay()){
+        boost::optional<std::string>& slot = pendingSlots[slotKey(flat->incarnation, i.first)];
+        if(i.second || !flat->complete)
+            slot = rlpString(dev::RLPStream() << i.second);
+        else
+            slot = boost::none;
+    }
+    flat->storageRoot = _storageRoot;
+    pendingAccounts[_address] = flat;
+}
+
+void FlatStorage::discardPending(){
+    LOCK(cs);
+    pendingAccounts.clear();
+    pendingSlots.clear();
+    firstPendingIncarnation = nextIncarnation;
+}
+
+void FlatStorage::deleteIncarnation(leveldb::WriteBatch& _batch, uint64_t _incarnation){
+    std::string prefix = slotKey(_incarnation, 0).substr(0, 9);
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(leveldb::ReadOptions()));
+    for(it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next())
+        _batch.Delete(it->key());
+}
+
+bool FlatStorage::connectBlock(unsigned int _height, uint256 const& _hash){
+    LOCK(cs);
+    leveldb::WriteBatch batch;
+    std::vector<std::pair<std::string, boost::optional<std::string>>> undo;
+    auto write = [&](std::string const& key, boost::optional<std::string> const& value, bool existed){
+        std::string old;
+        if(existed && db->Get(leveldb::ReadOptions(), key, &old).ok())
+            undo.push_back(std::make_pair(key, old));
+        else
+            undo.push_back(std::make_pair(key, boost::none));
+        if(value)
+            batch.Put(key, *value);
+        else
+            batch.Delete(key);
+    };
+
+    // The incarnations replaced by this block are still read if it is disconnected, they are deleted with its undo data
+    std::vector<uint64_t> superseded;
+    std::set<uint64_t> started;
+    for(auto const& i : pendingAccounts){
+        boost::optional<FlatAccount> old = account(i.first);
+        if(old && (!i.second || i.second->incarnation != old->incarnation))
+            superseded.push_back(old->incarnation);
+        if(i.second && i.second->incarnation >= firstPendingIncarnation)
+            started.insert(i.second->incarnation);
+    }
+
+    for(auto const& i : pendingAccounts){
+        boost::optional<std::string> value;
+        if(i.second){
+            dev::RLPStream stream(3);
+            stream << i.second->storageRoot << i.second->incarnation << (uint8_t)i.second->complete;
+            value = rlpString(stream);
+        }
+        write(accountKey(i.first), value, true);
+    }
+    for(auto const& i : pendingSlots){
+        // The slots of incarnations started by this block are new, and those replaced within the block are never read
+        uint64_t incarnation = slotIncarnation(i.first);
+        if(incarnation >= firstPendingIncarnation && !started.count(incarnation))
+            continue;
+        write(i.first, i.second, incarnation < firstPendingIncarnation);
+    }
+
+    dev::RLPStream stream(4);
+    stream << uintToh256(_hash) << uintToh256(tip());
+    stream.appendList(undo.size());
+    for(auto const& i : undo){
+        stream.appendList(3) << i.first << (uint8_t)!!i.second;
+        stream << (i.second ? *i.second : std::string());
+    }
+    stream << superseded;
+    batch.Put(undoKey(_height), rlpString(stream));
+    if(_height >= FLAT_STORAGE_UNDO_DEPTH){
+        std::string pruned;
+        if(db->Get(leveldb::ReadOptions(), undoKey(_height - FLAT_STORAGE_UNDO_DEPTH), &pruned).ok()){
+            dev::RLP rlp(pruned);
+            if(rlp.itemCount() > 3){
+                for(auto const& i : rlp[3])
+                    deleteIncarnation(batch, i.toInt<uint64_t>());
+            }
+        }
+        batch.Delete(undoKey(_height - FLAT_STORAGE_UNDO_DEPTH));
+    }
+    batch.Put(DB_FLAT_INCARNATION, rlpString(dev::RLPStream() << nextIncarnation));
+    batch.Put(DB_FLAT_TIP, std::string((char const*)_hash.begin(), _hash.size()));
+    if(!db->Write(leveldb::WriteOptions(), &batch).ok())
+        return false;
+
+    for(auto const& i : pendingAccounts){
+        if(accounts.size() >= FLAT_STORAGE_MAX_ACCOUNTS)
+            accounts.clear();
+        accounts[i.first] = i.second;
+    }
+    pendingAccounts.clear();
+    pendingSlots.clear();
+    firstPendingIncarnation = nextIncarnation;
+    return true;
+}
+
+bool FlatStorage::disconnectBlock(unsigned int _height, uint256 const& _hash){
+    LOCK(cs);
+    pendingAccounts.clear();
+    pendingSlots.clear();
+    firstPendingIncarnation = nextIncarnation;
+
+    std::string value;
+    if(tip() != _hash || !db->Get(leveldb::ReadOptions(), undoKey(_height), &value).ok() || dev::RLP(value)[0].toHash<dev::h256>() != uintToh256(_hash)){
+        LogPrintf("%s: no flat storage undo data for block %s, wiping the flat storage\n", __func__, _hash.ToString());
+        wipe();
+        return true;
+    }
+
+    dev::RLP rlp(value);
+    leveldb::WriteBatch batch;
+    for(auto const& i : rlp[2]){
+        if(i[1].toInt<uint8_t>())
+            batch.Put(i[0].toString(), i[2].toString());
+        else
+            batch.Delete(i[0].toString());
+    }
+    batch.Delete(undoKey(_height));
+    uint256 previous = h256Touint(rlp[1].toHash<dev::h256>());
+    if(!previous.IsNull())
+        batch.Put(DB_FLAT_TIP, std::string((char const*)previous.begin(), previous.size()));
+    else
+        batch.Delete(DB_FLAT_TIP);
+    accounts.clear();
+    return db->Write(leveldb::WriteOptions(), &batch).ok();
+}
+
+uint256 FlatStorage::tip(){
+    std::string value;
+    if(!db->Get(leveldb::ReadOptions(), DB_FLAT_TIP, &value).ok() || value.size() != 32)
+        return uint256();
+    return uint256(std::vector<unsigned char>(value.begin(), value.end()));
+}
+
+uint64_t FlatStorage::slots(){
+    uint64_t nSlots = 0;
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(leveldb::ReadOptions()));
+    for(it->Seek(std::string(1, DB_FLAT_SLOT)); it->Valid() && it->key()[0] == DB_FLAT_SLOT; it->Next())
+        nSlots++;
+    return nSlots;
+}
+
+void FlatStorage::wipe(){
+    LOCK(cs);
+    leveldb::WriteBatch batch;
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(leveldb::ReadOptions()));
+    for(it->SeekToFirst(); it->Valid(); it->Next()){
+        // Keep the counter, so that no incarnation is used twice
+        if(it->key() != DB_FLAT_INCARNATION)
+            batch.Delete(it->key());
+    }
+    db->Write(leveldb::WriteOptions(), &batch);
+    accounts.clear();
+    pendingAccounts.clear();
+    pendingSlots.clear();
+    firstPendingIncarnation = nextIncarnation;
+}
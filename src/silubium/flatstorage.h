@@ -0,0 +1,118 @@
+#pragma once
+
+#include <sync.h>
+#include <uint256.h>
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libethereum/Account.h>
+#include <leveldb/db.h>
+#include <leveldb/write_batch.h>
+#include <boost/optional.hpp>
+
+#include <atomic>
+#include <map>
+#include <unordered_map>
+
+/** Blocks whose changes to the flat storage can be undone */
+static const unsigned int FLAT_STORAGE_UNDO_DEPTH = 500;
+/** Accounts kept in memory by the flat storage, all of them are forgotten when there are more */
+static const size_t FLAT_STORAGE_MAX_ACCOUNTS = 100000;
+
+/**
+ * Storage slots of the contracts of the active chain tip in a flat (contract, slot) -> value table,
+ * next to the state trie, so that a slot is read with one lookup instead of a walk down the
+ * storage trie of the contract.
+ *
+ * Every contract has the storage root the table holds its slots for, and the slots are only used
+ * while the contract is at that root, so stale entries are never read whatever state they are
+ * read for. Slots of a contract are kept under an incarnation, which is replaced when its storage
+ * starts over from another root or the contract is removed. The slots of the old incarnation are
+ * deleted with the undo data of the block that replaced it, when it can no longer be disconnected. A contract is complete
+ * when its storage was empty when it was first seen, so that a missing slot is zero; otherwise only
+ * the slots written since are known and missing slots are read from the trie.
+ *
+ * The changes committed to the state are collected while a block is connected and written in one
+ * batch when it becomes the tip, with the previous values of what they overwrite, which take the
+ * table back when the block is disconnected.
+ */
+class FlatStorage{
+
+public:
+
+    FlatStorage(std::string const& _path);
+
+    ~FlatStorage();
+
+    /**
+     * Look up slot @a _key of @a _address while the storage of the contract is at @a _storageRoot.
+     * Returns false if the table does not know the slot at that root.
+     */
+    bool storage(dev::Address const& _address, dev::h256 const& _storageRoot, dev::u256 const& _key, dev::u256& o_value);
+
+    /** Collect an account committed to the state with @a _storageRoot, a null @a _account if it was removed */
+    void noteCommitted(dev::Address const& _address, dev::eth::Account const* _account, dev::h256 const& _storageRoot);
+
+    /** Forget the changes collected since the last connected block */
+    void discardPending();
+
+    /** Write the collected changes of the block @a _hash connected at @a _height */
+    bool connectBlock(unsigned int _height, uint256 const& _hash);
+
+    /** Undo the changes of the block @a _hash at @a _height, the table is wiped if they are not known */
+    bool disconnectBlock(unsigned int _height, uint256 const& _hash);
+
+    /** Block the table is at, null if it has been wiped since */
+    uint256 tip();
+
+    /** Number of slots in the table, of all incarnations */
+    uint64_t slots();
+
+    void wipe();
+
+    uint64_t hits() const { return nHits; }
+
+    uint64_t misses() const { return nMisses; }
+
+private:
+
+    struct FlatAccount{
+        dev::h256 storageRoot;
+        uint64_t incarnation;
+        bool complete;
+    };
+
+    /** Account as it is in the database, requires cs */
+    boost::optional<FlatAccount> const& account(dev::Address const& _address);
+
+    /** Account with the collected changes on top, requires cs */
+    boost::optional<FlatAccount> pendingAccount(dev::Address const& _address);
+
+    /** Delete the slots of @a _incarnation in @a _batch */
+    void deleteIncarnation(leveldb::WriteBatch& _batch, uint64_t _incarnation);
+
+    std::string path;
+
+    leveldb::DB* db;
+
+    leveldb::Options options;
+
+    CCriticalSection cs;
+
+    std::unordered_map<dev::Address, boost::optional<FlatAccount>> accounts;
+
+    std::unordered_map<dev::Address, boost::optional<FlatAccount>> pendingAccounts;
+
+    // Keys written by the collected changes, with no value to delete them
+    std::map<std::string, boost::optional<std::string>> pendingSlots;
+
+    uint64_t nextIncarnation;
+
+    // Incarnations from here on are not in the database yet
+    uint64_t firstPendingIncarnation;
+
+    std::atomic<uint64_t> nHits;
+
+    std::atomic<uint64_t> nMisses;
+};
+
+extern FlatStorage *pflatstorage;
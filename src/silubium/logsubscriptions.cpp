@@ -0,0 +1,179 @@
+#include <silubium/logsubscriptions.h>
+#include <validation.h>
+#include <utiltime.h>
+
+LogSubscriptions *plogsubscriptions = nullptr;
+
+bool LogFilter::matchesTopics(dev::eth::LogEntry const& log) const{
+    for(size_t i = 0; i < topics.size(); i++){
+        if(!topics[i])
+            continue;
+        if(i >= log.topics.size() || log.topics[i] != topics[i].get())
+            return false;
+    }
+    return true;
+}
+
+LogSubscriptions::LogSubscriptions(size_t _maxQueued) : nextId(1), maxQueued(std::max<size_t>(1, _maxQueued)) {}
+
+uint64_t LogSubscriptions::subscribe(LogFilter const& filter){
+    std::lock_guard<std::mutex> lock(cs);
+    uint64_t id = nextId++;
+    Subscription& subscription = subscriptions[id];
+    subscription.filter = filter;
+    subscription.first = 0;
+    subscription.lastPoll = GetTime();
+    subscription.waiters = 0;
+    if(filter.addresses.empty())
+        anyAddress.insert(id);
+    for(dev::h160 const& address : filter.addresses)
+        byAddress[address].insert(id);
+    return id;
+}
+
+bool LogSubscriptions::unsubscribe(uint64_t id){
+    std::lock_guard<std::mutex> lock(cs);
+    if(!subscriptions.count(id))
+        return false;
+    remove(id);
+    // Wake up the clients waiting on it
+    cond.notify_all();
+    return true;
+}
+
+bool LogSubscriptions::poll(uint64_t id, uint64_t cursor, std::chrono::milliseconds timeout, std::function<bool()> const& alive,
+                            std::vector<ContractLog>& logs, uint64_t& nextCursor, uint64_t& dropped){
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_lock<std::mutex> lock(cs);
+    auto it = subscriptions.find(id);
+    if(it == subscriptions.end())
+        return false;
+
+    Subscription* subscription = &it->second;
+    dropped = subscription->first > cursor ? subscription->first - cursor : 0;
+    while(subscription->first < cursor && !subscription->queue.empty()){
+        subscription->queue.pop_front();
+        subscription->first++;
+    }
+    if(subscription->queue.empty())
+        subscription->first = std::max(subscription->first, cursor);
+
+    subscription->waiters++;
+    while(subscription->queue.empty() && std::chrono::steady_clock::now() < deadline){
+        cond.wait_until(lock, std::min(deadline, std::chrono::steady_clock::now() + std::chrono::seconds(1)));
+
+        // The client is checked without the lock, blocks are connected under cs_main meanwhile
+        lock.unlock();
+        bool fAlive = alive();
+        lock.lock();
+
+        it = subscriptions.find(id);
+        if(it == subscriptions.end())
+            return false;
+        subscription = &it->second;
+        if(!fAlive)
+            break;
+    }
+    subscription->waiters--;
+    subscription->lastPoll = GetTime();
+
+    logs.assign(subscription->queue.begin(), subscription->queue.end());
+    nextCursor = subscription->first + subscription->queue.size();
+    return true;
+}
+
+void LogSubscriptions::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex, const std::vector<CTransactionRef>& vtxConflicted){
+    if(!fLogEvents)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        if(subscriptions.empty() && NotifyContractLogs.empty())
+            return;
+    }
+
+    std::vector<ContractLog> logs;
+    for(const CTransactionRef& tx : pblock->vtx){
+        if(!tx->HasCreateOrCall())
+            continue;
+        for(TransactionReceiptInfo& receipt : pstorageresult->getResult(uintToh256(tx->GetHash()))){
+            std::shared_ptr<const TransactionReceiptInfo> shared = std::make_shared<const TransactionReceiptInfo>(std::move(receipt));
+            for(size_t i = 0; i < shared->logs.size(); i++)
+                logs.push_back(ContractLog{shared, i, false});
+        }
+    }
+    if(logs.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        recentBlocks.push_back(std::make_pair(pblock->GetHash(), logs));
+        if(recentBlocks.size() > LOG_SUBSCRIPTION_RECENT_BLOCKS)
+            recentBlocks.pop_front();
+        dispatch(logs);
+    }
+    NotifyContractLogs(logs);
+}
+
+void LogSubscriptions::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock){
+    std::vector<ContractLog> logs;
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        uint256 hash = pblock->GetHash();
+        auto it = std::find_if(recentBlocks.begin(), recentBlocks.end(),
+                               [&hash](std::pair<uint256, std::vector<ContractLog>> const& block){ return block.first == hash; });
+        if(it == recentBlocks.end())
+            return;
+        logs.swap(it->second);
+        recentBlocks.erase(it);
+        for(ContractLog& log : logs)
+            log.removed = true;
+        dispatch(logs);
+    }
+    NotifyContractLogs(logs);
+}
+
+void LogSubscriptions::dispatch(std::vector<ContractLog> const& logs){
+    expire(GetTime());
+    if(subscriptions.empty())
+        return;
+
+    for(ContractLog const& log : logs){
+        std::set<uint64_t> ids(anyAddress);
+        auto byIt = byAddress.find(log.receipt->contractAddress);
+        if(byIt != byAddress.end())
+            ids.insert(byIt->second.begin(), byIt->second.end());
+
+        for(uint64_t id : ids){
+            Subscription& subscription = subscriptions[id];
+            if(!subscription.filter.matchesTopics(log.log()))
+                continue;
+            subscription.queue.push_back(log);
+            if(subscription.queue.size() > maxQueued){
+                subscription.queue.pop_front();
+                subscription.first++;
+            }
+        }
+    }
+    cond.notify_all();
+}
+
+void LogSubscriptions::expire(int64_t now){
+    std::vector<uint64_t> expired;
+    for(auto const& subscription : subscriptions){
+        if(subscription.second.waiters == 0 && now - subscription.second.lastPoll > LOG_SUBSCRIPTION_EXPIRY)
+            expired.push_back(subscription.first);
+    }
+    for(uint64_t id : expired)
+        remove(id);
+}
+
+void LogSubscriptions::remove(uint64_t id){
+    anyAddress.erase(id);
+    for(dev::h160 const& address : subscriptions[id].filter.addresses){
+        auto byIt = byAddress.find(address);
+        byIt->second.erase(id);
+        if(byIt->second.empty())
+            byAddress.erase(byIt);
+    }
+    subscriptions.erase(id);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <validationinterface.h>
+#include <silubium/storageresults.h>
+#include <boost/optional.hpp>
+#include <boost/signals2/signal.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+
+/** Logs kept for a subscription until its client polls past them, the oldest are dropped first */
+static const size_t MAX_LOG_SUBSCRIPTION_QUEUE = 10000;
+/** Seconds after the last poll when a subscription nobody waits on is removed */
+static const int64_t LOG_SUBSCRIPTION_EXPIRY = 10 * 60;
+/** Connected blocks whose logs are remembered, to notify them as removed when the block is disconnected */
+static const size_t LOG_SUBSCRIPTION_RECENT_BLOCKS = 100;
+
+/** A log of a connected or disconnected block, with the receipt of the transaction that emitted it */
+struct ContractLog{
+    std::shared_ptr<const TransactionReceiptInfo> receipt;
+    size_t index;
+    bool removed;
+
+    dev::eth::LogEntry const& log() const { return receipt->logs[index]; }
+};
+
+/** Contract addresses and positional topics a subscription is restricted to, matched like waitforlogs */
+struct LogFilter{
+    std::set<dev::h160> addresses;
+    std::vector<boost::optional<dev::h256>> topics;
+
+    bool matchesTopics(dev::eth::LogEntry const& log) const;
+};
+
+/**
+ * Matches the logs of every connected block against all subscriptions at once. The receipts of a
+ * block are read a single time, and each log is only compared with the subscriptions on its contract
+ * or on any contract. Matches are queued per subscription for polling clients, and all logs of the
+ * block are passed to NotifyContractLogs for the ZMQ publisher.
+ */
+class LogSubscriptions : public CValidationInterface{
+
+public:
+
+    LogSubscriptions(size_t _maxQueued = MAX_LOG_SUBSCRIPTION_QUEUE);
+
+    uint64_t subscribe(LogFilter const& filter);
+
+    bool unsubscribe(uint64_t id);
+
+    /**
+     * Drop the logs of subscription @a id before @a cursor, then wait up to @a timeout for logs at or
+     * after it while @a alive returns true. @a nextCursor is the cursor to poll with next, and
+     * @a dropped counts the logs after @a cursor that were discarded because the queue was full.
+     * Returns false if there is no such subscription.
+     */
+    bool poll(uint64_t id, uint64_t cursor, std::chrono::milliseconds timeout, std::function<bool()> const& alive,
+              std::vector<ContractLog>& logs, uint64_t& nextCursor, uint64_t& dropped);
+
+    /** Called once per connected or disconnected block with all of its logs */
+    boost::signals2::signal<void (std::vector<ContractLog> const&)> NotifyContractLogs;
+
+protected:
+
+    void BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex, const std::vector<CTransactionRef>& vtxConflicted) override;
+
+    void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) override;
+
+private:
+
+    struct Subscription{
+        LogFilter filter;
+        std::deque<ContractLog> queue;
+        uint64_t first; // cursor of queue.front()
+        int64_t lastPoll;
+        int waiters;
+    };
+
+    void dispatch(std::vector<ContractLog> const& logs);
+
+    void expire(int64_t now);
+
+    void remove(uint64_t id);
+
+    std::mutex cs;
+
+    std::condition_variable cond;
+
+    std::map<uint64_t, Subscription> subscriptions;
+
+    std::map<dev::h160, std::set<uint64_t>> byAddress;
+
+    std::set<uint64_t> anyAddress;
+
+    std::deque<std::pair<uint256, std::vector<ContractLog>>> recentBlocks;
+
+    uint64_t nextId;
+
+    size_t maxQueued;
+};
+
+extern LogSubscriptions *plogsubscriptions;
@@ -1,4 +1,5 @@
 #include "silubiumDGP.h"
+#include "chainparams.h"
 
 void SilubiumDGP::initDataEIP158(){
     std::vector<uint32_t> tempData = {dev::eth::EIP158Schedule.tierStepGas[0], dev::eth::EIP158Schedule.tierStepGas[1], dev::eth::EIP158Schedule.tierStepGas[2],
@@ -13,13 +14,17 @@ void SilubiumDGP::initDataEIP158(){
                                       dev::eth::EIP158Schedule.quadCoeffDiv, dev::eth::EIP158Schedule.createDataGas, dev::eth::EIP158Schedule.txGas,
                                       dev::eth::EIP158Schedule.txCreateGas, dev::eth::EIP158Schedule.txDataZeroGas, dev::eth::EIP158Schedule.txDataNonZeroGas,
                                       dev::eth::EIP158Schedule.copyGas, dev::eth::EIP158Schedule.extcodesizeGas, dev::eth::EIP158Schedule.extcodecopyGas,
-                                      dev::eth::EIP158Schedule.balanceGas, dev::eth::EIP158Schedule.suicideGas, dev::eth::EIP158Schedule.maxCodeSize};
+                                      dev::eth::EIP158Schedule.balanceGas, dev::eth::EIP158Schedule.suicideGas, dev::eth::EIP158Schedule.maxCodeSize,
+                                      dev::eth::EIP158Schedule.modexpQuadDivisor, dev::eth::EIP158Schedule.bn128AddGas, dev::eth::EIP158Schedule.bn128MulGas,
+                                      dev::eth::EIP158Schedule.bn128PairingBaseGas, dev::eth::EIP158Schedule.bn128PairingPairGas, dev::eth::EIP158Schedule.blake2RoundGas};
     dataEIP158Schedule = tempData;
 }
 
-bool SilubiumDGP::checkLimitSchedule(const std::vector<uint32_t>& defaultData, const std::vector<uint32_t>& checkData){
-    if(defaultData.size() == 39 && checkData.size() == 39){
-        for(size_t i = 0; i < defaultData.size(); i++){
+bool SilubiumDGP::checkLimitSchedule(const std::vector<uint32_t>& defaultData, const std::vector<uint32_t>& checkData, bool fPrecompiles){
+    // Schedules written before the precompiled contracts 0x05-0x09 stop after maxCodeSize,
+    // longer ones fall back to the default schedule before the fork as they always did
+    if(defaultData.size() == 45 && (checkData.size() == 39 || (fPrecompiles && checkData.size() == 45))){
+        for(size_t i = 0; i < checkData.size(); i++){
             uint32_t max = defaultData[i] * 1000 > 0 ? defaultData[i] * 1000 : 1 * 1000;
             uint32_t min = defaultData[i] / 100 > 0 ? defaultData[i] / 100 : 1;
             if(checkData[i] > max || checkData[i] < min){
@@ -34,21 +39,40 @@ bool SilubiumDGP::checkLimitSchedule(const std::vector<uint32_t>& defaultData, c
 dev::eth::EVMSchedule SilubiumDGP::getGasSchedule(unsigned int blockHeight){
     clear();
     dev::eth::EVMSchedule schedule = dev::eth::EIP158Schedule;
-    if(initStorages(GasScheduleDGP, blockHeight, ParseHex("26fadbe2"))){
-        schedule = createEVMSchedule();
+    SilubiumDGPCache::Key key = getCacheKey(GasScheduleDGP, blockHeight);
+
+    // A template selected before the fork is read again from it, so the fork height stands for its activation there
+    unsigned int precompilesHeight = Params().GetConsensus().nPrecompilesHFHeight;
+    bool fPrecompiles = blockHeight >= precompilesHeight;
+    if(fPrecompiles && std::get<1>(key) < precompilesHeight)
+        std::get<1>(key) = precompilesHeight;
+
+    if(dgpCache.getSchedule(key, schedule)){
+        return schedule;
     }
+    if(initStorages(blockHeight, ParseHex("26fadbe2"))){
+        schedule = createEVMSchedule(fPrecompiles);
+    }
+    if(fMemoize)
+        dgpCache.setSchedule(key, schedule);
     return schedule;
 }
 
 uint64_t SilubiumDGP::getUint64FromDGP(unsigned int blockHeight, const dev::Address& contract, std::vector<unsigned char> data){
     uint64_t value = 0;
-    if(initStorages(contract, blockHeight, data)){
+    SilubiumDGPCache::Key key = getCacheKey(contract, blockHeight);
+    if(dgpCache.getUint64(key, value)){
+        return value;
+    }
+    if(initStorages(blockHeight, data)){
         if(!dgpevm){
             parseStorageOneUint64(value);
         } else {
             parseDataOneUint64(value);
         }
     }
+    if(fMemoize)
+        dgpCache.setUint64(key, value);
     return value;
 }
 
@@ -82,9 +106,7 @@ uint64_t SilubiumDGP::getBlockGasLimit(unsigned int blockHeight){
     return result;
 }
 
-bool SilubiumDGP::initStorages(const dev::Address& addr, unsigned int blockHeight, std::vector<unsigned char> data){
-    initStorageDGP(addr);
-    createParamsInstance();
+bool SilubiumDGP::initStorages(unsigned int blockHeight, std::vector<unsigned char> data){
     dev::Address address = getAddressForBlock(blockHeight);
     if(address != dev::Address()){
         if(!dgpevm){
@@ -106,7 +128,10 @@ void SilubiumDGP::initStorageTemplate(const dev::Address& addr){
 }
 
 void SilubiumDGP::initDataTemplate(const dev::Address& addr, std::vector<unsigned char>& data){
-    dataTemplate = CallContract(addr, data)[0].execRes.output;
+    dev::eth::ExecutionResult execRes = CallContract(addr, data)[0].execRes;
+    dataTemplate = execRes.output;
+    // A failed call may depend on the gas schedule, and code reading other state on the block and on other contracts
+    fMemoize = execRes.excepted == dev::eth::TransactionException::None && isContextFree(state->code(addr));
 }
 
 void SilubiumDGP::createParamsInstance(){
@@ -132,6 +157,66 @@ dev::Address SilubiumDGP::getAddressForBlock(unsigned int blockHeight){
     return dev::Address();
 }
 
+SilubiumDGPCache::Key SilubiumDGP::getCacheKey(const dev::Address& contract, unsigned int blockHeight){
+    // The storage of the governance contract is only read again once its root changed
+    dev::h256 storageRoot = state->storageRoot(contract);
+    if(!dgpCache.getParamsInstance(contract, storageRoot, paramsInstance)){
+        initStorageDGP(contract);
+        createParamsInstance();
+        dgpCache.setParamsInstance(contract, storageRoot, paramsInstance);
+    }
+
+    // Entries sharing an activation height always resolve to the last one pushed,
+    // so the activation height identifies the selected template
+    unsigned int activationHeight = std::numeric_limits<unsigned int>::max();
+    for(auto i = paramsInstance.rbegin(); i != paramsInstance.rend(); i++){
+        if(i->first <= blockHeight){
+            activationHeight = i->first;
+            break;
+        }
+    }
+    return SilubiumDGPCache::Key(governanceFingerprint(contract, storageRoot), activationHeight, dgpevm);
+}
+
+dev::h256 SilubiumDGP::governanceFingerprint(const dev::Address& contract, const dev::h256& storageRoot){
+    dev::RLPStream stream(2 + paramsInstance.size() * 3);
+    stream << contract << storageRoot;
+    for(const std::pair<unsigned int, dev::Address>& params : paramsInstance){
+        stream << params.second << state->codeHash(params.second) << state->storageRoot(params.second);
+    }
+    return dev::sha3(stream.out());
+}
+
+bool SilubiumDGP::isContextFree(const dev::bytes& code){
+    for(size_t i = 0; i < code.size(); i++){
+        dev::eth::Instruction inst = dev::eth::Instruction(code[i]);
+        switch(inst){
+        case dev::eth::Instruction::BALANCE:
+        case dev::eth::Instruction::ORIGIN:
+        case dev::eth::Instruction::GASPRICE:
+        case dev::eth::Instruction::EXTCODESIZE:
+        case dev::eth::Instruction::EXTCODECOPY:
+        case dev::eth::Instruction::BLOCKHASH:
+        case dev::eth::Instruction::COINBASE:
+        case dev::eth::Instruction::TIMESTAMP:
+        case dev::eth::Instruction::NUMBER:
+        case dev::eth::Instruction::DIFFICULTY:
+        case dev::eth::Instruction::GASLIMIT:
+        case dev::eth::Instruction::GAS:
+        case dev::eth::Instruction::CREATE:
+        case dev::eth::Instruction::CALL:
+        case dev::eth::Instruction::CALLCODE:
+        case dev::eth::Instruction::DELEGATECALL:
+        case dev::eth::Instruction::SUICIDE:
+            return false;
+        default:
+            if(inst >= dev::eth::Instruction::PUSH1 && inst <= dev::eth::Instruction::PUSH32)
+                i += dev::eth::getPushNumber(inst);
+        }
+    }
+    return true;
+}
+
 static inline bool sortPairs(const std::pair<dev::u256, dev::u256>& a, const std::pair<dev::u256, dev::u256>& b){
     return a.first < b.first;
 }
@@ -184,7 +269,7 @@ void SilubiumDGP::parseDataOneUint64(uint64_t& value){
     }
 }
 
-dev::eth::EVMSchedule SilubiumDGP::createEVMSchedule(){
+dev::eth::EVMSchedule SilubiumDGP::createEVMSchedule(bool fPrecompiles){
     dev::eth::EVMSchedule schedule = dev::eth::EIP158Schedule;
     std::vector<uint32_t> uint32Values;
 
@@ -194,7 +279,7 @@ dev::eth::EVMSchedule SilubiumDGP::createEVMSchedule(){
         parseDataScheduleContract(uint32Values);
     }
 
-    if(!checkLimitSchedule(dataEIP158Schedule, uint32Values))
+    if(!checkLimitSchedule(dataEIP158Schedule, uint32Values, fPrecompiles))
         return schedule;
 
     if(uint32Values.size() >= 39){
@@ -232,12 +317,80 @@ dev::eth::EVMSchedule SilubiumDGP::createEVMSchedule(){
         schedule.suicideGas = uint32Values[37];
         schedule.maxCodeSize = uint32Values[38];
     }
+    if(uint32Values.size() >= 45){
+        schedule.modexpQuadDivisor = uint32Values[39];
+        schedule.bn128AddGas = uint32Values[40];
+        schedule.bn128MulGas = uint32Values[41];
+        schedule.bn128PairingBaseGas = uint32Values[42];
+        schedule.bn128PairingPairGas = uint32Values[43];
+        schedule.blake2RoundGas = uint32Values[44];
+    }
     return schedule;
 }
 
 void SilubiumDGP::clear(){
+    fMemoize = true;
     templateContract = dev::Address();
     storageDGP.clear();
     storageTemplate.clear();
     paramsInstance.clear();
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////
+SilubiumDGPCache dgpCache;
+
+bool SilubiumDGPCache::getParamsInstance(const dev::Address& contract, const dev::h256& storageRoot, ParamsInstance& params){
+    LOCK(cs);
+    auto it = paramsInstances.find(std::make_pair(contract, storageRoot));
+    if(it == paramsInstances.end())
+        return false;
+    params = it->second;
+    return true;
+}
+
+void SilubiumDGPCache::setParamsInstance(const dev::Address& contract, const dev::h256& storageRoot, const ParamsInstance& params){
+    LOCK(cs);
+    if(paramsInstances.size() >= MAX_DGP_CACHE_ENTRIES)
+        paramsInstances.clear();
+    paramsInstances[std::make_pair(contract, storageRoot)] = params;
+}
+
+bool SilubiumDGPCache::getUint64(const Key& key, uint64_t& value){
+    LOCK(cs);
+    auto it = values.find(key);
+    if(it == values.end())
+        return false;
+    value = it->second;
+    return true;
+}
+
+void SilubiumDGPCache::setUint64(const Key& key, uint64_t value){
+    LOCK(cs);
+    if(values.size() >= MAX_DGP_CACHE_ENTRIES)
+        values.clear();
+    values[key] = value;
+}
+
+bool SilubiumDGPCache::getSchedule(const Key& key, dev::eth::EVMSchedule& schedule){
+    LOCK(cs);
+    auto it = schedules.find(key);
+    if(it == schedules.end())
+        return false;
+    schedule = it->second;
+    return true;
+}
+
+void SilubiumDGPCache::setSchedule(const Key& key, const dev::eth::EVMSchedule& schedule){
+    LOCK(cs);
+    if(schedules.size() >= MAX_DGP_CACHE_ENTRIES)
+        schedules.clear();
+    schedules[key] = schedule;
+}
+
+void SilubiumDGPCache::clear(){
+    LOCK(cs);
+    paramsInstances.clear();
+    values.clear();
+    schedules.clear();
+}
+///////////////////////////////////////////////////////////////////////////////////////////
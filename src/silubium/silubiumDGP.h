@@ -5,6 +5,10 @@
 #include "primitives/block.h"
 #include "validation.h"
 #include "utilstrencodings.h"
+#include "sync.h"
+
+#include <limits>
+#include <tuple>
 
 static const dev::Address GasScheduleDGP = dev::Address("0000000000000000000000000000000000000080");
 static const dev::Address BlockSizeDGP = dev::Address("0000000000000000000000000000000000000081");
@@ -24,11 +28,58 @@ static const uint64_t MIN_BLOCK_GAS_LIMIT_DGP = 1000000;
 static const uint64_t MAX_BLOCK_GAS_LIMIT_DGP = 1000000000;
 static const uint64_t DEFAULT_BLOCK_GAS_LIMIT_DGP = 40000000;
 
+static const size_t MAX_DGP_CACHE_ENTRIES = 4096;
+
+/**
+ * Memo of DGP parameters shared by every SilubiumDGP instance.
+ * The params instances of a governance contract are kept by its storage root, so its storage
+ * is only read again once it changed. Values are keyed by a fingerprint of the governance
+ * contract and of the templates it references, and by the activation height of the selected
+ * template, so blocks that do not touch 0x80-0x84 keep hitting the same values and rewinding
+ * the state root on disconnect finds the old values.
+ * A template call is only memoized if its code reads nothing but its own storage and the call
+ * succeeded, as its result could otherwise depend on the block or on other contracts.
+ */
+class SilubiumDGPCache {
+
+public:
+
+    typedef std::vector<std::pair<unsigned int, dev::Address>> ParamsInstance;
+
+    typedef std::tuple<dev::h256, unsigned int, bool> Key;
+
+    bool getParamsInstance(const dev::Address& contract, const dev::h256& storageRoot, ParamsInstance& params);
+
+    void setParamsInstance(const dev::Address& contract, const dev::h256& storageRoot, const ParamsInstance& params);
+
+    bool getUint64(const Key& key, uint64_t& value);
+
+    void setUint64(const Key& key, uint64_t value);
+
+    bool getSchedule(const Key& key, dev::eth::EVMSchedule& schedule);
+
+    void setSchedule(const Key& key, const dev::eth::EVMSchedule& schedule);
+
+    void clear();
+
+private:
+
+    CCriticalSection cs;
+
+    std::map<std::pair<dev::Address, dev::h256>, ParamsInstance> paramsInstances;
+
+    std::map<Key, uint64_t> values;
+
+    std::map<Key, dev::eth::EVMSchedule> schedules;
+};
+
+extern SilubiumDGPCache dgpCache;
+
 class SilubiumDGP {
     
 public:
 
-    SilubiumDGP(SilubiumState* _state, bool _dgpevm = true) : dgpevm(_dgpevm), state(_state) { initDataEIP158(); }
+    SilubiumDGP(SilubiumState* _state, bool _dgpevm = true) : dgpevm(_dgpevm), fMemoize(true), state(_state) { initDataEIP158(); }
 
     dev::eth::EVMSchedule getGasSchedule(unsigned int blockHeight);
 
@@ -38,9 +89,17 @@ public:
 
     uint64_t getBlockGasLimit(unsigned int blockHeight);
 
+    /** Whether checkData is within the limits of the schedule defaultData. Schedules with the prices of
+     *  the precompiled contracts 0x05-0x09 are only valid from the fork that introduces them */
+    static bool checkLimitSchedule(const std::vector<uint32_t>& defaultData, const std::vector<uint32_t>& checkData, bool fPrecompiles);
+
+    /** Whether code reads nothing but its own code, storage and call data: no block information,
+     *  balances, other contracts or remaining gas. Only the result of such a template is memoized */
+    static bool isContextFree(const dev::bytes& code);
+
 private:
 
-    bool initStorages(const dev::Address& addr, unsigned int blockHeight, std::vector<unsigned char> data = std::vector<unsigned char>());
+    bool initStorages(unsigned int blockHeight, std::vector<unsigned char> data = std::vector<unsigned char>());
 
     void initStorageDGP(const dev::Address& addr);
 
@@ -50,12 +109,14 @@ private:
 
     void initDataEIP158();
 
-    bool checkLimitSchedule(const std::vector<uint32_t>& defaultData, const std::vector<uint32_t>& checkData);
-
     void createParamsInstance();
 
     dev::Address getAddressForBlock(unsigned int blockHeight);
 
+    SilubiumDGPCache::Key getCacheKey(const dev::Address& contract, unsigned int blockHeight);
+
+    dev::h256 governanceFingerprint(const dev::Address& contract, const dev::h256& storageRoot);
+
     uint64_t getUint64FromDGP(unsigned int blockHeight, const dev::Address& contract, std::vector<unsigned char> data);
 
     void parseStorageScheduleContract(std::vector<uint32_t>& uint32Values);
@@ -66,7 +127,7 @@ private:
 
     void parseDataOneUint64(uint64_t& value);
 
-    dev::eth::EVMSchedule createEVMSchedule();
+    dev::eth::EVMSchedule createEVMSchedule(bool fPrecompiles);
 
     void clear();    
 
@@ -74,6 +135,8 @@ private:
 
     bool dgpevm;
 
+    bool fMemoize;
+
     const SilubiumState* state;
 
     dev::Address templateContract;
@@ -3,6 +3,7 @@
 #include <validation.h>
 #include "chainparams.h"
 #include "silubiumstate.h"
+#include "flatstorage.h"
 
 using namespace std;
 using namespace dev;
@@ -19,6 +20,22 @@ SilubiumState::SilubiumState() : dev::eth::State(dev::Invalid256, dev::OverlayDB
     stateUTXO = SecureTrieDB<Address, OverlayDB>(&dbUTXO);
 }
 
+SilubiumState::SilubiumState(SilubiumState const& _s) : dev::eth::State(_s), dbUTXO(_s.dbUTXO), stateUTXO(&dbUTXO, _s.stateUTXO.root()), flatStorage(_s.flatStorage) {
+    // Forget the read caches so that every access of the fork goes through the trie and can be recorded
+    m_cache.clear();
+    m_unchangedCacheEntries.clear();
+    m_nonExistingAccountsCache.clear();
+}
+
+SilubiumState::SilubiumState(SilubiumState const& _s, h256 const& _root, h256 const& _rootUTXO) :
+        State(_s.accountStartNonce(), _s.db(), BaseState::PreExisting), dbUTXO(_s.dbUTXO), stateUTXO(&dbUTXO, _rootUTXO) {
+    setRoot(_root);
+}
+
+std::unique_ptr<SilubiumState> SilubiumState::snapshot(h256 const& _root, h256 const& _rootUTXO) const{
+    return std::unique_ptr<SilubiumState>(new SilubiumState(*this, _root, _rootUTXO));
+}
+
 ResultExecute SilubiumState::execute(EnvInfo const& _envInfo, SealEngineFace const& _sealEngine, SilubiumTransaction const& _t, Permanence _p, OnOpFunc const& _onOp){
 
     assert(_t.getVersion().toRaw() == VersionVM::GetEVMDefault().toRaw());
@@ -60,6 +77,7 @@ ResultExecute SilubiumState::execute(EnvInfo const& _envInfo, SealEngineFace con
         }
         e.finalize();
         if (_p == Permanence::Reverted){
+            recordDiff(false, CommitBehaviour::KeepEmptyAccounts);
             m_cache.clear();
             cacheUTXO.clear();
         } else {
@@ -79,9 +97,10 @@ ResultExecute SilubiumState::execute(EnvInfo const& _envInfo, SealEngineFace con
                 printfErrorLog(res.excepted);
             }
             
+            bool removeEmptyAccounts = _envInfo.number() >= _sealEngine.chainParams().u256Param("EIP158ForkBlock");
+            recordDiff(true, removeEmptyAccounts ? State::CommitBehaviour::RemoveEmptyAccounts : State::CommitBehaviour::KeepEmptyAccounts);
             silubium::commit(cacheUTXO, stateUTXO, m_cache);
             cacheUTXO.clear();
-            bool removeEmptyAccounts = _envInfo.number() >= _sealEngine.chainParams().u256Param("EIP158ForkBlock");
             commit(removeEmptyAccounts ? State::CommitBehaviour::RemoveEmptyAccounts : State::CommitBehaviour::KeepEmptyAccounts);
         }
     }
@@ -91,10 +110,12 @@ ResultExecute SilubiumState::execute(EnvInfo const& _envInfo, SealEngineFace con
         res.excepted = dev::eth::toTransactionException(_e);
         res.gasUsed = _t.gas();
         const Consensus::Params& consensusParams = Params().GetConsensus();
-        if(chainActive.Height() < consensusParams.nFixUTXOCacheHFHeight  && _p != Permanence::Reverted){
+        if(_p != Permanence::Reverted && chainActive.Height() < consensusParams.nFixUTXOCacheHFHeight){
             deleteAccounts(_sealEngine.deleteAddresses);
+            recordDiff(true, CommitBehaviour::RemoveEmptyAccounts);
             commit(CommitBehaviour::RemoveEmptyAccounts);
         } else {
+            recordDiff(false, CommitBehaviour::KeepEmptyAccounts);
             m_cache.clear();
             cacheUTXO.clear();
         }
@@ -158,6 +179,8 @@ Vin* SilubiumState::vin(dev::Address const& _addr)
     auto it = cacheUTXO.find(_addr);
     if (it == cacheUTXO.end()){
         std::string stateBack = stateUTXO.at(_addr);
+        if (recordAccess)
+            recordAccess->vinReads.insert(_addr);
         if (stateBack.empty())
             return nullptr;
             
@@ -167,6 +190,8 @@ Vin* SilubiumState::vin(dev::Address const& _addr)
             std::forward_as_tuple(_addr),
             std::forward_as_tuple(Vin{state[0].toHash<dev::h256>(), state[1].toInt<uint32_t>(), state[2].toInt<dev::u256>(), state[3].toInt<uint8_t>()})
         );
+        if (recordAccess)
+            loadedVins.emplace(_addr, i.first->second);
         return &i.first->second;
     }
     return &it->second;
@@ -275,6 +300,142 @@ void SilubiumState::printfErrorLog(const dev::eth::TransactionException er){
     clog(ExecutiveWarnChannel) << "VM exception:" << ss.str();
 }
 
+void SilubiumState::startRecording(SilubiumAccessSet* _access, std::vector<SilubiumStateDiff>* _diffs){
+    recordAccess = _access;
+    recordDiffs = _diffs;
+    loadedAccounts.clear();
+    loadedVins.clear();
+    writtenStorage.clear();
+}
+
+void SilubiumState::onAccountLoaded(dev::Address const& _addr, dev::eth::Account const* _account){
+    if(!recordAccess)
+        return;
+    recordAccess->accountReads.insert(_addr);
+    if(_account)
+        loadedAccounts.emplace(_addr, *_account);
+}
+
+void SilubiumState::onStorageLoaded(dev::Address const& _addr, dev::u256 const& _key) const{
+    if(recordAccess)
+        recordAccess->storageReads.insert(std::make_pair(_addr, _key));
+}
+
+void SilubiumState::onStorageWritten(dev::Address const& _addr, dev::u256 const& _key){
+    if(recordAccess)
+        writtenStorage.insert(std::make_pair(_addr, _key));
+}
+
+bool SilubiumState::lookupStorage(dev::Address const& _addr, dev::h256 const& _storageRoot, dev::u256 const& _key, dev::u256& o_value) const{
+    return flatStorage && flatStorage->storage(_addr, _storageRoot, _key, o_value);
+}
+
+void SilubiumState::onAccountCommitted(dev::Address const& _addr, dev::eth::Account const* _account, dev::h256 const& _storageRoot){
+    if(recordFlatStorage)
+        flatStorage->noteCommitted(_addr, _account, _storageRoot);
+}
+
+void SilubiumState::recordDiff(bool _commit, CommitBehaviour _commitBehaviour){
+    if(!recordAccess)
+        return;
+
+    SilubiumStateDiff diff;
+    diff.commit = _commit;
+    diff.behaviour = _commitBehaviour;
+    if(_commit){
+        for(auto const& i : m_cache){
+            dev::eth::Account const& acc = i.second;
+            if(!acc.isDirty())
+                continue;
+            auto loaded = loadedAccounts.find(i.first);
+            if(loaded == loadedAccounts.end()){
+                // created by this transaction, or created and killed again like the sender
+                if(!acc.isAlive())
+                    continue;
+                recordAccess->accountWrites.insert(i.first);
+            } else if(acc.isAlive() && acc.baseRoot() == loaded->second.baseRoot()){
+                dev::eth::Account const& old = loaded->second;
+                if(acc.nonce() != old.nonce() || acc.balance() != old.balance() || acc.codeHash() != old.codeHash() || acc.isEmpty())
+                    recordAccess->accountWrites.insert(i.first);
+                diff.rebase.insert(i.first);
+            } else {
+                recordAccess->accountWrites.insert(i.first);
+            }
+            diff.accounts.insert(i);
+        }
+        for(auto const& i : cacheUTXO){
+            auto loaded = loadedVins.find(i.first);
+            if(loaded != loadedVins.end() && loaded->second.hash == i.second.hash && loaded->second.nVout == i.second.nVout &&
+                    loaded->second.value == i.second.value && loaded->second.alive == i.second.alive)
+                continue;
+            recordAccess->vinWrites.insert(i.first);
+            diff.vins.insert(i);
+        }
+        recordAccess->storageWrites.insert(writtenStorage.begin(), writtenStorage.end());
+        diff.storageWrites.swap(writtenStorage);
+    }
+    if(recordDiffs)
+        recordDiffs->push_back(std::move(diff));
+    loadedAccounts.clear();
+    loadedVins.clear();
+    writtenStorage.clear();
+}
+
+void SilubiumState::applyDiff(SilubiumStateDiff const& _diff){
+    if(!_diff.commit){
+        m_cache.clear();
+        cacheUTXO.clear();
+        return;
+    }
+    for(auto const& i : _diff.accounts){
+        dev::eth::Account const* current = _diff.rebase.count(i.first) ? account(i.first) : nullptr;
+        if(current){
+            // Keep the storage written by other transactions since the diff was recorded
+            dev::eth::Account const& acc = i.second;
+            dev::eth::Account rebased(acc.nonce(), acc.balance(), current->baseRoot(), acc.codeHash(), dev::eth::Account::Changed);
+            if(acc.hasNewCode())
+                rebased.setNewCode(dev::bytes(acc.code()));
+            // Storage written by the transactions before it whose commits are deferred
+            for(auto const& slot : current->storageOverlay())
+                rebased.setStorage(slot.first, slot.second);
+            for(auto it = _diff.storageWrites.lower_bound(std::make_pair(i.first, dev::u256())); it != _diff.storageWrites.end() && it->first == i.first; ++it){
+                auto value = acc.storageOverlay().find(it->second);
+                if(value != acc.storageOverlay().end())
+                    rebased.setStorage(it->second, value->second);
+            }
+            m_cache[i.first] = std::move(rebased);
+        } else {
+            m_cache[i.first] = i.second;
+        }
+        m_nonExistingAccountsCache.erase(i.first);
+    }
+    for(auto const& i : _diff.vins)
+        cacheUTXO[i.first] = i.second;
+
+    silubium::commit(cacheUTXO, stateUTXO, m_cache);
+    cacheUTXO.clear();
+    commit(_diff.behaviour);
+}
+
+bool SilubiumAccessSet::conflicts(SilubiumAccessSet const& _written) const{
+    for(dev::Address const& a : accountReads)
+        if(_written.accountWrites.count(a))
+            return true;
+    for(auto const& s : storageReads)
+        if(_written.storageWrites.count(s))
+            return true;
+    for(dev::Address const& a : vinReads)
+        if(_written.vinWrites.count(a))
+            return true;
+    return false;
+}
+
+void SilubiumAccessSet::addWrites(SilubiumAccessSet const& _other){
+    accountWrites.insert(_other.accountWrites.begin(), _other.accountWrites.end());
+    storageWrites.insert(_other.storageWrites.begin(), _other.storageWrites.end());
+    vinWrites.insert(_other.vinWrites.begin(), _other.vinWrites.end());
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 CTransaction CondensingTX::createCondensingTX(){
     selectionVin();
@@ -54,8 +54,35 @@ namespace silubium{
     }
 }
 
+/** Accounts, storage slots and UTXO entries touched while recording a SilubiumState */
+struct SilubiumAccessSet{
+    std::set<dev::Address> accountReads;
+    std::set<std::pair<dev::Address, dev::u256>> storageReads;
+    std::set<dev::Address> vinReads;
+    std::set<dev::Address> accountWrites;
+    std::set<std::pair<dev::Address, dev::u256>> storageWrites;
+    std::set<dev::Address> vinWrites;
+
+    /** True if anything read here has been written in @a _written */
+    bool conflicts(SilubiumAccessSet const& _written) const;
+
+    void addWrites(SilubiumAccessSet const& _other);
+};
+
+/** Changes made by one SilubiumState::execute call, captured right before they were committed */
+struct SilubiumStateDiff{
+    std::unordered_map<dev::Address, dev::eth::Account> accounts;
+    std::set<dev::Address> rebase; // existing accounts whose written slots go on top of the current storage root
+    std::set<std::pair<dev::Address, dev::u256>> storageWrites;
+    std::unordered_map<dev::Address, Vin> vins;
+    bool commit = false;
+    dev::eth::State::CommitBehaviour behaviour = dev::eth::State::CommitBehaviour::KeepEmptyAccounts;
+};
+
 class CondensingTX;
 
+class FlatStorage;
+
 class SilubiumState : public dev::eth::State {
     
 public:
@@ -64,6 +91,13 @@ public:
 
     SilubiumState(dev::u256 const& _accountStartNonce, dev::OverlayDB const& _db, const std::string& _path, dev::eth::BaseState _bs = dev::eth::BaseState::PreExisting);
 
+    /// Fork of the committed state of @a _s, with its own overlays, which can be executed on another thread.
+    explicit SilubiumState(SilubiumState const& _s);
+
+    /// Read-only view of this state at @a _root and @a _rootUTXO, with its own caches and overlays on the shared databases.
+    /// Only committed nodes are visible, and calls on it must be executed with Permanence::Reverted.
+    std::unique_ptr<SilubiumState> snapshot(dev::h256 const& _root, dev::h256 const& _rootUTXO) const;
+
     ResultExecute execute(dev::eth::EnvInfo const& _envInfo, dev::eth::SealEngineFace const& _sealEngine, SilubiumTransaction const& _t, dev::eth::Permanence _p = dev::eth::Permanence::Committed, dev::eth::OnOpFunc const& _onOp = OnOpFunc());
 
     void setRootUTXO(dev::h256 const& _r) { cacheUTXO.clear(); stateUTXO.setRoot(_r); }
@@ -78,12 +112,25 @@ public:
 
 	dev::OverlayDB& dbUtxo() { return dbUTXO; }
 
+    /// Record reads into @a _access, and the changes of every execute call into @a _access and @a _diffs.
+    void startRecording(SilubiumAccessSet* _access, std::vector<SilubiumStateDiff>* _diffs = nullptr);
+
+    void stopRecording() { startRecording(nullptr); }
+
+    /// Apply and commit the changes of an execute call recorded on a fork of this state.
+    void applyDiff(SilubiumStateDiff const& _diff);
+
+    /// Read storage slots from @a _flat, and collect the committed changes into it. Forks only read from it.
+    void setFlatStorage(FlatStorage* _flat) { flatStorage = _flat; recordFlatStorage = !!_flat; }
+
     virtual ~SilubiumState(){}
 
     friend CondensingTX;
 
 private:
 
+    SilubiumState(SilubiumState const& _s, dev::h256 const& _root, dev::h256 const& _rootUTXO);
+
     void transferBalance(dev::Address const& _from, dev::Address const& _to, dev::u256 const& _value);
 
     Vin const* vin(dev::Address const& _a) const;
@@ -104,6 +151,18 @@ private:
 
     void printfErrorLog(const dev::eth::TransactionException er);
 
+    void onAccountLoaded(dev::Address const& _addr, dev::eth::Account const* _account) override;
+
+    void onStorageLoaded(dev::Address const& _addr, dev::u256 const& _key) const override;
+
+    void onStorageWritten(dev::Address const& _addr, dev::u256 const& _key) override;
+
+    bool lookupStorage(dev::Address const& _addr, dev::h256 const& _storageRoot, dev::u256 const& _key, dev::u256& o_value) const override;
+
+    void onAccountCommitted(dev::Address const& _addr, dev::eth::Account const* _account, dev::h256 const& _storageRoot) override;
+
+    void recordDiff(bool _commit, CommitBehaviour _commitBehaviour);
+
     dev::Address newAddress;
 
     std::vector<TransferInfo> transfers;
@@ -113,6 +172,37 @@ private:
 	dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> stateUTXO;
 
 	std::unordered_map<dev::Address, Vin> cacheUTXO;
+
+    FlatStorage* flatStorage = nullptr;
+
+    bool recordFlatStorage = false;
+
+    SilubiumAccessSet* recordAccess = nullptr;
+
+    std::vector<SilubiumStateDiff>* recordDiffs = nullptr;
+
+    // Accounts and vins as they were first read, and storage slots written, since the last commit
+    std::unordered_map<dev::Address, dev::eth::Account> loadedAccounts;
+
+    std::unordered_map<dev::Address, Vin> loadedVins;
+
+    std::set<std::pair<dev::Address, dev::u256>> writtenStorage;
+};
+
+/** Records the accesses of a SilubiumState while in scope */
+struct SilubiumStateRecorder{
+    SilubiumState& state;
+
+    SilubiumStateRecorder(SilubiumState& _state, SilubiumAccessSet& _access, std::vector<SilubiumStateDiff>* _diffs = nullptr) : state(_state) {
+        state.startRecording(&_access, _diffs);
+    }
+
+    ~SilubiumStateRecorder(){
+        state.stopRecording();
+    }
+    SilubiumStateRecorder() = delete;
+    SilubiumStateRecorder(const SilubiumStateRecorder&) = delete;
+    SilubiumStateRecorder& operator=(const SilubiumStateRecorder&) = delete;
 };
 
 
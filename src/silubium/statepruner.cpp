@@ -0,0 +1,232 @@
+#include <silubium/statepruner.h>
+#include <silubium/statesnapshot.h>
+#include <validation.h>
+#include <txdb.h>
+#include <chainparams.h>
+#include <util.h>
+#include <utiltime.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/TrieCommon.h>
+#include <libdevcore/TrieDB.h>
+
+#include <boost/thread.hpp>
+
+std::atomic<int> nStatePrunedHeight(-1);
+
+static bool IsCheckpoint(int nHeight){
+    const MapCheckpoints& checkpoints = Params().Checkpoints().mapCheckpoints;
+    auto it = checkpoints.find(nHeight);
+    return it != checkpoints.end() && nHeight <= chainActive.Height() && chainActive[nHeight]->GetBlockHash() == it->second;
+}
+
+bool IsStatePruned(int nHeight){
+    AssertLockHeld(cs_main);
+    // Nothing below a loaded state snapshot has been connected
+    return (nHeight <= nStatePrunedHeight && !IsCheckpoint(nHeight)) || nHeight < nStateSnapshotHeight;
+}
+
+std::vector<StateRoots> StatePruner::retainedRoots(){
+    AssertLockHeld(cs_main);
+    std::vector<StateRoots> roots;
+    // The roots of the blocks above nStatePrunedHeight, which keeps them after the tip moves on
+    for(int nHeight = std::max(0, nStatePrunedHeight + 1); nHeight <= chainActive.Height(); nHeight++)
+        roots.push_back(StateRoots(uintToh256(chainActive[nHeight]->hashStateRoot), uintToh256(chainActive[nHeight]->hashUTXORoot)));
+    for(auto const& checkpoint : Params().Checkpoints().mapCheckpoints){
+        if(checkpoint.first <= nStatePrunedHeight && IsCheckpoint(checkpoint.first))
+            roots.push_back(StateRoots(uintToh256(chainActive[checkpoint.first]->hashStateRoot), uintToh256(chainActive[checkpoint.first]->hashUTXORoot)));
+    }
+    if(globalState)
+        roots.push_back(StateRoots(globalState->rootHash(), globalState->rootHashUTXO()));
+    return roots;
+}
+
+size_t StatePruner::prune(ldb::DB* _stateDB, ldb::DB* _utxoDB){
+    stateDB = _stateDB;
+    utxoDB = _utxoDB;
+    markedState.clear();
+    markedUTXO.clear();
+    markedStateAux.clear();
+    markedUTXOAux.clear();
+    // The empty trie is the storage root of every account without storage
+    markedState.insert(dev::EmptyTrie);
+    markedUTXO.insert(dev::EmptyTrie);
+
+    std::vector<StateRoots> roots;
+    {
+        LOCK(cs_main);
+        // Disconnecting below this height fails from now on, as the state it goes back to can be deleted
+        int nHeight = chainActive.Height() - (int)depth;
+        if(nHeight > nStatePrunedHeight){
+            if(!pblocktree->WriteStatePrunedHeight(nHeight)){
+                LogPrintf("%s: failed to write the pruned height\n", __func__);
+                return 0;
+            }
+            nStatePrunedHeight = nHeight;
+        }
+        roots = retainedRoots();
+    }
+    mark(roots);
+
+    size_t deletedState = sweep(stateDB, markedState, markedStateAux);
+    size_t deletedUTXO = sweep(utxoDB, markedUTXO, markedUTXOAux);
+
+    // Compact after large deletions, so that later compactions only go through live nodes
+    if(deletedState * 4 > markedState.size())
+        stateDB->CompactRange(nullptr, nullptr);
+    if(deletedUTXO * 4 > markedUTXO.size())
+        utxoDB->CompactRange(nullptr, nullptr);
+
+    markedState.clear();
+    markedUTXO.clear();
+    markedStateAux.clear();
+    markedUTXOAux.clear();
+    return deletedState + deletedUTXO;
+}
+
+void StatePruner::mark(std::vector<StateRoots> const& roots){
+    for(StateRoots const& root : roots){
+        markTrie(stateDB, root.first, true, markedState, markedStateAux);
+        markTrie(utxoDB, root.second, false, markedUTXO, markedUTXOAux);
+    }
+}
+
+void StatePruner::markTrie(ldb::DB* db, dev::h256 const& root, bool accounts, std::unordered_set<dev::h256>& marked, std::unordered_set<dev::h256>& markedAux){
+    enum Kind { Accounts, Storage, Code };
+    // A node is referenced by its hash, or inlined in its parent when it is shorter than a hash.
+    // The nibbles of the path to it make up, at a leaf, the hashed key its aux entry is stored under.
+    struct Node { dev::h256 hash; std::string inlined; Kind kind; std::vector<uint8_t> path; };
+    std::vector<Node> stack(1, Node{root, std::string(), accounts ? Accounts : Storage, std::vector<uint8_t>()});
+    auto child = [&stack](dev::RLP const& item, Kind kind, std::vector<uint8_t> const& path){
+        if(item.isData() && item.size() == 32)
+            stack.push_back(Node{item.toHash<dev::h256>(), std::string(), kind, path});
+        else if(item.isList())
+            stack.push_back(Node{dev::h256(), item.data().toString(), kind, path});
+    };
+
+    std::string node;
+    while(!stack.empty()){
+        boost::this_thread::interruption_point();
+        Node current = std::move(stack.back());
+        stack.pop_back();
+        if(current.inlined.empty()){
+            if(!marked.insert(current.hash).second || current.kind == Code)
+                continue;
+            node.clear();
+            if(!db->Get(ldb::ReadOptions(), ldb::Slice((char const*)current.hash.data(), 32), &node).ok())
+                continue;
+        } else {
+            node = std::move(current.inlined);
+        }
+        try {
+            dev::RLP rlp(node);
+            std::vector<uint8_t>& path = current.path;
+            if(rlp.itemCount() == 17){
+                for(uint8_t i = 0; i < 16; i++){
+                    path.push_back(i);
+                    child(rlp[i], current.kind, path);
+                    path.pop_back();
+                }
+            } else if(rlp.itemCount() == 2){
+                dev::NibbleSlice key = dev::keyOf(rlp);
+                for(unsigned i = 0; i < key.size(); i++)
+                    path.push_back(key[i]);
+                if(!dev::isLeaf(rlp)){
+                    child(rlp[1], current.kind, path);
+                    continue;
+                }
+                // The keys of the secure tries are hashes, whose preimages are the aux entries
+                if(path.size() == 64){
+                    dev::h256 hashedKey;
+                    for(unsigned i = 0; i < 32; i++)
+                        hashedKey[i] = (path[2 * i] << 4) | path[2 * i + 1];
+                    markedAux.insert(hashedKey);
+                }
+                if(current.kind == Accounts){
+                    dev::RLP account(rlp[1].payload());
+                    if(account.itemCount() == 4){
+                        child(account[2], Storage, std::vector<uint8_t>());
+                        child(account[3], Code, std::vector<uint8_t>());
+                    }
+                }
+            }
+        } catch(dev::Exception const&) {
+            LogPrintf("%s: unexpected trie node %s\n", __func__, current.hash.hex());
+        }
+    }
+}
+
+size_t StatePruner::sweep(ldb::DB* db, std::unordered_set<dev::h256> const& marked, std::unordered_set<dev::h256> const& markedAux){
+    ldb::ReadOptions options;
+    options.fill_cache = false;
+    std::unique_ptr<ldb::Iterator> it(db->NewIterator(options));
+
+    size_t deleted = 0;
+    std::vector<std::string> keys;
+    for(it->SeekToFirst(); it->Valid(); it->Next()){
+        boost::this_thread::interruption_point();
+        // Nodes are stored under their hash, aux entries under the hashed key followed by 255
+        bool aux = it->key().size() == 33 && (uint8_t)it->key()[32] == 255;
+        if(it->key().size() != 32 && !aux)
+            continue;
+        dev::h256 hash((uint8_t const*)it->key().data(), dev::h256::ConstructFromPointer);
+        if((aux ? markedAux : marked).count(hash))
+            continue;
+        keys.push_back(it->key().ToString());
+        if(keys.size() >= STATE_PRUNE_BATCH){
+            deleted += deleteUnmarked(db, marked, markedAux, keys);
+            keys.clear();
+        }
+    }
+    if(!keys.empty())
+        deleted += deleteUnmarked(db, marked, markedAux, keys);
+    return deleted;
+}
+
+size_t StatePruner::deleteUnmarked(ldb::DB* db, std::unordered_set<dev::h256> const& marked, std::unordered_set<dev::h256> const& markedAux, std::vector<std::string> const& keys){
+    boost::this_thread::interruption_point();
+    LOCK(cs_main);
+    // Blocks connected since the nodes were found can reach some of them again
+    mark(retainedRoots());
+
+    ldb::WriteBatch batch;
+    size_t deleted = 0;
+    for(std::string const& key : keys){
+        dev::h256 hash((uint8_t const*)key.data(), dev::h256::ConstructFromPointer);
+        if((key.size() == 33 ? markedAux : marked).count(hash))
+            continue;
+        batch.Delete(key);
+        deleted++;
+    }
+    if(deleted && !db->Write(ldb::WriteOptions(), &batch).ok()){
+        LogPrintf("%s: failed to delete contract state nodes\n", __func__);
+        return 0;
+    }
+    return deleted;
+}
+
+void ThreadPruneState(){
+    RenameThread("silubium-prunestate");
+    StatePruner pruner(nPruneStateDepth);
+    int nLastHeight = -STATE_PRUNE_INTERVAL;
+
+    while(true){
+        MilliSleep(10000);
+
+        int nHeight;
+        ldb::DB* stateDB;
+        ldb::DB* utxoDB;
+        {
+            LOCK(cs_main);
+            nHeight = chainActive.Height();
+            stateDB = globalState->db().db();
+            utxoDB = globalState->dbUtxo().db();
+        }
+        if(nHeight - nLastHeight < STATE_PRUNE_INTERVAL || !stateDB || !utxoDB)
+            continue;
+
+        int64_t nStart = GetTimeMillis();
+        size_t deleted = pruner.prune(stateDB, utxoDB);
+        nLastHeight = nHeight;
+        LogPrint(BCLog::PRUNE, "Pruned %u contract state nodes below height %d in %dms\n", deleted, nStatePrunedHeight + 1, GetTimeMillis() - nStart);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <libdevcore/db.h>
+#include <libdevcore/FixedHash.h>
+
+#include <atomic>
+#include <unordered_set>
+#include <vector>
+
+/** Blocks connected between two runs of the state pruner */
+static const int STATE_PRUNE_INTERVAL = 500;
+/** Unreachable nodes and aux entries deleted at once, each batch is deleted with cs_main held */
+static const size_t STATE_PRUNE_BATCH = 10000;
+
+/** Root of the contract state trie and root of the UTXO trie of a block */
+typedef std::pair<dev::h256, dev::h256> StateRoots;
+
+/**
+ * Mark and sweep collector for the contract state and UTXO databases.
+ * The nodes of both tries are content addressed and shared between blocks and accounts, and the
+ * tries do not keep reference counts on disk, so nodes are marked by walking the tries from the
+ * roots that are kept: the last -prunestate blocks of the active chain and its checkpoints.
+ * The databases are then scanned without locks. Every batch of unmarked nodes and of the aux entries
+ * of keys no marked leaf has is deleted under cs_main, after marking the roots of the blocks connected
+ * in the meantime. The pruned height is written to the block tree database before anything is deleted.
+ */
+class StatePruner{
+
+public:
+
+    StatePruner(unsigned int _depth) : depth(_depth), stateDB(nullptr), utxoDB(nullptr) {}
+
+    virtual ~StatePruner(){}
+
+    /** Delete the nodes of @a _stateDB and @a _utxoDB that no kept root reaches, returns how many */
+    size_t prune(ldb::DB* _stateDB, ldb::DB* _utxoDB);
+
+protected:
+
+    /** Roots of the blocks whose state is kept, requires cs_main */
+    virtual std::vector<StateRoots> retainedRoots();
+
+private:
+
+    void mark(std::vector<StateRoots> const& roots);
+
+    /**
+     * Mark the nodes below @a root that are not marked yet, with the storage tries and code of accounts if @a accounts,
+     * and the hashed keys of their leaves in @a markedAux
+     */
+    void markTrie(ldb::DB* db, dev::h256 const& root, bool accounts, std::unordered_set<dev::h256>& marked, std::unordered_set<dev::h256>& markedAux);
+
+    size_t sweep(ldb::DB* db, std::unordered_set<dev::h256> const& marked, std::unordered_set<dev::h256> const& markedAux);
+
+    size_t deleteUnmarked(ldb::DB* db, std::unordered_set<dev::h256> const& marked, std::unordered_set<dev::h256> const& markedAux, std::vector<std::string> const& keys);
+
+    unsigned int depth;
+
+    ldb::DB* stateDB;
+
+    ldb::DB* utxoDB;
+
+    std::unordered_set<dev::h256> markedState;
+
+    std::unordered_set<dev::h256> markedUTXO;
+
+    /** Hashed keys whose preimages, the aux entries of the secure tries, are kept */
+    std::unordered_set<dev::h256> markedStateAux;
+
+    std::unordered_set<dev::h256> markedUTXOAux;
+};
+
+/** Highest height whose contract state may have been deleted, -1 if none */
+extern std::atomic<int> nStatePrunedHeight;
+
+/** True if the contract state of the active chain block at @a nHeight is no longer available, requires cs_main */
+bool IsStatePruned(int nHeight);
+
+/** Run the state pruner every STATE_PRUNE_INTERVAL blocks, with -prunestate */
+void ThreadPruneState();
@@ -0,0 +1,632 @@
+#include <silubium/statesnapshot.h>
+#include <validation.h>
+#include <chainparams.h>
+#include <clientversion.h>
+#include <hash.h>
+#include <init.h>
+#include <txdb.h>
+#include <util.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/TrieDB.h>
+#include <libethereum/State.h>
+
+#include <exception>
+#include <thread>
+
+std::atomic<int> nStateSnapshotHeight(0);
+
+enum StateSnapshotChunk : uint8_t {
+    SNAPSHOT_END = 0,
+    SNAPSHOT_ACCOUNTS = 1,
+    SNAPSHOT_VINS = 2,
+    SNAPSHOT_COINS = 3,
+    SNAPSHOT_STORAGE = 4,
+};
+
+template<typename Stream, unsigned N>
+static void WriteFixedHash(Stream& s, dev::FixedHash<N> const& h){
+    s.write((char const*)h.data(), N);
+}
+
+template<typename Stream, unsigned N>
+static void ReadFixedHash(Stream& s, dev::FixedHash<N>& h){
+    s.read((char*)h.data(), N);
+}
+
+// Numbers are written without their leading zero bytes, most balances and storage slots are small
+template<typename Stream>
+static void WriteU256(Stream& s, dev::u256 const& n){
+    ::Serialize(s, dev::toCompactBigEndian(n));
+}
+
+template<typename Stream>
+static void ReadU256(Stream& s, dev::u256& n){
+    dev::bytes b;
+    ::Unserialize(s, b);
+    if(b.size() > 32)
+        throw std::ios_base::failure("Number out of range");
+    n = dev::fromBigEndian<dev::u256>(b);
+}
+
+typedef std::vector<std::pair<dev::u256, dev::u256>> SnapshotSlots;
+
+template<typename Stream>
+static void WriteSlots(Stream& s, SnapshotSlots const& storage, bool fMoreStorage){
+    WriteCompactSize(s, storage.size());
+    for(auto const& slot : storage){
+        WriteU256(s, slot.first);
+        WriteU256(s, slot.second);
+    }
+    ::Serialize(s, fMoreStorage);
+}
+
+template<typename Stream>
+static void ReadSlots(Stream& s, SnapshotSlots& storage, bool& fMoreStorage){
+    uint64_t nSlots = ReadCompactSize(s);
+    if(nSlots > STATE_SNAPSHOT_CHUNK)
+        throw std::ios_base::failure("Too many storage slots in a chunk");
+    storage.clear();
+    storage.reserve(nSlots);
+    for(uint64_t i = 0; i < nSlots; i++){
+        std::pair<dev::u256, dev::u256> slot;
+        ReadU256(s, slot.first);
+        ReadU256(s, slot.second);
+        storage.push_back(slot);
+    }
+    ::Unserialize(s, fMoreStorage);
+}
+
+/** An account of the contract state with its code and the first slots of its storage */
+struct SnapshotAccount{
+    dev::Address address;
+    dev::u256 nonce;
+    dev::u256 balance;
+    dev::bytes code;
+    SnapshotSlots storage;
+    bool fMoreStorage = false; // the rest of the storage follows in SNAPSHOT_STORAGE chunks
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        WriteFixedHash(s, address);
+        WriteU256(s, nonce);
+        WriteU256(s, balance);
+        ::Serialize(s, code);
+        WriteSlots(s, storage, fMoreStorage);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s){
+        ReadFixedHash(s, address);
+        ReadU256(s, nonce);
+        ReadU256(s, balance);
+        ::Unserialize(s, code);
+        ReadSlots(s, storage, fMoreStorage);
+    }
+};
+
+/** More of the storage of the last account of the previous chunk */
+struct SnapshotStorage{
+    dev::Address address;
+    SnapshotSlots storage;
+    bool fMoreStorage = false;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        WriteFixedHash(s, address);
+        WriteSlots(s, storage, fMoreStorage);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s){
+        ReadFixedHash(s, address);
+        ReadSlots(s, storage, fMoreStorage);
+    }
+};
+
+/** An entry of the UTXO trie */
+struct SnapshotVin{
+    dev::Address address;
+    Vin vin;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const {
+        WriteFixedHash(s, address);
+        WriteFixedHash(s, vin.hash);
+        ::Serialize(s, vin.nVout);
+        WriteU256(s, vin.value);
+        ::Serialize(s, vin.alive);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s){
+        ReadFixedHash(s, address);
+        ReadFixedHash(s, vin.hash);
+        ::Unserialize(s, vin.nVout);
+        ReadU256(s, vin.value);
+        ::Unserialize(s, vin.alive);
+    }
+};
+
+void WriteStateSnapshot(CAutoFile& file, dev::OverlayDB const& stateDB, dev::h256 const& stateRoot,
+                        dev::OverlayDB const& utxoDB, dev::h256 const& utxoRoot, CCoinsViewCursor& coins, StateSnapshotStats& stats){
+    // The tries are walked on copies of the databases, nothing is written to them
+    dev::OverlayDB db(stateDB);
+    std::vector<SnapshotAccount> accounts;
+    size_t nEntries = 0;
+    dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> accountsTrie(&db, stateRoot);
+    for(auto const& i : accountsTrie){
+        dev::RLP rlp(i.second);
+        accounts.emplace_back();
+        SnapshotAccount& account = accounts.back();
+        account.address = i.first;
+        account.nonce = rlp[0].toInt<dev::u256>();
+        account.balance = rlp[1].toInt<dev::u256>();
+        dev::h256 storageRoot = rlp[2].toHash<dev::h256>();
+        dev::h256 codeHash = rlp[3].toHash<dev::h256>();
+        if(codeHash != dev::EmptySHA3)
+            account.code = dev::asBytes(db.lookup(codeHash));
+        stats.nAccounts++;
+        nEntries++;
+        if(storageRoot != dev::EmptyTrie){
+            // The storage of a large contract is written over several chunks, it is never held in memory at once
+            SnapshotStorage more;
+            more.address = account.address;
+            bool fSplit = false;
+            dev::eth::SecureTrieDB<dev::h256, dev::OverlayDB> storageTrie(&db, storageRoot);
+            for(auto const& slot : storageTrie){
+                if(nEntries >= STATE_SNAPSHOT_CHUNK){
+                    if(!fSplit){
+                        accounts.back().fMoreStorage = true;
+                        file << (uint8_t)SNAPSHOT_ACCOUNTS << accounts;
+                        accounts.clear();
+                        fSplit = true;
+                    } else {
+                        more.fMoreStorage = true;
+                        file << (uint8_t)SNAPSHOT_STORAGE << more;
+                        more.storage.clear();
+                    }
+                    nEntries = 0;
+                }
+                (fSplit ? more.storage : accounts.back().storage).push_back(std::make_pair(dev::u256(slot.first), dev::RLP(slot.second).toInt<dev::u256>()));
+                stats.nStorage++;
+                nEntries++;
+            }
+            if(fSplit){
+                more.fMoreStorage = false;
+                file << (uint8_t)SNAPSHOT_STORAGE << more;
+                nEntries = 0;
+                continue;
+            }
+        }
+
+        if(nEntries >= STATE_SNAPSHOT_CHUNK){
+            file << (uint8_t)SNAPSHOT_ACCOUNTS << accounts;
+            accounts.clear();
+            nEntries = 0;
+        }
+    }
+    if(!accounts.empty())
+        file << (uint8_t)SNAPSHOT_ACCOUNTS << accounts;
+
+    dev::OverlayDB dbUTXO(utxoDB);
+    std::vector<SnapshotVin> vins;
+    dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> vinsTrie(&dbUTXO, utxoRoot);
+    for(auto const& i : vinsTrie){
+        dev::RLP rlp(i.second);
+        vins.push_back(SnapshotVin{i.first, Vin{rlp[0].toHash<dev::h256>(), rlp[1].toInt<uint32_t>(), rlp[2].toInt<dev::u256>(), rlp[3].toInt<uint8_t>()}});
+        stats.nVins++;
+        if(vins.size() >= STATE_SNAPSHOT_CHUNK){
+            file << (uint8_t)SNAPSHOT_VINS << vins;
+            vins.clear();
+        }
+    }
+    if(!vins.empty())
+        file << (uint8_t)SNAPSHOT_VINS << vins;
+
+    // Coins are hashed in the order of the database, which is the order they are loaded in
+    CHashWriter hashCoins(SER_GETHASH, PROTOCOL_VERSION);
+    std::vector<std::pair<COutPoint, Coin>> chunk;
+    for(; coins.Valid(); coins.Next()){
+        COutPoint outpoint;
+        Coin coin;
+        if(!coins.GetKey(outpoint) || !coins.GetValue(coin))
+            throw std::runtime_error("Unable to read the coins database");
+        hashCoins << outpoint << coin;
+        chunk.push_back(std::make_pair(outpoint, std::move(coin)));
+        stats.nCoins++;
+        if(chunk.size() >= STATE_SNAPSHOT_CHUNK){
+            file << (uint8_t)SNAPSHOT_COINS << chunk;
+            chunk.clear();
+        }
+    }
+    if(!chunk.empty())
+        file << (uint8_t)SNAPSHOT_COINS << chunk;
+    stats.hashCoins = hashCoins.GetHash();
+
+    file << (uint8_t)SNAPSHOT_END << stats.nAccounts << stats.nVins << stats.nCoins;
+}
+
+/** Build the storage tries and insert the code of @a accounts, returns their storage roots and code hashes */
+static std::vector<std::pair<dev::h256, dev::h256>> BuildAccountTries(dev::OverlayDB const& stateDB, std::vector<SnapshotAccount> const& accounts, unsigned int nThreads){
+    std::vector<std::pair<dev::h256, dev::h256>> roots(accounts.size());
+    nThreads = std::max<unsigned int>(1, std::min<size_t>(nThreads, accounts.size()));
+    // Each thread writes the nodes of its accounts through its own overlay, the database itself is thread safe
+    std::vector<dev::OverlayDB> dbs(nThreads, stateDB);
+    std::vector<std::exception_ptr> errors(nThreads);
+
+    auto build = [&](unsigned int thread){
+        try {
+            dev::OverlayDB& db = dbs[thread];
+            size_t begin = accounts.size() * thread / nThreads;
+            size_t end = accounts.size() * (thread + 1) / nThreads;
+            for(size_t i = begin; i < end; i++){
+                dev::eth::SecureTrieDB<dev::h256, dev::OverlayDB> storageTrie(&db);
+                storageTrie.init();
+                for(auto const& slot : accounts[i].storage){
+                    if(slot.second)
+                        storageTrie.insert(dev::h256(slot.first), dev::rlp(slot.second));
+                }
+                dev::h256 codeHash = dev::EmptySHA3;
+                if(!accounts[i].code.empty()){
+                    codeHash = dev::sha3(accounts[i].code);
+                    db.insert(codeHash, &accounts[i].code);
+                }
+                roots[i] = std::make_pair(storageTrie.root(), codeHash);
+            }
+            db.commit();
+        } catch(...) {
+            errors[thread] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned int thread = 1; thread < nThreads; thread++)
+        threads.emplace_back(build, thread);
+    build(0);
+    for(std::thread& thread : threads)
+        thread.join();
+    for(std::exception_ptr const& error : errors){
+        if(error)
+            std::rethrow_exception(error);
+    }
+    return roots;
+}
+
+bool ReadStateSnapshot(CAutoFile& file, dev::OverlayDB const& stateDB, dev::OverlayDB const& utxoDB,
+                       unsigned int nThreads, StateSnapshotStats& stats, std::string& error){
+    try {
+        dev::OverlayDB db(stateDB);
+        dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> accountsTrie(&db);
+        accountsTrie.init();
+        dev::OverlayDB dbUTXO(utxoDB);
+        dev::eth::SecureTrieDB<dev::Address, dev::OverlayDB> vinsTrie(&dbUTXO);
+        vinsTrie.init();
+        CHashWriter hashCoins(SER_GETHASH, PROTOCOL_VERSION);
+        // Account whose storage goes on in the next chunks, with the roots of what was built of it so far
+        SnapshotAccount pending;
+        std::pair<dev::h256, dev::h256> pendingRoots;
+        bool fPending = false;
+        auto insertAccount = [&](SnapshotAccount const& account, std::pair<dev::h256, dev::h256> const& roots){
+            dev::RLPStream s(4);
+            s << account.nonce << account.balance << roots.first << roots.second;
+            accountsTrie.insert(account.address, &s.out());
+        };
+
+        while(true){
+            boost::this_thread::interruption_point();
+            long nPos = ftell(file.Get());
+            uint8_t type;
+            file >> type;
+            if(fPending && type != SNAPSHOT_STORAGE){
+                error = "Snapshot file is corrupted: storage of an account is incomplete";
+                return false;
+            }
+            if(type == SNAPSHOT_ACCOUNTS){
+                std::vector<SnapshotAccount> accounts;
+                file >> accounts;
+                // The storage tries are independent, the accounts trie is then built on this thread
+                std::vector<std::pair<dev::h256, dev::h256>> roots = BuildAccountTries(stateDB, accounts, nThreads);
+                for(size_t i = 0; i < accounts.size(); i++){
+                    stats.nStorage += accounts[i].storage.size();
+                    if(!accounts[i].fMoreStorage){
+                        insertAccount(accounts[i], roots[i]);
+                    } else if(i + 1 == accounts.size()){
+                        pending = std::move(accounts[i]);
+                        pending.storage.clear();
+                        pendingRoots = roots[i];
+                        fPending = true;
+                    } else {
+                        error = "Snapshot file is corrupted: storage of an account is incomplete";
+                        return false;
+                    }
+                }
+                db.commit();
+                stats.nAccounts += accounts.size();
+            } else if(type == SNAPSHOT_STORAGE){
+                SnapshotStorage more;
+                file >> more;
+                if(!fPending || more.address != pending.address){
+                    error = "Snapshot file is corrupted: storage without its account";
+                    return false;
+                }
+                // Large storage tries are built on this thread, one chunk at a time
+                dev::eth::SecureTrieDB<dev::h256, dev::OverlayDB> storageTrie(&db, pendingRoots.first);
+                for(auto const& slot : more.storage){
+                    if(slot.second)
+                        storageTrie.insert(dev::h256(slot.first), dev::rlp(slot.second));
+                }
+                pendingRoots.first = storageTrie.root();
+                stats.nStorage += more.storage.size();
+                if(!more.fMoreStorage){
+                    insertAccount(pending, pendingRoots);
+                    fPending = false;
+                }
+                db.commit();
+            } else if(type == SNAPSHOT_VINS){
+                std::vector<SnapshotVin> vins;
+                file >> vins;
+                for(SnapshotVin const& vin : vins){
+                    dev::RLPStream s(4);
+                    s << vin.vin.hash << vin.vin.nVout << vin.vin.value << vin.vin.alive;
+                    vinsTrie.insert(vin.address, &s.out());
+                }
+                dbUTXO.commit();
+                stats.nVins += vins.size();
+            } else if(type == SNAPSHOT_COINS){
+                // The coins are only hashed here, they are written once the whole snapshot is checked
+                std::vector<std::pair<COutPoint, Coin>> chunk;
+                file >> chunk;
+                CHashWriter hashChunk(SER_GETHASH, PROTOCOL_VERSION);
+                for(std::pair<COutPoint, Coin> const& coin : chunk){
+                    hashCoins << coin.first << coin.second;
+                    hashChunk << coin.first << coin.second;
+                }
+                stats.vCoinsChunks.push_back(StateSnapshotCoinsChunk{nPos, hashChunk.GetHash()});
+                stats.nCoins += chunk.size();
+            } else if(type == SNAPSHOT_END){
+                uint64_t nAccounts, nVins, nCoins;
+                file >> nAccounts >> nVins >> nCoins;
+                if(nAccounts != stats.nAccounts || nVins != stats.nVins || nCoins != stats.nCoins){
+                    error = "Snapshot file is incomplete";
+                    return false;
+                }
+                break;
+            } else {
+                error = strprintf("Unknown chunk type %d in snapshot file", type);
+                return false;
+            }
+        }
+
+        stats.stateRoot = accountsTrie.root();
+        stats.utxoRoot = vinsTrie.root();
+        stats.hashCoins = hashCoins.GetHash();
+    } catch(std::ios_base::failure const& e) {
+        error = strprintf("Snapshot file is corrupted: %s", e.what());
+        return false;
+    } catch(dev::Exception const& e) {
+        error = strprintf("Unable to rebuild the contract state: %s", e.what());
+        return false;
+    }
+    return true;
+}
+
+bool ReadStateSnapshotCoins(CAutoFile& file, StateSnapshotStats const& stats, CCoinsViewCache& coins,
+                            size_t nCacheSize, std::string& error){
+    try {
+        for(StateSnapshotCoinsChunk const& chunkInfo : stats.vCoinsChunks){
+            boost::this_thread::interruption_point();
+            if(fseek(file.Get(), chunkInfo.nPos, SEEK_SET) != 0){
+                error = "Unable to seek in the snapshot file";
+                return false;
+            }
+            uint8_t type;
+            std::vector<std::pair<COutPoint, Coin>> chunk;
+            file >> type >> chunk;
+            CHashWriter hashChunk(SER_GETHASH, PROTOCOL_VERSION);
+            for(std::pair<COutPoint, Coin> const& coin : chunk)
+                hashChunk << coin.first << coin.second;
+            if(type != SNAPSHOT_COINS || hashChunk.GetHash() != chunkInfo.hash){
+                error = "Snapshot file changed while it was loaded";
+                return false;
+            }
+            for(std::pair<COutPoint, Coin>& coin : chunk)
+                coins.AddCoin(coin.first, std::move(coin.second), true);
+            // Like the coins cache of the chain state, the coins are written out when they reach the size of the cache
+            if(coins.DynamicMemoryUsage() > nCacheSize && !coins.Flush()){
+                error = "Unable to write the coins";
+                return false;
+            }
+        }
+    } catch(std::ios_base::failure const& e) {
+        error = strprintf("Snapshot file is corrupted: %s", e.what());
+        return false;
+    }
+    return true;
+}
+
+/** Open an empty database at @a path to rebuild the tries of a snapshot in */
+static dev::OverlayDB OpenScratchDB(const fs::path& path){
+    fs::create_directories(path);
+    ldb::Options options;
+    options.create_if_missing = true;
+    options.error_if_exists = true;
+    options.max_open_files = 64;
+    ldb::DB* db = nullptr;
+    ldb::Status status = ldb::DB::Open(options, path.string(), &db);
+    if(!status.ok() || !db)
+        throw std::runtime_error(strprintf("Unable to open %s: %s", path.string(), status.ToString()));
+    return dev::OverlayDB(db);
+}
+
+/** Copy the nodes of the scratch database @a from to the database of @a to */
+static bool CopyStateNodes(dev::OverlayDB const& from, dev::OverlayDB const& to){
+    ldb::ReadOptions readOptions;
+    readOptions.fill_cache = false;
+    std::unique_ptr<ldb::Iterator> it(from.db()->NewIterator(readOptions));
+    ldb::WriteBatch batch;
+    size_t nBatch = 0;
+    for(it->SeekToFirst(); it->Valid(); it->Next()){
+        batch.Put(it->key(), it->value());
+        if(++nBatch >= STATE_SNAPSHOT_CHUNK){
+            if(!to.db()->Write(ldb::WriteOptions(), &batch).ok())
+                return false;
+            batch.Clear();
+            nBatch = 0;
+        }
+    }
+    return it->status().ok() && to.db()->Write(ldb::WriteOptions(), &batch).ok();
+}
+
+/** Rebuild the tries of the snapshot in the scratch databases at @a scratchPath, and write the state once it is checked */
+static bool LoadStateSnapshotScratch(CAutoFile& file, CBlockIndex* pindex, StateSnapshotHeader const& header, const fs::path& scratchPath,
+                                     uint256 const& hashCoinsExpected, unsigned int nThreads, StateSnapshotStats& stats, std::string& error){
+    dev::OverlayDB scratchState, scratchUTXO;
+    try {
+        scratchState = OpenScratchDB(scratchPath / "state");
+        scratchUTXO = OpenScratchDB(scratchPath / "utxo");
+    } catch(std::exception const& e) {
+        error = e.what();
+        return false;
+    }
+
+    // Blocks can still be connected while the tries are rebuilt, nothing has been written to the chain state yet
+    if(!ReadStateSnapshot(file, scratchState, scratchUTXO, nThreads, stats, error))
+        return false;
+    if(stats.stateRoot != uintToh256(header.hashStateRoot) || stats.utxoRoot != uintToh256(header.hashUTXORoot)){
+        error = "Rebuilt contract state does not match the roots of the snapshot block";
+        return false;
+    }
+    if(stats.hashCoins != hashCoinsExpected){
+        error = strprintf("Coins hash %s does not match the expected hash", stats.hashCoins.GetHex());
+        return false;
+    }
+
+    LOCK(cs_main);
+    if(chainActive.Height() > 0){
+        error = "Snapshots can only be loaded on a node without blocks past genesis";
+        return false;
+    }
+    // The coins are flushed while the best block is still genesis, the mark keeps a node stopped before the snapshot block is activated from starting on them
+    if(!pcoinsdbview->WriteStateSnapshotLoad(pindex->GetBlockHash())){
+        error = "Unable to write the chain state";
+        return false;
+    }
+    if(!CopyStateNodes(scratchState, globalState->db()) || !CopyStateNodes(scratchUTXO, globalState->dbUtxo()))
+        error = "Unable to write the contract state";
+    else if(ReadStateSnapshotCoins(file, stats, *pcoinsTip, nCoinCacheUsage, error)){
+        pcoinsTip->SetBestBlock(pindex->GetBlockHash());
+        globalState->setRoot(stats.stateRoot);
+        globalState->setRootUTXO(stats.utxoRoot);
+        if(ActivateSnapshotBlock(pindex, header.nTx, header.nChainTx) && pcoinsdbview->WriteStateSnapshotLoad(uint256()))
+            return true;
+        error = "Unable to write the chain state";
+    }
+    // Some of the coins may have been written already, the node cannot go on from genesis with them
+    error += ". The chain state was partly replaced, restart with -reindex-chainstate";
+    StartShutdown();
+    return false;
+}
+
+bool DumpStateSnapshot(const fs::path& path, StateSnapshotHeader& header, StateSnapshotStats& stats, std::string& error){
+    dev::OverlayDB stateDB, utxoDB;
+    std::unique_ptr<CCoinsViewCursor> coins;
+    {
+        LOCK(cs_main);
+        // The coins database only has the coins of the tip, which are read from a database snapshot after the lock is released
+        FlushStateToDisk();
+        CBlockIndex* pindex = chainActive.Tip();
+        header.nVersion = STATE_SNAPSHOT_VERSION;
+        header.hashGenesisBlock = Params().GenesisBlock().GetHash();
+        header.hashBlock = pindex->GetBlockHash();
+        header.nHeight = pindex->nHeight;
+        header.hashStateRoot = pindex->hashStateRoot;
+        header.hashUTXORoot = pindex->hashUTXORoot;
+        header.nTx = pindex->nTx;
+        header.nChainTx = pindex->nChainTx;
+        stateDB = globalState->db();
+        utxoDB = globalState->dbUtxo();
+        coins.reset(pcoinsdbview->Cursor());
+    }
+
+    // Written under another name first, so that an interrupted dump is not taken for a snapshot
+    fs::path temppath = path;
+    temppath += ".incomplete";
+    CAutoFile file(fsbridge::fopen(temppath, "wb"), SER_DISK, CLIENT_VERSION);
+    if(file.IsNull()){
+        error = "Couldn't open file " + temppath.string() + " for writing";
+        return false;
+    }
+    try {
+        file << header;
+        WriteStateSnapshot(file, stateDB, uintToh256(header.hashStateRoot), utxoDB, uintToh256(header.hashUTXORoot), *coins, stats);
+    } catch(std::exception const& e) {
+        file.fclose();
+        fs::remove(temppath);
+        error = strprintf("Unable to write the snapshot: %s", e.what());
+        return false;
+    }
+    file.fclose();
+    fs::rename(temppath, path);
+    return true;
+}
+
+bool LoadStateSnapshot(const fs::path& path, uint256 const& hashCoinsExpected, unsigned int nThreads,
+                       StateSnapshotHeader& header, StateSnapshotStats& stats, std::string& error){
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    if(file.IsNull()){
+        error = "Couldn't open file " + path.string() + " for reading";
+        return false;
+    }
+    try {
+        file >> header;
+    } catch(std::ios_base::failure const& e) {
+        error = strprintf("Snapshot file is corrupted: %s", e.what());
+        return false;
+    }
+    if(hashCoinsExpected.IsNull()){
+        error = "The coins hash of the snapshot is required";
+        return false;
+    }
+    if(header.nVersion != STATE_SNAPSHOT_VERSION){
+        error = strprintf("Unsupported snapshot version %u", header.nVersion);
+        return false;
+    }
+    if(header.hashGenesisBlock != Params().GenesisBlock().GetHash()){
+        error = "Snapshot is for another network";
+        return false;
+    }
+
+    CBlockIndex* pindex;
+    {
+        LOCK(cs_main);
+        BlockMap::iterator it = mapBlockIndex.find(header.hashBlock);
+        if(it == mapBlockIndex.end() || it->second->nHeight != header.nHeight){
+            error = "Snapshot block is unknown, wait for the headers to be synced";
+            return false;
+        }
+        pindex = it->second;
+        if(!pindexBestHeader || pindexBestHeader->GetAncestor(pindex->nHeight) != pindex){
+            error = "Snapshot block is not on the best header chain";
+            return false;
+        }
+        if(pindex->hashStateRoot != header.hashStateRoot || pindex->hashUTXORoot != header.hashUTXORoot){
+            error = "Snapshot roots do not match the block header";
+            return false;
+        }
+        if(chainActive.Height() > 0){
+            error = "Snapshots can only be loaded on a node without blocks past genesis";
+            return false;
+        }
+    }
+
+    // The tries are only copied to the contract state once their roots match, what is left of a failed load is removed with the scratch databases
+    fs::path scratchPath = GetDataDir() / "snapshotstate";
+    fs::remove_all(scratchPath);
+    bool fLoaded = LoadStateSnapshotScratch(file, pindex, header, scratchPath, hashCoinsExpected, nThreads, stats, error);
+    fs::remove_all(scratchPath);
+    if(!fLoaded)
+        return false;
+    LogPrintf("Loaded state snapshot of block %s at height %d: %u accounts, %u vins, %u coins\n",
+              pindex->GetBlockHash().GetHex(), pindex->nHeight, stats.nAccounts, stats.nVins, stats.nCoins);
+    return true;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <coins.h>
+#include <fs.h>
+#include <serialize.h>
+#include <streams.h>
+#include <uint256.h>
+#include <libdevcore/OverlayDB.h>
+
+#include <atomic>
+
+/** Version of the state snapshot file format */
+static const uint32_t STATE_SNAPSHOT_VERSION = 2;
+/** Accounts, storage slots, vins or coins written in one chunk of a state snapshot */
+static const size_t STATE_SNAPSHOT_CHUNK = 10000;
+
+/** Block a state snapshot was taken at, at the start of the snapshot file */
+struct StateSnapshotHeader{
+    uint32_t nVersion;
+    uint256 hashGenesisBlock;
+    uint256 hashBlock;
+    int nHeight;
+    uint256 hashStateRoot;
+    uint256 hashUTXORoot;
+    unsigned int nTx;
+    uint64_t nChainTx;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nVersion);
+        READWRITE(hashGenesisBlock);
+        READWRITE(hashBlock);
+        READWRITE(nHeight);
+        READWRITE(hashStateRoot);
+        READWRITE(hashUTXORoot);
+        READWRITE(nTx);
+        READWRITE(nChainTx);
+    }
+};
+
+/** Position and hash of a chunk of coins in a snapshot file */
+struct StateSnapshotCoinsChunk{
+    long nPos;
+    uint256 hash;
+};
+
+/** What was written to or read from a state snapshot */
+struct StateSnapshotStats{
+    uint64_t nAccounts = 0;
+    uint64_t nStorage = 0;
+    uint64_t nVins = 0;
+    uint64_t nCoins = 0;
+    uint256 hashCoins;
+    dev::h256 stateRoot; // roots of the tries rebuilt by ReadStateSnapshot
+    dev::h256 utxoRoot;
+    std::vector<StateSnapshotCoinsChunk> vCoinsChunks; // coins found by ReadStateSnapshot
+};
+
+/**
+ * Write the accounts of the contract state trie at @a stateRoot with their code and storage, the
+ * vins of the UTXO trie at @a utxoRoot and the coins of @a coins to @a file, in chunks of at most
+ * STATE_SNAPSHOT_CHUNK entries, the storage of a large contract going on over several chunks.
+ * Only the leaves are written, the tries are rebuilt when reading.
+ */
+void WriteStateSnapshot(CAutoFile& file, dev::OverlayDB const& stateDB, dev::h256 const& stateRoot,
+                        dev::OverlayDB const& utxoDB, dev::h256 const& utxoRoot, CCoinsViewCursor& coins, StateSnapshotStats& stats);
+
+/**
+ * Rebuild the tries of a snapshot written by WriteStateSnapshot into @a stateDB and @a utxoDB, with
+ * the storage tries of the accounts of each chunk built on @a nThreads threads, and hash its coins.
+ * The roots of the rebuilt tries and the coins hash are returned in @a stats, for the caller to compare
+ * with those of the block, along with where the chunks of coins are for ReadStateSnapshotCoins.
+ * Returns false with @a error if the file is corrupted.
+ */
+bool ReadStateSnapshot(CAutoFile& file, dev::OverlayDB const& stateDB, dev::OverlayDB const& utxoDB,
+                       unsigned int nThreads, StateSnapshotStats& stats, std::string& error);
+
+/**
+ * Add the coins found by ReadStateSnapshot to @a coins, flushing it whenever it uses more than
+ * @a nCacheSize bytes. Each chunk is hashed again and must not have changed since it was read.
+ */
+bool ReadStateSnapshotCoins(CAutoFile& file, StateSnapshotStats const& stats, CCoinsViewCache& coins,
+                            size_t nCacheSize, std::string& error);
+
+/** Write a snapshot of the coins and contract state of the active chain tip to @a path */
+bool DumpStateSnapshot(const fs::path& path, StateSnapshotHeader& header, StateSnapshotStats& stats, std::string& error);
+
+/**
+ * Load the snapshot at @a path on a node that has not connected blocks past genesis, and make its
+ * block the tip. The block must be on the best header chain, and the tries, which are rebuilt in
+ * scratch databases first, must match its hashStateRoot and hashUTXORoot. The coins, which the block does not commit to, must match
+ * @a hashCoinsExpected. The blocks below the snapshot are not downloaded, the node keeps their headers only.
+ * From the point the chain state is written to until the snapshot block is the tip, a mark in the coins
+ * database keeps the node from starting again on it, the chain state then has to be rebuilt.
+ */
+bool LoadStateSnapshot(const fs::path& path, uint256 const& hashCoinsExpected, unsigned int nThreads,
+                       StateSnapshotHeader& header, StateSnapshotStats& stats, std::string& error);
+
+/** Height of the block the chain state was loaded from a snapshot at, 0 if none */
+extern std::atomic<int> nStateSnapshotHeight;
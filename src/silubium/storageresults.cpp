@@ -1,11 +1,18 @@
 #include <silubium/storageresults.h>
+#include <leveldb/write_batch.h>
+#include <utilstrencodings.h>
 
-StorageResults::StorageResults(std::string const& _path){
+static const std::string RESULTS_VERSION_KEY = "version";
+static const std::string RESULTS_VERSION = "1";
+
+StorageResults::StorageResults(std::string const& _path, size_t _cacheSize){
 	path = _path + "/resultsDB";
     options.create_if_missing = true;
     leveldb::Status status = leveldb::DB::Open(options, path, &db);
     assert(status.ok());
     LogPrintf("Opened LevelDB successfully\n");
+    m_shard_size = (_cacheSize + RECEIPT_CACHE_SHARDS - 1) / RECEIPT_CACHE_SHARDS;
+    migrateKeys();
 }
 
 StorageResults::~StorageResults()
@@ -15,11 +22,13 @@ StorageResults::~StorageResults()
 }
 
 void StorageResults::addResult(dev::h256 hashTx, std::vector<TransactionReceiptInfo>& result){
-	m_cache_result.insert(std::make_pair(hashTx, result));
+    LOCK(cs_pending);
+	m_pending_result.insert(std::make_pair(hashTx, result));
 }
 
 void StorageResults::clearCacheResult(){
-    m_cache_result.clear();
+    LOCK(cs_pending);
+    m_pending_result.clear();
 }
 
 void StorageResults::wipeResults(){
@@ -28,78 +37,140 @@ void StorageResults::wipeResults(){
 }
 
 void StorageResults::deleteResults(std::vector<CTransactionRef> const& txs){
-
-    for(CTransactionRef tx : txs){
-        dev::h256 hashTx = uintToh256(tx->GetHash());
-        m_cache_result.erase(hashTx);
-
-        std::string keyTemp = hashTx.hex();
-	    leveldb::Slice key(keyTemp);
-        leveldb::Status status = db->Delete(leveldb::WriteOptions(), key);
-        assert(status.ok());
+    leveldb::WriteBatch batch;
+    {
+        LOCK(cs_pending);
+        for(CTransactionRef tx : txs){
+            dev::h256 hashTx = uintToh256(tx->GetHash());
+            m_pending_result.erase(hashTx);
+            eraseCached(hashTx);
+            batch.Delete(resultKey(hashTx));
+        }
     }
+    leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+    assert(status.ok());
 }
 
 std::vector<TransactionReceiptInfo> StorageResults::getResult(dev::h256 const& hashTx){
     std::vector<TransactionReceiptInfo> result;
-	auto it = m_cache_result.find(hashTx);
-	if (it == m_cache_result.end()){
-		if(readResult(hashTx, result))
-			m_cache_result.insert(std::make_pair(hashTx, result));
-    } else {
-		result = it->second;
+    {
+        LOCK(cs_pending);
+        auto it = m_pending_result.find(hashTx);
+        if (it != m_pending_result.end())
+            return it->second;
     }
+    if (!getCached(hashTx, result) && readResult(hashTx, result))
+        setCached(hashTx, result);
 	return result;
 }
 
 void StorageResults::commitResults(){
-    if(m_cache_result.size()){
-
-        for (auto const& i: m_cache_result){
-            std::string valueTemp;
-            std::string keyTemp = i.first.hex();
-            leveldb::Slice key(keyTemp);
-            leveldb::Status status = db->Get(leveldb::ReadOptions(), key, &valueTemp);
-
-            if(status.IsNotFound()){
-
-                TransactionReceiptInfoSerialized tris;
-
-                for(size_t j = 0; j < i.second.size(); j++){
-                    tris.blockHashes.push_back(uintToh256(i.second[j].blockHash));
-                    tris.blockNumbers.push_back(i.second[j].blockNumber);
-                    tris.transactionHashes.push_back(uintToh256(i.second[j].transactionHash));
-                    tris.transactionIndexes.push_back(i.second[j].transactionIndex);
-                    tris.senders.push_back(i.second[j].from);
-                    tris.receivers.push_back(i.second[j].to);
-                    tris.cumulativeGasUsed.push_back(dev::u256(i.second[j].cumulativeGasUsed));
-                    tris.gasUsed.push_back(dev::u256(i.second[j].gasUsed));
-                    tris.contractAddresses.push_back(i.second[j].contractAddress);
-                    tris.logs.push_back(logEntriesSerialization(i.second[j].logs));
-                    tris.excepted.push_back(uint32_t(static_cast<int>(i.second[j].excepted)));
-                }
-
-                dev::RLPStream streamRLP(11);
-                streamRLP << tris.blockHashes << tris.blockNumbers << tris.transactionHashes << tris.transactionIndexes << tris.senders;
-                streamRLP << tris.receivers << tris.cumulativeGasUsed << tris.gasUsed << tris.contractAddresses << tris.logs << tris.excepted;
-
-                dev::bytes data = streamRLP.out();
-                std::string stringData(data.begin(), data.end());
-                leveldb::Slice value(stringData);
-                status = db->Put(leveldb::WriteOptions(), key, value);
-                assert(status.ok());
-            }
+    LOCK(cs_pending);
+    if(m_pending_result.size()){
+        leveldb::WriteBatch batch;
+        for (auto const& i: m_pending_result){
+            batch.Put(resultKey(i.first), serializeResult(i.second));
+            eraseCached(i.first);
         }
-        m_cache_result.clear();
+        leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+        assert(status.ok());
+        m_pending_result.clear();
+    }
+}
+
+std::string StorageResults::serializeResult(std::vector<TransactionReceiptInfo> const& _result){
+    TransactionReceiptInfoSerialized tris;
+
+    for(size_t j = 0; j < _result.size(); j++){
+        tris.blockHashes.push_back(uintToh256(_result[j].blockHash));
+        tris.blockNumbers.push_back(_result[j].blockNumber);
+        tris.transactionHashes.push_back(uintToh256(_result[j].transactionHash));
+        tris.transactionIndexes.push_back(_result[j].transactionIndex);
+        tris.senders.push_back(_result[j].from);
+        tris.receivers.push_back(_result[j].to);
+        tris.cumulativeGasUsed.push_back(dev::u256(_result[j].cumulativeGasUsed));
+        tris.gasUsed.push_back(dev::u256(_result[j].gasUsed));
+        tris.contractAddresses.push_back(_result[j].contractAddress);
+        tris.logs.push_back(logEntriesSerialization(_result[j].logs));
+        tris.excepted.push_back(uint32_t(static_cast<int>(_result[j].excepted)));
+    }
+
+    dev::RLPStream streamRLP(11);
+    streamRLP << tris.blockHashes << tris.blockNumbers << tris.transactionHashes << tris.transactionIndexes << tris.senders;
+    streamRLP << tris.receivers << tris.cumulativeGasUsed << tris.gasUsed << tris.contractAddresses << tris.logs << tris.excepted;
+
+    dev::bytes data = streamRLP.out();
+    return std::string(data.begin(), data.end());
+}
+
+void StorageResults::migrateKeys(){
+    std::string version;
+    if(db->Get(leveldb::ReadOptions(), RESULTS_VERSION_KEY, &version).ok() && version == RESULTS_VERSION)
+        return;
+
+    size_t count = 0;
+    leveldb::WriteBatch batch;
+    std::unique_ptr<leveldb::Iterator> it(db->NewIterator(leveldb::ReadOptions()));
+    for(it->SeekToFirst(); it->Valid(); it->Next()){
+        std::string key = it->key().ToString();
+        if(key.size() != dev::h256::size * 2 || !IsHex(key))
+            continue;
+        batch.Put(resultKey(dev::h256(key)), it->value());
+        batch.Delete(it->key());
+        if(++count % 10000 == 0){
+            leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+            assert(status.ok());
+            batch.Clear();
+        }
+    }
+    assert(it->status().ok());
+    batch.Put(RESULTS_VERSION_KEY, RESULTS_VERSION);
+    leveldb::Status status = db->Write(leveldb::WriteOptions(), &batch);
+    assert(status.ok());
+    if(count)
+        LogPrintf("Migrated %u transaction receipts to binary keys\n", count);
+}
+
+bool StorageResults::getCached(dev::h256 const& _hashTx, std::vector<TransactionReceiptInfo>& _result){
+    CacheShard& shard = m_cache_result[_hashTx[0] % RECEIPT_CACHE_SHARDS];
+    LOCK(shard.cs);
+    auto it = shard.index.find(_hashTx);
+    if(it == shard.index.end())
+        return false;
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    _result = it->second->second;
+    return true;
+}
+
+void StorageResults::setCached(dev::h256 const& _hashTx, std::vector<TransactionReceiptInfo> const& _result){
+    if(!m_shard_size)
+        return;
+    CacheShard& shard = m_cache_result[_hashTx[0] % RECEIPT_CACHE_SHARDS];
+    LOCK(shard.cs);
+    if(shard.index.count(_hashTx))
+        return;
+    shard.entries.emplace_front(_hashTx, _result);
+    shard.index[_hashTx] = shard.entries.begin();
+    if(shard.entries.size() > m_shard_size){
+        shard.index.erase(shard.entries.back().first);
+        shard.entries.pop_back();
+    }
+}
+
+void StorageResults::eraseCached(dev::h256 const& _hashTx){
+    CacheShard& shard = m_cache_result[_hashTx[0] % RECEIPT_CACHE_SHARDS];
+    LOCK(shard.cs);
+    auto it = shard.index.find(_hashTx);
+    if(it != shard.index.end()){
+        shard.entries.erase(it->second);
+        shard.index.erase(it);
     }
 }
 
 bool StorageResults::readResult(dev::h256 const& _key, std::vector<TransactionReceiptInfo>& _result){
 
     std::string value;
-    std::string keyTemp = _key.hex();;
-    leveldb::Slice key(keyTemp);
-    leveldb::Status s = db->Get(leveldb::ReadOptions(), key, &value);
+    leveldb::Status s = db->Get(leveldb::ReadOptions(), resultKey(_key), &value);
 
 	if(!s.IsNotFound() && s.ok()){
         
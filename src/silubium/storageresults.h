@@ -1,8 +1,19 @@
+#pragma once
+
 #include <uint256.h>
 #include <primitives/transaction.h>
 #include <libethereum/State.h>
 #include <libethereum/Transaction.h>
 #include "util.h"
+#include "sync.h"
+
+#include <array>
+#include <list>
+
+/** Default for -receiptcache, number of transaction receipts kept in memory for lookups */
+static const unsigned int DEFAULT_RECEIPT_CACHE_SIZE = 10000;
+/** Number of independently locked parts of the receipt cache */
+static const unsigned int RECEIPT_CACHE_SHARDS = 16;
 
 using logEntriesSerializ = std::vector<std::pair<dev::Address, std::pair<dev::h256s, dev::bytes>>>;
 
@@ -38,7 +49,7 @@ class StorageResults{
 
 public:
 
-	StorageResults(std::string const& _path);
+	StorageResults(std::string const& _path, size_t _cacheSize = DEFAULT_RECEIPT_CACHE_SIZE);
     ~StorageResults();
 
 	void addResult(dev::h256 hashTx, std::vector<TransactionReceiptInfo>& result);
@@ -49,6 +60,7 @@ public:
 
 	void commitResults();
 
+    // Drop the results added since the last commit
     void clearCacheResult();
 
     void wipeResults();
@@ -57,6 +69,19 @@ private:
 
 	bool readResult(dev::h256 const& _key, std::vector<TransactionReceiptInfo>& _result);
 
+	std::string serializeResult(std::vector<TransactionReceiptInfo> const& _result);
+
+	// Rewrite the 64 character hex keys of older databases as 32 byte binary keys
+	void migrateKeys();
+
+	static std::string resultKey(dev::h256 const& _hashTx) { return std::string((char const*)_hashTx.data(), dev::h256::size); }
+
+	bool getCached(dev::h256 const& _hashTx, std::vector<TransactionReceiptInfo>& _result);
+
+	void setCached(dev::h256 const& _hashTx, std::vector<TransactionReceiptInfo> const& _result);
+
+	void eraseCached(dev::h256 const& _hashTx);
+
 	logEntriesSerializ logEntriesSerialization(dev::eth::LogEntries const& _logs);
 
 	dev::eth::LogEntries logEntriesDeserialize(logEntriesSerializ const& _logs);
@@ -67,5 +92,17 @@ private:
 
     leveldb::Options options;
 
-	std::unordered_map<dev::h256, std::vector<TransactionReceiptInfo>> m_cache_result;
+	// Results of the blocks connected since the last commit
+	CCriticalSection cs_pending;
+	std::unordered_map<dev::h256, std::vector<TransactionReceiptInfo>> m_pending_result;
+
+	// Least recently used results read from the database, sharded by the first byte of the tx hash
+	struct CacheShard{
+		CCriticalSection cs;
+		std::list<std::pair<dev::h256, std::vector<TransactionReceiptInfo>>> entries; // most recently used first
+		std::unordered_map<dev::h256, std::list<std::pair<dev::h256, std::vector<TransactionReceiptInfo>>>::iterator> index;
+	};
+	std::array<CacheShard, RECEIPT_CACHE_SHARDS> m_cache_result;
+
+	size_t m_shard_size;
 };
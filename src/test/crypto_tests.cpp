@@ -4,6 +4,7 @@
 
 #include "crypto/aes.h"
 #include "crypto/chacha20.h"
+#include "crypto/common.h"
 #include "crypto/ripemd160.h"
 #include "crypto/sha1.h"
 #include "crypto/sha256.h"
@@ -483,6 +484,30 @@ BOOST_AUTO_TEST_CASE(chacha20_testvector)
                  "fab78c9");
 }
 
+BOOST_AUTO_TEST_CASE(sha256_transform_batch)
+{
+    // Odd count, so that the lanes of the wider paths are both filled and left over
+    const size_t count = 11;
+    std::vector<uint32_t> states(8 * count);
+    std::vector<unsigned char> blocks(64 * count, 0);
+    for (size_t i = 0; i < count; i++) {
+        SHA256Initialize(&states[8 * i]);
+        unsigned char* block = &blocks[64 * i];
+        for (size_t j = 0; j < i; j++) block[j] = InsecureRandBits(8);
+        block[i] = 0x80;
+        block[63] = i * 8;
+    }
+    SHA256TransformBatch(states.data(), blocks.data(), count);
+
+    for (size_t i = 0; i < count; i++) {
+        unsigned char expected[CSHA256::OUTPUT_SIZE];
+        CSHA256().Write(&blocks[64 * i], i).Finalize(expected);
+        for (int j = 0; j < 8; j++) {
+            BOOST_CHECK_EQUAL(states[8 * i + j], ReadBE32(expected + 4 * j));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(countbits_tests)
 {
     FastRandomContext ctx;
@@ -0,0 +1,124 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <keystore.h>
+#include <pos.h>
+#include <script/sign.h>
+#include <validation.h>
+
+namespace {
+
+/** Chain of block indexes with the stake modifiers and times a kernel reads */
+struct StakeChain {
+    std::vector<CBlockIndex> blocks;
+
+    StakeChain(int nBlocks) : blocks(nBlocks) {
+        for(int i = 0; i < nBlocks; i++){
+            blocks[i].nHeight = i;
+            blocks[i].pprev = i ? &blocks[i - 1] : nullptr;
+            blocks[i].nTime = 1500000000 + i * 128;
+            blocks[i].nStakeModifier = ArithToUint256(arith_uint256(i + 1));
+            blocks[i].BuildSkip();
+        }
+    }
+};
+
+CMutableTransaction CreateCoinStake(const CKey& key, const COutPoint& prevout, const Coin& coin){
+    CMutableTransaction tx;
+    tx.vin.push_back(CTxIn(prevout));
+    tx.vout.push_back(CTxOut());
+    tx.vout[0].SetEmpty();
+    tx.vout.push_back(CTxOut(coin.out.nValue, coin.out.scriptPubKey));
+    CBasicKeyStore keystore;
+    keystore.AddKey(key);
+    BOOST_CHECK(SignSignature(keystore, coin.out.scriptPubKey, tx, 0, coin.out.nValue, SIGHASH_ALL));
+    return tx;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(blockproofcheck_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(blockproofcheck_signature){
+    CKey key;
+    key.MakeNewKey(true);
+    COutPoint prevout(InsecureRand256(), 1);
+    Coin coin(CTxOut(1000, CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG), 10, false, false);
+
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(CMutableTransaction()));
+    block.vtx.push_back(MakeTransactionRef(CreateCoinStake(key, prevout, coin)));
+    block.prevoutStake = prevout;
+    BOOST_CHECK(key.Sign(block.GetHashWithoutSign(), block.vchBlockSig));
+
+    BlockProofPrecheck precheck;
+    precheck.pblock = std::make_shared<const CBlock>(block);
+    CBlockProofCheck check(precheck);
+    BOOST_CHECK(check());
+    BOOST_CHECK(precheck.fSignature && !precheck.fStake);
+
+    // A bad signature is left for ConnectBlock, as is a block without the coinstake holding its key
+    block.vchBlockSig[block.vchBlockSig.size() - 1] ^= 1;
+    BlockProofPrecheck bad;
+    bad.pblock = std::make_shared<const CBlock>(block);
+    BOOST_CHECK(CBlockProofCheck(bad)());
+    BOOST_CHECK(!bad.fSignature);
+
+    block.vtx.resize(1);
+    BlockProofPrecheck missing;
+    missing.pblock = std::make_shared<const CBlock>(block);
+    BOOST_CHECK(CBlockProofCheck(missing)());
+    BOOST_CHECK(!missing.fSignature);
+}
+
+BOOST_AUTO_TEST_CASE(blockproofcheck_stake){
+    StakeChain chain(COINBASE_MATURITY + 50);
+    CBlockIndex* pindexPrev = &chain.blocks.back();
+    CBlockIndex index;
+    index.pprev = pindexPrev;
+    index.nHeight = pindexPrev->nHeight + 1;
+
+    CKey key;
+    key.MakeNewKey(true);
+    COutPoint prevout(InsecureRand256(), 0);
+    Coin coin(CTxOut(1000, CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG), 10, false, false);
+    CTransaction txCoinStake(CreateCoinStake(key, prevout, coin));
+
+    CCoinsView coinsDummy;
+    CCoinsViewCache view(&coinsDummy);
+    view.AddCoin(prevout, Coin(coin), false);
+
+    // The check with the stake coin looked up ahead agrees with the one reading the coins view
+    unsigned int nBits = 0x1f00ffff;
+    for(uint32_t nTime = pindexPrev->nTime + 16; nTime < pindexPrev->nTime + 16 * 64; nTime += 16){
+        CValidationState state, stateCoin;
+        uint256 hashProof, hashProofCoin, target, targetCoin;
+        bool fStake = CheckProofOfStake(pindexPrev, state, txCoinStake, nBits, nTime, hashProof, target, view);
+        bool fStakeCoin = CheckProofOfStake(pindexPrev, stateCoin, txCoinStake, nBits, nTime, coin, hashProofCoin, targetCoin);
+        BOOST_CHECK(fStake == fStakeCoin);
+        BOOST_CHECK(hashProof == hashProofCoin);
+
+        CBlock block;
+        block.vtx.push_back(MakeTransactionRef(CMutableTransaction()));
+        block.vtx.push_back(MakeTransactionRef(txCoinStake));
+        block.prevoutStake = prevout;
+        block.nBits = nBits;
+        block.nTime = nTime;
+        BlockProofPrecheck precheck;
+        precheck.pblock = std::make_shared<const CBlock>(block);
+        precheck.pindex = &index;
+        precheck.coinStake = coin;
+        precheck.fHaveCoinStake = true;
+        BOOST_CHECK(CBlockProofCheck(precheck)());
+        BOOST_CHECK(precheck.fStake == fStake);
+        BOOST_CHECK(!fStake || precheck.hashProof == hashProof);
+    }
+
+    // An immature stake fails either way
+    Coin immature(coin.out, pindexPrev->nHeight, false, false);
+    CValidationState state;
+    uint256 hashProof, target;
+    BOOST_CHECK(!CheckProofOfStake(pindexPrev, state, txCoinStake, nBits, pindexPrev->nTime + 16, immature, hashProof, target));
+    BOOST_CHECK(state.IsInvalid());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
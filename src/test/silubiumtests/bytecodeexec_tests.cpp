@@ -1,6 +1,8 @@
 #include <boost/test/unit_test.hpp>
 #include <test/test_bitcoin.h>
 #include <silubiumtests/test_utils.h>
+#include <thread>
+#include <libevm/CodeAnalysisCache.h>
 
 dev::u256 GASLIMIT = dev::u256(500000);
 dev::Address SENDERADDRESS = dev::Address("0101010101010101010101010101010101010101");
@@ -374,4 +376,236 @@ BOOST_AUTO_TEST_CASE(bytecodeexec_contract_create_contracts){
     BOOST_CHECK(result.second.valueTransfers.size() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(bytecodeexec_speculative_apply){
+    initState();
+    SilubiumTransaction txEthCreate = createSilubiumTransaction(CODE[3], 0, GASLIMIT, dev::u256(1), HASHTX, dev::Address());
+    executeBC(std::vector<SilubiumTransaction>(1, txEthCreate));
+    dev::Address factory(createSilubiumAddress(txEthCreate.getHashWith(), txEthCreate.getNVout()));
+    dev::h256 hashTx2(ParseHex("bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb"));
+    std::vector<std::vector<SilubiumTransaction>> txs = {
+        {createSilubiumTransaction(ParseHex("3f811b80"), 0, GASLIMIT, dev::u256(1), HASHTX, factory, 0)},
+        {createSilubiumTransaction(CODE[0], 0, GASLIMIT, dev::u256(1), hashTx2, dev::Address())},
+        {createSilubiumTransaction(ParseHex("3f811b80"), 0, GASLIMIT, dev::u256(1), HASHTX, factory, 1)}
+    };
+    dev::h256 oldHashStateRoot(globalState->rootHash());
+    dev::h256 oldHashUTXORoot(globalState->rootHashUTXO());
+    for(auto& t : txs)
+        executeBC(t);
+    dev::h256 serialHashStateRoot(globalState->rootHash());
+    dev::h256 serialHashUTXORoot(globalState->rootHashUTXO());
+    globalState->setRoot(oldHashStateRoot);
+    globalState->setRootUTXO(oldHashUTXORoot);
+
+    CBlock block(generateBlock());
+    uint64_t blockGasLimit = SilubiumDGP(globalState.get(), fGettingValuesDGP).getBlockGasLimit(chainActive.Tip()->nHeight + 1);
+    std::vector<SilubiumAccessSet> access(txs.size());
+    std::vector<std::vector<SilubiumStateDiff>> diffs(txs.size());
+    std::vector<std::vector<ResultExecute>> results(txs.size());
+    for(size_t i = 0; i < txs.size(); i++){
+        SilubiumState fork(*globalState);
+        ByteCodeExec exec(block, txs[i], blockGasLimit);
+        BOOST_CHECK(exec.performSpeculative(fork, *globalSealEngine, access[i], diffs[i]));
+        globalSealEngine->deleteAddresses.clear();
+        results[i].swap(exec.getResult());
+        BOOST_CHECK(diffs[i].size() == 1);
+    }
+
+    // the second call of the factory reads what the first one wrote and has to be executed again
+    SilubiumAccessSet written;
+    for(size_t i = 0; i < txs.size(); i++){
+        ByteCodeExec exec(block, txs[i], blockGasLimit);
+        if(access[i].conflicts(written)){
+            BOOST_CHECK(i == 2);
+            SilubiumAccessSet serialAccess;
+            SilubiumStateRecorder recorder(*globalState, serialAccess);
+            BOOST_CHECK(exec.performByteCode());
+            written.addWrites(serialAccess);
+        } else {
+            exec.applySpeculative(results[i], diffs[i]);
+            BOOST_CHECK(exec.getResult()[0].execRes.excepted == dev::eth::TransactionException::None);
+            BOOST_CHECK(exec.getResult()[0].txRec.stateRoot() == globalState->rootHash());
+            written.addWrites(access[i]);
+        }
+    }
+    BOOST_CHECK(written.storageWrites.size() > 0);
+    BOOST_CHECK(globalState->rootHash() == serialHashStateRoot);
+    BOOST_CHECK(globalState->rootHashUTXO() == serialHashUTXORoot);
+}
+
+BOOST_AUTO_TEST_CASE(bytecodeexec_last_block_hashes){
+    // A chain of 300 blocks, with a fork of 2 blocks off height 297
+    std::vector<uint256> hashes(302);
+    std::vector<CBlockIndex> indexes(302);
+    for(size_t i = 0; i < indexes.size(); i++){
+        hashes[i] = ArithToUint256(arith_uint256(i + 1));
+        indexes[i].phashBlock = &hashes[i];
+        indexes[i].nHeight = i < 300 ? i : i - 3;
+        indexes[i].pprev = i == 0 ? nullptr : i == 300 ? &indexes[297] : &indexes[i - 1];
+        indexes[i].BuildSkip();
+    }
+
+    CLastBlockHashes fresh;
+    CLastBlockHashes ring;
+    ring.Get(&indexes[0]);
+    for(size_t i = 1; i < 300; i++){
+        ring.Connect(&indexes[i]);
+        if(i % 50 == 0 || i < 3)
+            BOOST_CHECK(*ring.Get(&indexes[i]) == *fresh.Get(&indexes[i]));
+    }
+
+    std::shared_ptr<const dev::eth::LastHashes> lh = ring.Get(&indexes[299]);
+    BOOST_CHECK(lh->size() == 256);
+    BOOST_CHECK((*lh)[0] == uintToh256(hashes[299]) && (*lh)[255] == uintToh256(hashes[44]));
+    BOOST_CHECK(ring.Get(&indexes[299]) == lh);
+
+    // Disconnecting back to the fork point brings the older hashes back
+    ring.Disconnect(&indexes[298]);
+    ring.Disconnect(&indexes[297]);
+    BOOST_CHECK(*ring.Get(&indexes[297]) == *fresh.Get(&indexes[297]));
+    ring.Connect(&indexes[300]);
+    ring.Connect(&indexes[301]);
+    BOOST_CHECK(*ring.Get(&indexes[301]) == *fresh.Get(&indexes[301]));
+
+    // Near genesis the missing hashes are zero
+    lh = fresh.Get(&indexes[1]);
+    BOOST_CHECK((*lh)[1] == uintToh256(hashes[0]) && (*lh)[2] == dev::h256());
+}
+
+BOOST_AUTO_TEST_CASE(bytecodeexec_call_contract_snapshot){
+    initState();
+    SilubiumTransaction txEthCreate = createSilubiumTransaction(CODE[3], 0, GASLIMIT, dev::u256(1), HASHTX, dev::Address());
+    executeBC(std::vector<SilubiumTransaction>(1, txEthCreate));
+    dev::Address factory(createSilubiumAddress(txEthCreate.getHashWith(), txEthCreate.getNVout()));
+    dev::h256 snapshotHashStateRoot(globalState->rootHash());
+
+    ContractStateSnapshot snapshot;
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(GetContractStateSnapshot(snapshot));
+    }
+    BOOST_CHECK(snapshot.state->rootHash() == snapshotHashStateRoot);
+
+    // The global state moves on, the snapshot stays at the root it was taken at
+    executeBC(std::vector<SilubiumTransaction>(1, createSilubiumTransaction(ParseHex("3f811b80"), 0, GASLIMIT, dev::u256(1), HASHTX, factory, 1)));
+    dev::h256 newHashStateRoot(globalState->rootHash());
+    BOOST_CHECK(newHashStateRoot != snapshotHashStateRoot);
+    BOOST_CHECK(snapshot.state->storage(factory).size() < globalState->storage(factory).size());
+
+    std::vector<ResultExecute> result = CallContract(snapshot, factory, ParseHex("3f811b80"));
+    BOOST_CHECK(result.size() == 1);
+    BOOST_CHECK(result[0].execRes.excepted == dev::eth::TransactionException::None);
+    BOOST_CHECK(snapshot.state->rootHash() == snapshotHashStateRoot);
+    BOOST_CHECK(globalState->rootHash() == newHashStateRoot);
+
+    // Calls on snapshots of their own run concurrently and match the serial call
+    std::vector<ContractStateSnapshot> snapshots(4);
+    {
+        LOCK(cs_main);
+        for(ContractStateSnapshot& s : snapshots)
+            BOOST_CHECK(GetContractStateSnapshot(s));
+    }
+    std::vector<ResultExecute> expected = CallContract(snapshots[0], factory, ParseHex("3f811b80"));
+    std::vector<std::vector<ResultExecute>> results(snapshots.size());
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < snapshots.size(); i++)
+        threads.emplace_back([&, i](){ results[i] = CallContract(snapshots[i], factory, ParseHex("3f811b80")); });
+    for(std::thread& t : threads)
+        t.join();
+    for(std::vector<ResultExecute>& r : results){
+        BOOST_CHECK(r.size() == 1);
+        BOOST_CHECK(r[0].execRes.excepted == dev::eth::TransactionException::None);
+        BOOST_CHECK(r[0].execRes.gasUsed == expected[0].execRes.gasUsed);
+        BOOST_CHECK(r[0].txRec.stateRoot() == expected[0].txRec.stateRoot());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(bytecodeexec_call_contract_batch){
+    initState();
+    SilubiumTransaction txEthCreate = createSilubiumTransaction(CODE[3], 0, GASLIMIT, dev::u256(1), HASHTX, dev::Address());
+    executeBC(std::vector<SilubiumTransaction>(1, txEthCreate));
+    dev::Address factory(createSilubiumAddress(txEthCreate.getHashWith(), txEthCreate.getNVout()));
+
+    ContractStateSnapshot snapshot;
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(GetContractStateSnapshot(snapshot));
+    }
+    dev::h256 snapshotHashStateRoot(snapshot.state->rootHash());
+
+    std::vector<ContractCall> calls(7);
+    for(size_t i = 0; i < calls.size(); i++){
+        calls[i].address = factory;
+        calls[i].data = ParseHex("3f811b80");
+        calls[i].sender = i % 2 ? SENDERADDRESS : dev::Address();
+    }
+    calls[3].address = dev::Address("0303030303030303030303030303030303030303");
+    calls[5].gasLimit = 21000;
+
+    std::vector<ResultExecute> serial;
+    for(ContractCall const& call : calls)
+        serial.push_back(CallContract(snapshot, call.address, call.data, call.sender, call.gasLimit)[0]);
+
+    // The batch matches the calls made one by one, in order, whatever the number of threads
+    for(unsigned int nThreads : {1, 3, 16}){
+        std::vector<ResultExecute> batch = CallContractBatch(snapshot, calls, nThreads);
+        BOOST_CHECK(batch.size() == calls.size());
+        for(size_t i = 0; i < batch.size(); i++){
+            BOOST_CHECK(batch[i].execRes.excepted == serial[i].execRes.excepted);
+            BOOST_CHECK(batch[i].execRes.gasUsed == serial[i].execRes.gasUsed);
+            BOOST_CHECK(batch[i].txRec.stateRoot() == serial[i].txRec.stateRoot());
+        }
+    }
+    BOOST_CHECK(serial[0].execRes.excepted == dev::eth::TransactionException::None);
+    BOOST_CHECK(serial[3].txRec.stateRoot() == dev::h256());
+    BOOST_CHECK(serial[5].execRes.excepted != dev::eth::TransactionException::None);
+    BOOST_CHECK(snapshot.state->rootHash() == snapshotHashStateRoot);
+    BOOST_CHECK(CallContractBatch(snapshot, std::vector<ContractCall>(), 4).empty());
+}
+
+BOOST_AUTO_TEST_CASE(bytecodeexec_code_analysis_cache){
+    initState();
+    dev::eth::CodeAnalysisCache& cache = dev::eth::CodeAnalysisCache::instance();
+    cache.clear();
+    uint64_t hits = cache.hits();
+
+    // The contracts are created with the same init code, which is only analyzed once
+    std::vector<dev::Address> newAddressGen;
+    std::vector<SilubiumTransaction> txs;
+    dev::h256 hash(HASHTX);
+    for(size_t i = 0; i < 5; i++){
+        SilubiumTransaction txEth = createSilubiumTransaction(CODE[0], 0, GASLIMIT, dev::u256(1), hash, dev::Address(), i);
+        newAddressGen.push_back(createSilubiumAddress(txEth.getHashWith(), txEth.getNVout()));
+        txs.push_back(txEth);
+        ++hash;
+    }
+    auto result = executeBC(txs);
+    valtype code = ParseHex("60606040525b600b5b5b565b0000a165627a7a723058209cedb722bf57a30e3eb00eeefc392103ea791a2001deed29f5c3809ff10eb1dd0029");
+    checkExecResult(result.first, 5, 5, dev::eth::TransactionException::None, newAddressGen, code, dev::u256(0));
+    BOOST_CHECK(cache.hits() >= hits + 4);
+    BOOST_CHECK(cache.size() > 0);
+
+    // The created contracts share their code too
+    hits = cache.hits();
+    std::vector<SilubiumTransaction> txsCall;
+    for(size_t i = 0; i < 2; i++)
+        txsCall.push_back(createSilubiumTransaction(ParseHex("00"), 0, GASLIMIT, dev::u256(1), hash, newAddressGen[i], i));
+    auto resultCached = executeBC(txsCall);
+    BOOST_CHECK(resultCached.first[0].execRes.excepted == dev::eth::TransactionException::None);
+    BOOST_CHECK(resultCached.first[1].execRes.excepted == dev::eth::TransactionException::None);
+    BOOST_CHECK(cache.hits() >= hits + 1);
+
+    // Without room in the cache each frame analyzes the code on its own, with the same results
+    cache.setMaxSize(0);
+    BOOST_CHECK(cache.size() == 0);
+    ++hash;
+    txsCall.clear();
+    for(size_t i = 2; i < 4; i++)
+        txsCall.push_back(createSilubiumTransaction(ParseHex("00"), 0, GASLIMIT, dev::u256(1), hash, newAddressGen[i], i));
+    auto resultUncached = executeBC(txsCall);
+    BOOST_CHECK(resultUncached.first[1].execRes.excepted == dev::eth::TransactionException::None);
+    BOOST_CHECK(resultUncached.first[1].execRes.gasUsed == resultCached.first[1].execRes.gasUsed);
+    BOOST_CHECK(cache.size() == 0);
+    cache.setMaxSize(dev::eth::CodeAnalysisCache::c_defaultMaxSize);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
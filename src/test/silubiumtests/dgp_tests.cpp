@@ -1,6 +1,7 @@
 #include <boost/test/unit_test.hpp>
 #include <silubiumtests/test_utils.h>
 #include <script/standard.h>
+#include <chainparams.h>
 
 namespace dgpTest{
 
@@ -580,6 +581,72 @@ BOOST_AUTO_TEST_CASE(min_gas_price_passage_from_130_to_0_three_paramsInstance_te
     }
 }
 
+BOOST_AUTO_TEST_CASE(min_gas_price_cache_rewind_state_root_test){
+    initState();
+    contractLoading();
+    dev::h256 oldHashStateRoot = globalState->rootHash();
+
+    dev::h256 hashTemp(hash);
+    std::vector<SilubiumTransaction> txs;
+    txs.push_back(createSilubiumTransaction(code[0], 0, dev::u256(500000), dev::u256(1), hashTemp, GasPriceDGP, 0));
+    txs.push_back(createSilubiumTransaction(code[10], 0, dev::u256(500000), dev::u256(1), ++hashTemp, dev::Address(), 0));
+    txs.push_back(createSilubiumTransaction(code[2], 0, dev::u256(500000), dev::u256(1), ++hashTemp, GasPriceDGP, 0));
+    auto result = executeBC(txs);
+    dev::h256 newHashStateRoot = globalState->rootHash();
+
+    SilubiumDGP silubiumDGP(globalState.get());
+    BOOST_CHECK(silubiumDGP.getMinGasPrice(502) == 13);
+
+    globalState->setRoot(oldHashStateRoot);
+    BOOST_CHECK(silubiumDGP.getMinGasPrice(502) == DEFAULT_MIN_GAS_PRICE_DGP);
+
+    globalState->setRoot(newHashStateRoot);
+    BOOST_CHECK(silubiumDGP.getMinGasPrice(502) == 13);
+
+    dgpCache.clear();
+    BOOST_CHECK(silubiumDGP.getMinGasPrice(502) == 13);
+}
+
+BOOST_AUTO_TEST_CASE(template_context_free_test){
+    // PUSH1 0x2a PUSH1 0 MSTORE PUSH1 32 PUSH1 0 RETURN
+    BOOST_CHECK(SilubiumDGP::isContextFree(ParseHex("602a60005260206000f3")));
+    // SLOAD of the template's own storage
+    BOOST_CHECK(SilubiumDGP::isContextFree(ParseHex("60005460005260206000f3")));
+    // NUMBER, TIMESTAMP and GAS, and BALANCE and CALL reach outside the template
+    BOOST_CHECK(!SilubiumDGP::isContextFree(ParseHex("4360005260206000f3")));
+    BOOST_CHECK(!SilubiumDGP::isContextFree(ParseHex("4260005260206000f3")));
+    BOOST_CHECK(!SilubiumDGP::isContextFree(ParseHex("5a60005260206000f3")));
+    BOOST_CHECK(!SilubiumDGP::isContextFree(ParseHex("303160005260206000f3")));
+    BOOST_CHECK(!SilubiumDGP::isContextFree(ParseHex("6000600060006000600030617530f1")));
+    // Push data is not read as instructions
+    BOOST_CHECK(SilubiumDGP::isContextFree(ParseHex("6343425af160005260206000f3")));
+}
+
+BOOST_AUTO_TEST_CASE(gas_schedule_precompiles_fork_test){
+    const dev::eth::EVMSchedule& s = dev::eth::EIP158Schedule;
+    std::vector<uint32_t> defaults(s.tierStepGas.begin(), s.tierStepGas.end());
+    defaults.resize(39, 1000);
+    std::vector<uint32_t> precompiles = {s.modexpQuadDivisor, s.bn128AddGas, s.bn128MulGas, s.bn128PairingBaseGas, s.bn128PairingPairGas, s.blake2RoundGas};
+    std::vector<uint32_t> schedule39 = defaults;
+    defaults.insert(defaults.end(), precompiles.begin(), precompiles.end());
+    std::vector<uint32_t> schedule45 = defaults;
+
+    // Before the fork a schedule with the precompiled contract prices is rejected, as old nodes reject it
+    BOOST_CHECK(SilubiumDGP::checkLimitSchedule(defaults, schedule39, false));
+    BOOST_CHECK(!SilubiumDGP::checkLimitSchedule(defaults, schedule45, false));
+
+    // From the fork both are valid, and the added prices are checked against their limits too
+    BOOST_CHECK(SilubiumDGP::checkLimitSchedule(defaults, schedule39, true));
+    BOOST_CHECK(SilubiumDGP::checkLimitSchedule(defaults, schedule45, true));
+    schedule45[42] = defaults[42] * 1000 + 1;
+    BOOST_CHECK(!SilubiumDGP::checkLimitSchedule(defaults, schedule45, true));
+    schedule45.pop_back();
+    BOOST_CHECK(!SilubiumDGP::checkLimitSchedule(defaults, schedule45, true));
+
+    // Regtest runs the precompiled contracts from genesis, so no schedule is read with the old limits there
+    BOOST_CHECK(Params().GetConsensus().nPrecompilesHFHeight == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
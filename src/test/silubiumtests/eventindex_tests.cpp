@@ -0,0 +1,84 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <silubiumtests/test_utils.h>
+#include <silubium/eventindex.h>
+#include <arith_uint256.h>
+
+const dev::h160 eventContract1("0101010101010101010101010101010101010101");
+const dev::h160 eventContract2("0202020202020202020202020202020202020202");
+
+EventIndexBlock createEventBlock(dev::h160 const& contract, dev::h256 const& topic, unsigned int nonce){
+    EventIndexBlock block;
+    block.bloom |= dev::eth::LogEntry(contract, dev::h256s(1, topic), dev::bytes()).bloom();
+    block.add(contract, std::vector<uint256>(1, ArithToUint256(arith_uint256(nonce))));
+    return block;
+}
+
+std::string createEventIndexDir(){
+    fs::path pathTemp = fs::temp_directory_path() / strprintf("test_events_%lu_%i", (unsigned long)GetTime(), (int)(GetRand(100000)));
+    fs::create_directories(pathTemp);
+    return pathTemp.string();
+}
+
+BOOST_FIXTURE_TEST_SUITE(eventindex_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(eventindex_search){
+    EventIndex index(createEventIndexDir());
+    BOOST_CHECK(index.writeBlock(10, createEventBlock(eventContract1, dev::h256(1), 10)));
+    BOOST_CHECK(index.writeBlock(11, createEventBlock(eventContract2, dev::h256(2), 11)));
+    BOOST_CHECK(index.writeBlock(EVENT_INDEX_RANGE + 5, createEventBlock(eventContract1, dev::h256(2), 12)));
+    BOOST_CHECK(index.writeBlock(EVENT_INDEX_RANGE + 20, EventIndexBlock()));
+
+    std::vector<boost::optional<dev::h256>> noTopics;
+    std::vector<std::vector<uint256>> hashes;
+    BOOST_CHECK(index.search(0, -1, 0, EventFilter(std::set<dev::h160>(), noTopics, false), hashes) == (int)EVENT_INDEX_RANGE + 5);
+    BOOST_CHECK(hashes.size() == 3);
+
+    hashes.clear();
+    BOOST_CHECK(index.search(0, -1, 0, EventFilter(std::set<dev::h160>{eventContract1}, noTopics, false), hashes) == (int)EVENT_INDEX_RANGE + 5);
+    BOOST_CHECK(hashes.size() == 2);
+
+    // The first range has no log with topic 3 and is skipped, the cursor still moves past it
+    hashes.clear();
+    std::vector<boost::optional<dev::h256>> topics{boost::optional<dev::h256>(dev::h256(3))};
+    BOOST_CHECK(index.search(0, EVENT_INDEX_RANGE - 1, 0, EventFilter(std::set<dev::h160>(), topics, false), hashes) == 11);
+    BOOST_CHECK(hashes.empty());
+
+    hashes.clear();
+    topics[0] = dev::h256(2);
+    BOOST_CHECK(index.search(0, -1, 0, EventFilter(std::set<dev::h160>{eventContract1}, topics, true), hashes) == (int)EVENT_INDEX_RANGE + 5);
+    BOOST_CHECK(hashes.size() == 1);
+    BOOST_CHECK(hashes[0][0] == ArithToUint256(arith_uint256(12)));
+
+    // Blocks without enough confirmations are left out
+    hashes.clear();
+    BOOST_CHECK(index.search(0, -1, 20, EventFilter(std::set<dev::h160>(), noTopics, false), hashes) == 11);
+    BOOST_CHECK(hashes.size() == 2);
+
+    BOOST_CHECK(index.search(5, 4, 0, EventFilter(std::set<dev::h160>(), noTopics, false), hashes) == -1);
+}
+
+BOOST_AUTO_TEST_CASE(eventindex_erase){
+    EventIndex index(createEventIndexDir());
+    BOOST_CHECK(index.writeBlock(10, createEventBlock(eventContract1, dev::h256(1), 10)));
+    BOOST_CHECK(index.writeBlock(11, createEventBlock(eventContract2, dev::h256(2), 11)));
+    BOOST_CHECK(index.eraseBlock(11));
+
+    std::vector<boost::optional<dev::h256>> noTopics;
+    std::vector<std::vector<uint256>> hashes;
+    BOOST_CHECK(index.search(0, -1, 0, EventFilter(std::set<dev::h160>(), noTopics, false), hashes) == 10);
+    BOOST_CHECK(hashes.size() == 1);
+
+    BOOST_CHECK(index.eraseBlock(10));
+    hashes.clear();
+    BOOST_CHECK(index.search(0, -1, 0, EventFilter(std::set<dev::h160>(), noTopics, false), hashes) == 0);
+    BOOST_CHECK(hashes.empty());
+
+    BOOST_CHECK(!index.isBuilt());
+    index.setBuilt();
+    BOOST_CHECK(index.isBuilt());
+    index.wipe();
+    BOOST_CHECK(!index.isBuilt());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,130 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <silubiumtests/test_utils.h>
+#include <utilstrencodings.h>
+#include <libevm/VM.h>
+#include <libevm/VMFactory.h>
+#include <libevm/CodeAnalysisCache.h>
+
+#include <tuple>
+
+namespace {
+
+typedef std::tuple<uint64_t, uint64_t, dev::eth::Instruction, dev::bigint, dev::bigint, dev::bigint> Step;
+
+struct DispatchResult {
+    std::string exception;
+    dev::u256 gas;
+    dev::bytes output;
+    std::map<dev::u256, dev::u256> storage;
+    std::vector<Step> trace;
+};
+
+/** Run @a code with or without superinstructions, by putting its analysis in the cache beforehand */
+DispatchResult runCode(dev::bytes const& code, dev::bytes const& data, dev::u256 gas, bool fuse){
+    dev::eth::CodeAnalysisCache& cache = dev::eth::CodeAnalysisCache::instance();
+    cache.clear();
+    cache.store(dev::sha3(code), dev::eth::VM::analyze(code, fuse));
+
+    dev::eth::EnvInfo envInfo;
+    TestExtVM ext(envInfo, code, dev::bytesConstRef(&data));
+    DispatchResult result;
+    result.gas = gas;
+    dev::eth::OnOpFunc onOp = [&result](uint64_t steps, uint64_t pc, dev::eth::Instruction inst, dev::bigint newMemSize,
+                                        dev::bigint gasCost, dev::bigint gasLeft, dev::eth::VM*, dev::eth::ExtVMFace const*){
+        result.trace.push_back(Step(steps, pc, inst, newMemSize, gasCost, gasLeft));
+    };
+    try {
+        result.output = dev::eth::VMFactory::create(dev::eth::VMKind::Interpreter)->exec(result.gas, ext, onOp).toBytes();
+    } catch (dev::eth::VMException const& e) {
+        result.exception = typeid(e).name();
+    }
+    result.storage = ext.storage;
+    cache.clear();
+    return result;
+}
+
+/** Run @a code with and without superinstructions, and check that nothing tells the runs apart */
+DispatchResult checkSameResults(std::string const& code, std::string const& data, dev::u256 gas){
+    DispatchResult fused = runCode(ParseHex(code), ParseHex(data), gas, true);
+    DispatchResult plain = runCode(ParseHex(code), ParseHex(data), gas, false);
+    BOOST_CHECK_EQUAL(fused.exception, plain.exception);
+    BOOST_CHECK(fused.gas == plain.gas);
+    BOOST_CHECK(fused.output == plain.output);
+    BOOST_CHECK(fused.storage == plain.storage);
+    BOOST_CHECK(fused.trace == plain.trace);
+    return plain;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(evmdispatch_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(evmdispatch_fused_sequences){
+    /*
+            PUSH1 0
+        loop:
+            JUMPDEST
+            PUSH1 1 ADD
+            DUP1 PUSH1 3 SWAP1 POP POP
+            DUP1 PUSH1 200 GT PUSH1 loop JUMPI
+            DUP1 PUSH1 0 SSTORE
+            PUSH2 done JUMP
+            STOP
+        done:
+            JUMPDEST
+            PUSH1 0 SLOAD PUSH1 1 PUSH2 ret JUMPI
+            STOP
+        ret:
+            JUMPDEST
+            PUSH1 0 MSTORE PUSH1 32 PUSH1 0 RETURN
+    */
+    std::string loop = "60005b6001018060039050508060c8116002578060005561001c56005b600054600161002757005b60005260206000f3";
+
+    std::shared_ptr<dev::eth::CodeAnalysis const> fused = dev::eth::VM::analyze(ParseHex(loop), true);
+    std::shared_ptr<dev::eth::CodeAnalysis const> plain = dev::eth::VM::analyze(ParseHex(loop), false);
+#if EVM_FUSE_INSTRUCTIONS
+    // The runs compared below differ: SWAP1 POP and PUSH1 loop JUMPI are fused, only when asked to
+    BOOST_CHECK(fused->code[9] == (uint8_t)dev::eth::Instruction::SWAP1POP);
+    BOOST_CHECK(fused->code[16] == (uint8_t)dev::eth::Instruction::PUSH1JUMPCI);
+#else
+    // The switch dispatch of the release builds never runs superinstructions
+    BOOST_CHECK(fused->code == plain->code);
+#endif
+    BOOST_CHECK(plain->code[9] == (uint8_t)dev::eth::Instruction::SWAP1);
+    BOOST_CHECK(plain->code[16] == (uint8_t)dev::eth::Instruction::PUSH1);
+    BOOST_CHECK(fused->code[18] == (uint8_t)dev::eth::Instruction::JUMPCI && plain->code[18] == (uint8_t)dev::eth::Instruction::JUMPCI);
+
+    DispatchResult result = checkSameResults(loop, "", 100000);
+
+    // Results of the interpreter before superinstructions, which both dispatch modes must match
+    BOOST_CHECK(result.exception.empty());
+    BOOST_CHECK_EQUAL(result.gas, dev::u256(100000 - 28506));
+    BOOST_CHECK(result.output == dev::toBigEndian(dev::u256(200)));
+    BOOST_CHECK(result.storage[0] == dev::u256(200));
+    BOOST_CHECK_EQUAL(result.trace.size(), 2618U);
+
+    // Out of gas, stack underflow and bad jumps in the middle of sequences
+    for(dev::u256 gas = 0; gas < 40; gas++)
+        checkSameResults(loop, "", gas);
+    checkSameResults("600456005b00", "", 10);
+    checkSameResults("6001905000", "", 1000);
+    checkSameResults("60016005575b00", "", 1000);
+    checkSameResults("6001610100575b00", "", 1000);
+}
+
+BOOST_AUTO_TEST_CASE(evmdispatch_contracts){
+    // Init code and calls of the Factory contract of the bytecodeexec tests
+    std::string init = "606060405234610000575b61034a806100196000396000f30060606040526000357c0100000000000000000000000000000000000000000000000000000000900463ffffffff1680633f811b80146100495780636b8ff5741461006a575b610000565b3461000057610068600480803560001916906020019091905050610087565b005b3461000057610085600480803590602001909190505061015b565b005b60008160405160e18061023e833901808260001916600019168152602001915050604051809103906000f08015610000579050600180548060010182818154818355818115116101035781836000526020600020918201910161010291905b808211156100fe5760008160009055506001016100e6565b5090565b5b505050916000526020600020900160005b83909190916101000a81548173ffffffffffffffffffffffffffffffffffffffff021916908373ffffffffffffffffffffffffffffffffffffffff160217905550505b5050565b6000600182815481101561000057906000526020600020900160005b9054906101000a900473ffffffffffffffffffffffffffffffffffffffff1690508073ffffffffffffffffffffffffffffffffffffffff16638052474d6000604051602001526040518163ffffffff167c0100000000000000000000000000000000000000000000000000000000028152600401809050602060405180830381600087803b156100005760325a03f1156100005750505060405180519050600083815481101561000057906000526020600020900160005b5081600019169055505b50505600606060405234610000576040516020806100e1833981016040528080519060200190919050505b80600081600019169055505b505b609f806100426000396000f30060606040523615603d576000357c0100000000000000000000000000000000000000000000000000000000900463ffffffff1680638052474d146045575b60435b5b565b005b34600057604f606d565b60405180826000191660001916815260200191505060405180910390f35b600054815600a165627a7a72305820fe28ec2b77f3b306095bda73561b85d147a1026db2e5714aeeb2f29246cffcbb0029a165627a7a7230582086cf938db13cf2aa8bca8ad6e720861683ef2cc971ad66dad68708438a5e4a9b0029";
+    DispatchResult created = checkSameResults(init, "", 1000000);
+    BOOST_CHECK(created.exception.empty() && !created.output.empty());
+
+    std::string runtime = HexStr(created.output);
+    std::string arg = "0000000000000000000000000000000000000000000000000000000000000001";
+    checkSameResults(runtime, "3f811b80" + arg, 1000000);
+    checkSameResults(runtime, "6b8ff574" + arg, 1000000);
+    checkSameResults(runtime, "", 1000000);
+    checkSameResults(runtime, "3f811b80" + arg, 2000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,77 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <silubiumtests/test_utils.h>
+#include <utilstrencodings.h>
+#include <libevm/VM.h>
+#include <libevm/VMFactory.h>
+#include <libevm/CodeAnalysisCache.h>
+#include <libevm/EVMProfiler.h>
+
+namespace {
+
+// PUSH1 1 PUSH1 0 SSTORE PUSH1 0 SLOAD POP STOP
+const dev::bytes CODE = ParseHex("600160005560005450" "00");
+
+void runCode(dev::Address const& address){
+    dev::eth::CodeAnalysisCache& cache = dev::eth::CodeAnalysisCache::instance();
+    cache.clear();
+    cache.store(dev::sha3(CODE), dev::eth::VM::analyze(CODE, false));
+
+    dev::eth::EnvInfo envInfo;
+    TestExtVM ext(envInfo, CODE, dev::bytesConstRef(), address);
+    dev::u256 gas = 100000;
+    dev::eth::VMFactory::create(dev::eth::VMKind::Interpreter)->exec(gas, ext, dev::eth::OnOpFunc());
+    cache.clear();
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(evmprofiler_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(evmprofiler_counts){
+    dev::eth::EVMProfiler::setEnabled(true, 1);
+    dev::eth::EVMProfiler::reset();
+    runCode(dev::Address(1));
+    runCode(dev::Address(1));
+    runCode(dev::Address(3));
+    dev::eth::EVMProfile profile = dev::eth::EVMProfiler::snapshot();
+    dev::eth::EVMProfiler::setEnabled(false);
+    dev::eth::EVMProfiler::reset();
+
+    BOOST_CHECK(profile.frames == 3);
+    BOOST_CHECK(profile.opcodes[(size_t)dev::eth::Instruction::PUSH1].count == 9);
+    BOOST_CHECK(profile.opcodes[(size_t)dev::eth::Instruction::SSTORE].count == 3);
+    BOOST_CHECK(profile.opcodes[(size_t)dev::eth::Instruction::SSTORE].gas == 3 * 20000);
+    BOOST_CHECK(profile.opcodes[(size_t)dev::eth::Instruction::SLOAD].count == 3);
+    BOOST_CHECK(profile.opcodes[(size_t)dev::eth::Instruction::STOP].count == 3);
+
+    // Every instruction is timed but the last one of a frame, which has no next instruction to end its sample
+    BOOST_CHECK(profile.opcodes[(size_t)dev::eth::Instruction::SLOAD].samples == 3);
+    BOOST_CHECK(profile.opcodes[(size_t)dev::eth::Instruction::STOP].samples == 0);
+
+    BOOST_CHECK(profile.contracts.size() == 2);
+    dev::eth::ContractProfile const& contract = profile.contracts[dev::Address(1)];
+    BOOST_CHECK(contract.frames == 2);
+    BOOST_CHECK(contract.steps == 14);
+    BOOST_CHECK(contract.sloads == 2 && contract.sstores == 2);
+    BOOST_CHECK(profile.contracts[dev::Address(3)].frames == 1);
+}
+
+BOOST_AUTO_TEST_CASE(evmprofiler_disabled_reset){
+    dev::eth::EVMProfiler::setEnabled(false);
+    dev::eth::EVMProfiler::reset();
+    runCode(dev::Address(1));
+    dev::eth::EVMProfile profile = dev::eth::EVMProfiler::snapshot();
+    BOOST_CHECK(profile.frames == 0 && profile.contracts.empty());
+    BOOST_CHECK(profile.opcodes[(size_t)dev::eth::Instruction::SSTORE].count == 0);
+
+    dev::eth::EVMProfiler::setEnabled(true);
+    runCode(dev::Address(1));
+    dev::eth::EVMProfiler::setEnabled(false);
+    BOOST_CHECK(dev::eth::EVMProfiler::snapshot().frames == 1);
+    dev::eth::EVMProfiler::reset();
+    BOOST_CHECK(dev::eth::EVMProfiler::snapshot().frames == 0);
+    BOOST_CHECK(dev::eth::EVMProfiler::samplePeriod() == dev::eth::EVMProfiler::c_defaultSamplePeriod);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,145 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <silubiumtests/test_utils.h>
+#include <silubium/flatstorage.h>
+
+const dev::Address flatContract("0202020202020202020202020202020202020202");
+
+/** Commit the changes to the state and connect them as the block @a hash at @a height */
+void connectFlatBlock(FlatStorage& flat, unsigned int height, uint256 const& hash){
+    globalState->commit(dev::eth::State::CommitBehaviour::KeepEmptyAccounts);
+    globalState->db().commit();
+    BOOST_CHECK(flat.connectBlock(height, hash));
+    BOOST_CHECK(flat.tip() == hash);
+}
+
+/** Remove the contract like a selfdestruct */
+void removeFlatContract(){
+    static_cast<dev::eth::State&>(*globalState).kill(flatContract);
+}
+
+bool flatSlot(FlatStorage& flat, dev::u256 const& key, dev::u256& value){
+    return flat.storage(flatContract, globalState->storageRoot(flatContract), key, value);
+}
+
+BOOST_FIXTURE_TEST_SUITE(flatstorage_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(flatstorage_connect_disconnect){
+    initState();
+    globalState->setRoot(dev::sha3(dev::rlp("")));
+    FlatStorage flat(GetDataDir().string());
+    globalState->setFlatStorage(&flat);
+    dev::u256 value;
+
+    globalState->createContract(flatContract);
+    globalState->setNewCode(flatContract, dev::bytes(40, 0x60));
+    for(unsigned i = 1; i <= 10; i++)
+        globalState->setStorage(flatContract, dev::u256(i), dev::u256(i));
+    connectFlatBlock(flat, 1, uint256S("01"));
+    dev::h256 root1 = globalState->rootHash();
+    dev::h256 storageRoot1 = globalState->storageRoot(flatContract);
+
+    // The storage of the new contract is complete, missing slots are zero
+    BOOST_CHECK(flatSlot(flat, 3, value) && value == 3);
+    BOOST_CHECK(flatSlot(flat, 11, value) && value == 0);
+
+    globalState->setStorage(flatContract, dev::u256(3), dev::u256(30));
+    globalState->setStorage(flatContract, dev::u256(4), dev::u256(0));
+    connectFlatBlock(flat, 2, uint256S("02"));
+    BOOST_CHECK(flatSlot(flat, 3, value) && value == 30);
+    BOOST_CHECK(flatSlot(flat, 4, value) && value == 0);
+    BOOST_CHECK(!flat.storage(flatContract, storageRoot1, 3, value));
+
+    // Reads of the state go through the table
+    uint64_t hits = flat.hits();
+    dev::h256 root2 = globalState->rootHash();
+    globalState->setRoot(dev::sha3(dev::rlp("")));
+    globalState->setRoot(root2);
+    BOOST_CHECK(globalState->storage(flatContract, dev::u256(5)) == dev::u256(5));
+    BOOST_CHECK_EQUAL(flat.hits(), hits + 1);
+
+    // Disconnecting takes the table back to the parent
+    globalState->setRoot(root1);
+    BOOST_CHECK(flat.disconnectBlock(2, uint256S("02")));
+    BOOST_CHECK(flat.tip() == uint256S("01"));
+    BOOST_CHECK(flatSlot(flat, 3, value) && value == 3);
+    BOOST_CHECK(flatSlot(flat, 4, value) && value == 4);
+
+    // Changes that do not end up in a block are discarded
+    globalState->setStorage(flatContract, dev::u256(5), dev::u256(50));
+    globalState->commit(dev::eth::State::CommitBehaviour::KeepEmptyAccounts);
+    globalState->setRoot(root1);
+    flat.discardPending();
+    globalState->setStorage(flatContract, dev::u256(6), dev::u256(60));
+    connectFlatBlock(flat, 2, uint256S("03"));
+    BOOST_CHECK(flatSlot(flat, 5, value) && value == 5);
+    BOOST_CHECK(flatSlot(flat, 6, value) && value == 60);
+    BOOST_CHECK(flatSlot(flat, 3, value) && value == 3);
+
+    globalState->setRoot(root1);
+    BOOST_CHECK(flat.disconnectBlock(2, uint256S("03")));
+    BOOST_CHECK(flatSlot(flat, 6, value) && value == 6);
+
+    // A block without undo data wipes the table, whose storage is then only known where it is written
+    BOOST_CHECK(flat.disconnectBlock(1, uint256S("02")));
+    BOOST_CHECK(flat.tip().IsNull());
+    BOOST_CHECK(!flatSlot(flat, 6, value));
+    globalState->setStorage(flatContract, dev::u256(7), dev::u256(70));
+    connectFlatBlock(flat, 2, uint256S("04"));
+    BOOST_CHECK(flatSlot(flat, 7, value) && value == 70);
+    BOOST_CHECK(!flatSlot(flat, 8, value));
+    BOOST_CHECK(globalState->storage(flatContract, dev::u256(8)) == dev::u256(8));
+
+    globalState->setFlatStorage(nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(flatstorage_deletes_replaced_incarnations){
+    initState();
+    globalState->setRoot(dev::sha3(dev::rlp("")));
+    FlatStorage flat(GetDataDir().string());
+    globalState->setFlatStorage(&flat);
+    dev::u256 value;
+
+    globalState->createContract(flatContract);
+    globalState->setNewCode(flatContract, dev::bytes(40, 0x60));
+    for(unsigned i = 1; i <= 10; i++)
+        globalState->setStorage(flatContract, dev::u256(i), dev::u256(i));
+    connectFlatBlock(flat, 1, uint256S("01"));
+    dev::h256 root1 = globalState->rootHash();
+    BOOST_CHECK_EQUAL(flat.slots(), 10);
+
+    // The slots of a removed contract stay while the block that removed it can be disconnected
+    removeFlatContract();
+    connectFlatBlock(flat, 2, uint256S("02"));
+    BOOST_CHECK_EQUAL(flat.slots(), 10);
+    globalState->setRoot(root1);
+    BOOST_CHECK(flat.disconnectBlock(2, uint256S("02")));
+    BOOST_CHECK(flatSlot(flat, 3, value) && value == 3);
+
+    removeFlatContract();
+    connectFlatBlock(flat, 2, uint256S("03"));
+    for(unsigned int height = 3; height < 2 + FLAT_STORAGE_UNDO_DEPTH; height++)
+        connectFlatBlock(flat, height, ArithToUint256(arith_uint256(height + 1000)));
+    BOOST_CHECK_EQUAL(flat.slots(), 10);
+    connectFlatBlock(flat, 2 + FLAT_STORAGE_UNDO_DEPTH, ArithToUint256(arith_uint256(1)));
+    BOOST_CHECK_EQUAL(flat.slots(), 0);
+
+    // A contract re-created in the block that removed it only keeps the slots of its new incarnation
+    globalState->createContract(flatContract);
+    globalState->setNewCode(flatContract, dev::bytes(40, 0x60));
+    globalState->setStorage(flatContract, dev::u256(1), dev::u256(1));
+    globalState->commit(dev::eth::State::CommitBehaviour::KeepEmptyAccounts);
+    removeFlatContract();
+    globalState->commit(dev::eth::State::CommitBehaviour::KeepEmptyAccounts);
+    globalState->createContract(flatContract);
+    globalState->setNewCode(flatContract, dev::bytes(40, 0x60));
+    globalState->setStorage(flatContract, dev::u256(2), dev::u256(2));
+    connectFlatBlock(flat, 3 + FLAT_STORAGE_UNDO_DEPTH, ArithToUint256(arith_uint256(2)));
+    BOOST_CHECK_EQUAL(flat.slots(), 1);
+    BOOST_CHECK(flatSlot(flat, 2, value) && value == 2);
+    BOOST_CHECK(flatSlot(flat, 1, value) && value == 0);
+
+    globalState->setFlatStorage(nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,65 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <silubiumtests/test_utils.h>
+#include <utilstrencodings.h>
+#include <libevm/VM.h>
+#include <libevm/VMFactory.h>
+#include <libevm/FramePool.h>
+
+namespace {
+
+dev::bytes runCode(std::string const& code){
+    dev::bytes bytecode = ParseHex(code);
+    dev::eth::EnvInfo envInfo;
+    TestExtVM ext(envInfo, bytecode);
+    dev::u256 gas = 100000;
+    return dev::eth::VMFactory::create(dev::eth::VMKind::Interpreter)->exec(gas, ext, dev::eth::OnOpFunc()).toBytes();
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(framepool_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(framepool_reuse_frames){
+    dev::eth::VMFace* first = dev::eth::VMFactory::create(dev::eth::VMKind::Interpreter).get();
+    BOOST_CHECK(dev::eth::FramePool::pooledFrames() > 0);
+
+    // A returned frame is the block of the next one, nested frames take distinct blocks
+    std::unique_ptr<dev::eth::VMFace> outer = dev::eth::VMFactory::create(dev::eth::VMKind::Interpreter);
+    std::unique_ptr<dev::eth::VMFace> inner = dev::eth::VMFactory::create(dev::eth::VMKind::Interpreter);
+    BOOST_CHECK(outer.get() == first);
+    BOOST_CHECK(inner.get() != first);
+}
+
+BOOST_AUTO_TEST_CASE(framepool_zeroed_memory){
+    // MSTORE 0xff.. at 0x20, STOP: the buffer goes back to the pool with its content
+    runCode("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff60205200");
+    BOOST_CHECK(dev::eth::FramePool::pooledBuffers() > 0);
+
+    // MLOAD 0x20, MSTORE at 0, RETURN 64 bytes: the reused buffer reads as zero
+    dev::bytes output = runCode("602051600052" "60406000f3");
+    BOOST_CHECK(output == dev::bytes(64, 0));
+
+    // The output outlives its frame, whose buffer is pooled again
+    output = runCode("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff600052" "60206000f3");
+    BOOST_CHECK(output == dev::bytes(32, 0xff));
+    BOOST_CHECK(dev::eth::FramePool::pooledBuffers() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(framepool_limits){
+    // Deep call chains allocate the frames beyond the pool, and give back what the pool holds
+    std::vector<std::unique_ptr<dev::eth::VMFace>> frames;
+    for(size_t i = 0; i < dev::eth::FramePool::c_maxFrames + 8; i++)
+        frames.push_back(dev::eth::VMFactory::create(dev::eth::VMKind::Interpreter));
+    BOOST_CHECK(dev::eth::FramePool::pooledFrames() == 0);
+    frames.clear();
+    BOOST_CHECK(dev::eth::FramePool::pooledFrames() == dev::eth::FramePool::c_maxFrames);
+
+    // Large buffers are freed
+    dev::bytes buffer(dev::eth::FramePool::c_maxBufferCapacity + 1);
+    size_t pooled = dev::eth::FramePool::pooledBuffers();
+    dev::eth::FramePool::releaseBuffer(buffer);
+    BOOST_CHECK(buffer.empty() && dev::eth::FramePool::pooledBuffers() == pooled);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
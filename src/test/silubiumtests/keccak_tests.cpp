@@ -0,0 +1,85 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <libdevcore/SHA3.h>
+
+namespace {
+
+dev::bytes randomBytes(size_t size){
+    dev::bytes data(size);
+    for(size_t i = 0; i < size; i++)
+        data[i] = InsecureRandBits(8);
+    return data;
+}
+
+/** sha3Batch() of the inputs against sha3() of each of them */
+void checkBatch(const std::vector<dev::bytes>& inputs){
+    std::vector<dev::bytesConstRef> refs;
+    for(const dev::bytes& input : inputs)
+        refs.push_back(dev::bytesConstRef(&input));
+    dev::h256s hashes = dev::sha3Batch(refs);
+    BOOST_CHECK_EQUAL(hashes.size(), inputs.size());
+    for(size_t i = 0; i < inputs.size() && i < hashes.size(); i++)
+        BOOST_CHECK_MESSAGE(hashes[i] == dev::sha3(inputs[i]), "input " << i << " of " << inputs[i].size() << " bytes");
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(keccak_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(keccak_f1600_known_answers){
+    // Keccak-f[1600] applied once and twice to the all-zero state, from the Keccak reference
+    static const uint64_t first[25] = {
+        0xF1258F7940E1DDE7, 0x84D5CCF933C0478A, 0xD598261EA65AA9EE, 0xBD1547306F80494D, 0x8B284E056253D057,
+        0xFF97A42D7F8E6FD4, 0x90FEE5A0A44647C4, 0x8C5BDA0CD6192E76, 0xAD30A6F71B19059C, 0x30935AB7D08FFC64,
+        0xEB5AA93F2317D635, 0xA9A6E6260D712103, 0x81A57C16DBCF555F, 0x43B831CD0347C826, 0x01F22F1A11A5569F,
+        0x05E5635A21D9AE61, 0x64BEFEF28CC970F2, 0x613670957BC46611, 0xB87C5A554FD00ECB, 0x8C3EE88A1CCF32C8,
+        0x940C7922AE3A2614, 0x1841F924A2C509E4, 0x16F53526E70465C2, 0x75F644E97F30A13B, 0xEAF1FF7B5CECA249};
+    static const uint64_t second[25] = {
+        0x2D5C954DF96ECB3C, 0x6A332CD07057B56D, 0x093D8D1270D76B6C, 0x8A20D9B25569D094, 0x4F9C4F99E5E7F156,
+        0xF957B9A2DA65FB38, 0x85773DAE1275AF0D, 0xFAF4F247C3D810F7, 0x1F1B9EE6F79A8759, 0xE4FECC0FEE98B425,
+        0x68CE61B6B9CE68A1, 0xDEEA66C4BA8F974F, 0x33C43D836EAFB1F5, 0xE00654042719DBD9, 0x7CF8A9F009831265,
+        0xFD5449A6BF174743, 0x97DDAD33D8994B40, 0x48EAD5FC5D0BE774, 0xE3B8C8EE55B7B03C, 0x91A0226E649E42E9,
+        0x900E3129E7BADD7B, 0x202A9EC5FAA3CCE8, 0x5B3402464E1C3DB6, 0x609F4E62A44C1059, 0x20D06CD26A8FBF5C};
+    uint64_t state[25] = {0};
+    dev::keccakF1600(state);
+    for(size_t i = 0; i < 25; i++)
+        BOOST_CHECK_EQUAL(state[i], first[i]);
+    dev::keccakF1600(state);
+    for(size_t i = 0; i < 25; i++)
+        BOOST_CHECK_EQUAL(state[i], second[i]);
+
+    // Keccak-256 as Ethereum uses it
+    BOOST_CHECK(dev::sha3(dev::bytes()) == dev::h256("c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470"));
+    BOOST_CHECK(dev::sha3(std::string("abc")) == dev::h256("4e03657aea45a94fc7d47ba826c8d667c0d1e6e33a64a036ec44f58fa12d6c45"));
+}
+
+BOOST_AUTO_TEST_CASE(sha3_batch_block_boundaries){
+    // The rate of Keccak-256 is 136 bytes, so these sizes take 0, 0, 1, 1 and 2 full blocks before the padded one
+    for(size_t size : {0, 135, 136, 137, 272}){
+        // Enough inputs of one size to fill the widest batch more than once
+        std::vector<dev::bytes> inputs;
+        for(int i = 0; i < 17; i++)
+            inputs.push_back(randomBytes(size));
+        checkBatch(inputs);
+        checkBatch(std::vector<dev::bytes>(1, randomBytes(size)));
+        checkBatch(std::vector<dev::bytes>(2, randomBytes(size)));
+    }
+    checkBatch(std::vector<dev::bytes>());
+}
+
+BOOST_AUTO_TEST_CASE(sha3_batch_mixed_lengths){
+    std::vector<dev::bytes> inputs;
+    for(size_t size : {272, 0, 136, 135, 137, 0, 271, 273, 136, 1, 408, 135, 32, 64, 137, 500})
+        inputs.push_back(randomBytes(size));
+    checkBatch(inputs);
+
+    for(int round = 0; round < 20; round++){
+        inputs.clear();
+        size_t count = InsecureRandRange(40);
+        for(size_t i = 0; i < count; i++)
+            inputs.push_back(randomBytes(InsecureRandRange(5 * 136)));
+        checkBatch(inputs);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
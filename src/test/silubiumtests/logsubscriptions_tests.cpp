@@ -0,0 +1,106 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <silubiumtests/test_utils.h>
+#include <silubium/logsubscriptions.h>
+
+const dev::Address subscribedContract("0101010101010101010101010101010101010101");
+const dev::Address otherContract("0202020202020202020202020202020202020202");
+
+/** Exposes the validation callbacks, which are otherwise only called through the main signals */
+class TestLogSubscriptions : public LogSubscriptions{
+public:
+    TestLogSubscriptions(size_t maxQueued = MAX_LOG_SUBSCRIPTION_QUEUE) : LogSubscriptions(maxQueued) {}
+
+    using LogSubscriptions::BlockConnected;
+    using LogSubscriptions::BlockDisconnected;
+};
+
+std::shared_ptr<const CBlock> createLogBlock(uint32_t nonce, dev::Address const& contract, std::vector<dev::h256> const& topics){
+    CMutableTransaction mtx;
+    mtx.nLockTime = nonce;
+    mtx.vout.push_back(CTxOut(0, CScript() << OP_CALL));
+    CTransactionRef tx = MakeTransactionRef(CTransaction(mtx));
+
+    dev::eth::LogEntries logs;
+    for(dev::h256 const& topic : topics)
+        logs.push_back(dev::eth::LogEntry(contract, dev::h256s(1, topic), dev::bytes(1, nonce)));
+    TransactionReceiptInfo tri{uint256(), nonce, tx->GetHash(), 1, dev::Address(1), contract, 30000, 21000, contract, logs, dev::eth::TransactionException::None};
+    std::vector<TransactionReceiptInfo> receipts(1, tri);
+    pstorageresult->addResult(uintToh256(tx->GetHash()), receipts);
+    pstorageresult->commitResults();
+
+    std::shared_ptr<CBlock> block = std::make_shared<CBlock>();
+    block->nNonce = nonce;
+    block->vtx.push_back(tx);
+    return block;
+}
+
+bool pollNow(LogSubscriptions& subscriptions, uint64_t id, uint64_t cursor, std::vector<ContractLog>& logs, uint64_t& nextCursor, uint64_t& dropped){
+    logs.clear();
+    return subscriptions.poll(id, cursor, std::chrono::milliseconds(0), [](){ return true; }, logs, nextCursor, dropped);
+}
+
+BOOST_FIXTURE_TEST_SUITE(logsubscriptions_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(logsubscriptions_match_and_cursor){
+    TestLogSubscriptions subscriptions;
+
+    LogFilter filter;
+    filter.addresses.insert(subscribedContract);
+    filter.topics.push_back(boost::optional<dev::h256>());
+    uint64_t byAddress = subscriptions.subscribe(filter);
+    filter.addresses.clear();
+    filter.topics.push_back(boost::optional<dev::h256>(dev::h256(7)));
+    uint64_t byTopic = subscriptions.subscribe(filter);
+
+    // Every log of the block is passed to the publishers once
+    size_t published = 0;
+    boost::signals2::scoped_connection connection = subscriptions.NotifyContractLogs.connect([&published](std::vector<ContractLog> const& logs){ published += logs.size(); });
+
+    std::shared_ptr<const CBlock> block1 = createLogBlock(1, subscribedContract, {dev::h256(7), dev::h256(8)});
+    subscriptions.BlockConnected(block1, nullptr, std::vector<CTransactionRef>());
+    subscriptions.BlockConnected(createLogBlock(2, otherContract, {dev::h256(8)}), nullptr, std::vector<CTransactionRef>());
+    BOOST_CHECK(published == 3);
+
+    std::vector<ContractLog> logs;
+    uint64_t nextCursor = 0, dropped = 0;
+    BOOST_CHECK(pollNow(subscriptions, byAddress, 0, logs, nextCursor, dropped));
+    BOOST_CHECK(logs.size() == 2 && nextCursor == 2 && dropped == 0);
+    BOOST_CHECK(logs[0].log().topics[0] == dev::h256(7) && logs[1].log().topics[0] == dev::h256(8));
+
+    // Topics are matched by position, a log with fewer topics does not match
+    BOOST_CHECK(pollNow(subscriptions, byTopic, 0, logs, nextCursor, dropped));
+    BOOST_CHECK(logs.size() == 0 && nextCursor == 0);
+
+    // Polling with the returned cursor releases the logs before it
+    BOOST_CHECK(pollNow(subscriptions, byAddress, 1, logs, nextCursor, dropped));
+    BOOST_CHECK(logs.size() == 1 && nextCursor == 2);
+    BOOST_CHECK(pollNow(subscriptions, byAddress, 2, logs, nextCursor, dropped));
+    BOOST_CHECK(logs.empty() && nextCursor == 2);
+
+    // The logs of a disconnected block come back as removed
+    subscriptions.BlockDisconnected(block1);
+    BOOST_CHECK(published == 5);
+    BOOST_CHECK(pollNow(subscriptions, byAddress, 2, logs, nextCursor, dropped));
+    BOOST_CHECK(logs.size() == 2 && nextCursor == 4);
+    BOOST_CHECK(logs[0].removed && logs[1].removed);
+
+    BOOST_CHECK(subscriptions.unsubscribe(byAddress));
+    BOOST_CHECK(!subscriptions.unsubscribe(byAddress));
+    BOOST_CHECK(!pollNow(subscriptions, byAddress, 4, logs, nextCursor, dropped));
+}
+
+BOOST_AUTO_TEST_CASE(logsubscriptions_queue_limit){
+    TestLogSubscriptions subscriptions(2);
+    uint64_t id = subscriptions.subscribe(LogFilter());
+
+    subscriptions.BlockConnected(createLogBlock(1, otherContract, {dev::h256(1), dev::h256(2), dev::h256(3)}), nullptr, std::vector<CTransactionRef>());
+
+    std::vector<ContractLog> logs;
+    uint64_t nextCursor = 0, dropped = 0;
+    BOOST_CHECK(pollNow(subscriptions, id, 0, logs, nextCursor, dropped));
+    BOOST_CHECK(logs.size() == 2 && nextCursor == 3 && dropped == 1);
+    BOOST_CHECK(logs[0].log().topics[0] == dev::h256(2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
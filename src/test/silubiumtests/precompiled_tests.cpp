@@ -0,0 +1,141 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <libethcore/Precompiled.h>
+#include <libethcore/SealEngine.h>
+#include <libevmcore/EVMSchedule.h>
+#include <libdevcrypto/AltBn128.h>
+#include <libdevcrypto/Blake2.h>
+#include <chainparams.h>
+#include <validation.h>
+
+namespace {
+
+const std::string G1_ONE = "0000000000000000000000000000000000000000000000000000000000000001"
+                           "0000000000000000000000000000000000000000000000000000000000000002";
+const std::string G1_TWO = "030644e72e131a029b85045b68181585d97816a916871ca8d3c208c16d87cfd3"
+                           "15ed738c0e0a7c92e7845f96b2ae9c0a68a6a449e3538fc7ff3ebf7a5a18a2c4";
+const std::string G1_MINUS_ONE = "0000000000000000000000000000000000000000000000000000000000000001"
+                                 "30644e72e131a029b85045b68181585d97816a916871ca8d3c208c16d87cfd45";
+const std::string G2_ONE = "198e9393920d483a7260bfb731fb5d25f1aa493335a9e71297e485b7aef312c2"
+                           "1800deef121f1e76426a00665e5c4479674322d4f75edadd46debd5cd992f6ed"
+                           "090689d0585ff075ec9e99ad690c3395bc4b313370b38ef355acdadcd122975b"
+                           "12c85ea5db8c6deb4aab71808dcb408fe3d1e7690c43d37b4ce6cc0166fa7daa";
+const std::string ONE = "0000000000000000000000000000000000000000000000000000000000000001";
+const std::string ZERO = "0000000000000000000000000000000000000000000000000000000000000000";
+
+std::pair<bool, dev::bytes> execute(std::string const& name, std::string const& input){
+    dev::bytes in = ParseHex(input);
+    return dev::eth::PrecompiledRegistrar::executor(name)(dev::bytesConstRef(&in));
+}
+
+dev::bigint cost(std::string const& name, std::string const& input){
+    dev::bytes in = ParseHex(input);
+    return dev::eth::PrecompiledRegistrar::pricer(name)(dev::bytesConstRef(&in), dev::eth::EIP158Schedule);
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(precompiled_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(precompiled_bn128_add){
+    std::pair<bool, dev::bytes> res = execute("alt_bn128_G1_add", G1_ONE + G1_ONE);
+    BOOST_CHECK(res.first && HexStr(res.second) == G1_TWO);
+
+    // The point at infinity is the identity, and a short input is padded with zeros
+    res = execute("alt_bn128_G1_add", G1_ONE);
+    BOOST_CHECK(res.first && HexStr(res.second) == G1_ONE);
+    res = execute("alt_bn128_G1_add", G1_ONE + G1_MINUS_ONE);
+    BOOST_CHECK(res.first && HexStr(res.second) == ZERO + ZERO);
+
+    // (1, 3) is not on the curve
+    res = execute("alt_bn128_G1_add", ONE + "0000000000000000000000000000000000000000000000000000000000000003" + G1_ONE);
+    BOOST_CHECK(!res.first);
+    BOOST_CHECK(cost("alt_bn128_G1_add", G1_ONE) == dev::eth::EIP158Schedule.bn128AddGas);
+}
+
+BOOST_AUTO_TEST_CASE(precompiled_bn128_mul){
+    std::pair<bool, dev::bytes> res = execute("alt_bn128_G1_mul", G1_ONE + "0000000000000000000000000000000000000000000000000000000000000002");
+    BOOST_CHECK(res.first && HexStr(res.second) == G1_TWO);
+
+    // The group order r maps every point to infinity
+    res = execute("alt_bn128_G1_mul", G1_TWO + "30644e72e131a029b85045b68181585d2833e84879b9709143e1f593f0000001");
+    BOOST_CHECK(res.first && HexStr(res.second) == ZERO + ZERO);
+    BOOST_CHECK(cost("alt_bn128_G1_mul", G1_ONE) == dev::eth::EIP158Schedule.bn128MulGas);
+}
+
+BOOST_AUTO_TEST_CASE(precompiled_bn128_pairing){
+    // e(P, Q) * e(-P, Q) == 1, e(P, Q) * e(P, Q) != 1
+    std::pair<bool, dev::bytes> res = execute("alt_bn128_pairing_product", G1_ONE + G2_ONE + G1_MINUS_ONE + G2_ONE);
+    BOOST_CHECK(res.first && HexStr(res.second) == ONE);
+    res = execute("alt_bn128_pairing_product", G1_ONE + G2_ONE + G1_ONE + G2_ONE);
+    BOOST_CHECK(res.first && HexStr(res.second) == ZERO);
+
+    // e(2P, Q) * e(-P, Q) * e(-P, Q) == 1
+    res = execute("alt_bn128_pairing_product", G1_TWO + G2_ONE + G1_MINUS_ONE + G2_ONE + G1_MINUS_ONE + G2_ONE);
+    BOOST_CHECK(res.first && HexStr(res.second) == ONE);
+
+    // The empty product is one
+    res = execute("alt_bn128_pairing_product", "");
+    BOOST_CHECK(res.first && HexStr(res.second) == ONE);
+
+    // Input not a multiple of 192 bytes
+    res = execute("alt_bn128_pairing_product", G1_ONE + G2_ONE + "00");
+    BOOST_CHECK(!res.first);
+
+    dev::eth::EVMSchedule const& schedule = dev::eth::EIP158Schedule;
+    BOOST_CHECK(cost("alt_bn128_pairing_product", G1_ONE + G2_ONE + G1_MINUS_ONE + G2_ONE) == schedule.bn128PairingBaseGas + 2 * schedule.bn128PairingPairGas);
+}
+
+BOOST_AUTO_TEST_CASE(precompiled_modexp){
+    // Fermat: 3^(p-1) mod p == 1 for the secp256k1 field prime
+    std::string input = "0000000000000000000000000000000000000000000000000000000000000001"
+                        "0000000000000000000000000000000000000000000000000000000000000020"
+                        "0000000000000000000000000000000000000000000000000000000000000020"
+                        "03"
+                        "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2e"
+                        "fffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f";
+    std::pair<bool, dev::bytes> res = execute("modexp", input);
+    BOOST_CHECK(res.first && HexStr(res.second) == ONE);
+    BOOST_CHECK(cost("modexp", input) == 1024 * 255 / dev::eth::EIP158Schedule.modexpQuadDivisor);
+
+    // A zero modulus length gives an empty output
+    res = execute("modexp", "0000000000000000000000000000000000000000000000000000000000000001"
+                            "0000000000000000000000000000000000000000000000000000000000000001"
+                            "0000000000000000000000000000000000000000000000000000000000000000"
+                            "0303");
+    BOOST_CHECK(res.first && res.second.empty());
+}
+
+BOOST_AUTO_TEST_CASE(precompiled_blake2_compression){
+    // EIP-152 test vector 5: 12 rounds over "abc"
+    std::string input = "0000000c"
+                        "48c9bdf267e6096a3ba7ca8485ae67bb2bf894fe72f36e3cf1361d5f3af54fa5d182e6ad7f520e511f6c3e2b8c68059b6bbd41fbabd9831f79217e1319cde05b"
+                        "6162630000000000000000000000000000000000000000000000000000000000"
+                        "0000000000000000000000000000000000000000000000000000000000000000"
+                        "0000000000000000000000000000000000000000000000000000000000000000"
+                        "0000000000000000000000000000000000000000000000000000000000000000"
+                        "0300000000000000"
+                        "0000000000000000"
+                        "01";
+    std::pair<bool, dev::bytes> res = execute("blake2_compression", input);
+    BOOST_CHECK(res.first && HexStr(res.second) == "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+                                                   "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923");
+    BOOST_CHECK(cost("blake2_compression", input) == 12 * dev::eth::EIP158Schedule.blake2RoundGas);
+
+    // The final block flag must be 0 or 1, and the input exactly 213 bytes
+    BOOST_CHECK(!execute("blake2_compression", input.substr(0, input.size() - 2) + "02").first);
+    BOOST_CHECK(!execute("blake2_compression", input + "00").first);
+}
+
+BOOST_AUTO_TEST_CASE(precompiled_fork_height){
+    // The main network has not scheduled the fork, regtest runs the contracts from genesis
+    for(unsigned i = 1; i <= 4; i++)
+        BOOST_CHECK(globalSealEngine->isPrecompiled(dev::Address(i), 0));
+    for(unsigned i = 5; i <= 9; i++){
+        BOOST_CHECK(!globalSealEngine->isPrecompiled(dev::Address(i), 0));
+        BOOST_CHECK(!globalSealEngine->isPrecompiled(dev::Address(i), chainActive.Height() + 1));
+    }
+    BOOST_CHECK(CreateChainParams(CBaseChainParams::REGTEST)->GetConsensus().nPrecompilesHFHeight == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,45 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <chain.h>
+#include <pos.h>
+
+BOOST_FIXTURE_TEST_SUITE(stakekernel_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(stakekernel_batch_search){
+    CBlockIndex index;
+    index.nStakeModifier = InsecureRand256();
+    std::vector<CStakeKernelCoin> coins;
+    for(int i = 0; i < 300; i++){
+        COutPoint prevout(InsecureRand256(), i % 7);
+        coins.push_back(CStakeKernelCoin(prevout, CStakeCache(1500000000 + i, (i + 1) * 1000)));
+    }
+
+    // Easy target, so that a fair part of the coins stakes in the window
+    unsigned int nBits = 0x1f00ffff;
+    uint32_t nTimeBegin = 1600000000;
+    uint32_t nTimeEnd = nTimeBegin + 3 * (STAKE_TIMESTAMP_MASK + 1);
+    CStakeKernelBatch batch(&index, nBits, coins);
+    std::vector<std::pair<size_t, uint32_t>> hits;
+    batch.Search(nTimeBegin, nTimeEnd, hits);
+
+    // The batch finds exactly the kernels of the scalar check, ordered by time
+    std::set<std::pair<size_t, uint32_t>> found(hits.begin(), hits.end());
+    size_t nExpected = 0;
+    for(uint32_t nTime = nTimeBegin; nTime < nTimeEnd; nTime += STAKE_TIMESTAMP_MASK + 1){
+        for(size_t i = 0; i < coins.size(); i++){
+            uint256 hashProofOfStake, targetProofOfStake;
+            bool fKernel = CheckStakeKernelHash(&index, nBits, coins[i].blockFromTime, coins[i].amount, coins[i].prevout, nTime, hashProofOfStake, targetProofOfStake);
+            BOOST_CHECK(fKernel == (found.count(std::make_pair(i, nTime)) > 0));
+            nExpected += fKernel;
+        }
+    }
+    BOOST_CHECK(nExpected > 0 && hits.size() == nExpected);
+    for(size_t i = 1; i < hits.size(); i++)
+        BOOST_CHECK(hits[i - 1].second <= hits[i].second);
+
+    // Larger coins stake sooner
+    BOOST_CHECK(batch.ExpectedTime(coins.size() - 1) < batch.ExpectedTime(0));
+    BOOST_CHECK(batch.ExpectedTime(0) >= STAKE_TIMESTAMP_MASK + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,185 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <miner.h>
+#include <consensus/merkle.h>
+#include <consensus/validation.h>
+#include <pos.h>
+#include <validation.h>
+#include <script/sign.h>
+
+namespace {
+
+const CScript STAKER = CScript() << OP_TRUE;
+const CScript OTHER_STAKER = CScript() << OP_FALSE;
+
+std::unique_ptr<CBlockTemplate> makeTemplate(bool fContract){
+    std::unique_ptr<CBlockTemplate> pblocktemplate(new CBlockTemplate());
+    CBlock& block = pblocktemplate->block;
+    block.hashPrevBlock = uint256S("01");
+    block.nTime = 1600;
+    block.nBits = 0x1d00ffff;
+    block.vtx.push_back(MakeTransactionRef(CMutableTransaction()));
+    block.vtx.push_back(MakeTransactionRef(CMutableTransaction()));
+    if(fContract){
+        CMutableTransaction tx;
+        tx.vout.push_back(CTxOut(0, CScript() << OP_CALL));
+        block.vtx.push_back(MakeTransactionRef(tx));
+    }
+    return pblocktemplate;
+}
+
+CBlockHeader makeHeader(uint32_t nTime){
+    CBlockHeader header;
+    header.hashPrevBlock = uint256S("01");
+    header.nTime = nTime;
+    header.nBits = 0x1d00ffff;
+    return header;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(staketemplate_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(staketemplate_without_contracts){
+    CStakeTemplate stakeTemplate;
+    int64_t nTotalFees = 0;
+    BOOST_CHECK(!stakeTemplate.Get(makeHeader(1600), STAKER, nTotalFees));
+    BOOST_CHECK(stakeTemplate.NeedsUpdate(uint256S("01"), 1600, STAKER));
+
+    stakeTemplate.Set(makeTemplate(false), 1000, STAKER);
+    BOOST_CHECK(!stakeTemplate.NeedsUpdate(uint256S("01"), 1632, OTHER_STAKER));
+    BOOST_CHECK(stakeTemplate.NeedsUpdate(uint256S("02"), 1600, STAKER));
+
+    // The body serves any slot and any staker, with the time of the signed header
+    std::unique_ptr<CBlockTemplate> pblocktemplate = stakeTemplate.Get(makeHeader(1632), OTHER_STAKER, nTotalFees);
+    BOOST_CHECK(pblocktemplate && pblocktemplate->block.nTime == 1632 && pblocktemplate->block.vtx.size() == 2);
+    BOOST_CHECK(nTotalFees == 1000);
+
+    CBlockHeader header = makeHeader(1600);
+    header.hashPrevBlock = uint256S("02");
+    BOOST_CHECK(!stakeTemplate.Get(header, STAKER, nTotalFees));
+    header = makeHeader(1600);
+    header.nBits = 0x1d00fffe;
+    BOOST_CHECK(!stakeTemplate.Get(header, STAKER, nTotalFees));
+
+    stakeTemplate.Clear();
+    BOOST_CHECK(!stakeTemplate.Get(makeHeader(1600), STAKER, nTotalFees));
+}
+
+BOOST_AUTO_TEST_CASE(staketemplate_with_contracts){
+    CStakeTemplate stakeTemplate;
+    int64_t nTotalFees = 0;
+    stakeTemplate.Set(makeTemplate(true), 2000, STAKER);
+
+    // The executions read the block time and the author
+    BOOST_CHECK(stakeTemplate.Get(makeHeader(1600), STAKER, nTotalFees));
+    BOOST_CHECK(nTotalFees == 2000);
+    BOOST_CHECK(!stakeTemplate.Get(makeHeader(1616), STAKER, nTotalFees));
+    BOOST_CHECK(!stakeTemplate.Get(makeHeader(1600), OTHER_STAKER, nTotalFees));
+    BOOST_CHECK(stakeTemplate.NeedsUpdate(uint256S("01"), 1616, STAKER));
+    BOOST_CHECK(stakeTemplate.NeedsUpdate(uint256S("01"), 1600, OTHER_STAKER));
+    BOOST_CHECK(!stakeTemplate.NeedsUpdate(uint256S("01"), 1600, STAKER));
+
+
+    stakeTemplate.SetStakerScript(OTHER_STAKER);
+    BOOST_CHECK(stakeTemplate.GetStakerScript() == OTHER_STAKER);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(staketemplate_chain_tests, TestChain100Setup)
+
+/** Spend the output of coinbaseTxns[n] to the coinbase key with a fee of 10000, in the mempool */
+CTransactionRef spendCoinbase(TestChain100Setup& setup, size_t n){
+    CScript scriptPubKey = CScript() << ToByteVector(setup.coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CMutableTransaction spend;
+    spend.nVersion = 1;
+    spend.vin.resize(1);
+    spend.vin[0].prevout = COutPoint(setup.coinbaseTxns[n].GetHash(), 0);
+    spend.vout.resize(1);
+    spend.vout[0].nValue = setup.coinbaseTxns[n].vout[0].nValue - 10000;
+    spend.vout[0].scriptPubKey = scriptPubKey;
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(scriptPubKey, spend, 0, SIGHASH_ALL, 0, SIGVERSION_BASE);
+    BOOST_CHECK(setup.coinbaseKey.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+    CTransactionRef tx = MakeTransactionRef(spend);
+    LOCK(cs_main);
+    CValidationState state;
+    BOOST_CHECK(AcceptToMemoryPool(mempool, state, tx, false, nullptr, nullptr, true, 0));
+    return tx;
+}
+
+bool checkTemplateBlock(CBlock& block){
+    LOCK(cs_main);
+    CValidationState state;
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    return TestBlockValidity(state, Params(), block, chainActive.Tip(), false, false);
+}
+
+BOOST_AUTO_TEST_CASE(staketemplate_assembled_block){
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CTransactionRef spend = spendCoinbase(*this, 0);
+
+    // The template is a block assembled with the mempool, which stays valid when the header changes time
+    CStakeTemplate stakeTemplate;
+    int64_t nTotalFees = 0;
+    std::unique_ptr<CBlockTemplate> pblocktemplate = BlockAssembler(Params()).CreateNewBlock(scriptPubKey, true, false, &nTotalFees);
+    BOOST_CHECK(pblocktemplate && pblocktemplate->block.vtx.size() == 2);
+    CBlockHeader header = pblocktemplate->block.GetBlockHeader();
+    stakeTemplate.Set(std::move(pblocktemplate), nTotalFees, scriptPubKey);
+    BOOST_CHECK(!stakeTemplate.NeedsUpdate(chainActive.Tip()->GetBlockHash(), header.nTime, scriptPubKey));
+
+    header.nTime += STAKE_TIMESTAMP_MASK + 1;
+    int64_t nTemplateFees = 0;
+    std::unique_ptr<CBlockTemplate> pblocktemplateFilled = stakeTemplate.Get(header, scriptPubKey, nTemplateFees);
+    BOOST_CHECK(pblocktemplateFilled);
+    BOOST_CHECK(nTemplateFees == 10000 && nTemplateFees == nTotalFees);
+    CBlock& block = pblocktemplateFilled->block;
+    BOOST_CHECK(block.nTime == header.nTime && block.vtx[1]->GetHash() == spend->GetHash());
+    BOOST_CHECK(checkTemplateBlock(block));
+
+    // The next tip rebuilds it
+    mempool.clear();
+    BOOST_CHECK(!stakeTemplate.NeedsUpdate(chainActive.Tip()->GetBlockHash(), header.nTime, scriptPubKey));
+    CreateAndProcessBlock(std::vector<CMutableTransaction>(), scriptPubKey);
+    BOOST_CHECK(stakeTemplate.NeedsUpdate(chainActive.Tip()->GetBlockHash(), header.nTime, scriptPubKey));
+    BOOST_CHECK(!stakeTemplate.Get(chainActive.Tip()->GetBlockHeader(), scriptPubKey, nTemplateFees));
+}
+
+BOOST_AUTO_TEST_CASE(staketemplate_follows_mempool){
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CStakeTemplate stakeTemplate;
+    boost::signals2::scoped_connection connAdded(mempool.NotifyEntryAdded.connect(boost::bind(&CStakeTemplate::TransactionAddedToMempool, &stakeTemplate, _1)));
+    boost::signals2::scoped_connection connRemoved(mempool.NotifyEntryRemoved.connect(boost::bind(&CStakeTemplate::TransactionRemovedFromMempool, &stakeTemplate, _1, _2)));
+    spendCoinbase(*this, 0);
+    int64_t nTotalFees = 0;
+    std::unique_ptr<CBlockTemplate> pblocktemplate = BlockAssembler(Params()).CreateNewBlock(scriptPubKey, true, false, &nTotalFees);
+    CBlockHeader header = pblocktemplate->block.GetBlockHeader();
+    stakeTemplate.Set(std::move(pblocktemplate), nTotalFees, scriptPubKey);
+
+    // A transaction received after the build is appended in place, with its fee
+    CTransactionRef later = spendCoinbase(*this, 1);
+    stakeTemplate.Update();
+    BOOST_CHECK(!stakeTemplate.NeedsUpdate(chainActive.Tip()->GetBlockHash(), header.nTime, scriptPubKey));
+    std::unique_ptr<CBlockTemplate> pblocktemplateFilled = stakeTemplate.Get(header, scriptPubKey, nTotalFees);
+    BOOST_CHECK(pblocktemplateFilled && pblocktemplateFilled->block.vtx.size() == 3);
+    BOOST_CHECK(pblocktemplateFilled->block.vtx[2]->GetHash() == later->GetHash());
+    BOOST_CHECK(nTotalFees == 20000 && pblocktemplateFilled->vTxFees[0] == -20000);
+    BOOST_CHECK(checkTemplateBlock(pblocktemplateFilled->block));
+
+    // A transaction leaving the mempool leaves the block
+    {
+        LOCK(mempool.cs);
+        mempool.removeRecursive(*later, MemPoolRemovalReason::CONFLICT);
+    }
+    stakeTemplate.Update();
+    pblocktemplateFilled = stakeTemplate.Get(header, scriptPubKey, nTotalFees);
+    BOOST_CHECK(pblocktemplateFilled && pblocktemplateFilled->block.vtx.size() == 2);
+    BOOST_CHECK(nTotalFees == 10000);
+    BOOST_CHECK(checkTemplateBlock(pblocktemplateFilled->block));
+    mempool.clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,139 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <silubiumtests/test_utils.h>
+#include <random>
+
+const dev::Address cachedContract("0101010101010101010101010101010101010101");
+
+dev::h256 commitCachedState(){
+    globalState->commit(dev::eth::State::CommitBehaviour::KeepEmptyAccounts);
+    globalState->db().commit();
+    return globalState->rootHash();
+}
+
+BOOST_FIXTURE_TEST_SUITE(statecache_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(statecache_survives_commits){
+    initState();
+    globalState->setRoot(dev::sha3(dev::rlp("")));
+    globalState->createContract(cachedContract);
+    globalState->setNewCode(cachedContract, dev::bytes(40, 0x60));
+    for(unsigned i = 1; i <= 10; i++)
+        globalState->setStorage(cachedContract, dev::u256(i), dev::u256(i));
+    dev::h256 root0 = commitCachedState();
+
+    // The committed account and slots are written through
+    dev::eth::StateCache const& cache = globalState->cleanCache();
+    BOOST_CHECK_EQUAL(cache.size(), 1U);
+    BOOST_CHECK_EQUAL(cache.storageSize(), 10U);
+
+    // Later transactions and blocks read them without going to the trie
+    uint64_t hits = cache.hits();
+    uint64_t misses = cache.misses();
+    globalState->setRoot(root0);
+    BOOST_CHECK(globalState->storage(cachedContract, dev::u256(3)) == dev::u256(3));
+    BOOST_CHECK(globalState->code(cachedContract) == dev::bytes(40, 0x60));
+    BOOST_CHECK(cache.hits() == hits + 1 && cache.misses() == misses);
+
+    globalState->setStorage(cachedContract, dev::u256(3), dev::u256(30));
+    dev::h256 root1 = commitCachedState();
+    BOOST_CHECK(globalState->storage(cachedContract, dev::u256(3)) == dev::u256(30));
+    BOOST_CHECK(globalState->storage(cachedContract, dev::u256(4)) == dev::u256(4));
+    BOOST_CHECK(cache.hits() == hits + 2 && cache.misses() == misses);
+
+    // The state at another root, as after a reorg, is read again from the trie
+    globalState->setRoot(root0);
+    BOOST_CHECK_EQUAL(cache.size(), 0U);
+    BOOST_CHECK(globalState->storage(cachedContract, dev::u256(3)) == dev::u256(3));
+    globalState->setRoot(root1);
+    BOOST_CHECK(globalState->storage(cachedContract, dev::u256(3)) == dev::u256(30));
+    BOOST_CHECK(globalState->code(cachedContract) == dev::bytes(40, 0x60));
+}
+
+BOOST_AUTO_TEST_CASE(statecache_matches_trie){
+    initState();
+    globalState->setRoot(dev::sha3(dev::rlp("")));
+    dev::eth::State& state = *globalState;
+    std::vector<dev::Address> addresses;
+    for(unsigned i = 1; i <= 8; i++)
+        addresses.push_back(dev::Address(i));
+
+    for(int round = 0; round < 100; round++){
+        for(int i = 0; i < 4; i++){
+            dev::Address const& address = addresses[InsecureRandRange(addresses.size())];
+            switch(InsecureRandRange(4)){
+            case 0:
+                if(globalState->addressInUse(address))
+                    state.kill(address);
+                break;
+            case 1:
+                state.addBalance(address, dev::u256(InsecureRandRange(100)));
+                break;
+            default:
+                if(!globalState->addressInUse(address))
+                    globalState->createContract(address);
+                globalState->setStorage(address, dev::u256(InsecureRandRange(16)), dev::u256(InsecureRandRange(3)));
+            }
+        }
+        dev::h256 root = commitCachedState();
+
+        // A state without the cache reads the same accounts and slots from the trie
+        std::unique_ptr<SilubiumState> trie = globalState->snapshot(root, globalState->rootHashUTXO());
+        for(dev::Address const& address : addresses){
+            BOOST_CHECK_EQUAL(globalState->addressInUse(address), trie->addressInUse(address));
+            BOOST_CHECK(globalState->balance(address) == trie->balance(address));
+            for(unsigned key = 0; key < 16; key++)
+                BOOST_CHECK(globalState->storage(address, dev::u256(key)) == trie->storage(address, dev::u256(key)));
+        }
+    }
+}
+
+/** Run @a txs transactions of random changes to @a addresses drawn from @a seed and return the root they end at */
+dev::h256 commitRandomBlock(std::vector<dev::Address> const& addresses, unsigned seed, int txs, bool defer){
+    dev::eth::State& state = *globalState;
+    std::mt19937 rand(seed);
+    if(defer)
+        globalState->deferCommits();
+    for(int tx = 0; tx < txs; tx++){
+        for(int i = 0; i < 4; i++){
+            dev::Address const& address = addresses[rand() % addresses.size()];
+            switch(rand() % 4){
+            case 0:
+                if(globalState->addressInUse(address))
+                    state.kill(address);
+                break;
+            case 1:
+                state.addBalance(address, dev::u256(rand() % 100));
+                break;
+            default:
+                if(!globalState->addressInUse(address))
+                    globalState->createContract(address);
+                globalState->setStorage(address, dev::u256(rand() % 16), dev::u256(rand() % 3));
+            }
+        }
+        globalState->commit(dev::eth::State::CommitBehaviour::KeepEmptyAccounts);
+    }
+    if(defer)
+        globalState->commitDeferred(4);
+    return commitCachedState();
+}
+
+BOOST_AUTO_TEST_CASE(statecache_deferred_commits){
+    initState();
+    globalState->setRoot(dev::sha3(dev::rlp("")));
+    std::vector<dev::Address> addresses;
+    for(unsigned i = 1; i <= 8; i++)
+        addresses.push_back(dev::Address(i));
+
+    for(unsigned block = 0; block < 20; block++){
+        dev::h256 parent = globalState->rootHash();
+        dev::h256 root = commitRandomBlock(addresses, block, 10, false);
+        globalState->setRoot(parent);
+
+        // Keeping the transactions of the block in memory ends at the same root
+        BOOST_CHECK(commitRandomBlock(addresses, block, 10, true) == root);
+        BOOST_CHECK(!globalState->deferringCommits());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
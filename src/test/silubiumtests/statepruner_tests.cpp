@@ -0,0 +1,88 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <silubiumtests/test_utils.h>
+#include <silubium/statepruner.h>
+#include <txdb.h>
+
+const dev::Address prunedContract("0101010101010101010101010101010101010101");
+
+/** Keeps the roots given by the test instead of those of the active chain */
+class TestStatePruner : public StatePruner{
+public:
+    TestStatePruner(unsigned int depth = 1000) : StatePruner(depth) {}
+
+    std::vector<StateRoots> roots;
+
+protected:
+    std::vector<StateRoots> retainedRoots() override { return roots; }
+};
+
+StateRoots commitPrunedState(){
+    globalState->commit(dev::eth::State::CommitBehaviour::KeepEmptyAccounts);
+    globalState->db().commit();
+    globalState->dbUtxo().commit();
+    return StateRoots(globalState->rootHash(), globalState->rootHashUTXO());
+}
+
+BOOST_FIXTURE_TEST_SUITE(statepruner_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(statepruner_keeps_retained_roots){
+    initState();
+    globalState->createContract(prunedContract);
+    globalState->setNewCode(prunedContract, dev::bytes(40, 0x60));
+    for(unsigned i = 1; i <= 20; i++)
+        globalState->setStorage(prunedContract, dev::u256(i), dev::u256(i));
+    globalState->setStorage(prunedContract, dev::u256(30), dev::u256(30));
+    StateRoots roots0 = commitPrunedState();
+
+    globalState->setStorage(prunedContract, dev::u256(1), dev::u256(100));
+    globalState->setStorage(prunedContract, dev::u256(30), dev::u256(0));
+    StateRoots roots1 = commitPrunedState();
+
+    globalState->setStorage(prunedContract, dev::u256(2), dev::u256(200));
+    globalState->incNonce(dev::Address(2));
+    StateRoots roots2 = commitPrunedState();
+    BOOST_CHECK(roots0.first != roots1.first && roots1.first != roots2.first);
+
+    TestStatePruner pruner;
+    pruner.roots = {roots1, roots2};
+    size_t deleted = pruner.prune(globalState->db().db(), globalState->dbUtxo().db());
+    BOOST_CHECK(deleted > 0);
+
+    // The nodes of the kept roots are all there, with the storage tries and code of their accounts
+    for(StateRoots const& roots : pruner.roots){
+        globalState->setRoot(roots.first);
+        globalState->setRootUTXO(roots.second);
+        BOOST_CHECK(globalState->code(prunedContract) == dev::bytes(40, 0x60));
+        BOOST_CHECK(globalState->storage(prunedContract).size() == 20);
+        BOOST_CHECK(globalState->storage(prunedContract, dev::u256(1)) == dev::u256(100));
+        BOOST_CHECK(globalState->storage(prunedContract, dev::u256(20)) == dev::u256(20));
+    }
+    BOOST_CHECK(globalState->storage(prunedContract, dev::u256(2)) == dev::u256(200));
+
+    // Only the first root has gone, with the preimage of the slot only it had
+    BOOST_CHECK_THROW(globalState->setRoot(roots0.first), dev::Exception);
+    BOOST_CHECK(globalState->db().lookupAux(dev::sha3(dev::h256(30))).empty());
+    BOOST_CHECK(!globalState->db().lookupAux(dev::sha3(dev::h256(1))).empty());
+
+    // Nothing else is unreachable
+    globalState->setRoot(roots2.first);
+    BOOST_CHECK(pruner.prune(globalState->db().db(), globalState->dbUtxo().db()) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(statepruner_writes_pruned_height){
+    initState();
+    StateRoots roots = commitPrunedState();
+    int nHeight = -1;
+    BOOST_CHECK(!pblocktree->ReadStatePrunedHeight(nHeight));
+
+    // The height is kept in the block tree database, for the next runs whatever their -prunestate
+    TestStatePruner pruner(0);
+    pruner.roots = {roots};
+    pruner.prune(globalState->db().db(), globalState->dbUtxo().db());
+    BOOST_CHECK(nStatePrunedHeight == chainActive.Height());
+    BOOST_CHECK(pblocktree->ReadStatePrunedHeight(nHeight) && nHeight == chainActive.Height());
+    nStatePrunedHeight = -1;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
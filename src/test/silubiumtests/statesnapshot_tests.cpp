@@ -0,0 +1,138 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <silubiumtests/test_utils.h>
+#include <silubium/statesnapshot.h>
+#include <chainparams.h>
+#include <clientversion.h>
+#include <txdb.h>
+
+const dev::Address snapshotContract("0101010101010101010101010101010101010101");
+const dev::Address snapshotAccount("0202020202020202020202020202020202020202");
+
+/** Writes a snapshot of the committed globalState and the coins of @a coinsDB to @a path */
+StateSnapshotStats writeTestSnapshot(const fs::path& path, CCoinsViewDB& coinsDB){
+    StateSnapshotStats stats;
+    CAutoFile file(fsbridge::fopen(path, "wb"), SER_DISK, CLIENT_VERSION);
+    std::unique_ptr<CCoinsViewCursor> coins(coinsDB.Cursor());
+    WriteStateSnapshot(file, globalState->db(), globalState->rootHash(), globalState->dbUtxo(), globalState->rootHashUTXO(), *coins, stats);
+    return stats;
+}
+
+BOOST_FIXTURE_TEST_SUITE(statesnapshot_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(statesnapshot_rebuilds_tries){
+    initState();
+    globalState->createContract(snapshotContract);
+    globalState->setNewCode(snapshotContract, dev::bytes(40, 0x60));
+    // More slots than fit in a chunk, so that the storage of the contract is split across chunks
+    for(unsigned i = 1; i <= 3 * STATE_SNAPSHOT_CHUNK; i++)
+        globalState->setStorage(snapshotContract, dev::u256(i), dev::u256(i) << 200);
+    globalState->incNonce(snapshotAccount);
+    globalState->incNonce(snapshotAccount);
+    globalState->setCacheUTXO(snapshotContract, Vin{dev::h256(7), 1, dev::u256(1000), 1});
+    globalState->commit(dev::eth::State::CommitBehaviour::KeepEmptyAccounts);
+    globalState->db().commit();
+    globalState->dbUtxo().commit();
+    dev::h256 stateRoot = globalState->rootHash();
+    dev::h256 utxoRoot = globalState->rootHashUTXO();
+
+    CCoinsViewDB coinsDB(1 << 20, true);
+    CCoinsViewCache coinsCache(&coinsDB);
+    COutPoint outpoint(uint256S("01"), 0);
+    coinsCache.AddCoin(outpoint, Coin(CTxOut(50, CScript() << OP_TRUE), 1, false, false), false);
+    coinsCache.SetBestBlock(uint256S("02"));
+    coinsCache.Flush();
+
+    fs::path path = GetDataDir() / "state.dat";
+    StateSnapshotStats written = writeTestSnapshot(path, coinsDB);
+    BOOST_CHECK(written.nAccounts == 2 && written.nStorage == 3 * STATE_SNAPSHOT_CHUNK);
+    BOOST_CHECK(written.nVins == 1 && written.nCoins == 1);
+
+    // The tries are rebuilt from the leaves, with the same roots
+    CCoinsViewDB loadedDB(1 << 20, true);
+    CCoinsViewCache loadedCoins(&loadedDB);
+    StateSnapshotStats loaded;
+    std::string error;
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    BOOST_CHECK(ReadStateSnapshot(file, globalState->db(), globalState->dbUtxo(), 4, loaded, error));
+    BOOST_CHECK(loaded.stateRoot == stateRoot && loaded.utxoRoot == utxoRoot);
+    BOOST_CHECK(loaded.nAccounts == written.nAccounts && loaded.nStorage == written.nStorage);
+    BOOST_CHECK(loaded.hashCoins == written.hashCoins);
+    // The coins are only added once the snapshot is checked
+    BOOST_CHECK(!loadedCoins.HaveCoin(outpoint));
+    BOOST_CHECK(ReadStateSnapshotCoins(file, loaded, loadedCoins, 1 << 20, error));
+    BOOST_CHECK(loadedCoins.HaveCoin(outpoint));
+
+    globalState->setRoot(loaded.stateRoot);
+    BOOST_CHECK(globalState->code(snapshotContract) == dev::bytes(40, 0x60));
+    BOOST_CHECK(globalState->storage(snapshotContract, dev::u256(12345)) == dev::u256(12345) << 200);
+    BOOST_CHECK(globalState->getNonce(snapshotAccount) == dev::u256(2));
+}
+
+BOOST_AUTO_TEST_CASE(statesnapshot_rejects_truncated_file){
+    initState();
+    globalState->setStorage(snapshotContract, dev::u256(1), dev::u256(1));
+    globalState->commit(dev::eth::State::CommitBehaviour::KeepEmptyAccounts);
+    globalState->db().commit();
+
+    CCoinsViewDB coinsDB(1 << 20, true);
+    fs::path path = GetDataDir() / "state.dat";
+    writeTestSnapshot(path, coinsDB);
+    fs::resize_file(path, fs::file_size(path) - 1);
+
+    StateSnapshotStats loaded;
+    std::string error;
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    BOOST_CHECK(!ReadStateSnapshot(file, globalState->db(), globalState->dbUtxo(), 1, loaded, error));
+    BOOST_CHECK(!error.empty());
+}
+
+BOOST_AUTO_TEST_CASE(statesnapshot_coins_written_in_batches){
+    initState();
+    CCoinsViewDB coinsDB(1 << 20, true);
+    CCoinsViewCache coinsCache(&coinsDB);
+    for(unsigned i = 1; i <= 2 * STATE_SNAPSHOT_CHUNK; i++)
+        coinsCache.AddCoin(COutPoint(ArithToUint256(arith_uint256(i)), 0), Coin(CTxOut(i, CScript() << OP_TRUE), 1, false, false), false);
+    coinsCache.SetBestBlock(uint256S("02"));
+    coinsCache.Flush();
+
+    fs::path path = GetDataDir() / "state.dat";
+    StateSnapshotStats written = writeTestSnapshot(path, coinsDB);
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    StateSnapshotStats loaded;
+    std::string error;
+    BOOST_CHECK(ReadStateSnapshot(file, globalState->db(), globalState->dbUtxo(), 1, loaded, error));
+    BOOST_CHECK(loaded.hashCoins == written.hashCoins && loaded.vCoinsChunks.size() == 2);
+
+    // A cache smaller than a chunk is written out after each of them
+    CCoinsViewDB loadedDB(1 << 20, true);
+    CCoinsViewCache loadedCoins(&loadedDB);
+    loadedCoins.SetBestBlock(uint256S("02"));
+    BOOST_CHECK(ReadStateSnapshotCoins(file, loaded, loadedCoins, 1024, error));
+    BOOST_CHECK(loadedCoins.GetCacheSize() == 0);
+    BOOST_CHECK(loadedDB.HaveCoin(COutPoint(ArithToUint256(arith_uint256(1)), 0)));
+    BOOST_CHECK(loadedDB.HaveCoin(COutPoint(ArithToUint256(arith_uint256(2 * STATE_SNAPSHOT_CHUNK)), 0)));
+
+    // A chunk that changed since it was hashed is not written
+    StateSnapshotStats changed = loaded;
+    changed.vCoinsChunks[1].hash = uint256S("01");
+    CCoinsViewCache changedCoins(&loadedDB);
+    BOOST_CHECK(!ReadStateSnapshotCoins(file, changed, changedCoins, 1 << 20, error));
+}
+
+BOOST_AUTO_TEST_CASE(statesnapshot_load_mark){
+    CCoinsViewDB coinsDB(1 << 20, true);
+    BOOST_CHECK(coinsDB.ReadStateSnapshotLoad().IsNull());
+    BOOST_CHECK(coinsDB.WriteStateSnapshotLoad(uint256S("02")));
+    BOOST_CHECK(coinsDB.ReadStateSnapshotLoad() == uint256S("02"));
+    // Flushing coins, which happens while the snapshot is loaded, keeps the mark
+    CCoinsViewCache coinsCache(&coinsDB);
+    coinsCache.AddCoin(COutPoint(uint256S("01"), 0), Coin(CTxOut(50, CScript() << OP_TRUE), 1, false, false), false);
+    coinsCache.SetBestBlock(Params().GenesisBlock().GetHash());
+    BOOST_CHECK(coinsCache.Flush());
+    BOOST_CHECK(coinsDB.ReadStateSnapshotLoad() == uint256S("02"));
+    BOOST_CHECK(coinsDB.WriteStateSnapshotLoad(uint256()));
+    BOOST_CHECK(coinsDB.ReadStateSnapshotLoad().IsNull());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
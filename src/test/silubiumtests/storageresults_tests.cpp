@@ -0,0 +1,85 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <silubiumtests/test_utils.h>
+#include <leveldb/db.h>
+#include <arith_uint256.h>
+
+std::vector<TransactionReceiptInfo> createReceipts(uint256 hashTx){
+    dev::eth::LogEntries logs(1, dev::eth::LogEntry(dev::Address("0101010101010101010101010101010101010101"), dev::h256s(1, dev::h256(5)), dev::bytes(3, 7)));
+    TransactionReceiptInfo tri{uint256(), 10, hashTx, 1, dev::Address(1), dev::Address(2), 30000, 21000, dev::Address(), logs, dev::eth::TransactionException::None};
+    return std::vector<TransactionReceiptInfo>(1, tri);
+}
+
+std::string createResultsDir(){
+    fs::path pathTemp = fs::temp_directory_path() / strprintf("test_results_%lu_%i", (unsigned long)GetTime(), (int)(GetRand(100000)));
+    fs::create_directories(pathTemp);
+    return pathTemp.string();
+}
+
+BOOST_FIXTURE_TEST_SUITE(storageresults_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(storageresults_pending_and_committed){
+    StorageResults results(createResultsDir(), 2);
+    CMutableTransaction mtx;
+    mtx.nLockTime = 1;
+    CTransactionRef tx = MakeTransactionRef(CTransaction(mtx));
+    dev::h256 hashTx = uintToh256(tx->GetHash());
+    std::vector<TransactionReceiptInfo> receipts = createReceipts(tx->GetHash());
+
+    results.addResult(hashTx, receipts);
+    BOOST_CHECK(results.getResult(hashTx).size() == 1);
+    results.clearCacheResult();
+    BOOST_CHECK(results.getResult(hashTx).empty());
+
+    results.addResult(hashTx, receipts);
+    results.commitResults();
+    std::vector<TransactionReceiptInfo> read = results.getResult(hashTx);
+    BOOST_CHECK(read.size() == 1);
+    BOOST_CHECK(read[0].transactionHash == tx->GetHash());
+    BOOST_CHECK(read[0].logs.size() == 1);
+    BOOST_CHECK(read[0].logs[0].address == receipts[0].logs[0].address);
+    BOOST_CHECK(read[0].logs[0].topics == receipts[0].logs[0].topics);
+    BOOST_CHECK(read[0].logs[0].data == receipts[0].logs[0].data);
+    BOOST_CHECK(results.getResult(hashTx).size() == 1);
+
+    // more results than the cache holds are still read back from the database
+    for(uint32_t i = 0; i < 40; i++){
+        std::vector<TransactionReceiptInfo> other = createReceipts(ArithToUint256(arith_uint256(i)));
+        results.addResult(dev::h256(i), other);
+    }
+    results.commitResults();
+    for(uint32_t i = 0; i < 40; i++)
+        BOOST_CHECK(results.getResult(dev::h256(i))[0].transactionHash == ArithToUint256(arith_uint256(i)));
+
+    results.deleteResults(std::vector<CTransactionRef>(1, tx));
+    BOOST_CHECK(results.getResult(hashTx).empty());
+}
+
+BOOST_AUTO_TEST_CASE(storageresults_migrate_hex_keys){
+    std::string dir = createResultsDir();
+    dev::h256 hashTx(ParseHex("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"));
+    {
+        StorageResults results(dir);
+        std::vector<TransactionReceiptInfo> receipts = createReceipts(h256Touint(hashTx));
+        results.addResult(hashTx, receipts);
+        results.commitResults();
+    }
+    {
+        // rewrite the entry the way older versions stored it
+        leveldb::DB* db;
+        BOOST_CHECK(leveldb::DB::Open(leveldb::Options(), dir + "/resultsDB", &db).ok());
+        std::string key((char const*)hashTx.data(), dev::h256::size);
+        std::string value;
+        BOOST_CHECK(db->Get(leveldb::ReadOptions(), key, &value).ok());
+        BOOST_CHECK(db->Delete(leveldb::WriteOptions(), key).ok());
+        BOOST_CHECK(db->Delete(leveldb::WriteOptions(), "version").ok());
+        BOOST_CHECK(db->Put(leveldb::WriteOptions(), hashTx.hex(), value).ok());
+        delete db;
+    }
+    StorageResults results(dir);
+    std::vector<TransactionReceiptInfo> read = results.getResult(hashTx);
+    BOOST_CHECK(read.size() == 1);
+    BOOST_CHECK(read[0].transactionHash == h256Touint(hashTx));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 #include <test/test_bitcoin.h>
 #include <boost/filesystem/operations.hpp>
 #include "fs.h"
+#include <libevm/ExtVMFace.h>
 
 extern std::unique_ptr<SilubiumState> globalState;
 
@@ -17,3 +18,16 @@ SilubiumTransaction createSilubiumTransaction(valtype data, dev::u256 value, dev
     dev::h256 hashTransaction, dev::Address recipient, int32_t nvout = 0);
 
 std::pair<std::vector<ResultExecute>, ByteCodeExecResult> executeBC(std::vector<SilubiumTransaction> txs);
+
+/** Frame of a contract with its own storage, creating and calling nothing */
+class TestExtVM : public dev::eth::ExtVMFace {
+public:
+    TestExtVM(dev::eth::EnvInfo const& envInfo, dev::bytes const& code, dev::bytesConstRef data = dev::bytesConstRef(), dev::Address const& address = dev::Address(1)) :
+        dev::eth::ExtVMFace(envInfo, address, dev::Address(2), dev::Address(2), 0, 1, data, code, dev::sha3(code), 0) {}
+
+    dev::u256 store(dev::u256 key) override { return storage[key]; }
+    void setStore(dev::u256 key, dev::u256 value) override { storage[key] = value; }
+    boost::optional<dev::eth::owning_bytes_ref> call(dev::eth::CallParameters&) override { return dev::eth::owning_bytes_ref(); }
+
+    std::map<dev::u256, dev::u256> storage;
+};
@@ -0,0 +1,68 @@
+#include <boost/test/unit_test.hpp>
+#include <test/test_bitcoin.h>
+#include <libevm/Word256.h>
+
+namespace {
+
+/** Random value, with whole limbs and bytes cleared or set so that carries, borrows and short divisors occur */
+dev::u256 randomValue(){
+    dev::u256 value = 0;
+    for(int i = 0; i < 4; i++){
+        uint64_t limb = InsecureRandBits(64);
+        switch(InsecureRandRange(6)){
+        case 0: limb = 0; break;
+        case 1: limb = ~uint64_t(0); break;
+        case 2: limb &= 0xff; break;
+        case 3: limb |= uint64_t(1) << 63; break;
+        }
+        value = (value << 64) | limb;
+    }
+    return value >> InsecureRandRange(256);
+}
+
+void checkOperations(dev::u256 const& a, dev::u256 const& b){
+    dev::eth::Word256 x = a;
+    dev::eth::Word256 y = b;
+    BOOST_CHECK(dev::u256(x) == a && dev::u256(y) == b);
+
+    BOOST_CHECK(dev::u256(x + y) == a + b);
+    BOOST_CHECK(dev::u256(x - y) == a - b);
+    BOOST_CHECK(dev::u256(x * y) == a * b);
+    BOOST_CHECK(dev::u256(x / y) == (b ? a / b : 0));
+    BOOST_CHECK(dev::u256(x % y) == (b ? a % b : 0));
+    BOOST_CHECK(dev::u256(x & y) == (a & b));
+    BOOST_CHECK(dev::u256(x | y) == (a | b));
+    BOOST_CHECK(dev::u256(x ^ y) == (a ^ b));
+    BOOST_CHECK(dev::u256(~x) == ~a);
+    BOOST_CHECK((x < y) == (a < b) && (x > y) == (a > b) && (x == y) == (a == b));
+    BOOST_CHECK((x <= y) == (a <= b) && (x >= y) == (a >= b) && (x != y) == (a != b));
+
+    unsigned shift = static_cast<unsigned>(b & 0x1ff);
+    BOOST_CHECK(dev::u256(x << shift) == (shift < 256 ? a << shift : 0));
+    BOOST_CHECK(dev::u256(x >> shift) == (shift < 256 ? a >> shift : 0));
+
+    BOOST_CHECK(dev::u256(dev::eth::Word256::exp(x, y)) == dev::u256(boost::multiprecision::powm(dev::bigint(a), dev::bigint(b), dev::bigint(1) << 256)));
+    BOOST_CHECK_EQUAL(x.bitLength(), a ? boost::multiprecision::msb(a) + 1 : 0);
+    BOOST_CHECK(x.hash() == dev::h256(a) && dev::eth::Word256(dev::h256(a)) == x);
+    BOOST_CHECK_EQUAL(static_cast<uint64_t>(x), static_cast<uint64_t>(a));
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE(word256_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(word256_edge_values){
+    std::vector<dev::u256> values = {0, 1, 2, 0xff, dev::u256(1) << 63, (dev::u256(1) << 64) - 1, dev::u256(1) << 64,
+        (dev::u256(1) << 128) - 1, dev::u256(1) << 128, dev::u256(1) << 255, ~dev::u256(0), ~dev::u256(0) << 64,
+        (dev::u256(1) << 192) + 1, dev::u256("0x7fffffffffffffff8000000000000000ffffffffffffffff0000000000000001")};
+    for(dev::u256 const& a : values)
+        for(dev::u256 const& b : values)
+            checkOperations(a, b);
+}
+
+BOOST_AUTO_TEST_CASE(word256_random_values){
+    for(int i = 0; i < 20000; i++)
+        checkOperations(randomValue(), randomValue());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
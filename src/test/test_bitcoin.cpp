@@ -21,6 +21,7 @@
 #include "rpc/server.h"
 #include "rpc/register.h"
 #include "script/sigcache.h"
+#include <libdevcore/SHA3.h>
 
 #include <memory>
 
@@ -45,6 +46,7 @@ extern void noui_connect();
 BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
 {
         SHA256AutoDetect();
+        dev::sha3AutoDetect();
         RandomInit();
         ECC_Start();
         SetupEnvironment();
@@ -91,12 +93,15 @@ TestingSetup::TestingSetup(const std::string& chainName) : BasicTestingSetup(cha
         const dev::h256 hashDB(dev::sha3(dev::rlp("")));
         globalState = std::unique_ptr<SilubiumState>(new SilubiumState(dev::u256(0), SilubiumState::openDB(pathTemp.string(), hashDB, dev::WithExisting::Trust), pathTemp.string(), dev::eth::BaseState::Empty));
         dev::eth::ChainParams cp((dev::eth::genesisInfo(dev::eth::Network::silubiumTestNetwork)));
+        for (unsigned i = 5; i <= 9; i++)
+            cp.precompiled.at(dev::Address(i)).setStartingBlock(chainparams.GetConsensus().nPrecompilesHFHeight);
         globalSealEngine = std::unique_ptr<dev::eth::SealEngineFace>(cp.createSealEngine());
         globalState->populateFrom(cp.genesisState);
         globalState->setRootUTXO(uintToh256(chainparams.GenesisBlock().hashUTXORoot));
         globalState->db().commit();
         globalState->dbUtxo().commit();
         pstorageresult = new StorageResults(pathTemp.string());
+        peventindex = new EventIndex(pathTemp.string());
 //////////////////////////////////////////////////////////////
 
         if (!LoadGenesisBlock(chainparams)) {
@@ -132,6 +137,8 @@ TestingSetup::~TestingSetup()
 /////////////////////////////////////////////// // silubium
         delete globalState.release();
         globalSealEngine.reset();
+        delete peventindex;
+        peventindex = nullptr;
 ///////////////////////////////////////////////
 
         fs::remove_all(pathTemp);
@@ -27,6 +27,9 @@ static const char DB_BLOCK_INDEX = 'b';
 ////////////////////////////////////////// // silubium
 static const char DB_HEIGHTINDEX = 'h';
 static const char DB_STAKEINDEX = 's';
+static const char DB_STATE_SNAPSHOT = 'S';
+static const char DB_STATE_SNAPSHOT_LOAD = 'L';
+static const char DB_STATE_PRUNED = 'P';
 //////////////////////////////////////////
 
 static const char DB_BEST_BLOCK = 'B';
@@ -147,6 +150,19 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) {
     return ret;
 }
 
+bool CCoinsViewDB::WriteStateSnapshotLoad(const uint256 &hashBlock) {
+    if (hashBlock.IsNull())
+        return db.Erase(DB_STATE_SNAPSHOT_LOAD, true);
+    return db.Write(DB_STATE_SNAPSHOT_LOAD, hashBlock, true);
+}
+
+uint256 CCoinsViewDB::ReadStateSnapshotLoad() const {
+    uint256 hashBlock;
+    if (!db.Read(DB_STATE_SNAPSHOT_LOAD, hashBlock))
+        return uint256();
+    return hashBlock;
+}
+
 size_t CCoinsViewDB::EstimateSize() const
 {
     return db.EstimateSize(DB_COIN, (char)(DB_COIN+1));
@@ -368,6 +384,31 @@ bool CBlockTreeDB::WipeHeightIndex() {
     return WriteBatch(batch);
 }
 
+bool CBlockTreeDB::ForEachHeightIndex(std::function<bool(const CHeightTxIndexKey&, const std::vector<uint256>&)> fn) {
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(DB_HEIGHTINDEX);
+
+    for (; pcursor->Valid(); pcursor->Next()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CHeightTxIndexKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_HEIGHTINDEX) {
+            break;
+        }
+
+        std::vector<uint256> hashesTx;
+        if (!pcursor->GetValue(hashesTx)) {
+            return error("%s: failed to read height index value", __func__);
+        }
+
+        if (!fn(key.second, hashesTx)) {
+            return false;
+        }
+    }
+
+    return true;
+}
 
 bool CBlockTreeDB::WriteStakeIndex(unsigned int height, uint160 address) {
     CDBBatch batch(*this);
@@ -435,6 +476,28 @@ bool CBlockTreeDB::EraseStakeIndex(unsigned int height) {
 
     return WriteBatch(batch);
 }
+
+bool CBlockTreeDB::WriteStateSnapshotBlock(const uint256 &hash, uint64_t nChainTx) {
+    return Write(DB_STATE_SNAPSHOT, std::make_pair(hash, nChainTx));
+}
+
+bool CBlockTreeDB::ReadStateSnapshotBlock(uint256 &hash, uint64_t &nChainTx) {
+    std::pair<uint256, uint64_t> snapshot;
+    if (!Read(DB_STATE_SNAPSHOT, snapshot))
+        return false;
+    hash = snapshot.first;
+    nChainTx = snapshot.second;
+    return true;
+}
+
+bool CBlockTreeDB::WriteStatePrunedHeight(int nHeight) {
+    // Written before any node is deleted, so that the height is never behind the deleted state
+    return Write(DB_STATE_PRUNED, nHeight, true);
+}
+
+bool CBlockTreeDB::ReadStatePrunedHeight(int &nHeight) {
+    return Read(DB_STATE_PRUNED, nHeight);
+}
 ///////////////////////////////////////////////////////
 
 bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
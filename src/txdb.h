@@ -10,6 +10,7 @@
 #include "dbwrapper.h"
 #include "chain.h"
 
+#include <functional>
 #include <map>
 #include <string>
 #include <utility>
@@ -85,6 +86,11 @@ public:
     //! Attempt to update from an older database format. Returns whether an error occurred.
     bool Upgrade();
     size_t EstimateSize() const override;
+
+    //! Mark the coins as being replaced by those of a state snapshot of @a hashBlock, or clear the mark with a null hash // silubium
+    bool WriteStateSnapshotLoad(const uint256 &hashBlock);
+    //! Block of the state snapshot that was being loaded when the node stopped, null if none
+    uint256 ReadStateSnapshotLoad() const;
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
@@ -148,6 +154,8 @@ public:
             std::set<dev::h160> const &addresses);
     bool EraseHeightIndex(const unsigned int &height);
     bool WipeHeightIndex();
+    /** Call fn on the height index entries in height order, until it returns false */
+    bool ForEachHeightIndex(std::function<bool(const CHeightTxIndexKey&, const std::vector<uint256>&)> fn);
 
 
     bool WriteStakeIndex(unsigned int height, uint160 address);
@@ -155,6 +163,14 @@ public:
     bool ReadStakeIndex(unsigned int high, unsigned int low, std::vector<uint160> addresses);
     bool EraseStakeIndex(unsigned int height);
 
+    /** Block the chain state was loaded from a snapshot at, with its nChainTx */
+    bool WriteStateSnapshotBlock(const uint256 &hash, uint64_t nChainTx);
+    bool ReadStateSnapshotBlock(uint256 &hash, uint64_t &nChainTx);
+
+    /** Highest height whose contract state the state pruner may have deleted */
+    bool WriteStatePrunedHeight(int nHeight);
+    bool ReadStatePrunedHeight(int &nHeight);
+
     //////////////////////////////////////////////////////////////////////////////
 
 };
@@ -49,6 +49,7 @@
 
 #include <atomic>
 #include <sstream>
+#include <thread>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/join.hpp>
@@ -67,6 +68,9 @@
 #include <bitset>
 #include "pubkey.h"
 #include <univalue.h>
+#include "silubium/statepruner.h"
+#include "silubium/statesnapshot.h"
+#include "silubium/flatstorage.h"
 
 std::unique_ptr<SilubiumState> globalState;
 std::shared_ptr<dev::eth::SealEngineFace> globalSealEngine;
@@ -88,6 +92,9 @@ std::atomic_bool fImporting(false);
 bool fReindex = false;
 bool fTxIndex = false;
 bool fLogEvents = true;//false;
+bool fParallelContracts = DEFAULT_PARALLEL_CONTRACTS;
+bool fParallelBlockProofs = DEFAULT_PARALLEL_BLOCK_PROOFS;
+unsigned int nPruneStateDepth = DEFAULT_PRUNE_STATE;
 bool fHavePruned = false;
 bool fPruneMode = false;
 bool fIsBareMultisigStd = DEFAULT_PERMIT_BAREMULTISIG;
@@ -109,7 +116,7 @@ CBlockPolicyEstimator feeEstimator;
 CTxMemPool mempool(&feeEstimator);
 
 static void CheckBlockIndex(const Consensus::Params& consensusParams);
-static bool UpdateHashProof(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, CBlockIndex* pindex, CCoinsViewCache& view);
+static bool UpdateHashProof(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, CBlockIndex* pindex, CCoinsViewCache& view, const BlockProofPrecheck* pprecheck = nullptr);
 
 /** Constant stuff for coinbase transactions we create: */
 CScript COINBASE_FLAGS;
@@ -1693,6 +1700,11 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
 
     bool fClean = true;
 
+    if (IsStatePruned(pindex->pprev->nHeight)) { // silubium
+        error("DisconnectBlock(): contract state of block %s has been pruned", pindex->pprev->GetBlockHash().ToString());
+        return DISCONNECT_FAILED;
+    }
+
     CBlockUndo blockUndo;
     CDiskBlockPos pos = pindex->GetUndoPos();
     if (pos.IsNull()) {
@@ -1755,6 +1767,7 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
     if(pfClean == NULL && fLogEvents){
         pstorageresult->deleteResults(block.vtx);
         pblocktree->EraseHeightIndex(pindex->nHeight);
+        peventindex->eraseBlock(pindex->nHeight);
     }
     pblocktree->EraseStakeIndex(pindex->nHeight);
 
@@ -1793,6 +1806,35 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+static CCheckQueue<CContractCheck> contractcheckqueue(1);
+
+void ThreadContractCheck() {
+    RenameThread("silubium-contractch");
+    contractcheckqueue.Thread();
+}
+
+static CCheckQueue<CBlockProofCheck> blockproofcheckqueue(1);
+
+void ThreadBlockProofCheck() {
+    RenameThread("silubium-blockproofch");
+    blockproofcheckqueue.Thread();
+}
+
+/** Prechecks of the run of blocks ActivateBestChainStep is connecting, by block hash. Protected by cs_main */
+static std::map<uint256, BlockProofPrecheck> mapBlockProofPrechecks;
+
+/** The precheck of the block object being connected at pindex, if there is one */
+static const BlockProofPrecheck* GetBlockProofPrecheck(const CBlock& block, const CBlockIndex* pindex)
+{
+    AssertLockHeld(cs_main);
+    if (pindex->phashBlock == nullptr)
+        return nullptr;
+    std::map<uint256, BlockProofPrecheck>::const_iterator it = mapBlockProofPrechecks.find(*pindex->phashBlock);
+    if (it == mapBlockProofPrechecks.end() || it->second.pblock.get() != &block)
+        return nullptr;
+    return &it->second;
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -1890,30 +1932,134 @@ bool CheckSenderScript(const CCoinsViewCache& view, const CTransaction& tx){
     return true;
 }
 
-std::vector<ResultExecute> CallContract(const dev::Address& addrContract, std::vector<unsigned char> opcode, const dev::Address& sender, uint64_t gasLimit){
-    CBlock block;
-    CMutableTransaction tx;
-
-    SilubiumDGP silubiumDGP(globalState.get(), fGettingValuesDGP);
-    uint64_t blockGasLimit = silubiumDGP.getBlockGasLimit(chainActive.Tip()->nHeight + 1);
-
+static SilubiumTransaction CreateCallTransaction(const dev::Address& addrContract, std::vector<unsigned char> opcode, const dev::Address& sender, uint64_t gasLimit, uint64_t blockGasLimit){
     if(gasLimit == 0){
         gasLimit = blockGasLimit - 1;
     }
     dev::Address senderAddress = sender == dev::Address() ? dev::Address("ffffffffffffffffffffffffffffffffffffffff") : sender;
-    tx.vout.push_back(CTxOut(0, CScript() << OP_DUP << OP_HASH160 << senderAddress.asBytes() << OP_EQUALVERIFY << OP_CHECKSIG));
-    block.vtx.push_back(MakeTransactionRef(CTransaction(tx)));
 
     SilubiumTransaction callTransaction(0, 1, dev::u256(gasLimit), addrContract, opcode, dev::u256(0));
     callTransaction.forceSender(senderAddress);
     callTransaction.setVersion(VersionVM::GetEVMDefault());
+    return callTransaction;
+}
+
+static std::unique_ptr<dev::eth::SealEngineFace> CopySealEngine(const dev::eth::SealEngineFace& sealEngine){
+    std::unique_ptr<dev::eth::SealEngineFace> copy(dev::eth::SealEngineRegistrar::create(sealEngine.name()));
+    if(copy){
+        copy->setChainParams(sealEngine.chainParams());
+        copy->setSilubiumSchedule(sealEngine.getSilubiumSchedule());
+    }
+    return copy;
+}
+
+std::vector<ResultExecute> CallContract(const dev::Address& addrContract, std::vector<unsigned char> opcode, const dev::Address& sender, uint64_t gasLimit){
+    CBlock block;
+    CMutableTransaction tx;
+
+    SilubiumDGP silubiumDGP(globalState.get(), fGettingValuesDGP);
+    uint64_t blockGasLimit = silubiumDGP.getBlockGasLimit(chainActive.Tip()->nHeight + 1);
 
+    SilubiumTransaction callTransaction = CreateCallTransaction(addrContract, opcode, sender, gasLimit, blockGasLimit);
+    tx.vout.push_back(CTxOut(0, CScript() << OP_DUP << OP_HASH160 << callTransaction.sender().asBytes() << OP_EQUALVERIFY << OP_CHECKSIG));
+    block.vtx.push_back(MakeTransactionRef(CTransaction(tx)));
     
     ByteCodeExec exec(block, std::vector<SilubiumTransaction>(1, callTransaction), blockGasLimit);
     exec.performByteCode(dev::eth::Permanence::Reverted);
     return exec.getResult();
 }
 
+bool GetContractStateSnapshot(ContractStateSnapshot& snapshot){
+    AssertLockHeld(cs_main);
+    CBlockIndex* tip = chainActive.Tip();
+    if(!tip || !globalState || !globalSealEngine)
+        return false;
+
+    std::unique_ptr<dev::eth::SealEngineFace> sealEngine(CopySealEngine(*globalSealEngine));
+    if(!sealEngine)
+        return false;
+
+    SilubiumDGP silubiumDGP(globalState.get(), fGettingValuesDGP);
+    snapshot.blockGasLimit = silubiumDGP.getBlockGasLimit(tip->nHeight + 1);
+    snapshot.state = globalState->snapshot(globalState->rootHash(), globalState->rootHashUTXO());
+    snapshot.sealEngine = std::move(sealEngine);
+
+    // Calls are executed in an empty block on top of the tip
+    snapshot.env = dev::eth::EnvInfo();
+    snapshot.env.setNumber(dev::u256(tip->nHeight + 1));
+    snapshot.env.setLastHashes(lastBlockHashes.Get(tip));
+    snapshot.env.setGasLimit(snapshot.blockGasLimit);
+    return true;
+}
+
+bool ForkContractStateSnapshot(const ContractStateSnapshot& from, ContractStateSnapshot& to){
+    std::unique_ptr<dev::eth::SealEngineFace> sealEngine(CopySealEngine(*from.sealEngine));
+    if(!sealEngine)
+        return false;
+    to.state = from.state->snapshot(from.state->rootHash(), from.state->rootHashUTXO());
+    to.sealEngine = std::move(sealEngine);
+    to.env = from.env;
+    to.blockGasLimit = from.blockGasLimit;
+    return true;
+}
+
+std::vector<ResultExecute> CallContract(ContractStateSnapshot& snapshot, const dev::Address& addrContract, std::vector<unsigned char> opcode, const dev::Address& sender, uint64_t gasLimit){
+    SilubiumTransaction callTransaction = CreateCallTransaction(addrContract, opcode, sender, gasLimit, snapshot.blockGasLimit);
+
+    CBlock block;
+    ByteCodeExec exec(block, std::vector<SilubiumTransaction>(1, callTransaction), snapshot.blockGasLimit);
+    exec.performSnapshot(snapshot);
+    return exec.getResult();
+}
+
+std::vector<ResultExecute> CallContractBatch(ContractStateSnapshot& snapshot, const std::vector<ContractCall>& calls, unsigned int nThreads){
+    std::vector<SilubiumTransaction> txs;
+    txs.reserve(calls.size());
+    for(const ContractCall& call : calls)
+        txs.push_back(CreateCallTransaction(call.address, call.data, call.sender, call.gasLimit, snapshot.blockGasLimit));
+
+    // Each thread takes a range of consecutive calls and executes them on its own fork of the snapshot
+    nThreads = std::max(1u, std::min<unsigned int>(nThreads, txs.size()));
+    size_t nPerThread = (txs.size() + nThreads - 1) / nThreads;
+    std::vector<ContractStateSnapshot> forks(nThreads - 1);
+    for(ContractStateSnapshot& fork : forks){
+        if(!ForkContractStateSnapshot(snapshot, fork))
+            throw std::runtime_error("Failed to fork contract state snapshot");
+    }
+
+    const CBlock block;
+    std::vector<std::vector<ResultExecute>> results(nThreads);
+    std::vector<std::exception_ptr> errors(nThreads);
+    auto executeRange = [&](unsigned int n){
+        try {
+            size_t begin = std::min(txs.size(), n * nPerThread);
+            size_t end = std::min(txs.size(), begin + nPerThread);
+            ByteCodeExec exec(block, std::vector<SilubiumTransaction>(txs.begin() + begin, txs.begin() + end), snapshot.blockGasLimit);
+            exec.performSnapshot(n == 0 ? snapshot : forks[n - 1]);
+            results[n].swap(exec.getResult());
+        } catch (...) {
+            errors[n] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(unsigned int n = 1; n < nThreads; n++)
+        threads.emplace_back(executeRange, n);
+    executeRange(0);
+    for(std::thread& thread : threads)
+        thread.join();
+
+    std::vector<ResultExecute> result;
+    result.reserve(txs.size());
+    for(unsigned int n = 0; n < nThreads; n++){
+        if(errors[n])
+            std::rethrow_exception(errors[n]);
+        for(ResultExecute& re : results[n])
+            result.push_back(std::move(re));
+    }
+    return result;
+}
+
 bool CheckMinGasPrice(std::vector<EthTransactionParams>& etps, const uint64_t& minGasPrice){
     for(EthTransactionParams& etp : etps){
         if(etp.gasPrice < dev::u256(minGasPrice))
@@ -2106,23 +2252,94 @@ void writeVMlog(const std::vector<ResultExecute>& res, const CTransaction& tx, c
 }
 
 bool ByteCodeExec::performByteCode(dev::eth::Permanence type){
+    if(!execute(*globalState, *globalSealEngine.get(), type)){
+        return false;
+    }
+    if(!globalState->deferringCommits()){
+        globalState->db().commit();
+        globalState->dbUtxo().commit();
+    }
+    globalSealEngine.get()->deleteAddresses.clear();
+    return true;
+}
+
+bool ByteCodeExec::performSnapshot(ContractStateSnapshot& _snapshot){
+    snapshot = &_snapshot;
+    bool ret = execute(*_snapshot.state, *_snapshot.sealEngine, dev::eth::Permanence::Reverted);
+    _snapshot.sealEngine->deleteAddresses.clear();
+    snapshot = nullptr;
+    return ret;
+}
+
+bool ByteCodeExec::performSpeculative(SilubiumState& state, dev::eth::SealEngineFace const& sealEngine, SilubiumAccessSet& access, std::vector<SilubiumStateDiff>& diffs){
+    SilubiumStateRecorder recorder(state, access, &diffs);
+    return execute(state, sealEngine, dev::eth::Permanence::Committed);
+}
+
+void ByteCodeExec::applySpeculative(std::vector<ResultExecute> const& results, std::vector<SilubiumStateDiff> const& diffs){
+    for(ResultExecute const& re : results)
+        result.push_back(re);
+    std::vector<SilubiumStateDiff>::const_iterator diff = diffs.begin();
+    for(ResultExecute& re : result){
+        //outputs sent to an unused address were never executed
+        if(re.txRec.stateRoot() == dev::h256())
+            continue;
+        assert(diff != diffs.end());
+        globalState->applyDiff(*diff++);
+        re.txRec = dev::eth::TransactionReceipt(globalState->rootHash(), re.txRec.gasUsed(), re.txRec.log());
+    }
+    if(!globalState->deferringCommits()){
+        globalState->db().commit();
+        globalState->dbUtxo().commit();
+    }
+}
+
+bool ByteCodeExec::execute(SilubiumState& state, dev::eth::SealEngineFace const& sealEngine, dev::eth::Permanence type){
     for(SilubiumTransaction& tx : txs){
         //validate VM version
         if(tx.getVersion().toRaw() != VersionVM::GetEVMDefault().toRaw()){
             return false;
         }
-        dev::eth::EnvInfo envInfo(BuildEVMEnvironment());
-        if(!tx.isCreation() && !globalState->addressInUse(tx.receiveAddress())){
+        dev::eth::EnvInfo envInfo(snapshot ? snapshot->env : BuildEVMEnvironment());
+        if(snapshot){
+            envInfo.setAuthor(tx.sender());
+        }
+        if(!tx.isCreation() && !state.addressInUse(tx.receiveAddress())){
             dev::eth::ExecutionResult execRes;
             execRes.excepted = dev::eth::TransactionException::Unknown;
             result.push_back(ResultExecute{execRes, dev::eth::TransactionReceipt(dev::h256(), dev::u256(), dev::eth::LogEntries()), CTransaction()});
             continue;
         }
-        result.push_back(globalState->execute(envInfo, *globalSealEngine.get(), tx, type, OnOpFunc()));
+        result.push_back(state.execute(envInfo, sealEngine, tx, type, OnOpFunc()));
+    }
+    return true;
+}
+
+bool CContractCheck::operator()() {
+    try {
+        ByteCodeExec exec(*pblock, pspec->txs, blockGasLimit);
+        pspec->fOk = exec.performSpeculative(*pspec->state, *pspec->sealEngine, pspec->access, pspec->diffs);
+        pspec->results.swap(exec.getResult());
+    } catch (const std::exception& e) {
+        LogPrint(BCLog::BENCH, "%s: speculative execution failed: %s\n", __func__, e.what());
+        pspec->fOk = false;
+    } catch (...) {
+        pspec->fOk = false;
+    }
+    return true;
+}
+
+bool CBlockProofCheck::operator()() {
+    const CBlock& block = *pprecheck->pblock;
+    // CheckBlock checks the coinstake before the signature key it holds
+    if (block.IsProofOfWork() || (block.vtx.size() > 1 && block.vtx[1]->IsCoinStake()))
+        pprecheck->fSignature = CheckBlockSignature(block);
+    if (pprecheck->fHaveCoinStake) {
+        CValidationState state;
+        uint256 targetProofOfStake;
+        pprecheck->fStake = CheckProofOfStake(pprecheck->pindex->pprev, state, *block.vtx[1], block.nBits, block.nTime,
+                                              pprecheck->coinStake, pprecheck->hashProof, targetProofOfStake);
     }
-    globalState->db().commit();
-    globalState->dbUtxo().commit();
-    globalSealEngine.get()->deleteAddresses.clear();
     return true;
 }
 
@@ -2165,22 +2382,72 @@ bool ByteCodeExec::processingResults(ByteCodeExecResult& resultBCE){
     return true;
 }
 
+CLastBlockHashes lastBlockHashes;
+
+CLastBlockHashes::CLastBlockHashes() : head(0), pindexLast(nullptr) {}
+
+void CLastBlockHashes::Connect(const CBlockIndex* pindexNew)
+{
+    LOCK(cs);
+    if (!pindexLast || pindexNew->pprev != pindexLast) {
+        Reset(pindexNew);
+        return;
+    }
+    head = (head + 1) % SIZE;
+    ring[head] = uintToh256(pindexNew->GetBlockHash());
+    pindexLast = pindexNew;
+    lastHashes.reset();
+}
+
+void CLastBlockHashes::Disconnect(const CBlockIndex* pindexNew)
+{
+    LOCK(cs);
+    if (!pindexNew || !pindexLast || pindexLast->pprev != pindexNew) {
+        Reset(pindexNew);
+        return;
+    }
+    // The slot of the disconnected tip becomes the oldest one, which now goes one block further back
+    const CBlockIndex* pindexOldest = pindexNew->GetAncestor(pindexNew->nHeight - (SIZE - 1));
+    ring[head] = pindexOldest ? uintToh256(pindexOldest->GetBlockHash()) : dev::h256();
+    head = (head + SIZE - 1) % SIZE;
+    pindexLast = pindexNew;
+    lastHashes.reset();
+}
+
+std::shared_ptr<const dev::eth::LastHashes> CLastBlockHashes::Get(const CBlockIndex* pindexTip)
+{
+    LOCK(cs);
+    if (pindexTip != pindexLast)
+        Reset(pindexTip);
+    if (!lastHashes) {
+        dev::eth::LastHashes lh(SIZE);
+        for (int i = 0; i < SIZE; i++)
+            lh[i] = ring[(head + SIZE - i) % SIZE];
+        lastHashes = std::make_shared<const dev::eth::LastHashes>(std::move(lh));
+    }
+    return lastHashes;
+}
+
+void CLastBlockHashes::Reset(const CBlockIndex* pindexTip)
+{
+    head = 0;
+    const CBlockIndex* pindex = pindexTip;
+    for (int i = 0; i < SIZE; i++) {
+        ring[(SIZE - i) % SIZE] = pindex ? uintToh256(pindex->GetBlockHash()) : dev::h256();
+        if (pindex)
+            pindex = pindex->pprev;
+    }
+    pindexLast = pindexTip;
+    lastHashes.reset();
+}
+
 dev::eth::EnvInfo ByteCodeExec::BuildEVMEnvironment(){
     dev::eth::EnvInfo env;
     CBlockIndex* tip = chainActive.Tip();
     env.setNumber(dev::u256(tip->nHeight + 1));
     env.setTimestamp(dev::u256(block.nTime));
     env.setDifficulty(dev::u256(block.nBits));
-
-    dev::eth::LastHashes lh;
-    lh.resize(256);
-    for(int i=0;i<256;i++){
-        if(!tip)
-            break;
-        lh[i]= uintToh256(*tip->phashBlock);
-        tip = tip->pprev;
-    }
-    env.setLastHashes(std::move(lh));
+    env.setLastHashes(lastBlockHashes.Get(tip));
     env.setGasLimit(blockGasLimit);
     if(block.IsProofOfStake()){
         env.setAuthor(EthAddrFromScript(block.vtx[1]->vout[1].scriptPubKey));
@@ -2346,8 +2613,9 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         return state.DoS(100, false, REJECT_INVALID, "bad-blk-weight", false, strprintf("%s : weight limit failed", __func__));
     }
 
-    // Check it again in case a previous version let a bad block in
-    if (!CheckBlock(block, state, chainparams.GetConsensus(), !fJustCheck, !fJustCheck))
+    // Check it again in case a previous version let a bad block in, but the signature if it was checked ahead
+    const BlockProofPrecheck* pprecheck = GetBlockProofPrecheck(block, pindex);
+    if (!CheckBlock(block, state, chainparams.GetConsensus(), !fJustCheck, !fJustCheck, !(pprecheck && pprecheck->fSignature)))
         return error("%s: Consensus::CheckBlock: %s", __func__, FormatStateMessage(state));
 
     // verify that the view's current state corresponds to the previous block
@@ -2363,7 +2631,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     }
 
     // State is filled in by UpdateHashProof
-    if (!UpdateHashProof(block, state, chainparams.GetConsensus(), pindex, view)) {
+    if (!UpdateHashProof(block, state, chainparams.GetConsensus(), pindex, view, pprecheck)) {
         return error("%s: ConnectBlock(): %s", __func__, state.GetRejectReason().c_str());
     }
 
@@ -2464,6 +2732,44 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
 
     ///////////////////////////////////////////////////////// // silubium
     std::map<dev::Address, std::pair<CHeightTxIndexKey, std::vector<uint256>>> heightIndexes;
+    EventIndexBlock eventBlock;
+
+    // Execute the contract transactions ahead on forks of the state. In block order, each one is applied
+    // if nothing it read was written by the transactions before it, and executed again otherwise.
+    bool fSpeculate = fParallelContracts && nScriptCheckThreads && chainActive.Height() >= chainparams.GetConsensus().nFixUTXOCacheHFHeight;
+    std::map<unsigned int, SpeculativeContractTx> speculativeTxs;
+    SilubiumAccessSet blockWrites;
+    CCheckQueueControl<CContractCheck> contractControl(fSpeculate ? &contractcheckqueue : nullptr);
+    if(fSpeculate){
+        std::vector<CContractCheck> vContractChecks;
+        for (unsigned int i = 0; i < block.vtx.size(); i++){
+            const CTransaction &tx = *(block.vtx[i]);
+            if(!tx.HasCreateOrCall() || tx.HasOpSpend())
+                continue;
+            SilubiumTxConverter convert(tx, &view, &block.vtx);
+            ExtractSilubiumTX resultConvertSilubiumTX;
+            if(!convert.extractionSilubiumTransactions(resultConvertSilubiumTX))
+                continue;
+            dev::u256 gasAllTxs = dev::u256(0);
+            for(SilubiumTransaction& qtx : resultConvertSilubiumTX.first)
+                gasAllTxs += qtx.gas();
+            if(gasAllTxs > dev::u256(blockGasLimit))
+                continue;
+            std::unique_ptr<dev::eth::SealEngineFace> sealEngine(CopySealEngine(*globalSealEngine));
+            if(!sealEngine)
+                break;
+
+            SpeculativeContractTx& spec = speculativeTxs[i];
+            spec.txs = resultConvertSilubiumTX.first;
+            spec.state.reset(new SilubiumState(*globalState));
+            spec.sealEngine = std::move(sealEngine);
+            vContractChecks.push_back(CContractCheck(block, blockGasLimit, spec));
+        }
+        contractControl.Add(vContractChecks);
+    }
+
+    // The accounts written by the contracts stay in memory until the end of the block, where their tries are hashed once
+    globalState->deferCommits();
     /////////////////////////////////////////////////////////
 
     std::vector<PrecomputedTransactionData> txdata;
@@ -2545,7 +2851,8 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
             std::vector<CScriptCheck> vChecks;
             bool fCacheResults = fJustCheck; /* Don't cache results if we're actually connecting blocks (still consult the cache, though) */
             //note that coinbase and coinstake can not contain any contract opcodes, this is checked in CheckBlock
-            if (!CheckInputs(tx, state, view, fScriptChecks, flags, fCacheResults, false, txdata[i], (hasOpSpend || tx.HasCreateOrCall()) ? nullptr : (nScriptCheckThreads ? &vChecks : nullptr)))//nScriptCheckThreads ? &vChecks : nullptr))
+            //contract transactions are checked in parallel as well, a failing block resets the state roots anyway
+            if (!CheckInputs(tx, state, view, fScriptChecks, flags, fCacheResults, false, txdata[i], hasOpSpend ? nullptr : (nScriptCheckThreads ? &vChecks : nullptr)))//nScriptCheckThreads ? &vChecks : nullptr))
                 return error("ConnectBlock(): CheckInputs on %s failed with %s",
                              tx.GetHash().ToString(), FormatStateMessage(state));
             control.Add(vChecks);
@@ -2650,7 +2957,18 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
                 }
             }
 
-            if(!exec.performByteCode()){
+            auto spec = speculativeTxs.find(i);
+            if(spec != speculativeTxs.end() && contractControl.Wait() && spec->second.fOk && !spec->second.access.conflicts(blockWrites)){
+                exec.applySpeculative(spec->second.results, spec->second.diffs);
+                blockWrites.addWrites(spec->second.access);
+            } else if(fSpeculate){
+                SilubiumAccessSet access;
+                SilubiumStateRecorder recorder(*globalState, access);
+                if(!exec.performByteCode()){
+                    return state.DoS(100, error("ConnectBlock(): Unknown error during contract execution"), REJECT_INVALID, "bad-tx-unknown-error");
+                }
+                blockWrites.addWrites(access);
+            } else if(!exec.performByteCode()){
                 return state.DoS(100, error("ConnectBlock(): Unknown error during contract execution"), REJECT_INVALID, "bad-tx-unknown-error");
             }
 
@@ -2670,6 +2988,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
                         heightIndexes[key].first = CHeightTxIndexKey(pindex->nHeight, resultExec[k].execRes.newAddress);
                     }
                     heightIndexes[key].second.push_back(tx.GetHash());
+                    eventBlock.bloom |= resultExec[k].txRec.bloom();
                     tri.push_back(TransactionReceiptInfo{block.GetHash(), uint32_t(pindex->nHeight), tx.GetHash(), uint32_t(i), resultConvertSilubiumTX.first[k].from(), resultConvertSilubiumTX.first[k].to(),
                                                          countCumulativeGasUsed, uint64_t(resultExec[k].execRes.gasUsed), resultExec[k].execRes.newAddress, resultExec[k].txRec.log(), resultExec[k].execRes.excepted});
                 }
@@ -2725,6 +3044,10 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     LogPrint(BCLog::BENCH, "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs]\n", nInputs - 1, 0.001 * (nTime4 - nTime2), nInputs <= 1 ? 0 : 0.001 * (nTime4 - nTime2) / (nInputs-1), nTimeVerify * 0.000001);
 
     ////////////////////////////////////////////////////////////////// // silubium
+    globalState->commitDeferred(std::max(nScriptCheckThreads, 1));
+    globalState->db().commit();
+    globalState->dbUtxo().commit();
+
     checkBlock.hashMerkleRoot = BlockMerkleRoot(checkBlock);
     checkBlock.hashStateRoot = h256Touint(globalState->rootHash());
     checkBlock.hashUTXORoot = h256Touint(globalState->rootHashUTXO());
@@ -2836,7 +3159,10 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         {
             if (!pblocktree->WriteHeightIndex(e.second.first, e.second.second))
                 return AbortNode(state, "Failed to write height index");
+            eventBlock.add(e.second.first.address, e.second.second);
         }
+        if (!peventindex->writeBlock(pindex->nHeight, eventBlock))
+            return AbortNode(state, "Failed to write event index");
     }
     if(block.IsProofOfStake()){
         // Read the public key from the second output
@@ -3088,6 +3414,8 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
         assert(view.GetBestBlock() == pindexDelete->GetBlockHash());
         if (DisconnectBlock(block, pindexDelete, view, nullptr) != DISCONNECT_OK)
             return error("DisconnectTip(): DisconnectBlock %s failed", pindexDelete->GetBlockHash().ToString());
+        if (pflatstorage && !pflatstorage->disconnectBlock(pindexDelete->nHeight, pindexDelete->GetBlockHash())) // silubium
+            return AbortNode(state, "Failed to undo the flat contract storage");
         bool flushed = view.Flush();
         assert(flushed);
     }
@@ -3111,6 +3439,7 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
 
     // Update chainActive and related variables.
     UpdateTip(pindexDelete->pprev, chainparams);
+    lastBlockHashes.Disconnect(pindexDelete->pprev); // silubium
     // Let wallets know transactions went from 1-confirmed to
     // 0-confirmed or conflicted:
     GetMainSignals().BlockDisconnected(pblock);
@@ -3200,7 +3529,10 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     // Read block from disk.
     int64_t nTime1 = GetTimeMicros();
     std::shared_ptr<const CBlock> pthisBlock;
-    if (!pblock) {
+    std::map<uint256, BlockProofPrecheck>::iterator itPrecheck = mapBlockProofPrechecks.find(pindexNew->GetBlockHash());
+    if (!pblock && itPrecheck != mapBlockProofPrechecks.end()) {
+        pthisBlock = itPrecheck->second.pblock;
+    } else if (!pblock) {
         std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
         if (!ReadBlockFromDisk(*pblockNew, pindexNew, chainparams.GetConsensus()))
             return AbortNode(state, "Failed to read block");
@@ -3219,7 +3551,13 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
         dev::h256 oldHashStateRoot(globalState->rootHash()); // silubium
         dev::h256 oldHashUTXORoot(globalState->rootHashUTXO()); // silubium
 
+        // Only the changes of this block go to the flat storage, not those of block templates or checks
+        if (pflatstorage)
+            pflatstorage->discardPending(); // silubium
+
         bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams);
+        if (itPrecheck != mapBlockProofPrechecks.end())
+            mapBlockProofPrechecks.erase(itPrecheck);
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
             if (state.IsInvalid())
@@ -3230,6 +3568,8 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
             pstorageresult->clearCacheResult();
             return error("ConnectTip(): ConnectBlock %s failed", pindexNew->GetBlockHash().ToString());
         }
+        if (pflatstorage && !pflatstorage->connectBlock(pindexNew->nHeight, pindexNew->GetBlockHash())) // silubium
+            return AbortNode(state, "Failed to write the flat contract storage");
         nTime3 = GetTimeMicros(); nTimeConnectTotal += nTime3 - nTime2;
         LogPrint(BCLog::BENCH, "  - Connect total: %.2fms [%.2fs]\n", (nTime3 - nTime2) * 0.001, nTimeConnectTotal * 0.000001);
         bool flushed = view.Flush();
@@ -3247,6 +3587,7 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     disconnectpool.removeForBlock(blockConnecting.vtx);
     // Update chainActive & related variables.
     UpdateTip(pindexNew, chainparams);
+    lastBlockHashes.Connect(pindexNew); // silubium
 
     int64_t nTime6 = GetTimeMicros(); nTimePostConnect += nTime6 - nTime5; nTimeTotal += nTime6 - nTime1;
     LogPrint(BCLog::BENCH, "  - Connect postprocess: %.2fms [%.2fs]\n", (nTime6 - nTime5) * 0.001, nTimePostConnect * 0.000001);
@@ -3326,6 +3667,62 @@ static void PruneBlockIndexCandidates() {
     assert(!setBlockIndexCandidates.empty());
 }
 
+/**
+ * Check the block signatures and stake kernels of a run of blocks to connect on the block proof
+ * threads, with the stake coins as pcoinsTip has them before the run. The blocks are read from
+ * disk here instead of in ConnectTip, which takes them with their results from mapBlockProofPrechecks.
+ */
+static void PrecheckBlockProofs(const std::vector<CBlockIndex*>& vpindexToConnect, const CChainParams& chainparams, const std::shared_ptr<const CBlock>& pblock)
+{
+    AssertLockHeld(cs_main);
+
+    // Drop the prechecks of the blocks out of the run, left by a reorg or a failure
+    std::set<uint256> setRun;
+    for (const CBlockIndex* pindex : vpindexToConnect)
+        setRun.insert(pindex->GetBlockHash());
+    for (std::map<uint256, BlockProofPrecheck>::iterator it = mapBlockProofPrechecks.begin(); it != mapBlockProofPrechecks.end();) {
+        if (setRun.count(it->first))
+            ++it;
+        else
+            it = mapBlockProofPrechecks.erase(it);
+    }
+    if (!fParallelBlockProofs || !nScriptCheckThreads || vpindexToConnect.size() < 2)
+        return;
+    // The run is checked again once the blocks checked ahead are connected, not one block at a time
+    if (mapBlockProofPrechecks.count(vpindexToConnect.back()->GetBlockHash()))
+        return;
+
+    int64_t nTimeStart = GetTimeMicros();
+    std::vector<CBlockProofCheck> vChecks;
+    for (CBlockIndex* pindex : reverse_iterate(vpindexToConnect)) {
+        if (mapBlockProofPrechecks.count(pindex->GetBlockHash()))
+            continue;
+
+        std::shared_ptr<const CBlock> pblockRead = pblock;
+        if (!pblockRead || pblockRead->GetHash() != pindex->GetBlockHash()) {
+            std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
+            if (!ReadBlockFromDisk(*pblockNew, pindex, chainparams.GetConsensus()))
+                break; // ConnectTip reports it
+            pblockRead = pblockNew;
+        }
+
+        BlockProofPrecheck& precheck = mapBlockProofPrechecks[pindex->GetBlockHash()];
+        precheck.pblock = pblockRead;
+        precheck.pindex = pindex;
+        // The stake of a block is COINBASE_MATURITY blocks old, it was not created in the run
+        if (pblockRead->IsProofOfStake() && pblockRead->vtx.size() > 1 && pblockRead->vtx[1]->IsCoinStake())
+            precheck.fHaveCoinStake = pcoinsTip->GetCoin(pblockRead->vtx[1]->vin[0].prevout, precheck.coinStake);
+        vChecks.push_back(CBlockProofCheck(precheck));
+    }
+    if (vChecks.empty())
+        return;
+
+    CCheckQueueControl<CBlockProofCheck> control(&blockproofcheckqueue);
+    control.Add(vChecks);
+    control.Wait();
+    LogPrint(BCLog::BENCH, "- Precheck %u block proofs: %.2fms\n", (unsigned)vChecks.size(), (GetTimeMicros() - nTimeStart) * 0.001);
+}
+
 /**
  * Try to make some progress towards making pindexMostWork the active block.
  * pblock is either nullptr or a pointer to a CBlock corresponding to pindexMostWork.
@@ -3365,6 +3762,7 @@ static bool ActivateBestChainStep(CValidationState& state, const CChainParams& c
             pindexIter = pindexIter->pprev;
         }
         nHeight = nTargetHeight;
+        PrecheckBlockProofs(vpindexToConnect, chainparams, pblock);
 
         // Connect new blocks.
         for (CBlockIndex *pindexConnect : reverse_iterate(vpindexToConnect)) {
@@ -3508,6 +3906,28 @@ bool ActivateBestChain(CValidationState &state, const CChainParams& chainparams,
     return true;
 }
 
+bool ActivateSnapshotBlock(CBlockIndex* pindex, unsigned int nTx, uint64_t nChainTx) // silubium
+{
+    AssertLockHeld(cs_main);
+    pindex->nTx = nTx;
+    pindex->nChainTx = nChainTx;
+    pindex->RaiseValidity(BLOCK_VALID_SCRIPTS);
+    setDirtyBlockIndex.insert(pindex);
+
+    // The earlier blocks are never connected, so the chain goes straight to the snapshot block
+    chainActive.SetTip(pindex);
+    setBlockIndexCandidates.insert(pindex);
+    PruneBlockIndexCandidates();
+    mempool.clear();
+    nStateSnapshotHeight = pindex->nHeight;
+
+    // Like a pruned node, the node has no data for the blocks below the snapshot
+    fHavePruned = true;
+    if (!pblocktree->WriteFlag("prunedblockfiles", true) || !pblocktree->WriteStateSnapshotBlock(pindex->GetBlockHash(), nChainTx))
+        return false;
+    CValidationState state;
+    return FlushStateToDisk(Params(), state, FLUSH_STATE_ALWAYS);
+}
 
 bool PreciousBlock(CValidationState& state, const CChainParams& params, CBlockIndex *pindex)
 {
@@ -4225,7 +4645,7 @@ static bool ContextualCheckBlock(const CBlock& block, CValidationState& state, c
     return true;
 }
 
-static bool UpdateHashProof(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, CBlockIndex* pindex, CCoinsViewCache& view)
+static bool UpdateHashProof(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, CBlockIndex* pindex, CCoinsViewCache& view, const BlockProofPrecheck* pprecheck)
 {
     int nHeight = pindex->nHeight;
     uint256 hash = block.GetHash();
@@ -4246,10 +4666,21 @@ static bool UpdateHashProof(const CBlock& block, CValidationState& state, const
     // Verify hash target and signature of coinstake tx
     if (block.IsProofOfStake())
     {
-        uint256 targetProofOfStake;
-        if (!CheckProofOfStake(pindex->pprev, state, *block.vtx[1], block.nBits, block.nTime, hashProof, targetProofOfStake, view))
+        // A kernel checked ahead holds if the stake coin is still the one it was checked with
+        Coin coinStake;
+        if (pprecheck && pprecheck->fStake && view.GetCoin(block.vtx[1]->vin[0].prevout, coinStake) &&
+            coinStake.nHeight == pprecheck->coinStake.nHeight && coinStake.fCoinBase == pprecheck->coinStake.fCoinBase &&
+            coinStake.fCoinStake == pprecheck->coinStake.fCoinStake && coinStake.out == pprecheck->coinStake.out)
+        {
+            hashProof = pprecheck->hashProof;
+        }
+        else
         {
-            return error("UpdateHashProof() : check proof-of-stake failed for block %s", hash.ToString());
+            uint256 targetProofOfStake;
+            if (!CheckProofOfStake(pindex->pprev, state, *block.vtx[1], block.nBits, block.nTime, hashProof, targetProofOfStake, view))
+            {
+                return error("UpdateHashProof() : check proof-of-stake failed for block %s", hash.ToString());
+            }
         }
     }
     
@@ -4778,6 +5209,10 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
 
     boost::this_thread::interruption_point();
 
+    uint256 hashSnapshotBlock; // silubium
+    uint64_t nSnapshotChainTx = 0;
+    pblocktree->ReadStateSnapshotBlock(hashSnapshotBlock, nSnapshotChainTx);
+
     // Calculate nChainWork
     std::vector<std::pair<int, CBlockIndex*> > vSortedByHeight;
     vSortedByHeight.reserve(mapBlockIndex.size());
@@ -4795,7 +5230,11 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
         // We can link the chain of blocks for which we've received transactions at some point.
         // Pruned nodes may have deleted the block.
         if (pindex->nTx > 0) {
-            if (pindex->pprev) {
+            if (pindex->GetBlockHash() == hashSnapshotBlock) { // silubium
+                // The chain state was loaded from a snapshot of this block, whose ancestors are headers only
+                pindex->nChainTx = nSnapshotChainTx;
+                nStateSnapshotHeight = pindex->nHeight;
+            } else if (pindex->pprev) {
                 if (pindex->pprev->nChainTx) {
                     pindex->nChainTx = pindex->pprev->nChainTx + pindex->nTx;
                 } else {
@@ -4860,6 +5299,13 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     if (fHavePruned)
         LogPrintf("LoadBlockIndexDB(): Block files have previously been pruned\n");
 
+    // Check whether the state pruner has deleted the contract state of older blocks // silubium
+    int nPrunedHeight = -1;
+    pblocktree->ReadStatePrunedHeight(nPrunedHeight);
+    nStatePrunedHeight = nPrunedHeight;
+    if (nStatePrunedHeight >= 0)
+        LogPrintf("LoadBlockIndexDB(): Contract state has previously been pruned up to height %d\n", nStatePrunedHeight);
+
     // Check whether we need to continue reindexing
     bool fReindexing = false;
     pblocktree->ReadReindexing(fReindexing);
@@ -4905,6 +5351,39 @@ bool LoadChainTip(const CChainParams& chainparams)
     return true;
 }
 
+bool BuildEventIndex()
+{
+    LogPrintf("%s: building event index from the height index...\n", __func__);
+    peventindex->wipe();
+
+    // Height index entries come ordered by height, so a block is complete once the next one starts
+    unsigned int height = 0;
+    EventIndexBlock eventBlock;
+    bool fOk = pblocktree->ForEachHeightIndex([&](const CHeightTxIndexKey& key, const std::vector<uint256>& hashes) {
+        if (key.height != height && !eventBlock.contracts.empty()) {
+            if (!peventindex->writeBlock(height, eventBlock))
+                return false;
+            eventBlock = EventIndexBlock();
+        }
+        height = key.height;
+        eventBlock.add(key.address, hashes);
+        for (const uint256& hash : hashes) {
+            for (const TransactionReceiptInfo& info : pstorageresult->getResult(uintToh256(hash)))
+                eventBlock.bloom |= dev::eth::bloom(info.logs);
+        }
+        return true;
+    });
+    if (fOk && !eventBlock.contracts.empty())
+        fOk = peventindex->writeBlock(height, eventBlock);
+    if (fOk && chainActive.Height() >= 0)
+        fOk = peventindex->writeBlock(chainActive.Height(), EventIndexBlock());
+    if (!fOk)
+        return error("%s: failed to build the event index", __func__);
+
+    peventindex->setBuilt();
+    return true;
+}
+
 CVerifyDB::CVerifyDB()
 {
     uiInterface.ShowProgress(_("Verifying blocks..."), 0);
@@ -4957,6 +5436,16 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
             LogPrintf("VerifyDB(): block verification stopping at height %d (pruning, no data)\n", pindex->nHeight);
             break;
         }
+        if (pindex->nHeight <= nStateSnapshotHeight) { // silubium
+            // The chain state was loaded from a snapshot of this block, the blocks below have headers only
+            LogPrintf("VerifyDB(): block verification stopping at height %d (state snapshot)\n", pindex->nHeight);
+            break;
+        }
+        if (IsStatePruned(pindex->pprev->nHeight)) { // silubium
+            // The contract state the block would be disconnected to may have been deleted by the state pruner
+            LogPrintf("VerifyDB(): block verification stopping at height %d (contract state pruned)\n", pindex->nHeight);
+            break;
+        }
 
         ///////////////////////////////////////////////////////////////////// // silubium
         uint32_t sizeBlockDGP = silubiumDGP.getBlockSize(pindex->nHeight);
@@ -5129,7 +5618,8 @@ bool RewindBlockIndex(const CChainParams& params)
 
     // Note that during -reindex-chainstate we are called with an empty chainActive!
 
-    int nHeight = 1;
+    // The blocks up to a state snapshot have never been downloaded // silubium
+    int nHeight = nStateSnapshotHeight + 1;
     while (nHeight <= chainActive.Height()) {
         if (IsWitnessEnabled(chainActive[nHeight - 1], params.GetConsensus()) && !(chainActive[nHeight]->nStatus & BLOCK_OPT_WITNESS)) {
             break;
@@ -5244,6 +5734,7 @@ void UnloadBlockIndex()
     }
     mapBlockIndex.clear();
     fHavePruned = false;
+    nStatePrunedHeight = -1; // silubium
 }
 
 bool LoadBlockIndex(const CChainParams& chainparams)
@@ -5495,6 +5986,10 @@ void static CheckBlockIndex(const Consensus::Params& consensusParams)
     CBlockIndex* pindexFirstNotTransactionsValid = nullptr; // Oldest ancestor of pindex which does not have BLOCK_VALID_TRANSACTIONS (regardless of being valid or not).
     CBlockIndex* pindexFirstNotChainValid = nullptr; // Oldest ancestor of pindex which does not have BLOCK_VALID_CHAIN (regardless of being valid or not).
     CBlockIndex* pindexFirstNotScriptsValid = nullptr; // Oldest ancestor of pindex which does not have BLOCK_VALID_SCRIPTS (regardless of being valid or not).
+    // silubium: the chain state was loaded from a snapshot of this block, whose ancestors have headers only.
+    // Like the genesis block, it starts a chain of processed blocks, and the blocks below it are pruned.
+    CBlockIndex* pindexSnapshot = nStateSnapshotHeight > 0 ? chainActive[nStateSnapshotHeight] : nullptr;
+    CBlockIndex* pindexSnapshotFirst[4] = {nullptr, nullptr, nullptr, nullptr}; // The oldest ancestors above, for the blocks beside the snapshot block.
     while (pindex != nullptr) {
         nNodes++;
         if (pindexFirstInvalid == nullptr && pindex->nStatus & BLOCK_FAILED_VALID) pindexFirstInvalid = pindex;
@@ -5504,6 +5999,13 @@ void static CheckBlockIndex(const Consensus::Params& consensusParams)
         if (pindex->pprev != nullptr && pindexFirstNotTransactionsValid == nullptr && (pindex->nStatus & BLOCK_VALID_MASK) < BLOCK_VALID_TRANSACTIONS) pindexFirstNotTransactionsValid = pindex;
         if (pindex->pprev != nullptr && pindexFirstNotChainValid == nullptr && (pindex->nStatus & BLOCK_VALID_MASK) < BLOCK_VALID_CHAIN) pindexFirstNotChainValid = pindex;
         if (pindex->pprev != nullptr && pindexFirstNotScriptsValid == nullptr && (pindex->nStatus & BLOCK_VALID_MASK) < BLOCK_VALID_SCRIPTS) pindexFirstNotScriptsValid = pindex;
+        if (pindex == pindexSnapshot) { // silubium
+            pindexSnapshotFirst[0] = pindexFirstNeverProcessed;
+            pindexSnapshotFirst[1] = pindexFirstNotTransactionsValid;
+            pindexSnapshotFirst[2] = pindexFirstNotChainValid;
+            pindexSnapshotFirst[3] = pindexFirstNotScriptsValid;
+            pindexFirstNeverProcessed = pindexFirstNotTransactionsValid = pindexFirstNotChainValid = pindexFirstNotScriptsValid = nullptr;
+        }
 
         // Begin: actual consistency checks.
         if (pindex->pprev == nullptr) {
@@ -5611,6 +6113,12 @@ void static CheckBlockIndex(const Consensus::Params& consensusParams)
             if (pindex == pindexFirstNotTransactionsValid) pindexFirstNotTransactionsValid = nullptr;
             if (pindex == pindexFirstNotChainValid) pindexFirstNotChainValid = nullptr;
             if (pindex == pindexFirstNotScriptsValid) pindexFirstNotScriptsValid = nullptr;
+            if (pindex == pindexSnapshot) { // silubium
+                pindexFirstNeverProcessed = pindexSnapshotFirst[0];
+                pindexFirstNotTransactionsValid = pindexSnapshotFirst[1];
+                pindexFirstNotChainValid = pindexSnapshotFirst[2];
+                pindexFirstNotScriptsValid = pindexSnapshotFirst[3];
+            }
             // Find our parent.
             CBlockIndex* pindexPar = pindex->pprev;
             // Find which child we just visited.
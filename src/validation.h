@@ -40,6 +40,7 @@
 #include <libethashseal/GenesisInfo.h>
 #include <script/standard.h>
 #include <silubium/storageresults.h>
+#include <silubium/eventindex.h>
 
 
 extern std::unique_ptr<SilubiumState> globalState;
@@ -161,6 +162,16 @@ static const bool DEFAULT_PERMIT_BAREMULTISIG = true;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
 static const bool DEFAULT_TXINDEX = false;
 static const bool DEFAULT_LOGEVENTS = true;// false;
+/** Default for -parallelcontracts, speculative execution of the contract transactions of a block */
+static const bool DEFAULT_PARALLEL_CONTRACTS = false;
+/** Default for -parallelblockproofs, checking of the block signatures and stake kernels of the blocks to connect on -par threads */
+static const bool DEFAULT_PARALLEL_BLOCK_PROOFS = true;
+/** Default for -prunestate, number of recent blocks whose contract state is kept, 0 keeps all */
+static const unsigned int DEFAULT_PRUNE_STATE = 0;
+/** Default for -flatstorage, contract storage slots of the tip kept in a flat table next to the state trie */
+static const bool DEFAULT_FLAT_STORAGE = true;
+/** Default for -evmprofile, counting and sampling profiler of the EVM, also switched by the setevmprofile rpc call */
+static const bool DEFAULT_EVM_PROFILE = false;
 static const unsigned int DEFAULT_BANSCORE_THRESHOLD = 100;
 /** Default for -persistmempool */
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
@@ -211,6 +222,9 @@ extern bool fReindex;
 extern int nScriptCheckThreads;
 extern bool fTxIndex;
 extern bool fLogEvents;
+extern bool fParallelContracts;
+extern bool fParallelBlockProofs;
+extern unsigned int nPruneStateDepth;
 extern bool fIsBareMultisigStd;
 extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
@@ -314,6 +328,10 @@ bool LoadChainTip(const CChainParams& chainparams);
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the speculative contract execution thread */
+void ThreadContractCheck();
+/** Run an instance of the block signature and stake kernel checking thread */
+void ThreadBlockProofCheck();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Retrieve a transaction (from memory pool, or from disk, if possible) */
@@ -520,6 +538,7 @@ bool CheckIndexProof(const CBlockIndex& block, const Consensus::Params& consensu
 /** Context-independent validity checks */
 bool CheckBlock(const CBlock& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, bool fCheckMerkleRoot = true, bool fCheckSig=true);
 bool GetBlockPublicKey(const CBlock& block, std::vector<unsigned char>& vchPubKey);
+bool CheckBlockSignature(const CBlock& block);
 bool SignBlock(std::shared_ptr<CBlock> pblock, CWallet& wallet, const CAmount& nTotalFees, uint32_t nTime);
 bool CheckCanonicalBlockSignature(const std::shared_ptr<const CBlock> pblock);
 /** Check a block is completely valid from start to finish (only works on top of our current best block, with cs_main held) */
@@ -551,6 +570,9 @@ bool ReplayBlocks(const CChainParams& params, CCoinsView* view);
 /** Find the last common block between the parameter chain and a locator. */
 CBlockIndex* FindForkInGlobalIndex(const CChain& chain, const CBlockLocator& locator);
 
+/** Make @a pindex the tip after its coins and contract state were loaded from a snapshot, without connecting the blocks below it */
+bool ActivateSnapshotBlock(CBlockIndex* pindex, unsigned int nTx, uint64_t nChainTx);
+
 /** Mark a block as precious and reorganize. */
 bool PreciousBlock(CValidationState& state, const CChainParams& params, CBlockIndex *pindex);
 
@@ -574,6 +596,9 @@ extern CBlockTreeDB *pblocktree;
 
 extern StorageResults *pstorageresult;
 
+/** Fill the event index from the height index and the stored receipts */
+bool BuildEventIndex();
+
 /**
  * Return the spend height, which is one more than the inputs.GetBestBlock().
  * While checking, GetBestBlock() refers to the parent block. (protected by cs_main)
@@ -611,6 +636,37 @@ bool CheckReward(const CBlock& block, CValidationState& state, int nHeight, cons
 //////////////////////////////////////////////////////// silubium
 std::vector<ResultExecute> CallContract(const dev::Address& addrContract, std::vector<unsigned char> opcode, const dev::Address& sender = dev::Address(), uint64_t gasLimit=0);
 
+/** Contract state and block environment of the active tip, to execute read-only calls on without cs_main */
+struct ContractStateSnapshot {
+    std::unique_ptr<SilubiumState> state;
+    std::unique_ptr<dev::eth::SealEngineFace> sealEngine;
+    dev::eth::EnvInfo env; //!< environment of the next block, the author is set to the sender of each call
+    uint64_t blockGasLimit = 0;
+};
+
+/** Pin the contract state of the active tip into @a snapshot, requires cs_main */
+bool GetContractStateSnapshot(ContractStateSnapshot& snapshot);
+
+/** Copy @a from into @a to at the same roots, with caches of its own, so that both can be executed on concurrently */
+bool ForkContractStateSnapshot(const ContractStateSnapshot& from, ContractStateSnapshot& to);
+
+/** Execute a read-only call on @a snapshot, calls on the same snapshot must not run concurrently */
+std::vector<ResultExecute> CallContract(ContractStateSnapshot& snapshot, const dev::Address& addrContract, std::vector<unsigned char> opcode, const dev::Address& sender = dev::Address(), uint64_t gasLimit=0);
+
+/** One read-only call of a batch */
+struct ContractCall {
+    dev::Address address;
+    std::vector<unsigned char> data;
+    dev::Address sender;
+    uint64_t gasLimit = 0;
+};
+
+/**
+ * Execute @a calls on @a snapshot, split in consecutive ranges over up to @a nThreads threads which
+ * each work on a fork of the snapshot. Returns one result per call, in the order of the calls.
+ */
+std::vector<ResultExecute> CallContractBatch(ContractStateSnapshot& snapshot, const std::vector<ContractCall>& calls, unsigned int nThreads = 1);
+
 bool CheckSenderScript(const CCoinsViewCache& view, const CTransaction& tx);
 
 bool CheckMinGasPrice(std::vector<EthTransactionParams>& etps, const uint64_t& minGasPrice);
@@ -669,6 +725,39 @@ private:
 
 };
 
+/**
+ * Hashes of the last 256 blocks of the active chain as the EVM sees them, newest first.
+ * Kept in a ring that follows ConnectTip and DisconnectTip, so that all EVM environments
+ * built on the same tip share one copy instead of walking pprev for each of them.
+ */
+class CLastBlockHashes
+{
+public:
+    static const int SIZE = 256;
+
+    CLastBlockHashes();
+
+    /** pindexNew was connected on top of the previous tip */
+    void Connect(const CBlockIndex* pindexNew);
+
+    /** The previous tip was disconnected, pindexNew is its parent */
+    void Disconnect(const CBlockIndex* pindexNew);
+
+    /** The hashes ending at pindexTip, rebuilt from pindexTip if the ring follows another chain */
+    std::shared_ptr<const dev::eth::LastHashes> Get(const CBlockIndex* pindexTip);
+
+private:
+    void Reset(const CBlockIndex* pindexTip);
+
+    CCriticalSection cs;
+    std::array<dev::h256, SIZE> ring;
+    int head; //!< slot of the tip hash
+    const CBlockIndex* pindexLast;
+    std::shared_ptr<const dev::eth::LastHashes> lastHashes; //!< built on the first Get after a change
+};
+
+extern CLastBlockHashes lastBlockHashes;
+
 class ByteCodeExec {
 
 public:
@@ -677,12 +766,23 @@ public:
 
     bool performByteCode(dev::eth::Permanence type = dev::eth::Permanence::Committed);
 
+    /** Execute read-only on a snapshot of the state, in the environment of its tip */
+    bool performSnapshot(ContractStateSnapshot& snapshot);
+
+    /** Execute on a fork of the global state, recording what the transactions touch */
+    bool performSpeculative(SilubiumState& state, dev::eth::SealEngineFace const& sealEngine, SilubiumAccessSet& access, std::vector<SilubiumStateDiff>& diffs);
+
+    /** Apply the results of performSpeculative to the global state */
+    void applySpeculative(std::vector<ResultExecute> const& results, std::vector<SilubiumStateDiff> const& diffs);
+
     bool processingResults(ByteCodeExecResult& result);
 
     std::vector<ResultExecute>& getResult(){ return result; }
 
 private:
 
+    bool execute(SilubiumState& state, dev::eth::SealEngineFace const& sealEngine, dev::eth::Permanence type);
+
     dev::eth::EnvInfo BuildEVMEnvironment();
 
     dev::Address EthAddrFromScript(const CScript& scriptIn);
@@ -695,6 +795,72 @@ private:
 
     const uint64_t blockGasLimit;
 
+    const ContractStateSnapshot* snapshot = nullptr;
+
+};
+
+/** Contract transaction of a block executed ahead of ConnectBlock on a fork of the global state */
+struct SpeculativeContractTx {
+    std::vector<SilubiumTransaction> txs;
+    std::unique_ptr<SilubiumState> state;
+    std::unique_ptr<dev::eth::SealEngineFace> sealEngine;
+    SilubiumAccessSet access;
+    std::vector<SilubiumStateDiff> diffs;
+    std::vector<ResultExecute> results;
+    bool fOk = false;
+};
+
+/** Closure representing the speculative execution of one contract transaction */
+class CContractCheck
+{
+private:
+    const CBlock *pblock;
+    uint64_t blockGasLimit;
+    SpeculativeContractTx *pspec;
+
+public:
+    CContractCheck(): pblock(nullptr), blockGasLimit(0), pspec(nullptr) {}
+    CContractCheck(const CBlock& blockIn, uint64_t blockGasLimitIn, SpeculativeContractTx& specIn) :
+        pblock(&blockIn), blockGasLimit(blockGasLimitIn), pspec(&specIn) {}
+
+    // Failures are left in pspec->fOk for the transaction to be executed serially
+    bool operator()();
+
+    void swap(CContractCheck &check) {
+        std::swap(pblock, check.pblock);
+        std::swap(blockGasLimit, check.blockGasLimit);
+        std::swap(pspec, check.pspec);
+    }
+};
+
+/** Block signature and stake kernel of a block to connect, checked ahead of ConnectBlock */
+struct BlockProofPrecheck {
+    std::shared_ptr<const CBlock> pblock;
+    CBlockIndex* pindex = nullptr;
+    // Stake coin in pcoinsTip before the run of blocks, the kernel is checked against it
+    Coin coinStake;
+    bool fHaveCoinStake = false;
+    bool fSignature = false;
+    bool fStake = false;
+    uint256 hashProof;
+};
+
+/** Closure representing the checks of the block signature and stake kernel of one block */
+class CBlockProofCheck
+{
+private:
+    BlockProofPrecheck *pprecheck;
+
+public:
+    CBlockProofCheck(): pprecheck(nullptr) {}
+    explicit CBlockProofCheck(BlockProofPrecheck& precheckIn) : pprecheck(&precheckIn) {}
+
+    // Failures are left in the precheck for ConnectBlock to check again serially
+    bool operator()();
+
+    void swap(CBlockProofCheck &check) {
+        std::swap(pprecheck, check.pprecheck);
+    }
 };
 ////////////////////////////////////////////////////////
 
@@ -427,6 +427,7 @@ UniValue importprunedfunds(const JSONRPCRequest& request)
 
     if (pwallet->IsMine(wtx)) {
         pwallet->AddToWallet(wtx, false);
+        pwallet->MarkDirty();
         return NullUniValue;
     }
 
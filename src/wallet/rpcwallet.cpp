@@ -16,6 +16,8 @@
 #include "policy/fees.h"
 #include "policy/policy.h"
 #include "policy/rbf.h"
+#include "pos.h"
+#include "pow.h"
 #include "rpc/mining.h"
 #include "rpc/server.h"
 #include "script/sign.h"
@@ -3002,6 +3004,79 @@ UniValue  reservebalance(const JSONRPCRequest& request)
     return result;
 }
 
+UniValue liststakingcoins(const JSONRPCRequest& request)
+{
+    CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
+    if (!EnsureWalletIsAvailable(pwallet, request.fHelp)) {
+        return NullUniValue;
+    }
+
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            "liststakingcoins ( count )\n"
+            "\nReturns the coins the staker searches for a kernel, soonest expected stake first.\n"
+            "\nArguments:\n"
+            "1. count          (numeric, optional, default=100) The number of coins to return, 0 for all\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"txid\" : \"transactionid\",     (string) The transaction id\n"
+            "    \"vout\" : n,                     (numeric) The vout value\n"
+            "    \"amount\" : x.xxx,               (numeric) The amount of the coin in " + CURRENCY_UNIT + "\n"
+            "    \"expectedtime\" : n              (numeric) The expected time in seconds before the coin stakes at the current difficulty\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("liststakingcoins", "")
+            + HelpExampleCli("liststakingcoins", "10")
+            + HelpExampleRpc("liststakingcoins", "10")
+        );
+
+    size_t nCount = 100;
+    if (!request.params[0].isNull()) {
+        int count = request.params[0].get_int();
+        if (count < 0)
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+        nCount = count;
+    }
+
+    LOCK(cs_main);
+
+    std::vector<CStakeKernelCoin> vKernelCoins;
+    pwallet->GetStakeKernelCoins(vKernelCoins);
+
+    CBlockIndex* pindexPrev = chainActive.Tip();
+    CBlockHeader header;
+    header.nTime = GetAdjustedTime();
+    unsigned int nBits = GetNextWorkRequired(pindexPrev, &header, Params().GetConsensus(), true);
+
+    // The weighted targets of the kernel search give the expected time of every coin
+    CStakeKernelBatch batch(pindexPrev, nBits, vKernelCoins);
+    std::vector<std::pair<double, size_t> > vExpected;
+    for (size_t i = 0; i < vKernelCoins.size(); i++) {
+        double nExpectedTime = batch.ExpectedTime(i);
+        if (nExpectedTime > 0)
+            vExpected.push_back(std::make_pair(nExpectedTime, i));
+    }
+    std::sort(vExpected.begin(), vExpected.end());
+    if (nCount && vExpected.size() > nCount)
+        vExpected.resize(nCount);
+
+    UniValue ret(UniValue::VARR);
+    for (const std::pair<double, size_t>& item : vExpected) {
+        const CStakeKernelCoin& coin = vKernelCoins[item.second];
+        UniValue o(UniValue::VOBJ);
+        o.push_back(Pair("txid", coin.prevout.hash.GetHex()));
+        o.push_back(Pair("vout", (int)coin.prevout.n));
+        o.push_back(Pair("amount", ValueFromAmount(coin.amount)));
+        o.push_back(Pair("expectedtime", (int64_t)std::min(item.first, 9e18)));
+        ret.push_back(o);
+    }
+
+    return ret;
+}
+
 UniValue lockunspent(const JSONRPCRequest& request)
 {
     CWallet * const pwallet = GetWalletForJSONRPCRequest(request);
@@ -3870,6 +3945,7 @@ static const CRPCCommand commands[] =
     { "wallet",             "listaccounts",             &listaccounts,             false,  {"minconf","include_watchonly"} },
     { "wallet",             "listaddressgroupings",     &listaddressgroupings,     false,  {} },
     { "wallet",             "listlockunspent",          &listlockunspent,          false,  {} },
+    { "wallet",             "liststakingcoins",         &liststakingcoins,         false,  {"count"} },
     { "wallet",             "listreceivedbyaccount",    &listreceivedbyaccount,    false,  {"minconf","include_empty","include_watchonly"} },
     { "wallet",             "listreceivedbyaddress",    &listreceivedbyaddress,    false,  {"minconf","include_empty","include_watchonly"} },
     { "wallet",             "listsinceblock",           &listsinceblock,           false,  {"blockhash","target_confirmations","include_watchonly","include_removed"} },
@@ -693,4 +693,45 @@ BOOST_FIXTURE_TEST_CASE(ListCoins, ListCoinsTestingSetup)
     BOOST_CHECK_EQUAL(list.begin()->second.size(), 2);
 }
 
+BOOST_AUTO_TEST_CASE(StakeableCoins)
+{
+    CStakeableCoins coins;
+    COutPoint first(uint256S("01"), 0), second(uint256S("02"), 1), third(uint256S("03"), 0);
+    coins.Add(first, CStakeableCoins::Coin{10, 509, ISMINE_SPENDABLE, 1500000000, 5 * COIN});
+    coins.Add(second, CStakeableCoins::Coin{5, 505, ISMINE_WATCH_SOLVABLE});
+    coins.Add(third, CStakeableCoins::Coin{20, 519, ISMINE_SPENDABLE});
+    BOOST_CHECK_EQUAL(coins.Size(), 3);
+
+    // Only the coins mature at the tip height, in maturity order
+    std::vector<std::pair<COutPoint, CStakeableCoins::Coin>> mature;
+    coins.GetMature(504, mature);
+    BOOST_CHECK(mature.empty());
+    coins.GetMature(509, mature);
+    BOOST_CHECK_EQUAL(mature.size(), 2);
+    BOOST_CHECK(mature[0].first == second && mature[1].first == first);
+    BOOST_CHECK_EQUAL(mature[1].second.nHeight, 10);
+    BOOST_CHECK_EQUAL(mature[1].second.nBlockTime, 1500000000);
+
+    // The kernel data of a coin is read without the coins database
+    const CStakeableCoins::Coin* coin = coins.Get(first);
+    BOOST_CHECK(coin && coin->nValue == 5 * COIN && coin->nBlockTime == 1500000000);
+    BOOST_CHECK(!coins.Get(COutPoint(uint256S("04"), 0)));
+
+    // Adding a coin again moves it, removing it drops it from both orders
+    coins.Add(third, CStakeableCoins::Coin{1, 500, ISMINE_SPENDABLE});
+    coins.Remove(second);
+    coins.Remove(COutPoint(uint256S("04"), 0));
+    BOOST_CHECK(!coins.Contains(second) && coins.Contains(third));
+    BOOST_CHECK(!coins.Get(second) && coins.Get(third)->nHeight == 1);
+    mature.clear();
+    coins.GetMature(509, mature);
+    BOOST_CHECK_EQUAL(mature.size(), 2);
+    BOOST_CHECK(mature[0].first == third && mature[1].first == first);
+
+    coins.Clear();
+    mature.clear();
+    coins.GetMature(1000, mature);
+    BOOST_CHECK(mature.empty() && coins.Size() == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1107,6 +1107,8 @@ void CWallet::MarkDirty()
         LOCK(cs_wallet);
         for (std::pair<const uint256, CWalletTx>& item : mapWallet)
             item.second.MarkDirty();
+        // new keys and scripts can make more outputs ours
+        fStakeableCoinsReady = false;
     }
 }
 
@@ -1490,6 +1492,7 @@ void CWallet::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const
     for (size_t i = 0; i < pblock->vtx.size(); i++) {
         SyncTransaction(pblock->vtx[i], pindex, i);
     }
+    UpdateStakeableCoins(*pblock, pindex, true);
 }
 
 void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) {
@@ -1499,6 +1502,7 @@ void CWallet::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) {
         int posInBlock = ptx->IsCoinStake() ? -1 : 0;
         SyncTransaction(ptx, nullptr, posInBlock);
     }
+    UpdateStakeableCoins(*pblock, nullptr, false);
 }
 
 
@@ -1883,6 +1887,7 @@ CBlockIndex* CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, bool f
         }
         ShowProgress(_("Rescanning..."), 100); // hide progress dialog in GUI
 
+        fStakeableCoinsReady = false;
         fScanningWallet = false;
     }
     return ret;
@@ -2479,40 +2484,201 @@ void CWallet::AvailableCoins(std::vector<COutput> &vCoins, bool fOnlySafe, const
     }
 }
 
+void CStakeableCoins::Add(const COutPoint& outpoint, const Coin& coin)
+{
+    Remove(outpoint);
+    mapCoins.insert(std::make_pair(outpoint, coin));
+    setByMaturity.insert(std::make_pair(coin.nMatureHeight, outpoint));
+}
+
+void CStakeableCoins::Remove(const COutPoint& outpoint)
+{
+    std::map<COutPoint, Coin>::iterator it = mapCoins.find(outpoint);
+    if (it == mapCoins.end())
+        return;
+    setByMaturity.erase(std::make_pair(it->second.nMatureHeight, outpoint));
+    mapCoins.erase(it);
+}
+
+void CStakeableCoins::Clear()
+{
+    mapCoins.clear();
+    setByMaturity.clear();
+}
+
+const CStakeableCoins::Coin* CStakeableCoins::Get(const COutPoint& outpoint) const
+{
+    std::map<COutPoint, Coin>::const_iterator it = mapCoins.find(outpoint);
+    return it != mapCoins.end() ? &it->second : nullptr;
+}
+
+void CStakeableCoins::GetMature(int nTipHeight, std::vector<std::pair<COutPoint, Coin>>& vCoins) const
+{
+    for (const std::pair<int, COutPoint>& item : setByMaturity) {
+        if (item.first > nTipHeight)
+            break;
+        vCoins.push_back(*mapCoins.find(item.second));
+    }
+}
+
+bool CWallet::IsStakeableOutput(const CTxOut& txout, isminetype& mine) const
+{
+    mine = IsMine(txout);
+    return mine != ISMINE_NO && txout.nValue > 0 &&
+           !txout.scriptPubKey.HasOpCall() && !txout.scriptPubKey.HasOpCreate();
+}
+
+void CWallet::AddStakeableCoins(const CTransaction& tx, const CBlockIndex* pindex) const
+{
+    // A coin stakes from COINBASE_MATURITY confirmations, coinbase and coinstake outputs from one more
+    int nMatureHeight = pindex->nHeight + COINBASE_MATURITY - 1;
+    if (tx.IsCoinBase() || tx.IsCoinStake())
+        nMatureHeight++;
+
+    for (unsigned int i = 0; i < tx.vout.size(); i++) {
+        CStakeableCoins::Coin coin;
+        if (IsStakeableOutput(tx.vout[i], coin.mine)) {
+            coin.nHeight = pindex->nHeight;
+            coin.nMatureHeight = nMatureHeight;
+            coin.nBlockTime = pindex->nTime;
+            coin.nValue = tx.vout[i].nValue;
+            stakeableCoins.Add(COutPoint(tx.GetHash(), i), coin);
+        }
+    }
+}
+
+void CWallet::LoadStakeableCoins() const
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    stakeableCoins.Clear();
+    nStakeableCoinsHeight = chainActive.Height();
+    for (const std::pair<const uint256, CWalletTx>& item : mapWallet) {
+        if (item.second.GetDepthInMainChain() < 1)
+            continue;
+        AddStakeableCoins(*item.second.tx, mapBlockIndex[item.second.hashBlock]);
+    }
+
+    // Drop the outputs spent in the chain, the ones spent in the mempool are checked on use
+    for (const std::pair<const COutPoint, uint256>& spend : mapTxSpends) {
+        std::map<uint256, CWalletTx>::const_iterator mit = mapWallet.find(spend.second);
+        if (mit != mapWallet.end() && mit->second.GetDepthInMainChain() > 0)
+            stakeableCoins.Remove(spend.first);
+    }
+    fStakeableCoinsReady = true;
+}
+
+void CWallet::UpdateStakeableCoins(const CBlock& block, const CBlockIndex* pindex, bool fConnect)
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    if (!fStakeableCoinsReady)
+        return;
+    nStakeableCoinsHeight = chainActive.Height();
+
+    if (fConnect) {
+        for (const CTransactionRef& ptx : block.vtx) {
+            if (mapWallet.count(ptx->GetHash()))
+                AddStakeableCoins(*ptx, pindex);
+        }
+        for (const CTransactionRef& ptx : block.vtx) {
+            for (const CTxIn& txin : ptx->vin)
+                stakeableCoins.Remove(txin.prevout);
+        }
+        return;
+    }
+
+    for (const CTransactionRef& ptx : block.vtx) {
+        for (unsigned int i = 0; i < ptx->vout.size(); i++)
+            stakeableCoins.Remove(COutPoint(ptx->GetHash(), i));
+    }
+    // The outputs the block spent are unspent again if their transaction is still confirmed
+    for (const CTransactionRef& ptx : block.vtx) {
+        if (ptx->IsCoinBase())
+            continue;
+        for (const CTxIn& txin : ptx->vin) {
+            std::map<uint256, CWalletTx>::const_iterator mit = mapWallet.find(txin.prevout.hash);
+            if (mit == mapWallet.end() || txin.prevout.n >= mit->second.tx->vout.size())
+                continue;
+            if (mit->second.GetDepthInMainChain() < 1)
+                continue;
+
+            const CTransaction& prevTx = *mit->second.tx;
+            const CBlockIndex* pindexFrom = mapBlockIndex[mit->second.hashBlock];
+            CStakeableCoins::Coin coin;
+            if (IsStakeableOutput(prevTx.vout[txin.prevout.n], coin.mine)) {
+                coin.nHeight = pindexFrom->nHeight;
+                coin.nMatureHeight = coin.nHeight + COINBASE_MATURITY - 1;
+                if (prevTx.IsCoinBase() || prevTx.IsCoinStake())
+                    coin.nMatureHeight++;
+                coin.nBlockTime = pindexFrom->nTime;
+                coin.nValue = prevTx.vout[txin.prevout.n].nValue;
+                stakeableCoins.Add(txin.prevout, coin);
+            }
+        }
+    }
+}
+
 void CWallet::AvailableCoinsForStaking(std::vector<COutput>& vCoins) const
 {
     vCoins.clear();
 
+    bool fReady;
     {
+        LOCK(cs_wallet);
+        fReady = fStakeableCoinsReady;
+    }
+    if (!fReady) {
         LOCK2(cs_main, cs_wallet);
-        for (std::map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
-        {
-            const uint256& wtxid = it->first;
-            const CWalletTx* pcoin = &(*it).second;
-            int nDepth = pcoin->GetDepthInMainChain();
-
-            if (nDepth < 1)
-                continue;
+        if (!fStakeableCoinsReady)
+            LoadStakeableCoins();
+    }
 
-            if (nDepth < COINBASE_MATURITY)
+    // The index only needs cs_wallet, cs_main is taken for the coins a wallet transaction spends outside the chain
+    std::vector<std::pair<COutPoint, CStakeableCoins::Coin>> vMature;
+    std::vector<COutPoint> vPending;
+    {
+        LOCK(cs_wallet);
+        stakeableCoins.GetMature(nStakeableCoinsHeight, vMature);
+        for (const std::pair<COutPoint, CStakeableCoins::Coin>& item : vMature) {
+            const COutPoint& prevout = item.first;
+            const CStakeableCoins::Coin& coin = item.second;
+            std::map<uint256, CWalletTx>::const_iterator it = mapWallet.find(prevout.hash);
+            if (it == mapWallet.end() || IsLockedCoin(prevout.hash, prevout.n))
                 continue;
-
-            if (pcoin->GetBlocksToMaturity() > 0)
+            if (mapTxSpends.count(prevout)) {
+                vPending.push_back(prevout);
                 continue;
-
-            for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
-                isminetype mine = IsMine(pcoin->tx->vout[i]);
-                if (!(IsSpent(wtxid, i)) && mine != ISMINE_NO &&
-                    !IsLockedCoin((*it).first, i) && (pcoin->tx->vout[i].nValue > 0) &&
-                    !pcoin->tx->vout[i].scriptPubKey.HasOpCall() && !pcoin->tx->vout[i].scriptPubKey.HasOpCreate())
-                        vCoins.push_back(COutput(pcoin, i, nDepth,
-                                                 ((mine & ISMINE_SPENDABLE) != ISMINE_NO) ||
-                                                 (mine & ISMINE_WATCH_SOLVABLE) != ISMINE_NO,
-                                                 (mine & (ISMINE_SPENDABLE | ISMINE_WATCH_SOLVABLE)) != ISMINE_NO,
-                                                 pcoin->IsTrusted()));
             }
+            vCoins.push_back(COutput(&it->second, prevout.n, nStakeableCoinsHeight - coin.nHeight + 1,
+                                     ((coin.mine & ISMINE_SPENDABLE) != ISMINE_NO) ||
+                                     (coin.mine & ISMINE_WATCH_SOLVABLE) != ISMINE_NO,
+                                     (coin.mine & (ISMINE_SPENDABLE | ISMINE_WATCH_SOLVABLE)) != ISMINE_NO,
+                                     true));
         }
     }
+
+    if (vPending.empty())
+        return;
+
+    LOCK2(cs_main, cs_wallet);
+    for (const COutPoint& prevout : vPending) {
+        std::map<uint256, CWalletTx>::const_iterator it = mapWallet.find(prevout.hash);
+        if (it == mapWallet.end() || !stakeableCoins.Contains(prevout) || IsSpent(prevout.hash, prevout.n))
+            continue;
+        const CWalletTx* pcoin = &it->second;
+        int nDepth = pcoin->GetDepthInMainChain();
+        if (nDepth < COINBASE_MATURITY || pcoin->GetBlocksToMaturity() > 0)
+            continue;
+        isminetype mine = IsMine(pcoin->tx->vout[prevout.n]);
+        vCoins.push_back(COutput(pcoin, prevout.n, nDepth,
+                                 ((mine & ISMINE_SPENDABLE) != ISMINE_NO) ||
+                                 (mine & ISMINE_WATCH_SOLVABLE) != ISMINE_NO,
+                                 (mine & (ISMINE_SPENDABLE | ISMINE_WATCH_SOLVABLE)) != ISMINE_NO,
+                                 pcoin->IsTrusted()));
+    }
 }
 
 bool CWallet::HaveAvailableCoinsForStaking() const
@@ -3353,6 +3519,79 @@ bool CWallet::CreateTransaction(const std::vector<CRecipient>& vecSend, CWalletT
     return true;
 }
 
+void CWallet::GetStakeKernelCoins(const std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, const CBlockIndex* pindexPrev, std::vector<CStakeKernelCoin>& vKernelCoins) const
+{
+    if(!gArgs.GetBoolArg("-stakecache", DEFAULT_STAKE_CACHE)){
+        // Without the index data every coin is read from the coins database
+        std::map<COutPoint, CStakeCache> cache;
+        LOCK(cs_main);
+        for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
+        {
+            boost::this_thread::interruption_point();
+            COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
+            CacheKernel(cache, prevoutStake, const_cast<CBlockIndex*>(pindexPrev), *pcoinsTip); //this will do a 2 disk loads per op
+            auto it = cache.find(prevoutStake);
+            if(it != cache.end())
+                vKernelCoins.push_back(CStakeKernelCoin(prevoutStake, it->second));
+        }
+        return;
+    }
+
+    // Coins disconnected since they were selected are no longer in the index and are skipped
+    LOCK(cs_wallet);
+    for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
+    {
+        COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
+        const CStakeableCoins::Coin* coin = stakeableCoins.Get(prevoutStake);
+        if(!coin || pindexPrev->nHeight + 1 - coin->nHeight < COINBASE_MATURITY)
+            continue;
+        vKernelCoins.push_back(CStakeKernelCoin(prevoutStake, CStakeCache(coin->nBlockTime, coin->nValue)));
+    }
+}
+
+std::vector<uint32_t> CWallet::FindStakeTimes(unsigned int nBits, uint32_t nTimeBegin, uint32_t nTimeEnd)
+{
+    std::vector<uint32_t> vTimes;
+    CBlockIndex* pindexPrev = pindexBestHeader;
+
+    CAmount nBalance = GetBalance();
+    if (nBalance <= nReserveBalance)
+        return vTimes;
+
+    std::set<std::pair<const CWalletTx*,unsigned int> > setCoins;
+    CAmount nValueIn = 0;
+    CAmount nTargetValue = nBalance - nReserveBalance;
+    if (!SelectCoinsForStaking(nTargetValue, setCoins, nValueIn) || setCoins.empty())
+        return vTimes;
+
+    std::vector<CStakeKernelCoin> vKernelCoins;
+    GetStakeKernelCoins(setCoins, pindexPrev, vKernelCoins);
+
+    std::vector<std::pair<size_t, uint32_t> > vHits;
+    CStakeKernelBatch(pindexPrev, nBits, vKernelCoins).Search(nTimeBegin, nTimeEnd, vHits);
+    for (const std::pair<size_t, uint32_t>& hit : vHits) {
+        if (vTimes.empty() || vTimes.back() != hit.second)
+            vTimes.push_back(hit.second);
+    }
+    return vTimes;
+}
+
+void CWallet::GetStakeKernelCoins(std::vector<CStakeKernelCoin>& vKernelCoins) const
+{
+    std::set<std::pair<const CWalletTx*,unsigned int> > setCoins;
+    CAmount nValueIn = 0;
+    CAmount nTargetValue = GetBalance() - nReserveBalance;
+    if (nTargetValue <= 0 || !SelectCoinsForStaking(nTargetValue, setCoins, nValueIn))
+        return;
+
+    const CBlockIndex* pindexTip;
+    {
+        LOCK(cs_main);
+        pindexTip = chainActive.Tip();
+    }
+    GetStakeKernelCoins(setCoins, pindexTip, vKernelCoins);
+}
+
 uint64_t CWallet::GetStakeWeight() const
 {
     // Choose coins to use
@@ -3419,21 +3658,16 @@ bool CWallet::CreateCoinStake(const CKeyStore& keystore, unsigned int nBits, con
     if (setCoins.empty())
         return false;
 
-    static std::map<COutPoint, CStakeCache> stakeCache;
-    if(stakeCache.size() > setCoins.size() + 100){
-        //Determining if the cache is still valid is harder than just clearing it when it gets too big, so instead just clear it
-        //when it has more than 100 entries more than the actual setCoins.
-        stakeCache.clear();
-    }
-    if(gArgs.GetBoolArg("-stakecache", DEFAULT_STAKE_CACHE)) {
+    std::vector<CStakeKernelCoin> vKernelCoins;
+    GetStakeKernelCoins(setCoins, pindexPrev, vKernelCoins);
+
+    // Hash all the kernels at once, only the hits are checked in full
+    std::vector<std::pair<size_t, uint32_t> > vHits;
+    CStakeKernelBatch(pindexPrev, nBits, vKernelCoins).Search(nTimeBlock, nTimeBlock + 1, vHits);
+    std::set<COutPoint> setKernelHits;
+    for (const std::pair<size_t, uint32_t>& hit : vHits)
+        setKernelHits.insert(vKernelCoins[hit.first].prevout);
 
-        for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
-        {
-            boost::this_thread::interruption_point();
-            COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
-            CacheKernel(stakeCache, prevoutStake, pindexPrev, *pcoinsTip); //this will do a 2 disk loads per op
-        }
-    }
     int64_t nCredit = 0;
     CScript scriptPubKeyKernel;
     for(const std::pair<const CWalletTx*,unsigned int> &pcoin : setCoins)
@@ -3443,7 +3677,8 @@ bool CWallet::CreateCoinStake(const CKeyStore& keystore, unsigned int nBits, con
         // Search backward in time from the given txNew timestamp
         // Search nSearchInterval seconds back up to nMaxStakeSearchInterval
         COutPoint prevoutStake = COutPoint(pcoin.first->GetHash(), pcoin.second);
-        if (CheckKernel(pindexPrev, nBits, nTimeBlock, prevoutStake, *pcoinsTip, stakeCache))
+        // A hit is checked again against the coins database, in case the index is behind a reorg
+        if (setKernelHits.count(prevoutStake) && CheckKernel(pindexPrev, nBits, nTimeBlock, prevoutStake, *pcoinsTip))
         {
             // Found a kernel
             LogPrint(BCLog::COINSTAKE, "CreateCoinStake : kernel found\n");
@@ -4631,7 +4866,8 @@ std::string CWallet::GetWalletHelpString(bool showDebug)
     strUsage += HelpMessageOpt("-zapwallettxes=<mode>", _("Delete all wallet transactions and only recover those parts of the blockchain through -rescan on startup") +
                                " " + _("(1 = keep tx meta data e.g. account owner and payment request information, 2 = drop tx meta data)"));
     strUsage += HelpMessageOpt("-staking=<true/false>", _("Enables or disables staking (enabled by default)"));
-    strUsage += HelpMessageOpt("-stakecache=<true/false>", _("Enables or disables the staking cache; significantly improves staking performance, but can use a lot of memory (enabled by default)"));
+    strUsage += HelpMessageOpt("-stakecache=<true/false>", _("Enables or disables the staking cache; keeps the kernel data of the staking coins in the wallet rather than reading it from the coins database (enabled by default)"));
+    strUsage += HelpMessageOpt("-stakertemplate=<true/false>", _("Keeps a block filled with the mempool transactions ready for the staker, so a found stake is published without assembling the block; it is rebuilt on each new tip, and follows the mempool in between (enabled by default)"));
     strUsage += HelpMessageOpt("-rpcmaxgasprice", strprintf(_("The max value (in satoshis) for gas price allowed through RPC (default: %u)"), MAX_RPC_GAS_PRICE));
 
     if (showDebug)
@@ -97,6 +97,7 @@ class CWalletTx;
 class CTokenTx;
 class CContractBookData;
 struct FeeCalculation;
+struct CStakeKernelCoin;
 enum class FeeEstimateMode;
 
 /** (client) version numbers for particular wallet features */
@@ -669,6 +670,41 @@ private:
 };
 
 
+/**
+ * Stakeable outputs of a wallet: confirmed, not spent in the active chain, with a positive
+ * value and no contract opcode. They are ordered by the height of the tip from which they
+ * are mature enough to stake, so the staker reads the mature ones without walking mapWallet.
+ * Each output keeps the kernel data of its block, so the kernel search never reads the coins
+ * database; the outputs of a disconnected block are dropped and get the data of the block
+ * that confirms them again.
+ */
+class CStakeableCoins
+{
+public:
+    struct Coin
+    {
+        int nHeight;            //! height of the block of the output
+        int nMatureHeight;      //! first tip height at which it can stake
+        isminetype mine;
+        uint32_t nBlockTime;    //! time of the block of the output, the blockFrom time of the kernel
+        CAmount nValue;
+    };
+
+    void Add(const COutPoint& outpoint, const Coin& coin);
+    void Remove(const COutPoint& outpoint);
+    void Clear();
+
+    /** Append the outputs mature at the tip height nTipHeight */
+    void GetMature(int nTipHeight, std::vector<std::pair<COutPoint, Coin>>& vCoins) const;
+    bool Contains(const COutPoint& outpoint) const { return mapCoins.count(outpoint) > 0; }
+    const Coin* Get(const COutPoint& outpoint) const;
+    size_t Size() const { return mapCoins.size(); }
+
+private:
+    std::map<COutPoint, Coin> mapCoins;
+    std::set<std::pair<int, COutPoint>> setByMaturity;
+};
+
 /** 
  * A CWallet is an extension of a keystore, which also maintains a set of transactions and balances,
  * and provides the ability to create new transactions.
@@ -711,6 +747,18 @@ private:
     void AddToSpends(const uint256& wtxid);
     void RemoveFromSpends(const uint256& wtxid);
 
+    /**
+     * Index of the outputs the staker can use, kept at nStakeableCoinsHeight by the block
+     * notifications. It is built on first use and dropped when the set of our scripts changes.
+     */
+    mutable CStakeableCoins stakeableCoins;
+    mutable bool fStakeableCoinsReady;
+    mutable int nStakeableCoinsHeight;
+    bool IsStakeableOutput(const CTxOut& txout, isminetype& mine) const;
+    void AddStakeableCoins(const CTransaction& tx, const CBlockIndex* pindex) const;
+    void LoadStakeableCoins() const;
+    void UpdateStakeableCoins(const CBlock& block, const CBlockIndex* pindex, bool fConnect);
+
     /* Mark a transaction (and its in-wallet descendants) as conflicting with a particular block. */
     void MarkConflicted(const uint256& hashBlock, const uint256& hashTx);
 
@@ -816,6 +864,8 @@ public:
         nRelockTime = 0;
         fAbortRescan = false;
         fScanningWallet = false;
+        fStakeableCoinsReady = false;
+        nStakeableCoinsHeight = 0;
     }
 
     std::map<uint256, CWalletTx> mapWallet;
@@ -998,6 +1048,12 @@ public:
     void ListAccountCreditDebit(const std::string& strAccount, std::list<CAccountingEntry>& entries);
     uint64_t GetStakeWeight() const;
     bool CreateCoinStake(const CKeyStore &keystore, unsigned int nBits, const CAmount& nTotalFees, uint32_t nTimeBlock, CMutableTransaction& tx, CKey& key);
+    /** Block times of the lookahead window [nTimeBegin, nTimeEnd) at which a coin meets the kernel target, in one pass */
+    std::vector<uint32_t> FindStakeTimes(unsigned int nBits, uint32_t nTimeBegin, uint32_t nTimeEnd);
+    /** The coins CreateCoinStake searches, with their kernel data */
+    void GetStakeKernelCoins(std::vector<CStakeKernelCoin>& vKernelCoins) const;
+    /** Kernel data of the coins of setCoins mature at pindexPrev, from the stakeable coins index */
+    void GetStakeKernelCoins(const std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, const CBlockIndex* pindexPrev, std::vector<CStakeKernelCoin>& vKernelCoins) const;
     CAmount CalUtxoInterest(const CAmount& value,int64_t nUtxoTime);//Caluate UTXO interest
     bool AddAccountingEntry(const CAccountingEntry&);
     bool AddAccountingEntry(const CAccountingEntry&, CWalletDB *pwalletdb);
@@ -9,6 +9,7 @@
 #include "validation.h"
 #include "streams.h"
 #include "util.h"
+#include "silubium/logsubscriptions.h"
 
 void zmqError(const char *str)
 {
@@ -39,6 +40,7 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
+    factories["pubcontractlog"] = CZMQAbstractNotifier::Create<CZMQPublishContractLogNotifier>;
 
     for (std::map<std::string, CZMQNotifierFactory>::const_iterator i=factories.begin(); i!=factories.end(); ++i)
     {
@@ -103,6 +105,11 @@ bool CZMQNotificationInterface::Initialize()
         return false;
     }
 
+    if (plogsubscriptions)
+    {
+        contractLogsConnection = plogsubscriptions->NotifyContractLogs.connect([this](const std::vector<ContractLog>& logs) { ContractLogsNotified(logs); });
+    }
+
     return true;
 }
 
@@ -110,6 +117,7 @@ bool CZMQNotificationInterface::Initialize()
 void CZMQNotificationInterface::Shutdown()
 {
     LogPrint(BCLog::ZMQ, "zmq: Shutdown notification interface\n");
+    contractLogsConnection.disconnect();
     if (pcontext)
     {
         for (std::list<CZMQAbstractNotifier*>::iterator i=notifiers.begin(); i!=notifiers.end(); ++i)
@@ -180,3 +188,22 @@ void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CB
         TransactionAddedToMempool(ptx);
     }
 }
+
+void CZMQNotificationInterface::ContractLogsNotified(const std::vector<ContractLog>& logs)
+{
+    for (const ContractLog& log : logs) {
+        for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+        {
+            CZMQAbstractNotifier *notifier = *i;
+            if (notifier->NotifyContractLog(log))
+            {
+                i++;
+            }
+            else
+            {
+                notifier->Shutdown();
+                i = notifiers.erase(i);
+            }
+        }
+    }
+}
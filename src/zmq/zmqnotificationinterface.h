@@ -9,9 +9,13 @@
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
+
+#include <boost/signals2/connection.hpp>
 
 class CBlockIndex;
 class CZMQAbstractNotifier;
+struct ContractLog;
 
 class CZMQNotificationInterface : public CValidationInterface
 {
@@ -30,11 +34,15 @@ protected:
     void BlockDisconnected(const std::shared_ptr<const CBlock>& pblock) override;
     void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override;
 
+    // LogSubscriptions
+    void ContractLogsNotified(const std::vector<ContractLog>& logs);
+
 private:
     CZMQNotificationInterface();
 
     void *pcontext;
     std::list<CZMQAbstractNotifier*> notifiers;
+    boost::signals2::connection contractLogsConnection;
 };
 
 #endif // BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
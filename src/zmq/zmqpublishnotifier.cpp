@@ -9,6 +9,7 @@
 #include "validation.h"
 #include "util.h"
 #include "rpc/server.h"
+#include "silubium/logsubscriptions.h"
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
@@ -16,6 +17,7 @@ static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_CONTRACTLOG = "contractlog";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -195,3 +197,17 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     ss << transaction;
     return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
+
+bool CZMQPublishContractLogNotifier::NotifyContractLog(const ContractLog &log)
+{
+    const TransactionReceiptInfo& receipt = *log.receipt;
+    LogPrint(BCLog::ZMQ, "zmq: Publish contractlog %s:%u\n", receipt.transactionHash.GetHex(), log.index);
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << receipt.blockHash << receipt.blockNumber << receipt.transactionHash << receipt.transactionIndex;
+    ss << uint160(receipt.contractAddress.asBytes()) << uint160(log.log().address.asBytes());
+    std::vector<uint256> topics;
+    for (const dev::h256& topic : log.log().topics)
+        topics.push_back(uint256(topic.asBytes()));
+    ss << topics << log.log().data << log.removed;
+    return SendMessage(MSG_CONTRACTLOG, &(*ss.begin()), ss.size());
+}
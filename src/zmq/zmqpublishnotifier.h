@@ -52,4 +52,10 @@ public:
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
+class CZMQPublishContractLogNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyContractLog(const ContractLog &log) override;
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H